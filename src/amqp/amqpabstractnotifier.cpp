@@ -10,12 +10,7 @@ AMQPAbstractNotifier::~AMQPAbstractNotifier()
 {
 }
 
-bool AMQPAbstractNotifier::NotifyBlock(const CBlockIndex * /*CBlockIndex*/)
-{
-    return true;
-}
-
-bool AMQPAbstractNotifier::NotifyTransaction(const CTransaction &/*transaction*/)
+bool AMQPAbstractNotifier::NotifyMessages(const std::vector<CNotificationMessage> &/*batch*/)
 {
     return true;
 }
@@ -6,8 +6,8 @@
 #define ZCASH_AMQP_AMQPABSTRACTNOTIFIER_H
 
 #include "amqpconfig.h"
+#include "notificationqueue.h"
 
-class CBlockIndex;
 class AMQPAbstractNotifier;
 
 typedef AMQPAbstractNotifier* (*AMQPNotifierFactory)();
@@ -28,16 +28,19 @@ public:
     void SetType(const std::string &t) { type = t; }
     std::string GetAddress() const { return address; }
     void SetAddress(const std::string &a) { address = a; }
+    std::string GetTopic() const { return topic; }
+    void SetTopic(const std::string &t) { topic = t; }
 
     virtual bool Initialize() = 0;
     virtual void Shutdown() = 0;
 
-    virtual bool NotifyBlock(const CBlockIndex *pindex);
-    virtual bool NotifyTransaction(const CTransaction &transaction);
+    //! publish the messages of this notifier's topic in a batch
+    virtual bool NotifyMessages(const std::vector<CNotificationMessage> &batch);
 
 protected:
     std::string type;
     std::string address;
+    std::string topic;
 };
 
 #endif // ZCASH_AMQP_AMQPABSTRACTNOTIFIER_H
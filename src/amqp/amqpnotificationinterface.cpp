@@ -5,23 +5,13 @@
 #include "amqpnotificationinterface.h"
 #include "amqppublishnotifier.h"
 
-#include "version.h"
-#include "main.h"
-#include "streams.h"
 #include "util.h"
 
 // AMQP 1.0 Support
 //
-// The boost::signals2 signals and slot system is thread safe, so CValidationInterface listeners
-// can be invoked from any thread.
-//
-// Currently signals are fired from main.cpp so the callbacks should be invoked on the same thread.
-// It should be safe to share objects responsible for sending, as they should not be run concurrently
-// across different threads.
-//
-// Developers should be mindful of where notifications are fired to avoid potential race conditions.
-// For example, different signals targeting the same address could be fired from different threads
-// in different parts of the system around the same time.
+// Notifications are serialized and queued by CNotificationQueue, and batches are published from its
+// notification thread only. It is safe to share objects responsible for sending, as they are never
+// run concurrently across different threads.
 //
 // Like the ZMQ notification interface, if a notifier fails to send a message, the notifier is shut down.
 //
@@ -42,21 +32,15 @@ AMQPNotificationInterface::~AMQPNotificationInterface()
 AMQPNotificationInterface* AMQPNotificationInterface::CreateWithArguments(const std::map<std::string, std::string> &args)
 {
     AMQPNotificationInterface* notificationInterface = nullptr;
-    std::map<std::string, AMQPNotifierFactory> factories;
     std::list<AMQPAbstractNotifier*> notifiers;
 
-    factories["pubhashblock"] = AMQPAbstractNotifier::Create<AMQPPublishHashBlockNotifier>;
-    factories["pubhashtx"] = AMQPAbstractNotifier::Create<AMQPPublishHashTransactionNotifier>;
-    factories["pubrawblock"] = AMQPAbstractNotifier::Create<AMQPPublishRawBlockNotifier>;
-    factories["pubrawtx"] = AMQPAbstractNotifier::Create<AMQPPublishRawTransactionNotifier>;
-
-    for (std::map<std::string, AMQPNotifierFactory>::const_iterator i=factories.begin(); i!=factories.end(); ++i) {
-        std::map<std::string, std::string>::const_iterator j = args.find("-amqp" + i->first);
+    for (const std::string &topic : GetNotificationTopics()) {
+        std::map<std::string, std::string>::const_iterator j = args.find("-amqppub" + topic);
         if (j!=args.end()) {
-            AMQPNotifierFactory factory = i->second;
             std::string address = j->second;
-            AMQPAbstractNotifier *notifier = factory();
-            notifier->SetType(i->first);
+            AMQPAbstractNotifier *notifier = AMQPAbstractNotifier::Create<AMQPPublishNotifier>();
+            notifier->SetType("pub" + topic);
+            notifier->SetTopic(topic);
             notifier->SetAddress(address);
             notifiers.push_back(notifier);
         }
@@ -109,24 +93,20 @@ void AMQPNotificationInterface::Shutdown()
     }
 }
 
-void AMQPNotificationInterface::UpdatedBlockTip(const CBlockIndex *pindex)
+std::set<std::string> AMQPNotificationInterface::GetTopics() const
 {
-    for (std::list<AMQPAbstractNotifier*>::iterator i = notifiers.begin(); i != notifiers.end(); ) {
-        AMQPAbstractNotifier *notifier = *i;
-        if (notifier->NotifyBlock(pindex)) {
-            i++;
-        } else {
-            notifier->Shutdown();
-            i = notifiers.erase(i);
-        }
+    std::set<std::string> topics;
+    for (std::list<AMQPAbstractNotifier*>::const_iterator i = notifiers.begin(); i != notifiers.end(); ++i) {
+        topics.insert((*i)->GetTopic());
     }
+    return topics;
 }
 
-void AMQPNotificationInterface::SyncTransaction(const CTransaction &tx, const CBlock *pblock)
+void AMQPNotificationInterface::PublishBatch(const std::vector<CNotificationMessage> &batch)
 {
     for (std::list<AMQPAbstractNotifier*>::iterator i = notifiers.begin(); i != notifiers.end(); ) {
         AMQPAbstractNotifier *notifier = *i;
-        if (notifier->NotifyTransaction(tx)) {
+        if (notifier->NotifyMessages(batch)) {
             i++;
         } else {
             notifier->Shutdown();
@@ -5,28 +5,28 @@
 #ifndef ZCASH_AMQP_AMQPNOTIFICATIONINTERFACE_H
 #define ZCASH_AMQP_AMQPNOTIFICATIONINTERFACE_H
 
-#include "validationinterface.h"
+#include "notificationqueue.h"
+#include <list>
 #include <string>
 #include <map>
 
-class CBlockIndex;
 class AMQPAbstractNotifier;
 
-class AMQPNotificationInterface : public CValidationInterface
+class AMQPNotificationInterface : public CNotificationSink
 {
 public:
     virtual ~AMQPNotificationInterface();
 
     static AMQPNotificationInterface* CreateWithArguments(const std::map<std::string, std::string> &args);
 
+    // CNotificationSink
+    std::set<std::string> GetTopics() const;
+    void PublishBatch(const std::vector<CNotificationMessage> &batch);
+
 protected:
     bool Initialize();
     void Shutdown();
 
-    // CValidationInterface
-    void SyncTransaction(const CTransaction &tx, const CBlock *pblock);
-    void UpdatedBlockTip(const CBlockIndex *pindex);
-
 private:
     AMQPNotificationInterface();
 
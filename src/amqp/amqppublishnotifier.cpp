@@ -3,8 +3,6 @@
 // file COPYING or https://www.opensource.org/licenses/mit-license.php .
 
 #include "amqppublishnotifier.h"
-#include "chainparams.h"
-#include "main.h"
 #include "util.h"
 
 #include "amqpsender.h"
@@ -12,15 +10,10 @@
 #include <memory>
 #include <thread>
 
-static std::multimap<std::string, AMQPAbstractPublishNotifier*> mapPublishNotifiers;
-
-static const char *MSG_HASHBLOCK = "hashblock";
-static const char *MSG_HASHTX    = "hashtx";
-static const char *MSG_RAWBLOCK  = "rawblock";
-static const char *MSG_RAWTX     = "rawtx";
+static std::multimap<std::string, AMQPPublishNotifier*> mapPublishNotifiers;
 
 // Invoke this method from a new thread to run the proton container event loop.
-void AMQPAbstractPublishNotifier::SpawnProtonContainer()
+void AMQPPublishNotifier::SpawnProtonContainer()
 {
     try {
         proton::default_container(*handler_).run();
@@ -40,14 +33,14 @@ void AMQPAbstractPublishNotifier::SpawnProtonContainer()
     handler_->terminate();
 }
 
-bool AMQPAbstractPublishNotifier::Initialize()
+bool AMQPPublishNotifier::Initialize()
 {
-    std::multimap<std::string, AMQPAbstractPublishNotifier*>::iterator i = mapPublishNotifiers.find(address);
+    std::multimap<std::string, AMQPPublishNotifier*>::iterator i = mapPublishNotifiers.find(address);
 
     if (i == mapPublishNotifiers.end()) {
         try {
             handler_ = std::make_shared<AMQPSender>(address);
-            thread_ = std::make_shared<std::thread>(&AMQPAbstractPublishNotifier::SpawnProtonContainer, this);
+            thread_ = std::make_shared<std::thread>(&AMQPPublishNotifier::SpawnProtonContainer, this);
         }
         catch (std::exception &e) {
             LogPrint("amqp", "amqp: initialization error: %s\n", e.what());
@@ -65,14 +58,14 @@ bool AMQPAbstractPublishNotifier::Initialize()
 }
 
 
-void AMQPAbstractPublishNotifier::Shutdown()
+void AMQPPublishNotifier::Shutdown()
 {
     LogPrint("amqp", "amqp: Shutdown notifier %s at %s\n", GetType(), GetAddress());
 
     int count = mapPublishNotifiers.count(address);
 
     // remove this notifier from the list of publishers using this address
-    typedef std::multimap<std::string, AMQPAbstractPublishNotifier*>::iterator iterator;
+    typedef std::multimap<std::string, AMQPPublishNotifier*>::iterator iterator;
     std::pair<iterator, iterator> iterpair = mapPublishNotifiers.equal_range(address);
 
     for (iterator it = iterpair.first; it != iterpair.second; ++it) {
@@ -94,18 +87,22 @@ void AMQPAbstractPublishNotifier::Shutdown()
 }
 
 
-bool AMQPAbstractPublishNotifier::SendMessage(const char *command, const void* data, size_t size)
+bool AMQPPublishNotifier::SendMessages(const char *command, const std::vector<CNotificationPayload> &payloads)
 {
-    try { 
-        proton::binary content;
-        const char *p = (const char *)data;
-        content.assign(p, p + size);
-
-        proton::message message(content);
-        message.subject(std::string(command));
-        proton::message::property_map & props = message.properties();
-        props.put("x-opt-sequence-number", sequence_);
-        handler_->publish(message);
+    try {
+        std::vector<proton::message> messages;
+        messages.reserve(payloads.size());
+        for (size_t i = 0; i < payloads.size(); i++) {
+            proton::binary content;
+            content.assign(payloads[i]->begin(), payloads[i]->end());
+
+            proton::message message(content);
+            message.subject(std::string(command));
+            proton::message::property_map & props = message.properties();
+            props.put("x-opt-sequence-number", sequence_ + i);
+            messages.push_back(message);
+        }
+        handler_->publishBatch(messages);
 
     } catch (proton::error_condition &e) {
         LogPrint("amqp", "amqp: error : %s\n", e.what());
@@ -124,56 +121,22 @@ bool AMQPAbstractPublishNotifier::SendMessage(const char *command, const void* d
         return false;
     }
 
-    sequence_++;
+    sequence_ += payloads.size();
 
     return true;
 }
 
-bool AMQPPublishHashBlockNotifier::NotifyBlock(const CBlockIndex *pindex)
+bool AMQPPublishNotifier::NotifyMessages(const std::vector<CNotificationMessage> &batch)
 {
-    uint256 hash = pindex->GetBlockHash();
-    LogPrint("amqp", "amqp: Publish hashblock %s\n", hash.GetHex());
-    char data[32];
-    for (unsigned int i = 0; i < 32; i++)
-        data[31 - i] = hash.begin()[i];
-    return SendMessage(MSG_HASHBLOCK, data, 32);
-}
-
-bool AMQPPublishHashTransactionNotifier::NotifyTransaction(const CTransaction &transaction)
-{
-    uint256 hash = transaction.GetHash();
-    LogPrint("amqp", "amqp: Publish hashtx %s\n", hash.GetHex());
-    char data[32];
-    for (unsigned int i = 0; i < 32; i++)
-        data[31 - i] = hash.begin()[i];
-    return SendMessage(MSG_HASHTX, data, 32);
-}
-
-bool AMQPPublishRawBlockNotifier::NotifyBlock(const CBlockIndex *pindex)
-{
-    LogPrint("amqp", "amqp: Publish rawblock %s\n", pindex->GetBlockHash().GetHex());
-
-    const Consensus::Params& consensusParams = Params().GetConsensus();
-    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
-    {
-        LOCK(cs_main);
-        CBlock block;
-        if(!ReadBlockFromDisk(block, pindex, consensusParams)) {
-            LogPrint("amqp", "amqp: Can't read block from disk");
-            return false;
+    std::vector<CNotificationPayload> payloads;
+    for (const CNotificationMessage &message : batch) {
+        if (message.topic == topic) {
+            payloads.push_back(message.payload);
         }
-
-        ss << block;
     }
-
-    return SendMessage(MSG_RAWBLOCK, &(*ss.begin()), ss.size());
-}
-
-bool AMQPPublishRawTransactionNotifier::NotifyTransaction(const CTransaction &transaction)
-{
-    uint256 hash = transaction.GetHash();
-    LogPrint("amqp", "amqp: Publish rawtx %s\n", hash.GetHex());
-    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
-    ss << transaction;
-    return SendMessage(MSG_RAWTX, &(*ss.begin()), ss.size());
+    if (payloads.empty()) {
+        return true;
+    }
+    LogPrint("amqp", "amqp: Publish %u %s\n", (unsigned int)payloads.size(), topic);
+    return SendMessages(topic.c_str(), payloads);
 }
@@ -12,9 +12,7 @@
 #include <memory>
 #include <thread>
 
-class CBlockIndex;
-
-class AMQPAbstractPublishNotifier : public AMQPAbstractNotifier
+class AMQPPublishNotifier : public AMQPAbstractNotifier
 {
 private:
     uint64_t sequence_;                         // memory only, per notifier instance: upcounting message sequence number
@@ -23,34 +21,12 @@ private:
     std::shared_ptr<AMQPSender> handler_;      // proton container message handler, may be shared between notifiers
 
 public:
-    bool SendMessage(const char *command, const void* data, size_t size);
+    bool SendMessages(const char *command, const std::vector<CNotificationPayload> &payloads);
     bool Initialize();
     void Shutdown();
     void SpawnProtonContainer();
-};
-
-class AMQPPublishHashBlockNotifier : public AMQPAbstractPublishNotifier
-{
-public:
-    bool NotifyBlock(const CBlockIndex *pindex);
-};
-
-class AMQPPublishHashTransactionNotifier : public AMQPAbstractPublishNotifier
-{
-public:
-    bool NotifyTransaction(const CTransaction &transaction);
-};
-
-class AMQPPublishRawBlockNotifier : public AMQPAbstractPublishNotifier
-{
-public:
-    bool NotifyBlock(const CBlockIndex *pindex);
-};
 
-class AMQPPublishRawTransactionNotifier : public AMQPAbstractPublishNotifier
-{
-public:
-    bool NotifyTransaction(const CTransaction &transaction);
+    bool NotifyMessages(const std::vector<CNotificationMessage> &batch);
 };
 
 #endif // ZCASH_AMQP_AMQPPUBLISHNOTIFIER_H
@@ -11,6 +11,7 @@
 #include <memory>
 #include <future>
 #include <iostream>
+#include <vector>
 
 class AMQPSender : public proton::messaging_handler {
   private:
@@ -44,6 +45,15 @@ class AMQPSender : public proton::messaging_handler {
         dispatch();
     }
 
+    // Publish messages by adding them all to the queue and dispatching once
+    void publishBatch(const std::vector<proton::message> &ms) {
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            messages_.insert(messages_.end(), ms.begin(), ms.end());
+        }
+        dispatch();
+    }
+
     // Add message to queue
     void add_message(const proton::message &m) {
         std::lock_guard<std::mutex> guard(lock_);
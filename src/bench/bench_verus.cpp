@@ -0,0 +1,117 @@
+// Copyright (c) 2026 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#include "clientversion.h"
+#include "crypto/verus_hash.h"
+#include "util.h"
+#include "utilstrencodings.h"
+#include "verusbenchmarks.h"
+
+#include <fstream>
+#include <iostream>
+#include <set>
+
+#include <boost/algorithm/string.hpp>
+
+static const int DEFAULT_BENCH_SAMPLES = 5;
+
+static void PrintUsage()
+{
+    std::cout << "Usage: bench_verus [options]\n"
+              << "\n"
+              << "Runs the Verus benchmarks that need no chain, on synthetic data from a fixed seed.\n"
+              << "Benchmarks that need a chain are run with the zcbenchmark RPC in regtest.\n"
+              << "\n"
+              << "  -list              List the benchmarks and exit\n"
+              << "  -filter=<names>    Only run these benchmarks, comma separated\n"
+              << "  -samples=<n>       Samples per benchmark (default: " << DEFAULT_BENCH_SAMPLES << ")\n"
+              << "  -format=<fmt>      Output json or csv (default: json)\n"
+              << "  -output=<file>     Write the results to file instead of stdout\n";
+}
+
+int main(int argc, char *argv[])
+{
+    SetupEnvironment();
+    ParseParameters(argc, argv);
+
+    if (mapArgs.count("-?") || mapArgs.count("-h") || mapArgs.count("-help"))
+    {
+        PrintUsage();
+        return 0;
+    }
+
+    std::vector<CVerusBenchmark> benchmarks = GetStandaloneBenchmarks();
+    if (mapArgs.count("-list"))
+    {
+        for (auto &benchmark : benchmarks)
+        {
+            std::cout << benchmark.name << "\n";
+        }
+        return 0;
+    }
+
+    std::set<std::string> filter;
+    if (mapArgs.count("-filter"))
+    {
+        boost::split(filter, mapArgs["-filter"], boost::is_any_of(","));
+    }
+    int nSamples = GetArg("-samples", DEFAULT_BENCH_SAMPLES);
+    std::string format = GetArg("-format", "json");
+    if (nSamples < 1 || (format != "json" && format != "csv"))
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    CVerusHash::init();
+    CVerusHashV2::init();
+
+    UniValue results(UniValue::VARR);
+    std::string csv = "name,sample,seconds\n";
+    for (auto &benchmark : benchmarks)
+    {
+        if (filter.size() && !filter.count(benchmark.name))
+        {
+            continue;
+        }
+        std::vector<double> samples;
+        for (int i = 0; i < nSamples; i++)
+        {
+            samples.push_back(benchmark.run());
+            csv += strprintf("%s,%d,%.9f\n", benchmark.name, i, samples.back());
+        }
+        results.push_back(BenchmarkResultToUniValue(benchmark.name, samples));
+        std::cerr << benchmark.name << " done\n";
+    }
+
+    std::string output;
+    if (format == "csv")
+    {
+        output = csv;
+    }
+    else
+    {
+        UniValue ret(UniValue::VOBJ);
+        ret.push_back(Pair("version", FormatFullVersion()));
+        ret.push_back(Pair("samples", nSamples));
+        ret.push_back(Pair("benchmarks", results));
+        output = ret.write(1) + "\n";
+    }
+
+    if (mapArgs.count("-output"))
+    {
+        std::ofstream file(mapArgs["-output"]);
+        if (!file)
+        {
+            std::cerr << "Cannot write " << mapArgs["-output"] << "\n";
+            return 1;
+        }
+        file << output;
+    }
+    else
+    {
+        std::cout << output;
+    }
+    return 0;
+}
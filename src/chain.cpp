@@ -4,6 +4,8 @@
 // file COPYING or https://www.opensource.org/licenses/mit-license.php .
 
 #include "chain.h"
+#include "main.h"
+#include "txdb.h"
 
 using namespace std;
 
@@ -36,6 +38,24 @@ void CChain::SetTip(CBlockIndex *pindex) {
 // if it returns false, value is set to 0, but it can still be calculated from the full block
 // in that case. the only difference between this and the POS hash for the contest is that it is not divided by the value out
 // this is used as a source of entropy
+bool CBlockIndex::GetSolution(std::vector<unsigned char> &solution) const
+{
+    std::shared_ptr<const CCompactSolutionVector> pSol = std::atomic_load(&pSolution);
+    if (pSol)
+    {
+        solution = pSol->nSolution();
+        return true;
+    }
+    CDiskBlockIndex dbindex;
+    if (!pblocktree || !phashBlock || !pblocktree->ReadDiskBlockIndex(GetBlockHash(), dbindex))
+    {
+        solution.clear();
+        return error("%s: cannot read solution of block %s from the block tree database", __func__, phashBlock ? GetBlockHash().GetHex() : "(none)");
+    }
+    solution = std::move(dbindex.nSolution);
+    return true;
+}
+
 bool CBlockIndex::GetRawVerusPOSHash(uint256 &ret) const
 {
     // if below the required height or no storage space in the solution, we can't get
@@ -56,7 +76,7 @@ bool CBlockIndex::GetRawVerusPOSHash(uint256 &ret) const
     //                          )
     //    hashWriter << height;
     //    return hashWriter.GetHash();
-    ret = CBlockHeader::GetRawVerusPOSHash(nVersion, CConstVerusSolutionVector::Version(nSolution.nSolution()), ASSETCHAINS_MAGIC, nNonce, GetHeight());
+    ret = CBlockHeader::GetRawVerusPOSHash(nVersion, nSolutionVersion, ASSETCHAINS_MAGIC, nNonce, GetHeight());
     return true;
 }
 
@@ -257,8 +277,7 @@ CPartialTransactionProof CChain::GetPreHeaderProof(const CBlock &block, uint32_t
     uint256 entropyHash;
     if (block.IsAdvancedHeader() != 0)
     {
-        std::vector<unsigned char> nSol((*this)[blockHeight]->nSolution.nSolution());
-        bool posEntropyInfo = CVerusSolutionVector(nSol).Version() >= CActivationHeight::ACTIVATE_PBAAS;
+        bool posEntropyInfo = (*this)[blockHeight]->nSolutionVersion >= CActivationHeight::ACTIVATE_PBAAS;
 
         if (posEntropyInfo)
         {
@@ -15,6 +15,7 @@ class CChainPower;
 #include "uint256.h"
 #include "mmr.h"
 
+#include <memory>
 #include <vector>
 
 static const int SPROUT_VALUE_VERSION = 1001400;
@@ -340,11 +341,24 @@ public:
     unsigned int nTime;
     unsigned int nBits;
     uint256 nNonce;
-    CCompactSolutionVector nSolution;
+
+    //! Version of the header's solution and the block MMR root committed to by it, or the merkle
+    //! root before PBaaS. These are kept in memory, so the chain MMR and block entropy can be
+    //! calculated without loading the solution itself.
+    uint32_t nSolutionVersion;
+    uint256 hashBlockMMRRoot;
 
     //! (memory only) Sequential id assigned to distinguish order in which blocks are received.
     uint32_t nSequenceId;
 
+private:
+    //! Solution of the header. Once the index has been written to the block tree database, the
+    //! solution is dropped from memory and read back by GetSolution() when needed, since PBaaS
+    //! solutions carrying merged mining headers make up most of the size of the block index.
+    mutable std::shared_ptr<const CCompactSolutionVector> pSolution;
+
+public:
+
     void SetNull()
     {
         phashBlock = NULL;
@@ -376,7 +390,9 @@ public:
         nTime          = 0;
         nBits          = 0;
         nNonce         = uint256();
-        nSolution = CCompactSolutionVector();
+        nSolutionVersion = 0;
+        hashBlockMMRRoot = uint256();
+        pSolution.reset();
     }
 
     CBlockIndex()
@@ -394,7 +410,7 @@ public:
         nTime          = block.nTime;
         nBits          = block.nBits;
         nNonce         = block.nNonce;
-        nSolution      = block.nSolution;
+        SetSolution(block.nSolution);
     }
 
     void SetHeight(int32_t height)
@@ -425,18 +441,70 @@ public:
         return ret;
     }
 
-    CBlockHeader GetBlockHeader() const
+    //! Set nSolutionVersion and hashBlockMMRRoot from the header's solution, without keeping it in memory.
+    //! nVersion and hashMerkleRoot must be set first.
+    void SetSolutionSummary(const std::vector<unsigned char> &solution)
+    {
+        nSolutionVersion = CConstVerusSolutionVector::Version(solution);
+        hashBlockMMRRoot = hashMerkleRoot;
+        if (nVersion == CBlockHeader::VERUS_V2)
+        {
+            CPBaaSSolutionDescriptor descr = CConstVerusSolutionVector::GetDescriptor(solution);
+            if (descr.version >= CActivationHeight::ACTIVATE_PBAAS)
+            {
+                hashBlockMMRRoot = descr.hashBlockMMRRoot;
+            }
+        }
+    }
+
+    //! Set the header's solution and keep it in memory until the index is written to disk
+    void SetSolution(const std::vector<unsigned char> &solution)
+    {
+        SetSolutionSummary(solution);
+        std::atomic_store(&pSolution, std::shared_ptr<const CCompactSolutionVector>(std::make_shared<CCompactSolutionVector>(solution)));
+    }
+
+    bool HasSolution() const
+    {
+        return std::atomic_load(&pSolution) != nullptr;
+    }
+
+    //! Drop the solution from memory. Only call this once the index is stored in the block tree database.
+    void TrimSolution() const
+    {
+        std::atomic_store(&pSolution, std::shared_ptr<const CCompactSolutionVector>());
+    }
+
+    //! Get the header's solution, reading it from the block tree database if it is not in memory.
+    //! Returns false if it cannot be read.
+    bool GetSolution(std::vector<unsigned char> &solution) const;
+
+    //! Return the header's solution, or an empty solution if it cannot be read
+    std::vector<unsigned char> GetSolution() const
+    {
+        std::vector<unsigned char> solution;
+        GetSolution(solution);
+        return solution;
+    }
+
+    //! Get the header, returns false if its solution cannot be read
+    bool GetBlockHeader(CBlockHeader &block) const
     {
-        CBlockHeader block;
         block.nVersion       = nVersion;
-        if (pprev)
-            block.hashPrevBlock = pprev->GetBlockHash();
+        block.hashPrevBlock  = pprev ? pprev->GetBlockHash() : uint256();
         block.hashMerkleRoot = hashMerkleRoot;
         block.hashFinalSaplingRoot   = hashFinalSaplingRoot;
         block.nTime          = nTime;
         block.nBits          = nBits;
         block.nNonce         = nNonce;
-        block.nSolution      = nSolution.nSolution();
+        return GetSolution(block.nSolution);
+    }
+
+    //! Return the header, with an empty solution if it cannot be read
+    CBlockHeader GetBlockHeader() const
+    {
+        CBlockHeader block;
+        GetBlockHeader(block);
         return block;
     }
 
@@ -504,14 +572,23 @@ public:
     CBlockIndex* GetAncestor(int height);
     const CBlockIndex* GetAncestor(int height) const;
 
+    //! Header fields needed to check for and read the proof of stake target, which is in the nonce
+    CBlockHeader GetPOSHeader() const
+    {
+        CBlockHeader block;
+        block.nVersion       = nVersion;
+        block.nNonce         = nNonce;
+        return block;
+    }
+
     int32_t GetVerusPOSTarget() const
     {
-        return GetBlockHeader().GetVerusPOSTarget();
+        return GetPOSHeader().GetVerusPOSTarget();
     }
 
     bool IsVerusPOSBlock() const
     {
-        return GetBlockHeader().IsVerusPOSBlock();
+        return GetPOSHeader().IsVerusPOSBlock();
     }
 
     bool GetRawVerusPOSHash(uint256 &ret) const;
@@ -519,22 +596,14 @@ public:
 
     uint256 BlockMMRRoot() const
     {
-        if (nVersion == CBlockHeader::VERUS_V2)
-        {
-            CPBaaSSolutionDescriptor descr = CConstVerusSolutionVector::GetDescriptor((nSolution.nSolution()));
-            if (descr.version >= CActivationHeight::ACTIVATE_PBAAS)
-            {
-                return descr.hashBlockMMRRoot;
-            }
-        }
-        return hashMerkleRoot;
+        return hashBlockMMRRoot;
     }
 
     uint256 PrevMMRRoot()
     {
         if (nVersion == CBlockHeader::VERUS_V2)
         {
-            CPBaaSSolutionDescriptor descr = CConstVerusSolutionVector::GetDescriptor(nSolution.nSolution());
+            CPBaaSSolutionDescriptor descr = CConstVerusSolutionVector::GetDescriptor(GetSolution());
             if (descr.version >= CActivationHeight::ACTIVATE_PBAAS)
             {
                 return descr.hashPrevMMRRoot;
@@ -584,13 +653,17 @@ class CDiskBlockIndex : public CBlockIndex
 {
 public:
     uint256 hashPrev;
+    std::vector<unsigned char> nSolution;
 
     CDiskBlockIndex() : CBlockIndex() {
         hashPrev = uint256();
     }
 
-    explicit CDiskBlockIndex(const CBlockIndex* pindex) : CBlockIndex(*pindex) {
+    explicit CDiskBlockIndex(const CBlockIndex* pindex) : CDiskBlockIndex(pindex, pindex->GetSolution()) {}
+
+    CDiskBlockIndex(const CBlockIndex* pindex, const std::vector<unsigned char> &solution) : CBlockIndex(*pindex) {
         hashPrev = (pprev ? pprev->GetBlockHash() : uint256());
+        nSolution = solution;
     }
 
     ADD_SERIALIZE_METHODS;
@@ -639,25 +712,7 @@ public:
         READWRITE(nBits);
         READWRITE(nNonce);
 
-        if (CCompactSolutionVector::IsCompressionOn())
-        {
-            std::vector<unsigned char> tmpSolution;
-            if (ser_action.ForRead())
-            {
-                READWRITE(tmpSolution);
-                nSolution = tmpSolution;
-            }
-            else
-            {
-                tmpSolution = nSolution.nSolution();
-                READWRITE(tmpSolution);
-            }
-        }
-        else
-        {
-            READWRITE(nSolution.vch);
-            nSolution._size = nSolution.vch.size();
-        }
+        READWRITE(nSolution);
 
         // Only read/write nSproutValue if the client version used to create
         // this index was storing them.
@@ -685,7 +740,7 @@ public:
         block.nTime           = nTime;
         block.nBits           = nBits;
         block.nNonce          = nNonce;
-        block.nSolution       = nSolution.nSolution();
+        block.nSolution       = nSolution;
         return block.GetHash();
     }
 
@@ -701,11 +756,11 @@ public:
         block.nTime           = nTime;
         block.nBits           = nBits;
         block.nNonce          = nNonce;
-        block.nSolution       = nSolution.nSolution();
+        block.nSolution       = nSolution;
         CPBaaSPreHeader preBlock(block);
 
         str += strprintf("block.nVersion=%x\npprev=%p\nnHeight=%d\nhashBlock=%s\nblock.hashPrevBlock=%s\nblock.hashMerkleRoot=%s\nblock.nBits=%d\nblock.nNonce=%s\nblock.nSolution=%s\npreBlock.hashPrevMMRRoot=%s\npreBlock.hashBlockMMRRoot=%s\n",
-            this->nVersion, pprev, this->chainPower.nHeight, GetBlockHash().ToString(), hashPrev.ToString(), hashMerkleRoot.ToString(), nBits, nNonce.ToString(), HexBytes(nSolution.nSolution().data(), nSolution.size()), preBlock.hashPrevMMRRoot.ToString(), preBlock.hashBlockMMRRoot.ToString());
+            this->nVersion, pprev, this->chainPower.nHeight, GetBlockHash().ToString(), hashPrev.ToString(), hashMerkleRoot.ToString(), nBits, nNonce.ToString(), HexBytes(nSolution.data(), nSolution.size()), preBlock.hashPrevMMRRoot.ToString(), preBlock.hashBlockMMRRoot.ToString());
 
         return str;
     }
@@ -6,9 +6,12 @@
 #define BITCOIN_CHECKQUEUE_H
 
 #include <algorithm>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <variant>
 #include <vector>
 
-#include <boost/foreach.hpp>
 #include <boost/thread/condition_variable.hpp>
 #include <boost/thread/locks.hpp>
 #include <boost/thread/mutex.hpp>
@@ -16,21 +19,96 @@
 template <typename T>
 class CCheckQueueControl;
 
-/** 
+/**
+ * A check of one of the types Checks, which lets one queue run verifications from different
+ * sources, such as scripts, deferred signatures and shielded proofs, side by side. Like the
+ * checks themselves, it is only ever swapped, so queueing a check neither copies it nor
+ * allocates.
+ */
+template <typename... Checks>
+class CCheckVariant
+{
+private:
+    std::variant<std::monostate, Checks...> check;
+
+public:
+    //! Take over the check by swapping it out of checkIn, which is left default constructed
+    template <typename C>
+    void Take(C& checkIn)
+    {
+        check.template emplace<C>();
+        std::get<C>(check).swap(checkIn);
+    }
+
+    bool operator()()
+    {
+        return std::visit([](auto& oneCheck) { return Run(oneCheck); }, check);
+    }
+
+    void swap(CCheckVariant& other)
+    {
+        if (check.index() != other.check.index()) {
+            // the queues swap checks with empty ones, so move by default constructing and swapping
+            if (check.index() == 0) {
+                other.swap(*this);
+                return;
+            }
+            if (other.check.index() != 0) {
+                std::swap(check, other.check);
+                return;
+            }
+            std::visit([&other](auto& oneCheck) { Give(oneCheck, other); }, check);
+            check.template emplace<std::monostate>();
+            return;
+        }
+        std::visit([&other](auto& oneCheck) { Swap(oneCheck, other.check); }, check);
+    }
+
+private:
+    static bool Run(std::monostate&) { return true; }
+    template <typename C>
+    static bool Run(C& oneCheck) { return oneCheck(); }
+
+    static void Give(std::monostate&, CCheckVariant&) {}
+    template <typename C>
+    static void Give(C& oneCheck, CCheckVariant& other) { other.Take(oneCheck); }
+
+    static void Swap(std::monostate&, std::variant<std::monostate, Checks...>&) {}
+    template <typename C>
+    static void Swap(C& oneCheck, std::variant<std::monostate, Checks...>& other) { oneCheck.swap(std::get<C>(other)); }
+};
+
+/**
  * Queue for verifications that have to be performed.
-  * The verifications are represented by a type T, which must provide an
-  * operator(), returning a bool.
-  *
-  * One thread (the master) is assumed to push batches of verifications
-  * onto the queue, where they are processed by N-1 worker threads. When
-  * the master is done adding work, it temporarily joins the worker pool
-  * as an N'th worker, until all jobs are done.
-  */
+ * The verifications are represented by a type T, which must provide an
+ * operator(), returning a bool.
+ *
+ * One thread (the master) is assumed to push batches of verifications
+ * onto the queue, where they are processed by N-1 worker threads. When
+ * the master is done adding work, it temporarily joins the worker pool
+ * as an N'th worker, until all jobs are done.
+ *
+ * Each worker, including the master, owns a deque of checks. Added checks are
+ * spread over all deques, owners take work from the back of their own deque and
+ * workers that run dry steal half of another worker's deque from the front, so
+ * threads only contend on a deque when stealing. The shared mutex is only used
+ * by threads that have no work left to go to sleep and to be woken up.
+ */
 template <typename T>
 class CCheckQueue
 {
 private:
-    //! Mutex to protect the inner state
+    //! Deque of checks owned by one worker
+    struct WorkerQueue
+    {
+        boost::mutex mutex;
+        std::deque<T> checks;
+    };
+
+    //! Maximum number of worker deques, threads beyond this share deques
+    static const unsigned int MAX_WORKER_QUEUES = 64;
+
+    //! Mutex protecting sleeping and waking of workers and master
     boost::mutex mutex;
 
     //! Worker threads block on this when out of work
@@ -39,25 +117,27 @@ private:
     //! Master thread blocks on this when out of work
     boost::condition_variable condMaster;
 
-    //! The queue of elements to be processed.
-    //! As the order of booleans doesn't matter, it is used as a LIFO (stack)
-    std::vector<T> queue;
+    //! Per worker deques, slot 0 belongs to the master
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
 
-    //! The number of workers (including the master) that are idle.
-    int nIdle;
+    //! Number of worker threads that have registered a deque
+    std::atomic<unsigned int> nWorkers;
 
-    //! The total number of workers (including the master).
-    int nTotal;
+    //! Number of checks sitting in any deque
+    std::atomic<unsigned int> nQueued;
 
-    //! The temporary evaluation result.
-    bool fAllOk;
+    //! Deque that the next added batch starts filling, so single checks are dealt out round robin
+    std::atomic<unsigned int> nNextQueue;
 
     /**
      * Number of verifications that haven't completed yet.
      * This includes elements that are no longer queued, but still in the
      * worker's own batches.
      */
-    unsigned int nTodo;
+    std::atomic<unsigned int> nTodo;
+
+    //! The temporary evaluation result.
+    std::atomic<bool> fAllOk;
 
     //! Whether we're shutting down.
     bool fQuit;
@@ -65,95 +145,134 @@ private:
     //! The maximum number of elements to be processed in one batch
     unsigned int nBatchSize;
 
+    //! Number of deques currently in use, including the master's
+    unsigned int NumQueues() const
+    {
+        return std::min(nWorkers.load() + 1, MAX_WORKER_QUEUES);
+    }
+
+    //! Move a batch of checks from the back (own deque) or front (stolen) of a deque into vChecks
+    unsigned int Take(WorkerQueue& queue, std::vector<T>& vChecks, bool fSteal)
+    {
+        boost::unique_lock<boost::mutex> lock(queue.mutex);
+        unsigned int nSize = queue.checks.size();
+        if (!nSize)
+            return 0;
+        // Owners aim for shrinking batches so all workers finish at about the same time,
+        // thieves take half of what is left to cut the number of steals needed.
+        unsigned int nNow = fSteal ? (nSize + 1) / 2 : nSize / NumQueues();
+        nNow = std::max(1U, std::min(nBatchSize, nNow));
+        vChecks.resize(nNow);
+        for (unsigned int i = 0; i < nNow; i++) {
+            if (fSteal) {
+                vChecks[i].swap(queue.checks.front());
+                queue.checks.pop_front();
+            } else {
+                vChecks[i].swap(queue.checks.back());
+                queue.checks.pop_back();
+            }
+        }
+        nQueued -= nNow;
+        return nNow;
+    }
+
+    //! Get a batch from our own deque, or steal one from the other workers
+    unsigned int GetWork(unsigned int nSlot, std::vector<T>& vChecks)
+    {
+        unsigned int nNow = Take(*queues[nSlot], vChecks, false);
+        unsigned int nQueues = NumQueues();
+        for (unsigned int i = 1; !nNow && i < nQueues && nQueued; i++)
+            nNow = Take(*queues[(nSlot + i) % nQueues], vChecks, true);
+        return nNow;
+    }
+
     /** Internal function that does bulk of the verification work. */
-    bool Loop(bool fMaster = false)
+    bool Loop(unsigned int nSlot, bool fMaster = false)
     {
         boost::condition_variable& cond = fMaster ? condMaster : condWorker;
         std::vector<T> vChecks;
         vChecks.reserve(nBatchSize);
-        unsigned int nNow = 0;
-        bool fOk = true;
         do {
-            {
-                boost::unique_lock<boost::mutex> lock(mutex);
-                // first do the clean-up of the previous loop run (allowing us to do it in the same critsect)
-                if (nNow) {
-                    fAllOk &= fOk;
-                    nTodo -= nNow;
-                    if (nTodo == 0 && !fMaster)
-                        // We processed the last element; inform the master it can exit and return the result
-                        condMaster.notify_one();
-                } else {
-                    // first iteration
-                    nTotal++;
+            unsigned int nNow = GetWork(nSlot, vChecks);
+            if (nNow) {
+                // execute work, skipping it once a check has failed
+                bool fOk = fAllOk;
+                for (T& check : vChecks) {
+                    if (fOk)
+                        fOk = check();
                 }
-                // logically, the do loop starts here
-                while (queue.empty()) {
-                    if ((fMaster || fQuit) && nTodo == 0) {
-                        nTotal--;
-                        bool fRet = fAllOk;
-                        // reset the status for new work later
-                        if (fMaster)
-                            fAllOk = true;
-                        // return the current status
-                        return fRet;
-                    }
-                    nIdle++;
-                    cond.wait(lock); // wait
-                    nIdle--;
+                vChecks.clear();
+                if (!fOk)
+                    fAllOk = false;
+                if (nTodo.fetch_sub(nNow) == nNow && !fMaster) {
+                    // We processed the last element; inform the master it can exit and return the result
+                    boost::unique_lock<boost::mutex> lock(mutex);
+                    condMaster.notify_one();
                 }
-                // Decide how many work units to process now.
-                // * Do not try to do everything at once, but aim for increasingly smaller batches so
-                //   all workers finish approximately simultaneously.
-                // * Try to account for idle jobs which will instantly start helping.
-                // * Don't do batches smaller than 1 (duh), or larger than nBatchSize.
-                nNow = std::max(1U, std::min(nBatchSize, (unsigned int)queue.size() / (nTotal + nIdle + 1)));
-                vChecks.resize(nNow);
-                for (unsigned int i = 0; i < nNow; i++) {
-                    // We want the lock on the mutex to be as short as possible, so swap jobs from the global
-                    // queue to the local batch vector instead of copying.
-                    vChecks[i].swap(queue.back());
-                    queue.pop_back();
-                }
-                // Check whether we need to do work at all
-                fOk = fAllOk;
+                continue;
+            }
+
+            boost::unique_lock<boost::mutex> lock(mutex);
+            if ((fMaster || fQuit) && nTodo == 0) {
+                bool fRet = fAllOk;
+                // reset the status for new work later
+                if (fMaster)
+                    fAllOk = true;
+                // return the current status
+                return fRet;
             }
-            // execute work
-            BOOST_FOREACH (T& check, vChecks)
-                if (fOk)
-                    fOk = check();
-            vChecks.clear();
+            // only sleep if there is nothing left to steal, work added after this check will wake us
+            if (nQueued == 0)
+                cond.wait(lock);
         } while (true);
     }
 
 public:
     //! Create a new check queue
-    CCheckQueue(unsigned int nBatchSizeIn) : nIdle(0), nTotal(0), fAllOk(true), nTodo(0), fQuit(false), nBatchSize(nBatchSizeIn) {}
+    CCheckQueue(unsigned int nBatchSizeIn) : nWorkers(0), nQueued(0), nNextQueue(0), nTodo(0), fAllOk(true), fQuit(false), nBatchSize(nBatchSizeIn)
+    {
+        for (unsigned int i = 0; i < MAX_WORKER_QUEUES; i++)
+            queues.emplace_back(new WorkerQueue());
+    }
 
     //! Worker thread
     void Thread()
     {
-        Loop();
+        unsigned int nSlot = nWorkers++ % (MAX_WORKER_QUEUES - 1) + 1;
+        Loop(nSlot);
     }
 
     //! Wait until execution finishes, and return whether all evaluations were successful.
     bool Wait()
     {
-        return Loop(true);
+        return Loop(0, true);
     }
 
-    //! Add a batch of checks to the queue
+    //! Add a batch of checks to the queue, spreading them over the workers' deques
     void Add(std::vector<T>& vChecks)
     {
-        boost::unique_lock<boost::mutex> lock(mutex);
-        BOOST_FOREACH (T& check, vChecks) {
-            queue.push_back(T());
-            check.swap(queue.back());
-        }
+        if (vChecks.empty())
+            return;
+        unsigned int nQueues = NumQueues();
+        unsigned int nPer = (vChecks.size() + nQueues - 1) / nQueues;
+        unsigned int nUsed = (vChecks.size() + nPer - 1) / nPer;
+        // callers often add one check at a time, so each batch starts on the deque after the last one filled
+        unsigned int nStart = nNextQueue.fetch_add(nUsed);
+        // count the checks before queueing them, so they are never seen as completed or taken before being added
         nTodo += vChecks.size();
+        nQueued += vChecks.size();
+        for (unsigned int i = 0, nQueue = 0; i < vChecks.size(); nQueue++) {
+            WorkerQueue& queue = *queues[(nStart + nQueue) % nQueues];
+            boost::unique_lock<boost::mutex> lock(queue.mutex);
+            for (unsigned int end = std::min((unsigned int)vChecks.size(), i + nPer); i < end; i++) {
+                queue.checks.push_back(T());
+                vChecks[i].swap(queue.checks.back());
+            }
+        }
+        boost::unique_lock<boost::mutex> lock(mutex);
         if (vChecks.size() == 1)
             condWorker.notify_one();
-        else if (vChecks.size() > 1)
+        else
             condWorker.notify_all();
     }
 
@@ -164,12 +283,12 @@ public:
     bool IsIdle()
     {
         boost::unique_lock<boost::mutex> lock(mutex);
-        return (nTotal == nIdle && nTodo == 0 && fAllOk == true);
+        return (nTodo == 0 && nQueued == 0 && fAllOk == true);
     }
 
 };
 
-/** 
+/**
  * RAII-style controller object for a CCheckQueue that guarantees the passed
  * queue is finished before continuing.
  */
@@ -205,6 +324,18 @@ public:
             pqueue->Add(vChecks);
     }
 
+    //! Add checks of one of the types of a queue of CCheckVariant
+    template <typename C>
+    void AddAny(std::vector<C>& vChecks)
+    {
+        if (pqueue == NULL || vChecks.empty())
+            return;
+        std::vector<T> vAny(vChecks.size());
+        for (size_t i = 0; i < vChecks.size(); i++)
+            vAny[i].Take(vChecks[i]);
+        pqueue->Add(vAny);
+    }
+
     ~CCheckQueueControl()
     {
         if (!fDone)
@@ -5,6 +5,7 @@
 #include "coins.h"
 
 #include "memusage.h"
+#include "metrics.h"
 #include "random.h"
 #include "version.h"
 #include "policy/fees.h"
@@ -86,7 +87,8 @@ bool CCoinsViewBacked::GetStats(CCoinsStats &stats) const { return base->GetStat
 
 CCoinsKeyHasher::CCoinsKeyHasher() : salt(GetRandHash()) {}
 
-CCoinsViewCache::CCoinsViewCache(CCoinsView *baseIn) : CCoinsViewBacked(baseIn), hasModifier(false), cachedCoinsUsage(0) { }
+CCoinsViewCache::CCoinsViewCache(CCoinsView *baseIn) : CCoinsViewBacked(baseIn), hasModifier(false), fCountCacheUse(false),
+    cacheCoins(0, CCoinsKeyHasher(), std::equal_to<uint256>(), CCoinsMapAllocator(&cacheCoinsMemoryResource)), cachedCoinsUsage(0) { }
 
 CCoinsViewCache::~CCoinsViewCache()
 {
@@ -104,8 +106,13 @@ size_t CCoinsViewCache::DynamicMemoryUsage() const {
 
 CCoinsMap::const_iterator CCoinsViewCache::FetchCoins(const uint256 &txid) const {
     CCoinsMap::iterator it = cacheCoins.find(txid);
-    if (it != cacheCoins.end())
+    if (it != cacheCoins.end()) {
+        if (fCountCacheUse)
+            coinsCacheHits.increment();
         return it;
+    }
+    if (fCountCacheUse)
+        coinsCacheMisses.increment();
     CCoins tmp;
     if (!base->GetCoins(txid, tmp))
         return cacheCoins.end();
@@ -542,6 +549,7 @@ bool CCoinsViewCache::BatchWrite(CCoinsMap &mapCoins,
 bool CCoinsViewCache::Flush() {
     bool fOk = base->BatchWrite(cacheCoins, hashBlock, hashSproutAnchor, hashSaplingAnchor, cacheSproutAnchors, cacheSaplingAnchors, cacheSproutNullifiers, cacheSaplingNullifiers);
     cacheCoins.clear();
+    ReallocateCache();
     cacheSproutAnchors.clear();
     cacheSaplingAnchors.clear();
     cacheSproutNullifiers.clear();
@@ -550,6 +558,17 @@ bool CCoinsViewCache::Flush() {
     return fOk;
 }
 
+void CCoinsViewCache::ReallocateCache()
+{
+    // the map has to be gone before the pool its nodes and buckets came from
+    assert(cacheCoins.empty());
+    CCoinsKeyHasher hasher = cacheCoins.hash_function();
+    cacheCoins.~CCoinsMap();
+    cacheCoinsMemoryResource.~CCoinsMapMemoryResource();
+    ::new (&cacheCoinsMemoryResource) CCoinsMapMemoryResource();
+    ::new (&cacheCoins) CCoinsMap(0, hasher, std::equal_to<uint256>(), CCoinsMapAllocator(&cacheCoinsMemoryResource));
+}
+
 unsigned int CCoinsViewCache::GetCacheSize() const {
     return cacheCoins.size();
 }
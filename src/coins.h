@@ -12,6 +12,7 @@
 #include "core_memusage.h"
 #include "memusage.h"
 #include "serialize.h"
+#include "support/allocators/pool.h"
 #include "uint256.h"
 #include "base58.h"
 #include "pubkey.h"
@@ -335,7 +336,15 @@ enum ShieldedType
     SAPLING,
 };
 
-typedef boost::unordered_map<uint256, CCoinsCacheEntry, CCoinsKeyHasher> CCoinsMap;
+/**
+ * The coins cache is a node based map, as pointers to its entries have to stay valid while other
+ * entries are added. Its nodes are allocated from a pool that is released as a whole when the cache
+ * is flushed. The block size leaves room for the node's next pointer and cached hash.
+ */
+typedef CPoolAllocator<std::pair<const uint256, CCoinsCacheEntry>,
+                       sizeof(std::pair<const uint256, CCoinsCacheEntry>) + sizeof(void*) * 4> CCoinsMapAllocator;
+typedef std::unordered_map<uint256, CCoinsCacheEntry, CCoinsKeyHasher, std::equal_to<uint256>, CCoinsMapAllocator> CCoinsMap;
+typedef CCoinsMapAllocator::ResourceType CCoinsMapMemoryResource;
 typedef boost::unordered_map<uint256, CAnchorsSproutCacheEntry, CCoinsKeyHasher> CAnchorsSproutMap;
 typedef boost::unordered_map<uint256, CAnchorsSaplingCacheEntry, CCoinsKeyHasher> CAnchorsSaplingMap;
 typedef boost::unordered_map<uint256, CNullifiersCacheEntry, CCoinsKeyHasher> CNullifiersMap;
@@ -487,11 +496,16 @@ protected:
     /* Whether this cache has an active modifier. */
     bool hasModifier;
 
+    /* Whether lookups are counted in the coins cache hit and miss metrics. */
+    bool fCountCacheUse;
+
     /**
      * Make mutable so that we can "fill the cache" even from Get-methods
      * declared as "const".  
      */
     mutable uint256 hashBlock;
+    //! Pool the nodes of cacheCoins are allocated from, must be declared before it
+    mutable CCoinsMapMemoryResource cacheCoinsMemoryResource;
     mutable CCoinsMap cacheCoins;
     mutable uint256 hashSproutAnchor;
     mutable uint256 hashSaplingAnchor;
@@ -507,6 +521,10 @@ public:
     CCoinsViewCache(CCoinsView *baseIn);
     ~CCoinsViewCache();
 
+    //! Count lookups in this cache in the coins cache metrics, only done for pcoinsTip, so that
+    //! the short lived views of block and mempool validation don't skew its hit rate
+    void CountCacheUse() { fCountCacheUse = true; }
+
     // Standard CCoinsView methods
     static CLaunchMap &LaunchMap() { return launchMap; }
     bool GetSproutAnchorAt(const uint256 &rt, SproutMerkleTree &tree) const;
@@ -614,6 +632,9 @@ private:
      */
     CCoinsViewCache(const CCoinsViewCache &);
 
+    //! Give the memory of the emptied coins map back in one go, and start over with a fresh pool
+    void ReallocateCache();
+
     //! Generalized interface for popping anchors
     template<typename Tree, typename Cache, typename CacheEntry>
     void AbstractPopAnchor(
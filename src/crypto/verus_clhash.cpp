@@ -40,6 +40,8 @@ int __cpuverusoptimized = 0x80;
 
 thread_local thread_specific_ptr verusclhasher_key;
 thread_local thread_specific_ptr verusclhasher_descr;
+thread_local thread_specific_ptr verusclhasher_lanekeys;
+thread_local verusclhash_descr verusclhasher_lanedescr;
 
 #if defined(__APPLE__) || defined(_WIN32)
 // attempt to workaround horrible mingw/gcc destructor bug on Windows and Mac, which passes garbage in the this pointer
@@ -54,6 +56,10 @@ thread_specific_ptr::~thread_specific_ptr() {
     {
         verusclhasher_descr.reset();
     }
+    if (verusclhasher_lanekeys.ptr)
+    {
+        verusclhasher_lanekeys.reset();
+    }
 }
 #endif // defined(__APPLE__) || defined(_WIN32)
 
@@ -792,289 +798,497 @@ __m128i __verusclmulwithoutreduction64alignedrepeat_sv2_1(__m128i *randomsource,
     return acc;
 }
 
-__m128i __verusclmulwithoutreduction64alignedrepeat_sv2_2(__m128i *randomsource, const __m128i buf[4], uint64_t keyMask, __m128i **pMoveScratch)
+// one of the 32 rounds of the VerusHash 2.2 CLHash, shared by the scalar and multi-lane hashes so they cannot diverge.
+// keyMask is in units of __m128i
+static inline __attribute__((always_inline)) void verusclmul_sv2_2_round(__m128i *randomsource, const __m128i *pbuf_copy, uint64_t keyMask, __m128i **&pMoveScratch, __m128i &acc)
 {
-    const __m128i pbuf_copy[4] = {_mm_xor_si128(buf[0], buf[2]), _mm_xor_si128(buf[1], buf[3]), buf[2], buf[3]};
     const __m128i *pbuf;
 
-    // divide key mask by 16 from bytes to __m128i
-    keyMask >>= 4;
-
-    // the random buffer must have at least 32 16 byte dwords after the keymask to work with this
-    // algorithm. we take the value from the last element inside the keyMask + 2, as that will never
-    // be used to xor into the accumulator before it is hashed with other values first
-    __m128i acc = _mm_load_si128(randomsource + (keyMask + 2));
-
-    for (int64_t i = 0; i < 32; i++)
-    {
-        const uint64_t selector = _mm_cvtsi128_si64(acc);
+    const uint64_t selector = _mm_cvtsi128_si64(acc);
 
-        // get two random locations in the key, which will be mutated and swapped
-        __m128i *prand = randomsource + ((selector >> 5) & keyMask);
-        __m128i *prandex = randomsource + ((selector >> 32) & keyMask);
+    // get two random locations in the key, which will be mutated and swapped
+    __m128i *prand = randomsource + ((selector >> 5) & keyMask);
+    __m128i *prandex = randomsource + ((selector >> 32) & keyMask);
 
-        *(pMoveScratch++) = prand;
-        *(pMoveScratch++) = prandex;        
+    *(pMoveScratch++) = prand;
+    *(pMoveScratch++) = prandex;        
 
-        // select random start and order of pbuf processing
-        pbuf = pbuf_copy + (selector & 3);
+    // select random start and order of pbuf processing
+    pbuf = pbuf_copy + (selector & 3);
 
-        switch (selector & 0x1c)
+    switch (selector & 0x1c)
+    {
+        case 0:
         {
-            case 0:
-            {
-                const __m128i temp1 = _mm_load_si128(prandex);
-                const __m128i temp2 = _mm_load_si128(pbuf - (((selector & 1) << 1) - 1));
-                const __m128i add1 = _mm_xor_si128(temp1, temp2);
-                const __m128i clprod1 = _mm_clmulepi64_si128(add1, add1, 0x10);
-                acc = _mm_xor_si128(clprod1, acc);
-
-                const __m128i tempa1 = _mm_mulhrs_epi16(acc, temp1);
-                const __m128i tempa2 = _mm_xor_si128(tempa1, temp1);
+            const __m128i temp1 = _mm_load_si128(prandex);
+            const __m128i temp2 = _mm_load_si128(pbuf - (((selector & 1) << 1) - 1));
+            const __m128i add1 = _mm_xor_si128(temp1, temp2);
+            const __m128i clprod1 = _mm_clmulepi64_si128(add1, add1, 0x10);
+            acc = _mm_xor_si128(clprod1, acc);
+
+            const __m128i tempa1 = _mm_mulhrs_epi16(acc, temp1);
+            const __m128i tempa2 = _mm_xor_si128(tempa1, temp1);
+
+            const __m128i temp12 = _mm_load_si128(prand);
+            _mm_store_si128(prand, tempa2);
+
+            const __m128i temp22 = _mm_load_si128(pbuf);
+            const __m128i add12 = _mm_xor_si128(temp12, temp22);
+            const __m128i clprod12 = _mm_clmulepi64_si128(add12, add12, 0x10);
+            acc = _mm_xor_si128(clprod12, acc);
+
+            const __m128i tempb1 = _mm_mulhrs_epi16(acc, temp12);
+            const __m128i tempb2 = _mm_xor_si128(tempb1, temp12);
+            _mm_store_si128(prandex, tempb2);
+            break;
+        }
+        case 4:
+        {
+            const __m128i temp1 = _mm_load_si128(prand);
+            const __m128i temp2 = _mm_load_si128(pbuf);
+            const __m128i add1 = _mm_xor_si128(temp1, temp2);
+            const __m128i clprod1 = _mm_clmulepi64_si128(add1, add1, 0x10);
+            acc = _mm_xor_si128(clprod1, acc);
+            const __m128i clprod2 = _mm_clmulepi64_si128(temp2, temp2, 0x10);
+            acc = _mm_xor_si128(clprod2, acc);
+
+            const __m128i tempa1 = _mm_mulhrs_epi16(acc, temp1);
+            const __m128i tempa2 = _mm_xor_si128(tempa1, temp1);
+
+            const __m128i temp12 = _mm_load_si128(prandex);
+            _mm_store_si128(prandex, tempa2);
+
+            const __m128i temp22 = _mm_load_si128(pbuf - (((selector & 1) << 1) - 1));
+            const __m128i add12 = _mm_xor_si128(temp12, temp22);
+            acc = _mm_xor_si128(add12, acc);
+
+            const __m128i tempb1 = _mm_mulhrs_epi16(acc, temp12);
+            const __m128i tempb2 = _mm_xor_si128(tempb1, temp12);
+            _mm_store_si128(prand, tempb2);
+            break;
+        }
+        case 8:
+        {
+            const __m128i temp1 = _mm_load_si128(prandex);
+            const __m128i temp2 = _mm_load_si128(pbuf);
+            const __m128i add1 = _mm_xor_si128(temp1, temp2);
+            acc = _mm_xor_si128(add1, acc);
+
+            const __m128i tempa1 = _mm_mulhrs_epi16(acc, temp1);
+            const __m128i tempa2 = _mm_xor_si128(tempa1, temp1);
+
+            const __m128i temp12 = _mm_load_si128(prand);
+            _mm_store_si128(prand, tempa2);
+
+            const __m128i temp22 = _mm_load_si128(pbuf - (((selector & 1) << 1) - 1));
+            const __m128i add12 = _mm_xor_si128(temp12, temp22);
+            const __m128i clprod12 = _mm_clmulepi64_si128(add12, add12, 0x10);
+            acc = _mm_xor_si128(clprod12, acc);
+            const __m128i clprod22 = _mm_clmulepi64_si128(temp22, temp22, 0x10);
+            acc = _mm_xor_si128(clprod22, acc);
+
+            const __m128i tempb1 = _mm_mulhrs_epi16(acc, temp12);
+            const __m128i tempb2 = _mm_xor_si128(tempb1, temp12);
+            _mm_store_si128(prandex, tempb2);
+            break;
+        }
+        case 0xc:
+        {
+            const __m128i temp1 = _mm_load_si128(prand);
+            const __m128i temp2 = _mm_load_si128(pbuf - (((selector & 1) << 1) - 1));
+            const __m128i add1 = _mm_xor_si128(temp1, temp2);
 
-                const __m128i temp12 = _mm_load_si128(prand);
-                _mm_store_si128(prand, tempa2);
+            // cannot be zero here
+            const int32_t divisor = (uint32_t)selector;
 
-                const __m128i temp22 = _mm_load_si128(pbuf);
-                const __m128i add12 = _mm_xor_si128(temp12, temp22);
-                const __m128i clprod12 = _mm_clmulepi64_si128(add12, add12, 0x10);
-                acc = _mm_xor_si128(clprod12, acc);
+            acc = _mm_xor_si128(add1, acc);
 
-                const __m128i tempb1 = _mm_mulhrs_epi16(acc, temp12);
-                const __m128i tempb2 = _mm_xor_si128(tempb1, temp12);
-                _mm_store_si128(prandex, tempb2);
-                break;
-            }
-            case 4:
-            {
-                const __m128i temp1 = _mm_load_si128(prand);
-                const __m128i temp2 = _mm_load_si128(pbuf);
-                const __m128i add1 = _mm_xor_si128(temp1, temp2);
-                const __m128i clprod1 = _mm_clmulepi64_si128(add1, add1, 0x10);
-                acc = _mm_xor_si128(clprod1, acc);
-                const __m128i clprod2 = _mm_clmulepi64_si128(temp2, temp2, 0x10);
-                acc = _mm_xor_si128(clprod2, acc);
+            const int64_t dividend = _mm_cvtsi128_si64(acc);
+            const __m128i modulo = _mm_cvtsi32_si128(dividend % divisor);
+            acc = _mm_xor_si128(modulo, acc);
 
-                const __m128i tempa1 = _mm_mulhrs_epi16(acc, temp1);
-                const __m128i tempa2 = _mm_xor_si128(tempa1, temp1);
+            const __m128i tempa1 = _mm_mulhrs_epi16(acc, temp1);
+            const __m128i tempa2 = _mm_xor_si128(tempa1, temp1);
 
+            if (dividend & 1)
+            {
                 const __m128i temp12 = _mm_load_si128(prandex);
                 _mm_store_si128(prandex, tempa2);
 
-                const __m128i temp22 = _mm_load_si128(pbuf - (((selector & 1) << 1) - 1));
+                const __m128i temp22 = _mm_load_si128(pbuf);
                 const __m128i add12 = _mm_xor_si128(temp12, temp22);
-                acc = _mm_xor_si128(add12, acc);
+                const __m128i clprod12 = _mm_clmulepi64_si128(add12, add12, 0x10);
+                acc = _mm_xor_si128(clprod12, acc);
+                const __m128i clprod22 = _mm_clmulepi64_si128(temp22, temp22, 0x10);
+                acc = _mm_xor_si128(clprod22, acc);
 
                 const __m128i tempb1 = _mm_mulhrs_epi16(acc, temp12);
                 const __m128i tempb2 = _mm_xor_si128(tempb1, temp12);
                 _mm_store_si128(prand, tempb2);
-                break;
             }
-            case 8:
+            else
             {
-                const __m128i temp1 = _mm_load_si128(prandex);
-                const __m128i temp2 = _mm_load_si128(pbuf);
-                const __m128i add1 = _mm_xor_si128(temp1, temp2);
-                acc = _mm_xor_si128(add1, acc);
+                const __m128i tempb3 = _mm_load_si128(prandex);
+                _mm_store_si128(prandex, tempa2);
+                _mm_store_si128(prand, tempb3);
+                const __m128i tempb4 = _mm_load_si128(pbuf);
+                acc = _mm_xor_si128(tempb4, acc);
+            }
+            break;
+        }
+        case 0x10:
+        {
+            // a few AES operations
+            const __m128i *rc = prand;
+            __m128i tmp;
 
-                const __m128i tempa1 = _mm_mulhrs_epi16(acc, temp1);
-                const __m128i tempa2 = _mm_xor_si128(tempa1, temp1);
+            __m128i temp1 = _mm_load_si128(pbuf - (((selector & 1) << 1) - 1));
+            __m128i temp2 = _mm_load_si128(pbuf);
 
-                const __m128i temp12 = _mm_load_si128(prand);
-                _mm_store_si128(prand, tempa2);
+            AES2(temp1, temp2, 0);
+            MIX2(temp1, temp2);
 
-                const __m128i temp22 = _mm_load_si128(pbuf - (((selector & 1) << 1) - 1));
-                const __m128i add12 = _mm_xor_si128(temp12, temp22);
-                const __m128i clprod12 = _mm_clmulepi64_si128(add12, add12, 0x10);
-                acc = _mm_xor_si128(clprod12, acc);
-                const __m128i clprod22 = _mm_clmulepi64_si128(temp22, temp22, 0x10);
-                acc = _mm_xor_si128(clprod22, acc);
+            AES2(temp1, temp2, 4);
+            MIX2(temp1, temp2);
 
-                const __m128i tempb1 = _mm_mulhrs_epi16(acc, temp12);
-                const __m128i tempb2 = _mm_xor_si128(tempb1, temp12);
-                _mm_store_si128(prandex, tempb2);
-                break;
-            }
-            case 0xc:
-            {
-                const __m128i temp1 = _mm_load_si128(prand);
-                const __m128i temp2 = _mm_load_si128(pbuf - (((selector & 1) << 1) - 1));
-                const __m128i add1 = _mm_xor_si128(temp1, temp2);
+            AES2(temp1, temp2, 8);
+            MIX2(temp1, temp2);
 
-                // cannot be zero here
-                const int32_t divisor = (uint32_t)selector;
+            acc = _mm_xor_si128(temp2, _mm_xor_si128(temp1, acc));
 
-                acc = _mm_xor_si128(add1, acc);
+            const __m128i tempa1 = _mm_load_si128(prand);
+            const __m128i tempa2 = _mm_mulhrs_epi16(acc, tempa1);
+            const __m128i tempa3 = _mm_xor_si128(tempa1, tempa2);
 
-                const int64_t dividend = _mm_cvtsi128_si64(acc);
-                const __m128i modulo = _mm_cvtsi32_si128(dividend % divisor);
-                acc = _mm_xor_si128(modulo, acc);
+            const __m128i tempa4 = _mm_load_si128(prandex);
+            _mm_store_si128(prandex, tempa3);
+            _mm_store_si128(prand, tempa4);
+            break;
+        }
+        case 0x14:
+        {
+            // we'll just call this one the monkins loop, inspired by Chris - modified to cast to uint64_t on shift for more variability in the loop
+            const __m128i *buftmp = pbuf - (((selector & 1) << 1) - 1);
+            __m128i tmp; // used by MIX2
 
-                const __m128i tempa1 = _mm_mulhrs_epi16(acc, temp1);
-                const __m128i tempa2 = _mm_xor_si128(tempa1, temp1);
+            uint64_t rounds = selector >> 61; // loop randomly between 1 and 8 times
+            __m128i *rc = prand;
+            uint64_t aesroundoffset = 0;
+            __m128i onekey;
 
-                if (dividend & 1)
+            do
+            {
+                if (selector & (((uint64_t)0x10000000) << rounds))
                 {
-                    const __m128i temp12 = _mm_load_si128(prandex);
-                    _mm_store_si128(prandex, tempa2);
+                    onekey = _mm_load_si128(rc++);
+                    const __m128i temp2 = _mm_load_si128(rounds & 1 ? pbuf : buftmp);
+                    const __m128i add1 = _mm_xor_si128(onekey, temp2);
+                    const __m128i clprod1 = _mm_clmulepi64_si128(add1, add1, 0x10);
+                    acc = _mm_xor_si128(clprod1, acc);
+                }
+                else
+                {
+                    onekey = _mm_load_si128(rc++);
+                    __m128i temp2 = _mm_load_si128(rounds & 1 ? buftmp : pbuf);
+                    AES2(onekey, temp2, aesroundoffset);
+                    aesroundoffset += 4;
+                    MIX2(onekey, temp2);
+                    acc = _mm_xor_si128(onekey, acc);
+                    acc = _mm_xor_si128(temp2, acc);
+                }
+            } while (rounds--);
 
-                    const __m128i temp22 = _mm_load_si128(pbuf);
-                    const __m128i add12 = _mm_xor_si128(temp12, temp22);
-                    const __m128i clprod12 = _mm_clmulepi64_si128(add12, add12, 0x10);
-                    acc = _mm_xor_si128(clprod12, acc);
-                    const __m128i clprod22 = _mm_clmulepi64_si128(temp22, temp22, 0x10);
-                    acc = _mm_xor_si128(clprod22, acc);
+            const __m128i tempa1 = _mm_load_si128(prand);
+            const __m128i tempa2 = _mm_mulhrs_epi16(acc, tempa1);
+            const __m128i tempa3 = _mm_xor_si128(tempa1, tempa2);
 
-                    const __m128i tempb1 = _mm_mulhrs_epi16(acc, temp12);
-                    const __m128i tempb2 = _mm_xor_si128(tempb1, temp12);
-                    _mm_store_si128(prand, tempb2);
+            const __m128i tempa4 = _mm_load_si128(prandex);
+            _mm_store_si128(prandex, tempa3);
+            _mm_store_si128(prand, tempa4);
+            break;
+        }
+        case 0x18:
+        {
+            const __m128i *buftmp = pbuf - (((selector & 1) << 1) - 1);
+            __m128i tmp; // used by MIX2
+
+            uint64_t rounds = selector >> 61; // loop randomly between 1 and 8 times
+            __m128i *rc = prand;
+            __m128i onekey;
+
+            do
+            {
+                if (selector & (((uint64_t)0x10000000) << rounds))
+                {
+                    onekey = _mm_load_si128(rc++);
+                    const __m128i temp2 = _mm_load_si128(rounds & 1 ? pbuf : buftmp);
+                    onekey = _mm_xor_si128(onekey, temp2);
+                    // cannot be zero here, may be negative
+                    const int32_t divisor = (uint32_t)selector;
+                    const int64_t dividend = _mm_cvtsi128_si64(onekey);
+                    const __m128i modulo = _mm_cvtsi32_si128(dividend % divisor);
+                    acc = _mm_xor_si128(modulo, acc);
                 }
                 else
                 {
-                    const __m128i tempb3 = _mm_load_si128(prandex);
-                    _mm_store_si128(prandex, tempa2);
-                    _mm_store_si128(prand, tempb3);
-                    const __m128i tempb4 = _mm_load_si128(pbuf);
-                    acc = _mm_xor_si128(tempb4, acc);
+                    onekey = _mm_load_si128(rc++);
+                    __m128i temp2 = _mm_load_si128(rounds & 1 ? buftmp : pbuf);
+                    const __m128i add1 = _mm_xor_si128(onekey, temp2);
+                    onekey = _mm_clmulepi64_si128(add1, add1, 0x10);
+                    const __m128i clprod2 = _mm_mulhrs_epi16(acc, onekey);
+                    acc = _mm_xor_si128(clprod2, acc);
                 }
-                break;
-            }
-            case 0x10:
-            {
-                // a few AES operations
-                const __m128i *rc = prand;
-                __m128i tmp;
+            } while (rounds--);
 
-                __m128i temp1 = _mm_load_si128(pbuf - (((selector & 1) << 1) - 1));
-                __m128i temp2 = _mm_load_si128(pbuf);
+            const __m128i tempa3 = _mm_load_si128(prandex);
+            const __m128i tempa4 = _mm_xor_si128(tempa3, acc);
 
-                AES2(temp1, temp2, 0);
-                MIX2(temp1, temp2);
+            _mm_store_si128(prandex, onekey);
+            _mm_store_si128(prand, tempa4);
+            break;
+        }
+        case 0x1c:
+        {
+            const __m128i temp1 = _mm_load_si128(pbuf);
+            const __m128i temp2 = _mm_load_si128(prandex);
+            const __m128i add1 = _mm_xor_si128(temp1, temp2);
+            const __m128i clprod1 = _mm_clmulepi64_si128(add1, add1, 0x10);
+            acc = _mm_xor_si128(clprod1, acc);
+
+            const __m128i tempa1 = _mm_mulhrs_epi16(acc, temp2);
+            const __m128i tempa2 = _mm_xor_si128(tempa1, temp2);
+
+            const __m128i tempa3 = _mm_load_si128(prand);
+            _mm_store_si128(prand, tempa2);
+
+            acc = _mm_xor_si128(tempa3, acc);
+            const __m128i temp4 = _mm_load_si128(pbuf - (((selector & 1) << 1) - 1)); 
+            acc = _mm_xor_si128(temp4,acc);  
+            const __m128i tempb1 = _mm_mulhrs_epi16(acc, tempa3);
+            const __m128i tempb2 = _mm_xor_si128(tempb1, tempa3);
+            _mm_store_si128(prandex, tempb2);
+            break;
+        }
+    }
+}
 
-                AES2(temp1, temp2, 4);
-                MIX2(temp1, temp2);
+__m128i __verusclmulwithoutreduction64alignedrepeat_sv2_2(__m128i *randomsource, const __m128i buf[4], uint64_t keyMask, __m128i **pMoveScratch)
+{
+    const __m128i pbuf_copy[4] = {_mm_xor_si128(buf[0], buf[2]), _mm_xor_si128(buf[1], buf[3]), buf[2], buf[3]};
 
-                AES2(temp1, temp2, 8);
-                MIX2(temp1, temp2);
+    // divide key mask by 16 from bytes to __m128i
+    keyMask >>= 4;
 
-                acc = _mm_xor_si128(temp2, _mm_xor_si128(temp1, acc));
+    // the random buffer must have at least 32 16 byte dwords after the keymask to work with this
+    // algorithm. we take the value from the last element inside the keyMask + 2, as that will never
+    // be used to xor into the accumulator before it is hashed with other values first
+    __m128i acc = _mm_load_si128(randomsource + (keyMask + 2));
 
-                const __m128i tempa1 = _mm_load_si128(prand);
-                const __m128i tempa2 = _mm_mulhrs_epi16(acc, tempa1);
-                const __m128i tempa3 = _mm_xor_si128(tempa1, tempa2);
+    for (int64_t i = 0; i < 32; i++)
+    {
+        verusclmul_sv2_2_round(randomsource, pbuf_copy, keyMask, pMoveScratch, acc);
+    }
+    return acc;
+}
 
-                const __m128i tempa4 = _mm_load_si128(prandex);
-                _mm_store_si128(prandex, tempa3);
-                _mm_store_si128(prand, tempa4);
-                break;
-            }
-            case 0x14:
-            {
-                // we'll just call this one the monkins loop, inspired by Chris - modified to cast to uint64_t on shift for more variability in the loop
-                const __m128i *buftmp = pbuf - (((selector & 1) << 1) - 1);
-                __m128i tmp; // used by MIX2
+// number of nonces mine_verus_v2_lanes hashes together
+static const int VERUSHASH_MINING_LANES = 4;
 
-                uint64_t rounds = selector >> 61; // loop randomly between 1 and 8 times
-                __m128i *rc = prand;
-                uint64_t aesroundoffset = 0;
-                __m128i onekey;
+static inline __attribute__((always_inline)) void haraka512_keyed_lanes(unsigned char (*out)[32], unsigned char (*in)[64], u128 *const *rcs)
+{
+    u128 s[VERUSHASH_MINING_LANES][4], tmp;
 
-                do
-                {
-                    if (selector & (((uint64_t)0x10000000) << rounds))
-                    {
-                        onekey = _mm_load_si128(rc++);
-                        const __m128i temp2 = _mm_load_si128(rounds & 1 ? pbuf : buftmp);
-                        const __m128i add1 = _mm_xor_si128(onekey, temp2);
-                        const __m128i clprod1 = _mm_clmulepi64_si128(add1, add1, 0x10);
-                        acc = _mm_xor_si128(clprod1, acc);
-                    }
-                    else
-                    {
-                        onekey = _mm_load_si128(rc++);
-                        __m128i temp2 = _mm_load_si128(rounds & 1 ? buftmp : pbuf);
-                        AES2(onekey, temp2, aesroundoffset);
-                        aesroundoffset += 4;
-                        MIX2(onekey, temp2);
-                        acc = _mm_xor_si128(onekey, acc);
-                        acc = _mm_xor_si128(temp2, acc);
-                    }
-                } while (rounds--);
+    for (int lane = 0; lane < VERUSHASH_MINING_LANES; lane++)
+    {
+        s[lane][0] = LOAD(in[lane]);
+        s[lane][1] = LOAD(in[lane] + 16);
+        s[lane][2] = LOAD(in[lane] + 32);
+        s[lane][3] = LOAD(in[lane] + 48);
+    }
 
-                const __m128i tempa1 = _mm_load_si128(prand);
-                const __m128i tempa2 = _mm_mulhrs_epi16(acc, tempa1);
-                const __m128i tempa3 = _mm_xor_si128(tempa1, tempa2);
+    // the same rounds as haraka512_keyed_local, with the lanes interleaved so their AES latencies overlap
+    for (int round = 0; round < 40; round += 8)
+    {
+        for (int lane = 0; lane < VERUSHASH_MINING_LANES; lane++)
+        {
+            const u128 *rc = rcs[lane];
+            AES4(s[lane][0], s[lane][1], s[lane][2], s[lane][3], round);
+            MIX4(s[lane][0], s[lane][1], s[lane][2], s[lane][3]);
+        }
+    }
 
-                const __m128i tempa4 = _mm_load_si128(prandex);
-                _mm_store_si128(prandex, tempa3);
-                _mm_store_si128(prand, tempa4);
-                break;
-            }
-            case 0x18:
-            {
-                const __m128i *buftmp = pbuf - (((selector & 1) << 1) - 1);
-                __m128i tmp; // used by MIX2
+    for (int lane = 0; lane < VERUSHASH_MINING_LANES; lane++)
+    {
+        s[lane][0] = _mm_xor_si128(s[lane][0], LOAD(in[lane]));
+        s[lane][1] = _mm_xor_si128(s[lane][1], LOAD(in[lane] + 16));
+        s[lane][2] = _mm_xor_si128(s[lane][2], LOAD(in[lane] + 32));
+        s[lane][3] = _mm_xor_si128(s[lane][3], LOAD(in[lane] + 48));
 
-                uint64_t rounds = selector >> 61; // loop randomly between 1 and 8 times
-                __m128i *rc = prand;
-                __m128i onekey;
+        TRUNCSTORE(out[lane], s[lane][0], s[lane][1], s[lane][2], s[lane][3]);
+    }
+}
 
-                do
-                {
-                    if (selector & (((uint64_t)0x10000000) << rounds))
-                    {
-                        onekey = _mm_load_si128(rc++);
-                        const __m128i temp2 = _mm_load_si128(rounds & 1 ? pbuf : buftmp);
-                        onekey = _mm_xor_si128(onekey, temp2);
-                        // cannot be zero here, may be negative
-                        const int32_t divisor = (uint32_t)selector;
-                        const int64_t dividend = _mm_cvtsi128_si64(onekey);
-                        const __m128i modulo = _mm_cvtsi32_si128(dividend % divisor);
-                        acc = _mm_xor_si128(modulo, acc);
-                    }
-                    else
-                    {
-                        onekey = _mm_load_si128(rc++);
-                        __m128i temp2 = _mm_load_si128(rounds & 1 ? buftmp : pbuf);
-                        const __m128i add1 = _mm_xor_si128(onekey, temp2);
-                        onekey = _mm_clmulepi64_si128(add1, add1, 0x10);
-                        const __m128i clprod2 = _mm_mulhrs_epi16(acc, onekey);
-                        acc = _mm_xor_si128(clprod2, acc);
-                    }
-                } while (rounds--);
+// mines the same nonces with the same results as mine_verus_v2, VERUSHASH_MINING_LANES nonces at a time. every
+// round of VerusHash 2.2 picks its key entries and its operation from the last result, so lanes cannot share
+// vector registers, but each has its own key copy and runs its rounds between those of the others, keeping the
+// multipliers and AES units busy while any one lane waits on its last result
+bool mine_verus_v2_lanes(CBlockHeader &bh, CVerusHashV2bWriter &vhw, uint256 &finalHash, uint256 &target, uint64_t start, uint64_t *count)
+{
+    CVerusHashV2 &vh = vhw.GetState();
+    verusclhasher &vclh = vh.vclh;
 
-                const __m128i tempa3 = _mm_load_si128(prandex);
-                const __m128i tempa4 = _mm_xor_si128(tempa3, acc);
+    if (vclh.verusinternalclhashfunction != &__verusclmulwithoutreduction64alignedrepeat_sv2_2)
+    {
+        return mine_verus_v2(bh, vhw, finalHash, target, start, count);
+    }
 
-                _mm_store_si128(prandex, onekey);
-                _mm_store_si128(prand, tempa4);
-                break;
-            }
-            case 0x1c:
+    verusclhash_descr *pdesc = (verusclhash_descr *)verusclhasher_descr.get();
+    const uint32_t keysize = pdesc->keySizeInBytes;
+    const int keyrefreshsize = vclh.keyrefreshsize();
+
+    // lane keys are laid out like the thread's key, each followed by its refresh copy and move scratch
+    if (!verusclhasher_lanekeys.get() || verusclhasher_lanedescr.keySizeInBytes != keysize)
+    {
+        verusclhasher_lanekeys.reset(alloc_aligned_buffer((keysize << 1) * VERUSHASH_MINING_LANES));
+        verusclhasher_lanedescr.keySizeInBytes = keysize;
+        verusclhasher_lanedescr.seed.SetNull();
+        if (!verusclhasher_lanekeys.get())
+        {
+            return mine_verus_v2(bh, vhw, finalHash, target, start, count);
+        }
+    }
+
+    alignas(32) uint256 curTarget = target;
+    const uint64_t *compTarget = (uint64_t *)&curTarget;
+
+    u128 *hashKey = (u128 *)verusclhasher_key.get();
+    void *hasherrefresh = ((unsigned char *)hashKey) + keysize;
+    __m128i **pMoveScratch = vclh.getpmovescratch(hasherrefresh);
+
+    vhw.Reset();
+    vhw << bh;
+
+    int64_t *extraPtr = vhw.xI64p();
+    unsigned char *curBuf = vh.CurBuffer();
+
+    // the thread's key is generated as mine_verus_v2 does, and only copied to the lanes when it changes
+    if (pdesc->seed != *((uint256 *)curBuf))
+    {
+        int n256blks = keysize >> 5;
+        unsigned char *pkey = ((unsigned char *)hashKey);
+        unsigned char *psrc = curBuf;
+        for (int i = 0; i < n256blks; i++)
+        {
+            haraka256(pkey, psrc);
+            psrc = pkey;
+            pkey += 32;
+        }
+        pdesc->seed = *((uint256 *)curBuf);
+        memcpy(hasherrefresh, hashKey, keyrefreshsize);
+        memset(((unsigned char *)hasherrefresh) + keyrefreshsize, 0, keysize - keyrefreshsize);
+    }
+    else
+    {
+        fixupkey(pMoveScratch, pdesc);
+    }
+
+    __m128i *laneKey[VERUSHASH_MINING_LANES];
+    __m128i **laneMoveScratch[VERUSHASH_MINING_LANES];
+    for (int lane = 0; lane < VERUSHASH_MINING_LANES; lane++)
+    {
+        laneKey[lane] = (__m128i *)((unsigned char *)verusclhasher_lanekeys.get() + (keysize << 1) * lane);
+        laneMoveScratch[lane] = vclh.getpmovescratch((unsigned char *)laneKey[lane] + keysize);
+        if (verusclhasher_lanedescr.seed != pdesc->seed)
+        {
+            memcpy(laneKey[lane], hashKey, keysize + keyrefreshsize);
+            memset((unsigned char *)laneMoveScratch[lane], 0, keysize - keyrefreshsize);
+        }
+    }
+    verusclhasher_lanedescr.seed = pdesc->seed;
+
+    const __m128i shuf1 = _mm_setr_epi8(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 0);
+    const __m128i fill1 = _mm_shuffle_epi8(_mm_load_si128((u128 *)curBuf), shuf1);
+    const __m128i shuf2 = _mm_setr_epi8(1, 2, 3, 4, 5, 6, 7, 0, 1, 2, 3, 4, 5, 6, 7, 0);
+    const uint64_t keyMask128 = vclh.keyMask >> 4;
+
+    _mm_store_si128((u128 *)(&curBuf[32 + 16]), fill1);
+    curBuf[32 + 15] = curBuf[0];
+
+    alignas(32) unsigned char laneBuf[VERUSHASH_MINING_LANES][64];
+    alignas(32) unsigned char laneHash[VERUSHASH_MINING_LANES][32];
+    u128 *laneHashKey[VERUSHASH_MINING_LANES];
+
+    // a last group that is short of lanes still hashes them all, and only checks the nonces requested
+    uint64_t i, end = start + *count;
+    for (i = start; i < end; i += VERUSHASH_MINING_LANES)
+    {
+        __m128i pbuf_copy[VERUSHASH_MINING_LANES][4];
+        __m128i acc[VERUSHASH_MINING_LANES];
+        __m128i **pLaneMoveScratch[VERUSHASH_MINING_LANES];
+
+        for (int lane = 0; lane < VERUSHASH_MINING_LANES; lane++)
+        {
+            memcpy(laneBuf[lane], curBuf, 64);
+            *((int64_t *)&laneBuf[lane][32]) = i + lane;
+
+            const __m128i *buf = (const __m128i *)laneBuf[lane];
+            pbuf_copy[lane][0] = _mm_xor_si128(buf[0], buf[2]);
+            pbuf_copy[lane][1] = _mm_xor_si128(buf[1], buf[3]);
+            pbuf_copy[lane][2] = buf[2];
+            pbuf_copy[lane][3] = buf[3];
+            acc[lane] = _mm_load_si128(laneKey[lane] + (keyMask128 + 2));
+            pLaneMoveScratch[lane] = laneMoveScratch[lane];
+        }
+
+        for (int round = 0; round < 32; round++)
+        {
+            for (int lane = 0; lane < VERUSHASH_MINING_LANES; lane++)
             {
-                const __m128i temp1 = _mm_load_si128(pbuf);
-                const __m128i temp2 = _mm_load_si128(prandex);
-                const __m128i add1 = _mm_xor_si128(temp1, temp2);
-                const __m128i clprod1 = _mm_clmulepi64_si128(add1, add1, 0x10);
-                acc = _mm_xor_si128(clprod1, acc);
+                verusclmul_sv2_2_round(laneKey[lane], pbuf_copy[lane], keyMask128, pLaneMoveScratch[lane], acc[lane]);
+            }
+        }
 
-                const __m128i tempa1 = _mm_mulhrs_epi16(acc, temp2);
-                const __m128i tempa2 = _mm_xor_si128(tempa1, temp2);
+        for (int lane = 0; lane < VERUSHASH_MINING_LANES; lane++)
+        {
+            const uint64_t intermediate = precompReduction64(_mm_xor_si128(acc[lane], lazyLengthHash(1024, 64)));
+            __m128i fill2 = _mm_shuffle_epi8(_mm_loadl_epi64((u128 *)&intermediate), shuf2);
+            _mm_store_si128((u128 *)(&laneBuf[lane][32 + 16]), fill2);
+            laneBuf[lane][32 + 15] = *((unsigned char *)&intermediate);
+            laneHashKey[lane] = (u128 *)laneKey[lane] + vh.IntermediateTo128Offset(intermediate);
+        }
 
-                const __m128i tempa3 = _mm_load_si128(prand);
-                _mm_store_si128(prand, tempa2);
+        haraka512_keyed_lanes(laneHash, laneBuf, laneHashKey);
 
-                acc = _mm_xor_si128(tempa3, acc);
-                const __m128i temp4 = _mm_load_si128(pbuf - (((selector & 1) << 1) - 1)); 
-                acc = _mm_xor_si128(temp4,acc);  
-                const __m128i tempb1 = _mm_mulhrs_epi16(acc, tempa3);
-                const __m128i tempb2 = _mm_xor_si128(tempb1, tempa3);
-                _mm_store_si128(prandex, tempb2);
-                break;
+        for (int lane = 0; lane < VERUSHASH_MINING_LANES; lane++)
+        {
+            fixupkey(laneMoveScratch[lane], pdesc);
+        }
+
+        for (int lane = 0; lane < VERUSHASH_MINING_LANES && i + lane < end; lane++)
+        {
+            const uint64_t *compResult = (uint64_t *)laneHash[lane];
+            if (compResult[3] > compTarget[3] || (compResult[3] == compTarget[3] && compResult[2] > compTarget[2]) ||
+                (compResult[3] == compTarget[3] && compResult[2] == compTarget[2] && compResult[1] > compTarget[1]) ||
+                (compResult[3] == compTarget[3] && compResult[2] == compTarget[2] && compResult[1] == compTarget[1] && compResult[0] > compTarget[0]))
+            {
+                continue;
             }
+
+            // leave the hash state as mine_verus_v2 would after this nonce
+            memcpy(curBuf, laneBuf[lane], 64);
+            *extraPtr = i + lane;
+
+            std::vector<unsigned char> solution = bh.nSolution;
+            int extraSpace = (solution.size() % 32) + 15;
+            assert(solution.size() > 32);
+            *((int64_t *)&(solution.data()[solution.size() - extraSpace])) = i + lane;
+            bh.nSolution = solution;
+            memcpy(finalHash.begin(), laneHash[lane], 32);
+            *count = (i + lane - start) + 1;
+            return true;
         }
     }
-    return acc;
+    return false;
 }
 
 void *alloc_aligned_buffer(uint64_t bufSize)
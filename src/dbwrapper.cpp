@@ -70,7 +70,11 @@ CDBWrapper::~CDBWrapper()
 
 bool CDBWrapper::WriteBatch(CDBBatch& batch, bool fSync)
 {
-    leveldb::Status status = pdb->Write(fSync ? syncoptions : writeoptions, &batch.batch);
+    leveldb::Status status;
+    {
+        CScopedLatencyTimer timer(latencyDBWrite);
+        status = pdb->Write(fSync ? syncoptions : writeoptions, &batch.batch);
+    }
     dbwrapper_private::HandleError(status);
     return true;
 }
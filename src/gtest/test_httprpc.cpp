@@ -60,3 +60,18 @@ TEST(HTTPRPC, FailsWithBadAuth) {
     EXPECT_FALSE(HTTPReq_JSONRPC(&req, ""));
     req.CleanUp();
 }
+
+TEST(HTTPRPC, WorkClassOfBody) {
+    EXPECT_EQ(HTTP_WORK_CHEAP, RPCBodyWorkClass(""));
+    EXPECT_EQ(HTTP_WORK_CHEAP, RPCBodyWorkClass("{\"method\":\"getblockcount\",\"params\":[]}"));
+    EXPECT_EQ(HTTP_WORK_CHEAP, RPCBodyWorkClass("{\"method\": \"unknownmethod\"}"));
+    EXPECT_EQ(HTTP_WORK_HEAVY_READ, RPCBodyWorkClass("{\"jsonrpc\": \"1.0\", \"method\" : \"getcurrencyconverters\", \"params\": [\"VRSC\"]}"));
+    EXPECT_EQ(HTTP_WORK_WALLET_WRITE, RPCBodyWorkClass("{\"params\":[],\"method\":\"sendcurrency\"}"));
+
+    // a batch goes to the costliest class of its requests
+    EXPECT_EQ(HTTP_WORK_HEAVY_READ, RPCBodyWorkClass(
+        "[{\"method\":\"getblockcount\"},{\"method\":\"listidentities\"},{\"method\":\"getinfo\"}]"));
+
+    // "method" as a value is not a key
+    EXPECT_EQ(HTTP_WORK_CHEAP, RPCBodyWorkClass("{\"params\":[\"method\",\"sendcurrency\"],\"method\":\"getinfo\"}"));
+}
@@ -22,6 +22,7 @@
 #include "version.h"
 #include "serialize.h"
 #include "streams.h"
+#include "random.h"
 
 #include "zcash/IncrementalMerkleTree.hpp"
 #include "zcash/util.h"
@@ -284,3 +285,99 @@ TEST(merkletree, testZeroElements) {
         ASSERT_TRUE(newTree.root() == oldroot);
     }
 }
+
+template<typename Tree, typename Witness, typename Frontier>
+void test_witness_frontier()
+{
+    // Append blocks of commitments through a frontier, witnessing some of
+    // them, and check that the frontier brings every witness to exactly the
+    // state that appending each commitment to it would have.
+    for (size_t start = 0; start < 16; start++) {
+        for (size_t blockSize = 1; start + blockSize <= 16; blockSize++) {
+            Tree tree;
+            for (size_t i = 0; i < start; i++) {
+                tree.append(GetRandHash());
+            }
+
+            vector<Witness> expected;
+            vector<Witness> actual;
+            vector<size_t> from;
+            if (start > 0) {
+                expected.push_back(tree.witness());
+                actual.push_back(tree.witness());
+                from.push_back(start);
+            }
+
+            Frontier frontier(tree);
+            for (size_t i = 0; i < blockSize; i++) {
+                uint256 commitment = GetRandHash();
+                frontier.append(commitment);
+                tree.append(commitment);
+                for (Witness& wit : expected) {
+                    wit.append(commitment);
+                }
+                if (i % 3 == 0) {
+                    expected.push_back(tree.witness());
+                    actual.push_back(frontier.witness());
+                    from.push_back(frontier.size());
+                }
+            }
+
+            ASSERT_TRUE(frontier.size() == tree.size());
+            ASSERT_TRUE(frontier.merkle_tree().root() == tree.root());
+            for (size_t i = 0; i < actual.size(); i++) {
+                frontier.update(actual[i], from[i]);
+                ASSERT_TRUE(actual[i] == expected[i]);
+                ASSERT_TRUE(actual[i].root() == tree.root());
+            }
+        }
+    }
+}
+
+TEST(merkletree, WitnessFrontier) {
+    test_witness_frontier<SproutTestingMerkleTree, SproutTestingWitness, SproutTestingWitnessFrontier>();
+    test_witness_frontier<SaplingTestingMerkleTree, SaplingTestingWitness, SaplingTestingWitnessFrontier>();
+}
+
+template<typename Tree, typename Witness, typename Frontier>
+void test_witness_frontier_partial_cursor()
+{
+    // Witnesses that were already appended to before the frontier was made
+    // can have a cursor partly filled with commitments from before it. Check
+    // that the frontier finishes those cursors exactly as appending would.
+    for (size_t position = 1; position < 16; position++) {
+        for (size_t before = 1; position + before < 16; before++) {
+            for (size_t blockSize = 1; position + before + blockSize <= 16; blockSize++) {
+                Tree tree;
+                for (size_t i = 0; i < position; i++) {
+                    tree.append(GetRandHash());
+                }
+
+                Witness expected = tree.witness();
+                for (size_t i = 0; i < before; i++) {
+                    uint256 commitment = GetRandHash();
+                    tree.append(commitment);
+                    expected.append(commitment);
+                }
+                Witness actual = expected;
+
+                Frontier frontier(tree);
+                for (size_t i = 0; i < blockSize; i++) {
+                    uint256 commitment = GetRandHash();
+                    frontier.append(commitment);
+                    tree.append(commitment);
+                    expected.append(commitment);
+                }
+
+                frontier.update(actual, position + before);
+                ASSERT_TRUE(actual == expected);
+                ASSERT_TRUE(actual.root() == tree.root());
+            }
+        }
+    }
+}
+
+TEST(merkletree, WitnessFrontierPartialCursor) {
+    test_witness_frontier_partial_cursor<SproutTestingMerkleTree, SproutTestingWitness, SproutTestingWitnessFrontier>();
+    test_witness_frontier_partial_cursor<SaplingTestingMerkleTree, SaplingTestingWitness, SaplingTestingWitnessFrontier>();
+}
@@ -4,6 +4,8 @@
 #include "utiltest.h"
 #include "utiltime.h"
 
+#include <thread>
+
 
 TEST(Metrics, AtomicTimer) {
     AtomicTimer t;
@@ -107,3 +109,61 @@ TEST(Metrics, EstimateNetHeight) {
     }
     RegtestDeactivateBlossom();
 }
+
+TEST(Metrics, LatencyHistogram) {
+    EXPECT_EQ(0, CLatencyHistogram::BucketIndex(0));
+    EXPECT_EQ(1, CLatencyHistogram::BucketIndex(1));
+    EXPECT_EQ(2, CLatencyHistogram::BucketIndex(2));
+    EXPECT_EQ(2, CLatencyHistogram::BucketIndex(3));
+    EXPECT_EQ(11, CLatencyHistogram::BucketIndex(1024));
+    EXPECT_EQ(CLatencyHistogram::NUM_BUCKETS - 1, CLatencyHistogram::BucketIndex(UINT64_MAX));
+
+    CLatencyHistogram h("test_histogram", "test");
+    EXPECT_EQ(0, h.GetSnapshot().count);
+    EXPECT_EQ(0, h.GetSnapshot().Percentile(0.5));
+
+    // samples from several threads all land in the snapshot
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&h]() {
+            for (uint64_t i = 1; i <= 100; i++) {
+                h.Add(i);
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    CLatencyHistogram::Snapshot snapshot = h.GetSnapshot();
+    EXPECT_EQ(400, snapshot.count);
+    EXPECT_EQ(4 * 5050, snapshot.sumMicros);
+    EXPECT_EQ(4, snapshot.buckets[1]);
+    EXPECT_EQ(4 * 37, snapshot.buckets[7]);
+    // 50 is in [32, 64), 99 in [64, 128)
+    EXPECT_EQ(64, snapshot.Percentile(0.5));
+    EXPECT_EQ(128, snapshot.Percentile(0.99));
+
+    bool fRegistered = false;
+    for (auto pHistogram : GetLatencyHistograms()) {
+        fRegistered |= pHistogram == &h;
+    }
+    EXPECT_TRUE(fRegistered);
+    EXPECT_NE(std::string::npos, FormatPrometheusMetrics().find("verus_latency_seconds_count{path=\"test_histogram\"} 400"));
+}
+
+TEST(Metrics, ScopedLatencyTimer) {
+    CLatencyHistogram h("test_scoped_timer", "test");
+    {
+        CScopedLatencyTimer timer(h);
+    }
+    EXPECT_EQ(1, h.GetSnapshot().count);
+
+    // unregistered when destroyed
+    {
+        CLatencyHistogram temp("test_temporary", "test");
+    }
+    for (auto pHistogram : GetLatencyHistograms()) {
+        EXPECT_NE("test_temporary", pHistogram->name);
+    }
+}
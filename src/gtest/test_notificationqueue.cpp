@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include "metrics.h"
+#include "notificationqueue.h"
+#include "primitives/block.h"
+#include "primitives/transaction.h"
+
+class MockNotificationSink : public CNotificationSink
+{
+public:
+    std::set<std::string> topics;
+    std::vector<std::vector<CNotificationMessage>> batches;
+
+    MockNotificationSink(const std::set<std::string> &topicsIn) : topics(topicsIn) {}
+
+    std::set<std::string> GetTopics() const { return topics; }
+    void PublishBatch(const std::vector<CNotificationMessage> &batch) { batches.push_back(batch); }
+};
+
+static CTransaction NotificationTx(uint32_t nLockTime)
+{
+    CMutableTransaction mtx;
+    mtx.nLockTime = nLockTime;
+    return CTransaction(mtx);
+}
+
+TEST(NotificationQueue, PublishesTopicsOfSinksInBatches) {
+    MockNotificationSink sink({NOTIFY_HASHTX});
+    CNotificationQueue queue({&sink}, 100, true);
+    RegisterValidationInterface(&queue);
+
+    std::vector<CTransaction> txs;
+    for (int i = 0; i < 3; i++) {
+        txs.push_back(NotificationTx(i));
+        GetMainSignals().SyncTransaction(txs.back(), nullptr);
+    }
+    UnregisterValidationInterface(&queue);
+
+    // nothing is serialized for rawtx, which no sink publishes
+    EXPECT_TRUE(queue.HasTopic(NOTIFY_HASHTX));
+    EXPECT_FALSE(queue.HasTopic(NOTIFY_RAWTX));
+    EXPECT_EQ(3, queue.Size());
+
+    queue.Start();
+    queue.Stop();
+
+    ASSERT_EQ(1, sink.batches.size());
+    ASSERT_EQ(3, sink.batches[0].size());
+    for (int i = 0; i < 3; i++) {
+        const CNotificationMessage &message = sink.batches[0][i];
+        uint256 hash = txs[i].GetHash();
+        EXPECT_EQ(NOTIFY_HASHTX, message.topic);
+        EXPECT_EQ(std::vector<unsigned char>(std::reverse_iterator<const unsigned char *>(hash.end()),
+                                             std::reverse_iterator<const unsigned char *>(hash.begin())),
+                  *message.payload);
+    }
+}
+
+TEST(NotificationQueue, DropsMempoolTransactionsWhenFull) {
+    MockNotificationSink sink({NOTIFY_HASHTX, NOTIFY_RAWTX});
+    CNotificationQueue queue({&sink}, 2, true);
+    RegisterValidationInterface(&queue);
+
+    uint64_t nDropped = notificationsDropped.get();
+    GetMainSignals().SyncTransaction(NotificationTx(0), nullptr);
+    GetMainSignals().SyncTransaction(NotificationTx(1), nullptr);
+    UnregisterValidationInterface(&queue);
+
+    EXPECT_EQ(2, queue.Size());
+    EXPECT_EQ(nDropped + 2, notificationsDropped.get());
+
+    queue.Start();
+    queue.Stop();
+
+    ASSERT_EQ(1, sink.batches.size());
+    ASSERT_EQ(2, sink.batches[0].size());
+    EXPECT_EQ(NOTIFY_HASHTX, sink.batches[0][0].topic);
+    EXPECT_EQ(NOTIFY_RAWTX, sink.batches[0][1].topic);
+    EXPECT_EQ(GetSerializeSize(NotificationTx(0), SER_NETWORK, PROTOCOL_VERSION), sink.batches[0][1].payload->size());
+}
+
+TEST(NotificationQueue, QueuesConfirmedTransactionsBeyondSize) {
+    MockNotificationSink sink({NOTIFY_HASHTX});
+    CNotificationQueue queue({&sink}, 2, true);
+    RegisterValidationInterface(&queue);
+
+    // notifications are queued with cs_main held, so a full queue grows rather than blocks
+    CBlock block;
+    uint64_t nDropped = notificationsDropped.get();
+    for (int i = 0; i < 5; i++) {
+        GetMainSignals().SyncTransaction(NotificationTx(i), &block);
+    }
+    GetMainSignals().SyncTransaction(NotificationTx(5), nullptr);
+    UnregisterValidationInterface(&queue);
+
+    EXPECT_EQ(5, queue.Size());
+    EXPECT_EQ(nDropped + 1, notificationsDropped.get());
+
+    queue.Start();
+    queue.Stop();
+
+    ASSERT_EQ(1, sink.batches.size());
+    EXPECT_EQ(5, sink.batches[0].size());
+}
@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include "pbaas/reserves.h"
+
+#include <random>
+
+// the differential check runs this many random states, set CONVERSION_FUZZ_ITERATIONS to run more
+static const int DEFAULT_CONVERSION_FUZZ_ITERATIONS = 20000;
+
+// amounts of every magnitude, with whole coins and zero mixed in
+static CAmount RandomConversionAmount(std::mt19937_64 &rng)
+{
+    switch (rng() % 8) {
+        case 0:
+            return 0;
+        case 1:
+            return (CAmount)(rng() % 1000000) * COIN;
+        default:
+            return (CAmount)(rng() & ((1ULL << (rng() % 63)) - 1));
+    }
+}
+
+static int32_t RandomConversionRatio(std::mt19937_64 &rng)
+{
+    switch (rng() % 4) {
+        case 0:
+            return (int32_t)(rng() % CCurrencyState::MAX_RESERVE_RATIO) + 1;
+        case 1:
+            return (int32_t)(rng() % 20 + 1) * (CCurrencyState::MAX_RESERVE_RATIO / 20);
+        default:
+            return (int32_t)(CCurrencyState::MIN_RESERVE_RATIO +
+                             rng() % (CCurrencyState::MAX_RESERVE_RATIO - CCurrencyState::MIN_RESERVE_RATIO + 1));
+    }
+}
+
+TEST(Reserves, ConversionEdgeCases) {
+    int32_t ratios[] = {1, CCurrencyState::MIN_RESERVE_RATIO, CCurrencyState::MAX_RESERVE_RATIO / 3,
+                        CCurrencyState::MAX_RESERVE_RATIO / 2, CCurrencyState::MAX_RESERVE_RATIO};
+    CAmount amounts[] = {0, 1, 2, COIN - 1, COIN, 100 * COIN, 1000000 * COIN, INT64_MAX / 2, INT64_MAX - 1};
+
+    for (int32_t ratio : ratios) {
+        for (CAmount in : amounts) {
+            for (CAmount supply : amounts) {
+                for (CAmount reserve : amounts) {
+                    EXPECT_EQ(CalculateFractionalOutDecimal(in, supply, reserve, ratio),
+                              CalculateFractionalOut(in, supply, reserve, ratio))
+                        << in << " " << supply << " " << reserve << " " << ratio;
+                    if (in <= (supply ? supply : 1)) {
+                        EXPECT_EQ(CalculateReserveOutDecimal(in, supply, reserve, ratio),
+                                  CalculateReserveOut(in, supply, reserve, ratio))
+                            << in << " " << supply << " " << reserve << " " << ratio;
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST(Reserves, ConversionsMatchDecimal) {
+    int iterations = DEFAULT_CONVERSION_FUZZ_ITERATIONS;
+    if (const char *env = getenv("CONVERSION_FUZZ_ITERATIONS")) {
+        iterations = atoi(env);
+    }
+
+    std::mt19937_64 rng(0x5645525553);
+    for (int i = 0; i < iterations; i++) {
+        CAmount in = RandomConversionAmount(rng);
+        CAmount supply = RandomConversionAmount(rng);
+        CAmount reserve = RandomConversionAmount(rng);
+        int32_t ratio = RandomConversionRatio(rng);
+
+        ASSERT_EQ(CalculateFractionalOutDecimal(in, supply, reserve, ratio),
+                  CalculateFractionalOut(in, supply, reserve, ratio))
+            << in << " " << supply << " " << reserve << " " << ratio;
+
+        // selling cannot take out more than the supply
+        if (supply && in > supply) {
+            in %= supply;
+        }
+        ASSERT_EQ(CalculateReserveOutDecimal(in, supply, reserve, ratio),
+                  CalculateReserveOut(in, supply, reserve, ratio))
+            << in << " " << supply << " " << reserve << " " << ratio;
+    }
+}
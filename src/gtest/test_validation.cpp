@@ -1,10 +1,14 @@
 #include <gtest/gtest.h>
 
+#include "checkqueue.h"
 #include "consensus/upgrades.h"
 #include "consensus/validation.h"
 #include "main.h"
 #include "utiltest.h"
 
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
 extern ZCJoinSplit* params;
 
 extern bool ReceivedBlockTransactions(
@@ -165,3 +169,40 @@ TEST(Validation, ReceivedBlockTransactions) {
         ExpectOptionalAmount(30, fakeIndex2.nChainSproutValue);
     }
 }
+
+// a transaction with one shielded output whose description and proof are all zeros, so its Sapling check fails
+static CTransaction InvalidSaplingTransaction(const uint256 &prevHash)
+{
+    CMutableTransaction mtx;
+    mtx.fOverwintered = true;
+    mtx.nVersion = SAPLING_TX_VERSION;
+    mtx.nVersionGroupId = SAPLING_VERSION_GROUP_ID;
+    mtx.vin.push_back(CTxIn(prevHash, 0));
+    mtx.vout.push_back(CTxOut(1000, CScript() << OP_TRUE));
+    mtx.vShieldedOutput.resize(1);
+    return CTransaction(mtx);
+}
+
+TEST(Validation, SaplingProofCheckQueueRejectsInvalidTransaction) {
+    // AcceptToMemoryPoolInt verifies proofs on a queue with one worker, and only adds transactions whose
+    // checks all passed, using copies of the checks to find the reason when they fail
+    CCheckQueue<CSaplingProofCheck> queue(1);
+    boost::thread worker(boost::bind(&CCheckQueue<CSaplingProofCheck>::Thread, boost::ref(queue)));
+
+    CTransaction invalid = InvalidSaplingTransaction(uint256S("01"));
+    std::vector<CSaplingProofCheck> checks({CSaplingProofCheck(invalid, uint256())});
+    std::vector<CSaplingProofCheck> retry(checks);
+    {
+        CCheckQueueControl<CSaplingProofCheck> control(&queue);
+        control.Add(checks);
+        EXPECT_FALSE(control.Wait());
+    }
+    EXPECT_TRUE(queue.IsIdle());
+
+    std::string strRejectReason;
+    EXPECT_FALSE(retry[0].Verify(strRejectReason));
+    EXPECT_EQ("bad-txns-sapling-output-description-invalid", strRejectReason);
+
+    worker.interrupt();
+    worker.join();
+}
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+
+#include "arith_uint256.h"
+#include "hash.h"
+#include "primitives/block.h"
+#include "uint256.h"
+
+bool mine_verus_v2(CBlockHeader &bh, CVerusHashV2bWriter &vhw, uint256 &finalHash, uint256 &target, uint64_t start, uint64_t *count);
+bool mine_verus_v2_lanes(CBlockHeader &bh, CVerusHashV2bWriter &vhw, uint256 &finalHash, uint256 &target, uint64_t start, uint64_t *count);
+
+static CBlockHeader MiningHeader()
+{
+    CBlockHeader header;
+    header.nVersion = CBlockHeader::VERUS_V2;
+    header.hashPrevBlock = uint256S("0x01");
+    header.hashMerkleRoot = uint256S("0x02");
+    header.nTime = 1600000000;
+    header.nBits = 0x1e0fffff;
+    header.nSolution.resize(1344);
+    header.nSolution[0] = SOLUTION_VERUSHHASH_V2_2;
+    return header;
+}
+
+static uint64_t SolutionNonce(const CBlockHeader &header)
+{
+    return *((int64_t *)&(header.nSolution.data()[header.nSolution.size() - ((header.nSolution.size() % 32) + 15)]));
+}
+
+// hashes of the bytes i * 7 + 3 by the VerusHash 2.1 and 2.2 code before the lane miner was added,
+// which shares its CLHash round with the scalar hash
+static const struct
+{
+    int solutionVersion;
+    size_t nLength;
+    const char *hash;
+} verusHashVectors[] = {
+    {SOLUTION_VERUSHHASH_V2_1, 0, "0ccc4ab1fa418964a0549fec2ee4f00dacc0a20ed343d2f2a26f78fe98828a65"},
+    {SOLUTION_VERUSHHASH_V2_1, 1, "8aacac01f5ae503c9ca4e3defffb1307908ca2899b6149c7b6d961978e3d00fe"},
+    {SOLUTION_VERUSHHASH_V2_1, 31, "c6ede8e98030381e21e99fb524869188d29647721219932802bdd36bbf307ee6"},
+    {SOLUTION_VERUSHHASH_V2_1, 32, "2d53f6b7dcd42eaa227bd3baf89425ce730d1ece91a10078e103447b3dd8b6aa"},
+    {SOLUTION_VERUSHHASH_V2_1, 64, "20db9873ad0664764b431980b1dac0d6e3a320aa8f8e09e9530e5b1831abe33c"},
+    {SOLUTION_VERUSHHASH_V2_1, 140, "492fd93136282698513d96d772c5833636ecab1360371e228c48c98a8649f755"},
+    {SOLUTION_VERUSHHASH_V2_1, 1487, "041cd4e86c63f8a989c3c5c050fd4f08eeb5a9e08a010196c97f2d8d0c20965a"},
+    {SOLUTION_VERUSHHASH_V2_2, 0, "02fb9eb345b6dd344486f322ed19ad78ccea32b1d954cd3f2b8de82370fd8222"},
+    {SOLUTION_VERUSHHASH_V2_2, 1, "3eea38c24317d41f1095b0a53db22b6864a8a92237974366388f2a4b2907e761"},
+    {SOLUTION_VERUSHHASH_V2_2, 31, "5855118ee644ab681ae0a6dd02977a6d1353c13a6d967ec65cec8391e48ef8bb"},
+    {SOLUTION_VERUSHHASH_V2_2, 32, "90f4f30b6663a13762cf912742324da15be8800ff6b8560fd92a6f986730cb63"},
+    {SOLUTION_VERUSHHASH_V2_2, 64, "df5ea5e07980057994bbdb7b48fbc3c7ffef508ba06f3e103d11656d29ce98f8"},
+    {SOLUTION_VERUSHHASH_V2_2, 140, "6ad21a26de02d307fa832045986c1ef9cbcd27fae955eb7b5899d4ef1fc99c63"},
+    {SOLUTION_VERUSHHASH_V2_2, 1487, "df6c14112d1aad955b2e17db813154c08830ba9891e26623609dce1d3fb5e470"},
+};
+
+TEST(VerusHash, KnownAnswers)
+{
+    CVerusHashV2::init();
+
+    for (auto &vector : verusHashVectors)
+    {
+        std::vector<unsigned char> data(vector.nLength);
+        for (size_t i = 0; i < data.size(); i++)
+        {
+            data[i] = (unsigned char)(i * 7 + 3);
+        }
+        CVerusHashV2 hash(vector.solutionVersion);
+        hash.Write(data.data(), data.size());
+        uint256 result;
+        hash.Finalize2b((unsigned char *)&result);
+        EXPECT_EQ(result.GetHex(), vector.hash) << "version " << vector.solutionVersion << ", length " << vector.nLength;
+    }
+}
+
+// the interleaved miner must find the same first winning nonce as the scalar one, for groups of any alignment
+TEST(VerusHash, MiningLanesMatchScalar)
+{
+    if (!IsCPUVerusOptimized())
+    {
+        return;
+    }
+    CVerusHashV2::init();
+
+    const int nNonces = 11;
+    std::vector<uint256> hashes;
+    for (int i = 0; i < nNonces; i++)
+    {
+        CBlockHeader header = MiningHeader();
+        CVerusHashV2bWriter hw(SER_GETHASH, PROTOCOL_VERSION, SOLUTION_VERUSHHASH_V2_2);
+        uint256 target = ArithToUint256(~arith_uint256()), finalHash;
+        uint64_t count = 1;
+        ASSERT_TRUE(mine_verus_v2(header, hw, finalHash, target, i, &count));
+        EXPECT_EQ(SolutionNonce(header), i);
+        hashes.push_back(finalHash);
+    }
+
+    for (int i = 0; i < nNonces; i++)
+    {
+        int expected = 0;
+        while (UintToArith256(hashes[expected]) > UintToArith256(hashes[i]))
+        {
+            expected++;
+        }
+
+        for (int start = 0; start <= expected; start++)
+        {
+            CBlockHeader header = MiningHeader();
+            CVerusHashV2bWriter hw(SER_GETHASH, PROTOCOL_VERSION, SOLUTION_VERUSHHASH_V2_2);
+            uint256 target = hashes[i], finalHash;
+            uint64_t count = nNonces - start;
+            ASSERT_TRUE(mine_verus_v2_lanes(header, hw, finalHash, target, start, &count));
+            EXPECT_EQ(SolutionNonce(header), expected);
+            EXPECT_EQ(count, expected - start + 1);
+            EXPECT_EQ(finalHash, hashes[expected]);
+        }
+    }
+
+    // and find nothing where the scalar miner finds nothing
+    CBlockHeader header = MiningHeader();
+    CVerusHashV2bWriter hw(SER_GETHASH, PROTOCOL_VERSION, SOLUTION_VERUSHHASH_V2_2);
+    uint256 target, finalHash;
+    uint64_t count = nNonces;
+    EXPECT_FALSE(mine_verus_v2_lanes(header, hw, finalHash, target, 0, &count));
+    EXPECT_EQ(count, nNonces);
+}
@@ -3,6 +3,8 @@
 #include "chainparams.h"
 #include "httpserver.h"
 #include "key_io.h"
+#include "metrics.h"
+#include "rpc/jsonstream.h"
 #include "rpc/protocol.h"
 #include "rpc/server.h"
 #include "random.h"
@@ -11,6 +13,8 @@
 #include "utilstrencodings.h"
 #include "ui_interface.h"
 
+#include <set>
+
 #include <boost/algorithm/string.hpp> // boost::trim
 
 // WWW-Authenticate to present with 401 Unauthorized response
@@ -75,6 +79,157 @@ static void JSONErrorReply(HTTPRequest* req, const UniValue& objError, const Uni
     req->WriteReply(nStatus, strReply);
 }
 
+/**
+ * Execute a request, sending its reply as it is written. Replies that fit in one chunk
+ * are sent as a normal reply, and errors before anything was sent are rethrown to be
+ * reported as usual. After that, the status is already sent, so the result written so far
+ * is closed and the reply ends with the error, which is then not null.
+ */
+static void JSONRPCStreamReply(HTTPRequest* req, const JSONRequest& jreq)
+{
+    bool fStarted = false;
+    CJSONStreamWriter writer([req, &fStarted](const std::string& strChunk) {
+        // stop producing a reply nobody will read
+        if (req->IsCancelled())
+            throw std::runtime_error("client disconnected");
+        if (!fStarted) {
+            req->WriteHeader("Content-Type", "application/json");
+            req->StartChunkedReply(HTTP_OK);
+            fStarted = true;
+        }
+        req->WriteReplyChunk(strChunk);
+    });
+
+    try {
+        writer.BeginObject();
+        writer.Key("result");
+        tableRPC.execute(jreq.strMethod, jreq.params, writer);
+        writer.KeyValue("error", NullUniValue);
+        writer.KeyValue("id", jreq.id);
+        writer.EndObject();
+        writer.Raw("\n");
+    } catch (...) {
+        if (!writer.Flushed())
+            throw;
+        LogPrintf("%s: %s failed after part of its reply was sent\n", __func__, jreq.strMethod);
+        if (!req->IsCancelled()) {
+            UniValue objError;
+            try {
+                throw;
+            } catch (const UniValue& e) {
+                objError = e;
+            } catch (const std::exception& e) {
+                objError = JSONRPCError(RPC_MISC_ERROR, e.what());
+            } catch (...) {
+                objError = JSONRPCError(RPC_MISC_ERROR, "unknown error");
+            }
+            try {
+                writer.CloseLevels(1);
+                writer.KeyValue("error", objError);
+                writer.KeyValue("id", jreq.id);
+                writer.EndObject();
+                writer.Raw("\n");
+                writer.Flush();
+            } catch (const std::exception& e) {
+                LogPrintf("%s: could not finish the reply to %s: %s\n", __func__, jreq.strMethod, e.what());
+            }
+        }
+        req->EndChunkedReply();
+        return;
+    }
+
+    if (writer.Flushed()) {
+        writer.Flush();
+        req->EndChunkedReply();
+    } else {
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, writer.GetBuffer());
+    }
+}
+
+//! Queries that can scan indexes, currencies or identities, served by their own workers
+static const std::set<std::string> heavyReadMethods = {
+    "estimateconversion", "getaddressbalance", "getaddressdeltas", "getaddresstxids", "getaddressutxos",
+    "getbestproofroot", "getcurrencyconverters", "getcurrencystate", "getexports", "getidentitieswithaddress",
+    "getidentitieswithrecovery", "getidentitieswithrevocation", "getidentitycontent", "getidentityhistory",
+    "getimports", "getlastimportfrom", "getlaunchinfo", "getnotarizationdata", "getnotarizationproofs",
+    "getoffers", "getpendingtransfers", "getreservedeposits", "getsaplingtree", "gettxoutsetinfo",
+    "listcurrencies", "listidentities", "listopenoffers", "listsinceblock", "listtransactions", "listunspent",
+    "z_listreceivedbyaddress", "z_listunspent", "zcbenchmark"
+};
+
+//! Calls that create transactions or change the wallet, served by their own workers
+static const std::set<std::string> walletWriteMethods = {
+    "backupwallet", "closeoffers", "definecurrency", "dumpwallet", "encryptwallet", "fundrawtransaction",
+    "importaddress", "importprivkey", "importwallet", "keypoolrefill", "makeoffer", "move", "recoveridentity",
+    "refundfailedlaunch", "registeridentity", "registernamecommitment", "rescanfromheight", "revokeidentity",
+    "sendcurrency", "sendfrom", "sendmany", "sendtoaddress", "setidentitytimelock", "signrawtransaction",
+    "takeoffer", "updateidentity", "walletpassphrase", "walletpassphrasechange", "z_exportwallet",
+    "z_importkey", "z_importviewingkey", "z_importwallet", "z_mergetoaddress", "z_sendmany", "z_shieldcoinbase"
+};
+
+//! Classification only looks at the start of the body, where the method of a request normally is
+static const size_t MAX_CLASSIFY_BODY_SIZE = 64 * 1024;
+
+/**
+ * The work classes are kept apart from the command tables, so check that every method named
+ * in them exists. With the wallet disabled, its methods are not registered and are not checked.
+ */
+static void CheckRPCMethodWorkClasses()
+{
+#ifdef ENABLE_WALLET
+    if (GetBoolArg("-disablewallet", false))
+        return;
+    for (const std::set<std::string>* methods : {&heavyReadMethods, &walletWriteMethods}) {
+        for (const std::string& strMethod : *methods) {
+            if (!tableRPC[strMethod])
+                LogPrintf("%s: work class given for unknown RPC method %s\n", __func__, strMethod);
+            assert(tableRPC[strMethod]);
+        }
+    }
+#endif
+}
+
+static HTTPWorkClass RPCMethodWorkClass(const std::string& strMethod)
+{
+    if (walletWriteMethods.count(strMethod))
+        return HTTP_WORK_WALLET_WRITE;
+    if (heavyReadMethods.count(strMethod))
+        return HTTP_WORK_HEAVY_READ;
+    return HTTP_WORK_CHEAP;
+}
+
+/**
+ * Work class of a JSON-RPC request body, the costliest class of the methods in it. This only
+ * scans for "method" keys rather than parsing the body on the event loop thread. If that
+ * guesses wrong, the request only runs with other workers, it is still parsed and checked
+ * as usual.
+ */
+static HTTPWorkClass RPCBodyWorkClass(const std::string& body)
+{
+    HTTPWorkClass workClass = HTTP_WORK_CHEAP;
+    static const std::string methodKey = "\"method\"";
+    for (size_t pos = body.find(methodKey); pos != std::string::npos; pos = body.find(methodKey, pos)) {
+        pos = body.find_first_not_of(" \t\r\n", pos + methodKey.size());
+        if (pos == std::string::npos || body[pos] != ':')
+            continue;
+        pos = body.find_first_not_of(" \t\r\n", pos + 1);
+        if (pos == std::string::npos || body[pos] != '"')
+            continue;
+        size_t end = body.find('"', pos + 1);
+        if (end == std::string::npos)
+            break;
+        workClass = std::max(workClass, RPCMethodWorkClass(body.substr(pos + 1, end - pos - 1)));
+        pos = end;
+    }
+    return workClass;
+}
+
+static HTTPWorkClass ClassifyJSONRPC(HTTPRequest* req)
+{
+    return RPCBodyWorkClass(req->PeekBody(MAX_CLASSIFY_BODY_SIZE));
+}
+
 static bool RPCAuthorized(const std::string& strAuth)
 {
     if (strRPCUserColonPass.empty()) // Belt-and-suspenders measure if InitRPCAuthentication was not called
@@ -163,10 +318,9 @@ static bool HTTPReq_JSONRPC(HTTPRequest* req, const std::string &)
             }
             LogPrint("rpcapi", "%s %s\n", jreq.strMethod.c_str(), jreq.params.write().c_str());
 
-            UniValue result = tableRPC.execute(jreq.strMethod, jreq.params);
-
             // Send reply
-            strReply = JSONRPCReply(result, NullUniValue, jreq.id);
+            JSONRPCStreamReply(req, jreq);
+            return true;
 
         // array of requests
         } else if (valRequest.isArray())
@@ -186,6 +340,47 @@ static bool HTTPReq_JSONRPC(HTTPRequest* req, const std::string &)
     return true;
 }
 
+static bool HTTPReq_Prometheus(HTTPRequest* req, const std::string &)
+{
+    if (req->GetRequestMethod() != HTTPRequest::GET) {
+        req->WriteReply(HTTP_BAD_METHOD, "Metrics are only served for GET requests");
+        return false;
+    }
+    std::pair<bool, std::string> authHeader = req->GetHeader("authorization");
+    if (!authHeader.first || !RPCAuthorized(authHeader.second)) {
+        if (authHeader.first) {
+            LogPrintf("ThreadRPCServer incorrect password attempt from %s\n", req->GetPeer().ToString());
+            MilliSleep(250);
+        }
+        req->WriteHeader("WWW-Authenticate", WWW_AUTH_HEADER_DATA);
+        req->WriteReply(HTTP_UNAUTHORIZED);
+        return false;
+    }
+
+    // samples of one metric have to be listed together
+    std::vector<HTTPWorkQueueStats> queueStats = GetHTTPWorkQueueStats();
+    std::string strMetrics = FormatPrometheusMetrics();
+    strMetrics += "# TYPE verus_rpc_queue_depth gauge\n";
+    for (auto &stats : queueStats)
+        strMetrics += strprintf("verus_rpc_queue_depth{class=\"%s\"} %u\n", stats.name, stats.nDepth);
+    strMetrics += "# TYPE verus_rpc_queue_busy_workers gauge\n";
+    for (auto &stats : queueStats)
+        strMetrics += strprintf("verus_rpc_queue_busy_workers{class=\"%s\"} %d\n", stats.name, stats.nBusy);
+    strMetrics += "# TYPE verus_rpc_queue_admitted_total counter\n";
+    for (auto &stats : queueStats)
+        strMetrics += strprintf("verus_rpc_queue_admitted_total{class=\"%s\"} %u\n", stats.name, stats.nAdmitted);
+    strMetrics += "# TYPE verus_rpc_queue_rejected_total counter\n";
+    for (auto &stats : queueStats)
+        strMetrics += strprintf("verus_rpc_queue_rejected_total{class=\"%s\"} %u\n", stats.name, stats.nRejected);
+    strMetrics += "# TYPE verus_rpc_queue_cancelled_total counter\n";
+    for (auto &stats : queueStats)
+        strMetrics += strprintf("verus_rpc_queue_cancelled_total{class=\"%s\"} %u\n", stats.name, stats.nCancelled);
+
+    req->WriteHeader("Content-Type", "text/plain; version=0.0.4");
+    req->WriteReply(HTTP_OK, strMetrics);
+    return true;
+}
+
 static bool InitRPCAuthentication()
 {
     if (mapArgs["-rpcpassword"] == "")
@@ -209,7 +404,10 @@ bool StartHTTPRPC()
     if (!InitRPCAuthentication())
         return false;
 
-    RegisterHTTPHandler("/", true, HTTPReq_JSONRPC);
+    CheckRPCMethodWorkClasses();
+    RegisterHTTPHandler("/", true, HTTPReq_JSONRPC, ClassifyJSONRPC);
+    if (GetBoolArg("-prometheus", DEFAULT_HTTP_PROMETHEUS))
+        RegisterHTTPHandler("/metrics", true, HTTPReq_Prometheus);
 
     assert(EventBase());
     httpRPCTimerInterface = new HTTPRPCTimerInterface(EventBase());
@@ -226,6 +424,8 @@ void StopHTTPRPC()
 {
     LogPrint("rpc", "Stopping HTTP RPC server\n");
     UnregisterHTTPHandler("/", true);
+    if (GetBoolArg("-prometheus", DEFAULT_HTTP_PROMETHEUS))
+        UnregisterHTTPHandler("/metrics", true);
     if (httpRPCTimerInterface) {
         RPCUnregisterTimerInterface(httpRPCTimerInterface);
         delete httpRPCTimerInterface;
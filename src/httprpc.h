@@ -10,6 +10,9 @@
 
 class HTTPRequest;
 
+/** Serve metrics in Prometheus format at /metrics */
+static const bool DEFAULT_HTTP_PROMETHEUS = false;
+
 /** Start HTTP RPC subsystem.
  * Precondition; HTTP and RPC has been started.
  */
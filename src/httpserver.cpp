@@ -6,6 +6,7 @@
 
 #include "chainparamsbase.h"
 #include "compat.h"
+#include "metrics.h"
 #include "util.h"
 #include "netbase.h"
 #include "rpc/protocol.h" // For HTTP status codes
@@ -13,7 +14,9 @@
 #include "ui_interface.h"
 #include "utilstrencodings.h"
 
+#include <chrono>
 #include <deque>
+#include <map>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -40,16 +43,45 @@
 #include <boost/foreach.hpp>
 #include <boost/scoped_ptr.hpp>
 
+//! Time requests of each work class wait in the queue
+static CLatencyHistogram queueWaitCheap("http_queue_wait.cheap", "Wait of cheap RPC requests for a worker");
+static CLatencyHistogram queueWaitHeavyRead("http_queue_wait.heavyread", "Wait of heavy read RPC requests for a worker");
+static CLatencyHistogram queueWaitWalletWrite("http_queue_wait.walletwrite", "Wait of wallet write RPC requests for a worker");
+static CLatencyHistogram* const queueWaitHistograms[HTTP_WORK_CLASS_COUNT] = {&queueWaitCheap, &queueWaitHeavyRead, &queueWaitWalletWrite};
+//! Queued requests dropped because their client disconnected
+static AtomicCounter cancelledRequests[HTTP_WORK_CLASS_COUNT];
+
+std::string HTTPWorkClassName(int workClass)
+{
+    switch (workClass) {
+    case HTTP_WORK_CHEAP:
+        return "cheap";
+    case HTTP_WORK_HEAVY_READ:
+        return "heavyread";
+    case HTTP_WORK_WALLET_WRITE:
+        return "walletwrite";
+    default:
+        return "unknown";
+    }
+}
+
 /** HTTP request work item */
 class HTTPWorkItem : public HTTPClosure
 {
 public:
-    HTTPWorkItem(HTTPRequest* req, const std::string &path, const HTTPRequestHandler& func):
-        req(req), path(path), func(func)
+    HTTPWorkItem(HTTPRequest* req, const std::string &path, const HTTPRequestHandler& func, HTTPWorkClass workClass):
+        req(req), path(path), func(func), workClass(workClass), queued(std::chrono::steady_clock::now())
     {
     }
     void operator()()
     {
+        queueWaitHistograms[workClass]->Add(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - queued).count());
+        if (req->IsCancelled()) {
+            // nobody is waiting for the reply anymore
+            LogPrint("http", "Dropping request for %s, client disconnected\n", SanitizeString(path, SAFE_CHARS_URI).substr(0, 100));
+            cancelledRequests[workClass].increment();
+            return;
+        }
         func(req.get(), path);
     }
 
@@ -58,6 +90,8 @@ public:
 private:
     std::string path;
     HTTPRequestHandler func;
+    HTTPWorkClass workClass;
+    std::chrono::steady_clock::time_point queued;
 };
 
 /** Simple work queue for distributing work over multiple threads.
@@ -75,6 +109,10 @@ private:
     bool running;
     size_t maxDepth;
     int numThreads;
+    int numBusy;
+    size_t peakDepth;
+    uint64_t numAdmitted;
+    uint64_t numRejected;
 
     /** RAII object to keep track of number of running worker threads */
     class ThreadCounter
@@ -97,7 +135,11 @@ private:
 public:
     WorkQueue(size_t maxDepth) : running(true),
                                  maxDepth(maxDepth),
-                                 numThreads(0)
+                                 numThreads(0),
+                                 numBusy(0),
+                                 peakDepth(0),
+                                 numAdmitted(0),
+                                 numRejected(0)
     {
     }
     /*( Precondition: worker threads have all stopped
@@ -115,9 +157,12 @@ public:
     {
         boost::unique_lock<boost::mutex> lock(cs);
         if (queue.size() >= maxDepth) {
+            numRejected++;
             return false;
         }
         queue.push_back(item);
+        numAdmitted++;
+        peakDepth = std::max(peakDepth, queue.size());
         cond.notify_one();
         return true;
     }
@@ -135,9 +180,14 @@ public:
                     break;
                 i = queue.front();
                 queue.pop_front();
+                numBusy++;
             }
             (*i)();
             delete i;
+            {
+                boost::unique_lock<boost::mutex> lock(cs);
+                numBusy--;
+            }
         }
     }
     /** Interrupt and exit loops */
@@ -161,18 +211,32 @@ public:
         boost::unique_lock<boost::mutex> lock(cs);
         return queue.size();
     }
+
+    /** Fill in the counters of the queue */
+    void GetStats(HTTPWorkQueueStats& stats)
+    {
+        boost::unique_lock<boost::mutex> lock(cs);
+        stats.nThreads = numThreads;
+        stats.nBusy = numBusy;
+        stats.nDepth = queue.size();
+        stats.nMaxDepth = maxDepth;
+        stats.nPeakDepth = peakDepth;
+        stats.nAdmitted = numAdmitted;
+        stats.nRejected = numRejected;
+    }
 };
 
 struct HTTPPathHandler
 {
     HTTPPathHandler() {}
-    HTTPPathHandler(std::string prefix, bool exactMatch, HTTPRequestHandler handler):
-        prefix(prefix), exactMatch(exactMatch), handler(handler)
+    HTTPPathHandler(std::string prefix, bool exactMatch, HTTPRequestHandler handler, HTTPRequestClassifier classifier):
+        prefix(prefix), exactMatch(exactMatch), handler(handler), classifier(classifier)
     {
     }
     std::string prefix;
     bool exactMatch;
     HTTPRequestHandler handler;
+    HTTPRequestClassifier classifier;
 };
 
 /** HTTP module state */
@@ -183,8 +247,10 @@ static struct event_base* eventBase = 0;
 struct evhttp* eventHTTP = 0;
 //! List of subnets to allow RPC connections from
 static std::vector<CSubNet> rpc_allow_subnets;
-//! Work queue for handling longer requests off the event loop thread
-static WorkQueue<HTTPClosure>* workQueue = 0;
+//! Work queues for handling longer requests off the event loop thread, one per work class
+static WorkQueue<HTTPClosure>* workQueues[HTTP_WORK_CLASS_COUNT] = {};
+//! State of open connections with requests, the map is only used on the event loop thread
+static std::map<struct evhttp_connection*, std::shared_ptr<HTTPConnectionState> > connectionStates;
 //! Handlers for (sub)paths
 std::vector<HTTPPathHandler> pathHandlers;
 //! Bound listening sockets
@@ -248,6 +314,62 @@ static std::string RequestMethodString(HTTPRequest::RequestMethod m)
     }
 }
 
+/** Connection close callback, cancels the requests of the connection before evhttp frees them */
+static void http_connection_close_cb(struct evhttp_connection* evcon, void*)
+{
+    std::map<struct evhttp_connection*, std::shared_ptr<HTTPConnectionState> >::iterator it = connectionStates.find(evcon);
+    if (it != connectionStates.end()) {
+        // waits for any worker that is using a request of this connection
+        std::lock_guard<std::mutex> lock(it->second->cs);
+        it->second->closed = true;
+        // requests that evhttp detached rather than freeing are freed once their workers are done
+        for (struct evhttp_request* req : it->second->pending) {
+            if (!evhttp_request_get_connection(req))
+                it->second->detached.insert(req);
+        }
+        it->second->pending.clear();
+    }
+    if (it != connectionStates.end())
+        connectionStates.erase(it);
+}
+
+/** State of the connection of a request, marked closed when the connection closes */
+static std::shared_ptr<HTTPConnectionState> GetConnectionState(struct evhttp_request* req)
+{
+    struct evhttp_connection* evcon = evhttp_request_get_connection(req);
+    if (!evcon)
+        return nullptr;
+    std::shared_ptr<HTTPConnectionState>& state = connectionStates[evcon];
+    if (!state) {
+        state = std::make_shared<HTTPConnectionState>();
+        evhttp_connection_set_closecb(evcon, http_connection_close_cb, NULL);
+    }
+    return state;
+}
+
+/** Holds the connection of a request while a worker thread uses the request. Requests
+ * without a connection state are never freed from under their user.
+ */
+class HTTPConnectionLock
+{
+public:
+    HTTPConnectionLock(const std::shared_ptr<HTTPConnectionState>& state) : state(state)
+    {
+        if (state)
+            state->cs.lock();
+    }
+    ~HTTPConnectionLock()
+    {
+        if (state)
+            state->cs.unlock();
+    }
+    //! False once the connection closed, when the request must not be touched
+    bool IsOpen() const { return !state || !state->closed; }
+
+private:
+    std::shared_ptr<HTTPConnectionState> state;
+};
+
 /** HTTP request callback */
 static void http_request_cb(struct evhttp_request* req, void* arg)
 {
@@ -289,11 +411,13 @@ static void http_request_cb(struct evhttp_request* req, void* arg)
         }
     }
 
-    // Dispatch to worker thread
+    // Dispatch to worker thread of the work class of the request
     if (i != iend) {
-        std::unique_ptr<HTTPWorkItem> item(new HTTPWorkItem(hreq.release(), path, i->handler));
-        assert(workQueue);
-        if (workQueue->Enqueue(item.get()))
+        HTTPWorkClass workClass = i->classifier ? i->classifier(hreq.get()) : HTTP_WORK_CHEAP;
+        hreq->SetConnectionState(GetConnectionState(req));
+        std::unique_ptr<HTTPWorkItem> item(new HTTPWorkItem(hreq.release(), path, i->handler, workClass));
+        assert(workQueues[workClass]);
+        if (workQueues[workClass]->Enqueue(item.get()))
             item.release(); /* if true, queue took ownership */
         else
             item->req->WriteReply(HTTP_INTERNAL, "Work queue depth exceeded");
@@ -359,9 +483,9 @@ static bool HTTPBindAddresses(struct evhttp* http)
 }
 
 /** Simple wrapper to set thread name and run work queue */
-static void HTTPWorkQueueRun(WorkQueue<HTTPClosure>* queue)
+static void HTTPWorkQueueRun(WorkQueue<HTTPClosure>* queue, const char* threadName)
 {
-    RenameThread("verus-httpworker");
+    RenameThread(threadName);
     queue->Run();
 }
 
@@ -436,9 +560,10 @@ bool InitHTTPServer()
 
     LogPrint("http", "Initialized HTTP server\n");
     int workQueueDepth = std::max((long)GetArg("-rpcworkqueue", DEFAULT_HTTP_WORKQUEUE), 1L);
-    LogPrintf("HTTP: creating work queue of depth %d\n", workQueueDepth);
+    LogPrintf("HTTP: creating work queues of depth %d\n", workQueueDepth);
 
-    workQueue = new WorkQueue<HTTPClosure>(workQueueDepth);
+    for (int i = 0; i < HTTP_WORK_CLASS_COUNT; i++)
+        workQueues[i] = new WorkQueue<HTTPClosure>(workQueueDepth);
     eventBase = base;
     eventHTTP = http;
     return true;
@@ -449,13 +574,21 @@ boost::thread threadHTTP;
 bool StartHTTPServer()
 {
     LogPrint("http", "Starting HTTP server\n");
-    int rpcThreads = std::max((long)GetArg("-rpcthreads", DEFAULT_HTTP_THREADS), 1L);
-    LogPrintf("HTTP: starting %d worker threads\n", rpcThreads);
+    int rpcThreads[HTTP_WORK_CLASS_COUNT] = {
+        (int)std::max((long)GetArg("-rpcthreads", DEFAULT_HTTP_THREADS), 1L),
+        (int)std::max((long)GetArg("-rpcheavythreads", DEFAULT_HTTP_HEAVY_THREADS), 1L),
+        (int)std::max((long)GetArg("-rpcwalletthreads", DEFAULT_HTTP_WALLET_THREADS), 1L)
+    };
+    static const char* threadNames[HTTP_WORK_CLASS_COUNT] = {"verus-httpworker", "verus-httpheavy", "verus-httpwallet"};
+    LogPrintf("HTTP: starting %d cheap, %d heavy read and %d wallet write worker threads\n",
+              rpcThreads[HTTP_WORK_CHEAP], rpcThreads[HTTP_WORK_HEAVY_READ], rpcThreads[HTTP_WORK_WALLET_WRITE]);
     threadHTTP = boost::thread(boost::bind(&ThreadHTTP, eventBase, eventHTTP));
 
-    for (int i = 0; i < rpcThreads; i++) {
-        boost::thread rpc_worker(HTTPWorkQueueRun, workQueue);
-        rpc_worker.detach();
+    for (int c = 0; c < HTTP_WORK_CLASS_COUNT; c++) {
+        for (int i = 0; i < rpcThreads[c]; i++) {
+            boost::thread rpc_worker(HTTPWorkQueueRun, workQueues[c], threadNames[c]);
+            rpc_worker.detach();
+        }
     }
     return true;
 }
@@ -471,17 +604,21 @@ void InterruptHTTPServer()
         // Reject requests on current connections
         evhttp_set_gencb(eventHTTP, http_reject_request_cb, NULL);
     }
-    if (workQueue)
-        workQueue->Interrupt();
+    for (int i = 0; i < HTTP_WORK_CLASS_COUNT; i++)
+        if (workQueues[i])
+            workQueues[i]->Interrupt();
 }
 
 void StopHTTPServer()
 {
     LogPrint("http", "Stopping HTTP server\n");
-    if (workQueue) {
-        LogPrint("http", "Waiting for HTTP worker threads to exit\n");
-        workQueue->WaitExit();
-        delete workQueue;
+    LogPrint("http", "Waiting for HTTP worker threads to exit\n");
+    for (int i = 0; i < HTTP_WORK_CLASS_COUNT; i++) {
+        if (workQueues[i]) {
+            workQueues[i]->WaitExit();
+            delete workQueues[i];
+            workQueues[i] = 0;
+        }
     }
     if (eventBase) {
         LogPrint("http", "Waiting for HTTP event thread to exit\n");
@@ -503,6 +640,7 @@ void StopHTTPServer()
         evhttp_free(eventHTTP);
         eventHTTP = 0;
     }
+    connectionStates.clear();
     if (eventBase) {
         event_base_free(eventBase);
         eventBase = 0;
@@ -515,6 +653,19 @@ struct event_base* EventBase()
     return eventBase;
 }
 
+std::vector<HTTPWorkQueueStats> GetHTTPWorkQueueStats()
+{
+    std::vector<HTTPWorkQueueStats> result;
+    for (int i = 0; i < HTTP_WORK_CLASS_COUNT; i++) {
+        HTTPWorkQueueStats stats = {HTTPWorkClassName(i), 0, 0, 0, 0, 0, 0, 0, 0};
+        if (workQueues[i])
+            workQueues[i]->GetStats(stats);
+        stats.nCancelled = cancelledRequests[i].get();
+        result.push_back(stats);
+    }
+    return result;
+}
+
 static void httpevent_callback_fn(evutil_socket_t, short, void* data)
 {
     // Static handler: simply call inner handler
@@ -541,13 +692,44 @@ void HTTPEvent::trigger(struct timeval* tv)
     else
         evtimer_add(ev, tv); // trigger after timeval passed
 }
+
+/** Called from the main http thread once a worker is done with a request. Returns
+ * true if its reply can be sent. Otherwise the client disconnected, and evhttp either
+ * freed the request with its connection, or detached it, when it is freed here. The
+ * connection is only closed on this thread, so it cannot close while a reply is
+ * being sent.
+ */
+static bool http_finish_request(struct evhttp_request* req, std::shared_ptr<HTTPConnectionState> connection)
+{
+    if (!connection)
+        return true;
+    std::lock_guard<std::mutex> lock(connection->cs);
+    if (!connection->closed) {
+        connection->pending.erase(req);
+        return true;
+    }
+    if (connection->detached.erase(req))
+        evhttp_request_free(req);
+    return false;
+}
+
 HTTPRequest::HTTPRequest(struct evhttp_request* req) : req(req),
-                                                       replySent(false)
+                                                       replySent(false),
+                                                       chunkedReply(false)
 {
 }
 HTTPRequest::~HTTPRequest()
 {
-    if (!replySent) {
+    if (!replySent && IsCancelled()) {
+        // the connection is gone, and the request with it, unless evhttp left it to us to free
+        LogPrint("http", "%s: Request cancelled by client\n", __func__);
+        HTTPEvent* ev = new HTTPEvent(eventBase, true, boost::bind(http_finish_request, req, connection));
+        ev->trigger(0);
+    } else if (chunkedReply && !replySent) {
+        // The body may be incomplete, but the status has already been sent
+        LogPrintf("%s: Unfinished chunked reply\n", __func__);
+        EndChunkedReply();
+    } else if (!replySent) {
         // Keep track of whether reply was sent to avoid request leaks
         LogPrintf("%s: Unhandled request\n", __func__);
         WriteReply(HTTP_INTERNAL, "Unhandled request");
@@ -557,6 +739,9 @@ HTTPRequest::~HTTPRequest()
 
 std::pair<bool, std::string> HTTPRequest::GetHeader(const std::string& hdr)
 {
+    HTTPConnectionLock lock(connection);
+    if (!lock.IsOpen())
+        return std::make_pair(false, "");
     const struct evkeyvalq* headers = evhttp_request_get_input_headers(req);
     assert(headers);
     const char* val = evhttp_find_header(headers, hdr.c_str());
@@ -566,8 +751,41 @@ std::pair<bool, std::string> HTTPRequest::GetHeader(const std::string& hdr)
         return std::make_pair(false, "");
 }
 
+void HTTPRequest::SetConnectionState(const std::shared_ptr<HTTPConnectionState>& state)
+{
+    connection = state;
+    if (connection) {
+        std::lock_guard<std::mutex> lock(connection->cs);
+        connection->pending.insert(req);
+    }
+}
+
+bool HTTPRequest::IsCancelled() const
+{
+    HTTPConnectionLock lock(connection);
+    return !lock.IsOpen();
+}
+
+std::string HTTPRequest::PeekBody(size_t nMaxBytes)
+{
+    HTTPConnectionLock lock(connection);
+    if (!lock.IsOpen())
+        return "";
+    struct evbuffer* buf = evhttp_request_get_input_buffer(req);
+    if (!buf)
+        return "";
+    size_t size = std::min(evbuffer_get_length(buf), nMaxBytes);
+    const char* data = (const char*)evbuffer_pullup(buf, size);
+    if (!data)
+        return "";
+    return std::string(data, size);
+}
+
 std::string HTTPRequest::ReadBody()
 {
+    HTTPConnectionLock lock(connection);
+    if (!lock.IsOpen())
+        return "";
     struct evbuffer* buf = evhttp_request_get_input_buffer(req);
     if (!buf)
         return "";
@@ -588,11 +806,33 @@ std::string HTTPRequest::ReadBody()
 
 void HTTPRequest::WriteHeader(const std::string& hdr, const std::string& value)
 {
+    HTTPConnectionLock lock(connection);
+    if (!lock.IsOpen())
+        return;
     struct evkeyvalq* headers = evhttp_request_get_output_headers(req);
     assert(headers);
     evhttp_add_header(headers, hdr.c_str(), value.c_str());
 }
 
+/** Send a reply from the main http thread, if the client is still connected */
+static void http_send_reply(struct evhttp_request* req, int nStatus, std::shared_ptr<HTTPConnectionState> connection)
+{
+    if (http_finish_request(req, connection))
+        evhttp_send_reply(req, nStatus, NULL, NULL);
+}
+
+static void http_send_reply_start(struct evhttp_request* req, int nStatus, std::shared_ptr<HTTPConnectionState> connection)
+{
+    if (HTTPConnectionLock(connection).IsOpen())
+        evhttp_send_reply_start(req, nStatus, NULL);
+}
+
+static void http_send_reply_end(struct evhttp_request* req, std::shared_ptr<HTTPConnectionState> connection)
+{
+    if (http_finish_request(req, connection))
+        evhttp_send_reply_end(req);
+}
+
 /** Closure sent to main thread to request a reply to be sent to
  * a HTTP request.
  * Replies must be sent in the main loop in the main http thread,
@@ -601,12 +841,54 @@ void HTTPRequest::WriteHeader(const std::string& hdr, const std::string& value)
 void HTTPRequest::WriteReply(int nStatus, const std::string& strReply)
 {
     assert(!replySent && req);
-    // Send event to main http thread to send reply message
-    struct evbuffer* evb = evhttp_request_get_output_buffer(req);
+    {
+        HTTPConnectionLock lock(connection);
+        if (lock.IsOpen()) {
+            struct evbuffer* evb = evhttp_request_get_output_buffer(req);
+            assert(evb);
+            evbuffer_add(evb, strReply.data(), strReply.size());
+        }
+    }
+    // Send event to main http thread to send reply message, or free the request if the client disconnected
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, boost::bind(http_send_reply, req, nStatus, connection));
+    ev->trigger(0);
+    replySent = true;
+    req = 0; // transferred back to main thread
+}
+
+void HTTPRequest::StartChunkedReply(int nStatus)
+{
+    assert(!replySent && !chunkedReply && req);
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, boost::bind(http_send_reply_start, req, nStatus, connection));
+    ev->trigger(0);
+    chunkedReply = true;
+}
+
+/** Send one chunk from the main http thread and release its buffer */
+static void http_send_chunk(struct evhttp_request* req, struct evbuffer* evb, std::shared_ptr<HTTPConnectionState> connection)
+{
+    if (HTTPConnectionLock(connection).IsOpen())
+        evhttp_send_reply_chunk(req, evb);
+    evbuffer_free(evb);
+}
+
+void HTTPRequest::WriteReplyChunk(const std::string& strChunk)
+{
+    assert(!replySent && chunkedReply && req);
+    if (strChunk.empty()) // an empty chunk would end the reply
+        return;
+    struct evbuffer* evb = evbuffer_new();
     assert(evb);
-    evbuffer_add(evb, strReply.data(), strReply.size());
-    HTTPEvent* ev = new HTTPEvent(eventBase, true,
-        boost::bind(evhttp_send_reply, req, nStatus, (const char*)NULL, (struct evbuffer *)NULL));
+    evbuffer_add(evb, strChunk.data(), strChunk.size());
+    // events are run in the order they are activated, so chunks cannot overtake each other
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, boost::bind(http_send_chunk, req, evb, connection));
+    ev->trigger(0);
+}
+
+void HTTPRequest::EndChunkedReply()
+{
+    assert(!replySent && chunkedReply && req);
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, boost::bind(http_send_reply_end, req, connection));
     ev->trigger(0);
     replySent = true;
     req = 0; // transferred back to main thread
@@ -614,8 +896,11 @@ void HTTPRequest::WriteReply(int nStatus, const std::string& strReply)
 
 CService HTTPRequest::GetPeer()
 {
-    evhttp_connection* con = evhttp_request_get_connection(req);
+    HTTPConnectionLock lock(connection);
     CService peer;
+    if (!lock.IsOpen())
+        return peer;
+    evhttp_connection* con = evhttp_request_get_connection(req);
     if (con) {
         // evhttp retains ownership over returned address string
         const char* address = "";
@@ -628,11 +913,17 @@ CService HTTPRequest::GetPeer()
 
 std::string HTTPRequest::GetURI()
 {
+    HTTPConnectionLock lock(connection);
+    if (!lock.IsOpen())
+        return "";
     return evhttp_request_get_uri(req);
 }
 
 HTTPRequest::RequestMethod HTTPRequest::GetRequestMethod()
 {
+    HTTPConnectionLock lock(connection);
+    if (!lock.IsOpen())
+        return UNKNOWN;
     switch (evhttp_request_get_command(req)) {
     case EVHTTP_REQ_GET:
         return GET;
@@ -652,10 +943,11 @@ HTTPRequest::RequestMethod HTTPRequest::GetRequestMethod()
     }
 }
 
-void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler)
+void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler,
+                         const HTTPRequestClassifier &classifier)
 {
     LogPrint("http", "Registering HTTP handler for %s (exactmatch %d)\n", prefix, exactMatch);
-    pathHandlers.push_back(HTTPPathHandler(prefix, exactMatch, handler));
+    pathHandlers.push_back(HTTPPathHandler(prefix, exactMatch, handler, classifier));
 }
 
 void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch)
@@ -5,7 +5,11 @@
 #ifndef BITCOIN_HTTPSERVER_H
 #define BITCOIN_HTTPSERVER_H
 
+#include <memory>
+#include <mutex>
+#include <set>
 #include <string>
+#include <vector>
 #include <stdint.h>
 #ifdef _WIN32
 #undef __cpuid
@@ -15,6 +19,8 @@
 #include <boost/function.hpp>
 
 static const int DEFAULT_HTTP_THREADS=4;
+static const int DEFAULT_HTTP_HEAVY_THREADS=2;
+static const int DEFAULT_HTTP_WALLET_THREADS=2;
 static const int DEFAULT_HTTP_WORKQUEUE=16;
 static const int DEFAULT_HTTP_SERVER_TIMEOUT=30;
 
@@ -37,21 +43,75 @@ void InterruptHTTPServer();
 /** Stop HTTP server */
 void StopHTTPServer();
 
+/** Cost classes of requests. Each class has its own work queue and worker
+ * threads, so slow requests of one class cannot keep the others waiting.
+ */
+enum HTTPWorkClass {
+    HTTP_WORK_CHEAP,        //!< quick lookups and submissions, like getblockcount or sendrawtransaction
+    HTTP_WORK_HEAVY_READ,   //!< queries that may scan indexes, currencies or identities
+    HTTP_WORK_WALLET_WRITE, //!< calls that create transactions or change the wallet
+    HTTP_WORK_CLASS_COUNT
+};
+
+/** Name of a work class, as used in metrics */
+std::string HTTPWorkClassName(int workClass);
+
 /** Handler for requests to a certain HTTP path */
 typedef boost::function<void(HTTPRequest* req, const std::string &)> HTTPRequestHandler;
+/** Picks the work class of a request. Called on the event loop thread
+ * before the request is queued, so it must be quick.
+ */
+typedef boost::function<HTTPWorkClass(HTTPRequest* req)> HTTPRequestClassifier;
 /** Register handler for prefix.
  * If multiple handlers match a prefix, the first-registered one will
- * be invoked.
+ * be invoked. Without a classifier, requests are HTTP_WORK_CHEAP.
  */
-void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler);
+void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler,
+                         const HTTPRequestClassifier &classifier = HTTPRequestClassifier());
 /** Unregister handler for prefix */
 void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch);
 
+/** State of the work queue of one work class */
+struct HTTPWorkQueueStats
+{
+    std::string name;
+    int nThreads;        //!< worker threads
+    int nBusy;           //!< workers running a request
+    size_t nDepth;       //!< requests waiting
+    size_t nMaxDepth;    //!< depth at which requests are rejected
+    size_t nPeakDepth;   //!< most requests ever waiting
+    uint64_t nAdmitted;  //!< requests queued
+    uint64_t nRejected;  //!< requests rejected because the queue was full
+    uint64_t nCancelled; //!< queued requests dropped because the client disconnected
+};
+
+/** State of all work queues, indexed by work class */
+std::vector<HTTPWorkQueueStats> GetHTTPWorkQueueStats();
+
 /** Return evhttp event base. This can be used by submodules to
  * queue timers or custom events.
  */
 struct event_base* EventBase();
 
+/** State shared by the requests of one connection and the callback run when it closes.
+ * evhttp frees the requests of a connection on the event loop thread right after that
+ * callback, so worker threads hold the mutex from checking the connection is open until
+ * they are done with the request. Requests that are still being handled when the client
+ * disconnects are detached from the connection instead, and are left for us to free.
+ */
+class HTTPConnectionState
+{
+public:
+    std::mutex cs;
+    bool closed;
+    //! Requests handed to workers whose reply has not been sent yet
+    std::set<struct evhttp_request*> pending;
+    //! Pending requests that evhttp detached when the connection closed
+    std::set<struct evhttp_request*> detached;
+
+    HTTPConnectionState() : closed(false) {}
+};
+
 /** In-flight HTTP request.
  * Thin C++ wrapper around evhttp_request.
  */
@@ -59,10 +119,12 @@ class HTTPRequest
 {
 private:
     struct evhttp_request* req;
+    std::shared_ptr<HTTPConnectionState> connection;
 
     // For test access
 protected:
     bool replySent;
+    bool chunkedReply;
 
 public:
     HTTPRequest(struct evhttp_request* req);
@@ -94,6 +156,24 @@ public:
      */
     virtual std::pair<bool, std::string> GetHeader(const std::string& hdr);
 
+    /**
+     * Share the state of the connection of this request. Once the client
+     * disconnects, the request is not touched, and replies are dropped after
+     * freeing the request if evhttp detached it.
+     */
+    void SetConnectionState(const std::shared_ptr<HTTPConnectionState>& state);
+
+    /**
+     * True once the client has disconnected. Handlers that take long can
+     * check this to stop early.
+     */
+    bool IsCancelled() const;
+
+    /**
+     * Up to nMaxBytes of the request body, without consuming it.
+     */
+    std::string PeekBody(size_t nMaxBytes);
+
     /**
      * Read request body.
      *
@@ -118,6 +198,24 @@ public:
      * main thread, do not call any other HTTPRequest methods after calling this.
      */
     virtual void WriteReply(int nStatus, const std::string& strReply = "");
+
+    /**
+     * Start a chunked HTTP reply, to send a body that is not complete yet.
+     * Headers have to be written before calling this.
+     */
+    virtual void StartChunkedReply(int nStatus);
+
+    /**
+     * Send the next piece of the body of a reply started with StartChunkedReply.
+     */
+    virtual void WriteReplyChunk(const std::string& strChunk);
+
+    /**
+     * Finish a chunked reply.
+     *
+     * @note Like WriteReply, this gives the request back to the main thread.
+     */
+    virtual void EndChunkedReply();
 };
 
 /** Event handler closure.
@@ -26,6 +26,13 @@
 #include "miner.h"
 #include "net.h"
 #include "params.h"
+#include "pbaas/convertergraph.h"
+#include "pbaas/currencyregistry.h"
+#include "pbaas/identitycontent.h"
+#include "pbaas/identityindex.h"
+#include "pbaas/importcache.h"
+#include "pbaas/offerbook.h"
+#include "pbaas/transferqueue.h"
 #include "rpc/server.h"
 #include "rpc/pbaasrpc.h"
 #include "rpc/register.h"
@@ -69,6 +76,8 @@
 #include "amqp/amqpnotificationinterface.h"
 #endif
 
+#include "notificationqueue.h"
+
 #include "librustzcash.h"
 
 using namespace std;
@@ -88,6 +97,8 @@ CWallet* pwalletMain = NULL;
 #endif
 bool fFeeEstimatesInitialized = false;
 
+static CNotificationQueue* pnotificationQueue = NULL;
+
 #if ENABLE_ZMQ
 static CZMQNotificationInterface* pzmqNotificationInterface = NULL;
 #endif
@@ -241,6 +252,8 @@ void Shutdown()
         }
         delete pcoinsTip;
         pcoinsTip = NULL;
+        delete pcoinsWriteBehind;
+        pcoinsWriteBehind = NULL;
         delete pcoinscatcher;
         pcoinscatcher = NULL;
         delete pcoinsdbview;
@@ -255,9 +268,16 @@ void Shutdown()
         pwalletMain->Flush(true);
 #endif
 
+    // publish what is still queued before the sinks go away
+    if (pnotificationQueue) {
+        UnregisterValidationInterface(pnotificationQueue);
+        pnotificationQueue->Stop();
+        delete pnotificationQueue;
+        pnotificationQueue = NULL;
+    }
+
 #if ENABLE_ZMQ
     if (pzmqNotificationInterface) {
-        UnregisterValidationInterface(pzmqNotificationInterface);
         delete pzmqNotificationInterface;
         pzmqNotificationInterface = NULL;
     }
@@ -265,7 +285,6 @@ void Shutdown()
 
 #if ENABLE_PROTON
     if (pAMQPNotificationInterface) {
-        UnregisterValidationInterface(pAMQPNotificationInterface);
         delete pAMQPNotificationInterface;
         pAMQPNotificationInterface = NULL;
     }
@@ -353,6 +372,7 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-?", _("This help message"));
     strUsage += HelpMessageOpt("-alerts", strprintf(_("Receive and display P2P network alerts (default: %u)"), DEFAULT_ALERTS));
     strUsage += HelpMessageOpt("-alertnotify=<cmd>", _("Execute command when a relevant alert is received or we see a really long fork (%s in cmd is replaced by message)"));
+    strUsage += HelpMessageOpt("-backgroundcoinsflush", strprintf(_("Write the coins cache to disk on a background thread, which may use up to twice -dbcache while a flush is written (default: %u)"), DEFAULT_BACKGROUND_COINS_FLUSH));
     strUsage += HelpMessageOpt("-blocknotify=<cmd>", _("Execute command when the best block changes (%s in cmd is replaced by block hash)"));
     strUsage += HelpMessageOpt("-bootstrap", _("Removes previous chain data (if present), downloads and extracts the bootstrap archive."));
     strUsage += HelpMessageOpt("-checkblocks=<n>", strprintf(_("How many blocks to check at startup (default: %u, 0 = all)"), 288));
@@ -371,6 +391,7 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-maxorphantx=<n>", strprintf(_("Keep at most <n> unconnectable transactions in memory (default: %u)"), DEFAULT_MAX_ORPHAN_TRANSACTIONS));
     strUsage += HelpMessageOpt("-mempooltxinputlimit=<n>", _("[DEPRECATED FROM OVERWINTER] Set the maximum number of transparent inputs in a transaction that the mempool will accept (default: 0 = no limit applied)"));
     strUsage += HelpMessageOpt("-notarydatadir=<dir>", _("Specify data directory for notary chain"));
+    strUsage += HelpMessageOpt("-batchsigverify", strprintf(_("Defer signature checks of simple transparent scripts when connecting blocks and verify them together in parallel (default: %u)"), DEFAULT_BATCH_SIG_VERIFY));
     strUsage += HelpMessageOpt("-par=<n>", strprintf(_("Set the number of script verification threads (%u to %d, 0 = auto, <0 = leave that many cores free, default: %d)"),
         -(int)boost::thread::hardware_concurrency(), MAX_SCRIPTCHECK_THREADS, DEFAULT_SCRIPTCHECK_THREADS));
 #ifndef _WIN32
@@ -441,7 +462,7 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-defaultid=<i-address>", _("VerusID used for default change out and staking reward recipient"));
     strUsage += HelpMessageOpt("-defaultzaddr=<sapling-address>", _("sapling address to receive fraud proof rewards and if used with \"-privatechange=1\", z-change address for the sendcurrency command"));
     strUsage += HelpMessageOpt("-disablewallet", _("Do not load the wallet and disable wallet RPC calls"));
-    strUsage += HelpMessageOpt("-fastload", _("If fastload is true, the daemon will load much faster, potentially saving an hour off of load time, and it will also require up to 4GB more RAM for the same tasks"));
+    strUsage += HelpMessageOpt("-fastload", _("If fastload is true, block header solutions held in memory are not compressed, which is faster but uses more RAM. Solutions of block headers already stored in the block index database are read from disk when needed either way"));
     strUsage += HelpMessageOpt("-keypool=<n>", strprintf(_("Set key pool size to <n> (default: %u)"), 100));
     strUsage += HelpMessageOpt("-maxtxfee=<amt>", strprintf(_("Maximum total fees (in %s) to use in a single wallet transaction; setting this too low may abort large transactions (default: %s)"),
         CURRENCY_UNIT, FormatMoney(maxTxFee)));
@@ -473,6 +494,11 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-zmqpubhashtx=<address>", _("Enable publish hash transaction in <address>"));
     strUsage += HelpMessageOpt("-zmqpubrawblock=<address>", _("Enable publish raw block in <address>"));
     strUsage += HelpMessageOpt("-zmqpubrawtx=<address>", _("Enable publish raw transaction in <address>"));
+    strUsage += HelpMessageOpt("-zmqpubcheckedblock=<address>", _("Enable publish raw block that passed validation in <address>"));
+    strUsage += HelpMessageOpt("-zmqpubpbaasimport=<address>", _("Enable publish cross-chain imports mined in a block in <address>"));
+    strUsage += HelpMessageOpt("-zmqpubpbaasexport=<address>", _("Enable publish cross-chain exports mined in a block in <address>"));
+    strUsage += HelpMessageOpt("-zmqpubnotarization=<address>", _("Enable publish notarizations mined in a block in <address>"));
+    strUsage += HelpMessageOpt("-zmqpubidentity=<address>", _("Enable publish identity updates mined in a block in <address>"));
 #endif
 
 #if ENABLE_PROTON
@@ -481,6 +507,17 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-amqppubhashtx=<address>", _("Enable publish hash transaction in <address>"));
     strUsage += HelpMessageOpt("-amqppubrawblock=<address>", _("Enable publish raw block in <address>"));
     strUsage += HelpMessageOpt("-amqppubrawtx=<address>", _("Enable publish raw transaction in <address>"));
+    strUsage += HelpMessageOpt("-amqppubcheckedblock=<address>", _("Enable publish raw block that passed validation in <address>"));
+    strUsage += HelpMessageOpt("-amqppubpbaasimport=<address>", _("Enable publish cross-chain imports mined in a block in <address>"));
+    strUsage += HelpMessageOpt("-amqppubpbaasexport=<address>", _("Enable publish cross-chain exports mined in a block in <address>"));
+    strUsage += HelpMessageOpt("-amqppubnotarization=<address>", _("Enable publish notarizations mined in a block in <address>"));
+    strUsage += HelpMessageOpt("-amqppubidentity=<address>", _("Enable publish identity updates mined in a block in <address>"));
+#endif
+
+#if ENABLE_ZMQ || ENABLE_PROTON
+    strUsage += HelpMessageGroup(_("Notification options:"));
+    strUsage += HelpMessageOpt("-notificationqueuesize=<n>", strprintf(_("Most notifications waiting to be published (default: %u)"), DEFAULT_NOTIFICATION_QUEUE_SIZE));
+    strUsage += HelpMessageOpt("-notificationdropmempool", strprintf(_("Drop notifications of mempool transactions while the queue is full, instead of queueing them beyond its size (default: %u)"), DEFAULT_NOTIFICATION_DROP_MEMPOOL));
 #endif
 
     strUsage += HelpMessageGroup(_("Debugging/Testing options:"));
@@ -576,9 +613,12 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-rpcpassword=<pw>", _("Password for JSON-RPC connections"));
     strUsage += HelpMessageOpt("-rpcport=<port>", strprintf(_("Listen for JSON-RPC connections on <port> (default: %u or testnet: %u)"), 7771, 17771));
     strUsage += HelpMessageOpt("-rpcallowip=<ip>", _("Allow JSON-RPC connections from specified source. Valid for <ip> are a single IP (e.g. 1.2.3.4), a network/netmask (e.g. 1.2.3.4/255.255.255.0) or a network/CIDR (e.g. 1.2.3.4/24). This option can be specified multiple times"));
-    strUsage += HelpMessageOpt("-rpcthreads=<n>", strprintf(_("Set the number of threads to service RPC calls (default: %d)"), DEFAULT_HTTP_THREADS));
+    strUsage += HelpMessageOpt("-prometheus", strprintf(_("Serve latency histograms and counters in Prometheus format at /metrics on the RPC port, with the RPC credentials (default: %u)"), DEFAULT_HTTP_PROMETHEUS));
+    strUsage += HelpMessageOpt("-rpcthreads=<n>", strprintf(_("Set the number of threads to service cheap RPC calls (default: %d)"), DEFAULT_HTTP_THREADS));
+    strUsage += HelpMessageOpt("-rpcheavythreads=<n>", strprintf(_("Set the number of threads to service RPC queries that scan indexes, currencies or identities (default: %d)"), DEFAULT_HTTP_HEAVY_THREADS));
+    strUsage += HelpMessageOpt("-rpcwalletthreads=<n>", strprintf(_("Set the number of threads to service RPC calls that change the wallet (default: %d)"), DEFAULT_HTTP_WALLET_THREADS));
     if (showDebug) {
-        strUsage += HelpMessageOpt("-rpcworkqueue=<n>", strprintf("Set the depth of the work queue to service RPC calls (default: %d)", DEFAULT_HTTP_WORKQUEUE));
+        strUsage += HelpMessageOpt("-rpcworkqueue=<n>", strprintf("Set the depth of each work queue to service RPC calls (default: %d)", DEFAULT_HTTP_WORKQUEUE));
         strUsage += HelpMessageOpt("-rpcservertimeout=<n>", strprintf("Timeout during HTTP requests (default: %d)", DEFAULT_HTTP_SERVER_TIMEOUT));
     }
 
@@ -1054,6 +1094,7 @@ bool AppInit2(boost::thread_group& threadGroup, CScheduler& scheduler)
         nScriptCheckThreads = 0;
     else if (nScriptCheckThreads > MAX_SCRIPTCHECK_THREADS)
         nScriptCheckThreads = MAX_SCRIPTCHECK_THREADS;
+    fBatchSigVerify = GetBoolArg("-batchsigverify", DEFAULT_BATCH_SIG_VERIFY);
 
     fServer = GetBoolArg("-server", false);
 
@@ -1429,6 +1470,7 @@ bool AppInit2(boost::thread_group& threadGroup, CScheduler& scheduler)
     if (nScriptCheckThreads) {
         for (int i=0; i<nScriptCheckThreads-1; i++)
             threadGroup.create_thread(&ThreadScriptCheck);
+        threadGroup.create_thread(&ThreadMempoolSaplingCheck);
     }
 
     // Start the lightweight task scheduler thread
@@ -1641,9 +1683,6 @@ bool AppInit2(boost::thread_group& threadGroup, CScheduler& scheduler)
 #if ENABLE_ZMQ
     pzmqNotificationInterface = CZMQNotificationInterface::CreateWithArguments(mapArgs);
 
-    if (pzmqNotificationInterface) {
-        RegisterValidationInterface(pzmqNotificationInterface);
-    }
 #endif
 
 #if ENABLE_PROTON
@@ -1656,10 +1695,36 @@ bool AppInit2(boost::thread_group& threadGroup, CScheduler& scheduler)
         if (!fExperimentalMode) {
             return InitError(_("AMQP support requires -experimentalfeatures."));
         }
+    }
+#endif
 
-        RegisterValidationInterface(pAMQPNotificationInterface);
+    std::vector<CNotificationSink*> notificationSinks;
+#if ENABLE_ZMQ
+    if (pzmqNotificationInterface) {
+        notificationSinks.push_back(pzmqNotificationInterface);
+    }
+#endif
+#if ENABLE_PROTON
+    if (pAMQPNotificationInterface) {
+        notificationSinks.push_back(pAMQPNotificationInterface);
     }
 #endif
+    if (!notificationSinks.empty()) {
+        pnotificationQueue = new CNotificationQueue(notificationSinks,
+                                                    GetArg("-notificationqueuesize", DEFAULT_NOTIFICATION_QUEUE_SIZE),
+                                                    GetBoolArg("-notificationdropmempool", DEFAULT_NOTIFICATION_DROP_MEMPOOL));
+        RegisterValidationInterface(pnotificationQueue);
+        pnotificationQueue->Start();
+    }
+
+    // keep the converters, offers, currencies, identities, pending transfers and import stages in step with the chain
+    RegisterValidationInterface(&ConverterGraph);
+    RegisterValidationInterface(&OfferBook);
+    RegisterValidationInterface(&CurrencyRegistry);
+    RegisterValidationInterface(&IdentityIndex);
+    RegisterValidationInterface(&IdentityContentCache);
+    RegisterValidationInterface(&PendingTransfers);
+    RegisterValidationInterface(&ImportStages);
 
     // ********************************************************* Step 7: load block chain
 
@@ -1834,6 +1899,8 @@ bool AppInit2(boost::thread_group& threadGroup, CScheduler& scheduler)
             try {
                 UnloadBlockIndex();
                 delete pcoinsTip;
+                delete pcoinsWriteBehind;
+                pcoinsWriteBehind = NULL;
                 delete pcoinsdbview;
                 delete pcoinscatcher;
                 delete pblocktree;
@@ -1842,7 +1909,13 @@ bool AppInit2(boost::thread_group& threadGroup, CScheduler& scheduler)
                 pblocktree = new CBlockTreeDB(nBlockTreeDBCache, false, fReindex, dbCompression, dbMaxOpenFiles);
                 pcoinsdbview = new CCoinsViewDB(nCoinDBCache, false, fReindex);
                 pcoinscatcher = new CCoinsViewErrorCatcher(pcoinsdbview);
-                pcoinsTip = new CCoinsViewCache(pcoinscatcher);
+                if (GetBoolArg("-backgroundcoinsflush", DEFAULT_BACKGROUND_COINS_FLUSH)) {
+                    pcoinsWriteBehind = new CCoinsViewWriteBehind(pcoinscatcher, pcoinsdbview);
+                    pcoinsTip = new CCoinsViewCache(pcoinsWriteBehind);
+                } else {
+                    pcoinsTip = new CCoinsViewCache(pcoinscatcher);
+                }
+                pcoinsTip->CountCacheUse();
                 pnotarisations = new NotarisationDB(100*1024*1024, false, fReindex);
 
 
@@ -1853,6 +1926,11 @@ bool AppInit2(boost::thread_group& threadGroup, CScheduler& scheduler)
                         CleanupBlockRevFiles();
                 }
 
+                if (!fReindex && !pcoinsdbview->CheckVersion()) {
+                    strLoadError = _("You need to rebuild the database using -reindex to change the coin database version");
+                    break;
+                }
+
                 if (!LoadBlockIndex()) {
                     strLoadError = _("Error loading block database");
                     break;
@@ -83,6 +83,7 @@ static int64_t nTimeBestReceived = 0;
 CWaitableCriticalSection csBestBlock;
 CConditionVariable cvBlockChange;
 int nScriptCheckThreads = 0;
+bool fBatchSigVerify = DEFAULT_BATCH_SIG_VERIFY;
 bool fExperimentalMode = false;
 bool fImporting = false;
 bool fReindex = false;
@@ -624,6 +625,7 @@ CBlockIndex* FindForkInGlobalIndex(const CChain& chain, const CBlockLocator& loc
 }
 
 CCoinsViewCache *pcoinsTip = NULL;
+CCoinsViewWriteBehind *pcoinsWriteBehind = NULL;
 CBlockTreeDB *pblocktree = NULL;
 
 // Komodo globals
@@ -1217,6 +1219,78 @@ bool ContextualCheckCoinbaseTransaction(const CTransaction &tx, uint32_t nHeight
     return valid;
 }
 
+// script checks, deferred signature chunks and Sapling proofs all share this queue
+typedef CCheckVariant<CScriptCheck, CSignatureBatchCheck, CSaplingProofCheck> CValidationCheck;
+static CCheckQueue<CValidationCheck> validationcheckqueue(128);
+
+// Sapling proofs of transactions accepted to the mempool, verified while the rest of the transaction is checked.
+// only AcceptToMemoryPoolInt uses this queue, and it holds cs_main, so the queue is never shared
+static CCheckQueue<CSaplingProofCheck> mempoolsaplingcheckqueue(1);
+
+bool CSaplingProofCheck::Verify(std::string &strRejectReason) const
+{
+    const CTransaction &tx = *ptx;
+    auto ctx = librustzcash_sapling_verification_ctx_init();
+
+    for (const SpendDescription &spend : tx.vShieldedSpend) {
+        if (!librustzcash_sapling_check_spend(
+            ctx,
+            spend.cv.begin(),
+            spend.anchor.begin(),
+            spend.nullifier.begin(),
+            spend.rk.begin(),
+            spend.zkproof.begin(),
+            spend.spendAuthSig.begin(),
+            dataToBeSigned.begin()
+        ))
+        {
+            librustzcash_sapling_verification_ctx_free(ctx);
+            strRejectReason = "bad-txns-sapling-spend-description-invalid";
+            return false;
+        }
+    }
+
+    for (const OutputDescription &output : tx.vShieldedOutput) {
+        if (!librustzcash_sapling_check_output(
+            ctx,
+            output.cv.begin(),
+            output.cm.begin(),
+            output.ephemeralKey.begin(),
+            output.zkproof.begin()
+        ))
+        {
+            librustzcash_sapling_verification_ctx_free(ctx);
+            strRejectReason = "bad-txns-sapling-output-description-invalid";
+            return false;
+        }
+    }
+
+    if (!librustzcash_sapling_final_check(
+        ctx,
+        tx.valueBalance,
+        tx.bindingSig.begin(),
+        dataToBeSigned.begin()
+    ))
+    {
+        librustzcash_sapling_verification_ctx_free(ctx);
+        strRejectReason = "bad-txns-sapling-binding-signature-invalid";
+        return false;
+    }
+
+    librustzcash_sapling_verification_ctx_free(ctx);
+    return true;
+}
+
+bool CSaplingProofCheck::operator()()
+{
+    std::string strRejectReason;
+    if (!Verify(strRejectReason))
+    {
+        return ::error("CSaplingProofCheck(): %s: %s", ptx->GetHash().GetHex(), strRejectReason);
+    }
+    return true;
+}
+
 /**
  * Check a transaction contextually against a set of consensus rules valid at a given block height.
  *
@@ -1232,7 +1306,8 @@ bool ContextualCheckTransaction(
         const CChainParams& chainparams,
         const int nHeight,
         const int dosLevel,
-        bool (*isInitBlockDownload)(const CChainParams&))
+        bool (*isInitBlockDownload)(const CChainParams&),
+        std::vector<CSaplingProofCheck> *pvSaplingChecks)
 {
     bool overwinterActive = chainparams.GetConsensus().NetworkUpgradeActive(nHeight, Consensus::UPGRADE_OVERWINTER);
     bool saplingActive = chainparams.GetConsensus().NetworkUpgradeActive(nHeight, Consensus::UPGRADE_SAPLING);
@@ -1406,57 +1481,21 @@ bool ContextualCheckTransaction(
     if (!tx.vShieldedSpend.empty() ||
         !tx.vShieldedOutput.empty())
     {
-        auto ctx = librustzcash_sapling_verification_ctx_init();
-
-        for (const SpendDescription &spend : tx.vShieldedSpend) {
-            if (!librustzcash_sapling_check_spend(
-                ctx,
-                spend.cv.begin(),
-                spend.anchor.begin(),
-                spend.nullifier.begin(),
-                spend.rk.begin(),
-                spend.zkproof.begin(),
-                spend.spendAuthSig.begin(),
-                dataToBeSigned.begin()
-            ))
-            {
-                librustzcash_sapling_verification_ctx_free(ctx);
-                return state.DoS(100, error("ContextualCheckTransaction(): Sapling spend description invalid"),
-                                      REJECT_INVALID, "bad-txns-sapling-spend-description-invalid");
-            }
-        }
-
-        for (const OutputDescription &output : tx.vShieldedOutput) {
-            if (!librustzcash_sapling_check_output(
-                ctx,
-                output.cv.begin(),
-                output.cm.begin(),
-                output.ephemeralKey.begin(),
-                output.zkproof.begin()
-            ))
-            {
-                librustzcash_sapling_verification_ctx_free(ctx);
-                return state.DoS(100, error("ContextualCheckTransaction(): Sapling output description invalid"),
-                                      REJECT_INVALID, "bad-txns-sapling-output-description-invalid");
-            }
+        CSaplingProofCheck saplingCheck(tx, dataToBeSigned);
+        std::string strRejectReason;
+        if (pvSaplingChecks)
+        {
+            pvSaplingChecks->push_back(CSaplingProofCheck());
+            saplingCheck.swap(pvSaplingChecks->back());
         }
-
-        if (!librustzcash_sapling_final_check(
-            ctx,
-            tx.valueBalance,
-            tx.bindingSig.begin(),
-            dataToBeSigned.begin()
-        ))
+        else if (!saplingCheck.Verify(strRejectReason))
         {
-            librustzcash_sapling_verification_ctx_free(ctx);
-            return state.DoS(100, error("ContextualCheckTransaction(): Sapling binding signature invalid"),
-                                  REJECT_INVALID, "bad-txns-sapling-binding-signature-invalid");
+            return state.DoS(100, error("ContextualCheckTransaction(): %s", strRejectReason), REJECT_INVALID, strRejectReason);
         }
-
-        librustzcash_sapling_verification_ctx_free(ctx);
     }
 
-    // precheck all crypto conditions
+    // precheck all crypto conditions, the loop ends the function so the timer covers only the prechecks
+    CScopedLatencyTimer ccPrecheckTimer(latencyCCPrecheck);
     for (int i = 0; i < tx.vout.size(); i++)
     {
         COptCCParams p;
@@ -1976,12 +2015,21 @@ bool AcceptToMemoryPoolInt(CTxMemPool& pool, CValidationState &state, const CTra
 
     LOCK2(smartTransactionCS, pool.cs);
 
+    // verify Sapling proofs on their own queue while the rest of the transaction is being checked. they
+    // have passed before the transaction is added to the pool, also when connecting a block
+    std::vector<CSaplingProofCheck> vSaplingChecks;
+    bool fParallelSapling = nScriptCheckThreads != 0;
+    CCheckQueueControl<CSaplingProofCheck> saplingControl(fParallelSapling ? &mempoolsaplingcheckqueue : NULL);
+
     // DoS level set to 1 to be more forgiving.
     // Check transaction contextually against the set of consensus rules which apply in the next block to be mined.
-    if (!ContextualCheckTransaction(tx, state, chainParams, nextBlockHeight, (dosLevel == -1) ? 1 : dosLevel))
+    if (!ContextualCheckTransaction(tx, state, chainParams, nextBlockHeight, (dosLevel == -1) ? 1 : dosLevel,
+                                    IsInitialBlockDownload, fParallelSapling ? &vSaplingChecks : NULL))
     {
         return error("AcceptToMemoryPool: ContextualCheckTransaction failed");
     }
+    std::vector<CSaplingProofCheck> vSaplingRetry(vSaplingChecks);
+    saplingControl.Add(vSaplingChecks);
 
     // if this is an identity that is already present in the mem pool, then we cannot duplicate it
     std::list<CTransaction> conflicts;
@@ -2420,6 +2468,20 @@ bool AcceptToMemoryPoolInt(CTxMemPool& pool, CValidationState &state, const CTra
         if ( flag != 0 )
             KOMODO_CONNECTING = -1;
 
+        if (!saplingControl.Wait())
+        {
+            std::string strRejectReason;
+            for (auto &oneCheck : vSaplingRetry)
+            {
+                if (!oneCheck.Verify(strRejectReason))
+                {
+                    break;
+                }
+            }
+            return state.DoS(100, error("AcceptToMemoryPool: Sapling proof verification failed (%s) %s", strRejectReason, hash.ToString()),
+                             REJECT_INVALID, strRejectReason);
+        }
+
         // Store transaction in memory
         if ( komodo_is_notarytx(tx) == 0 )
             KOMODO_ON_DEMAND++;
@@ -2469,6 +2531,7 @@ bool GetSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value)
     if (mempool.getSpentIndex(key, value))
         return true;
 
+    CScopedLatencyTimer timer(latencyIndexLookup);
     if (!pblocktree->ReadSpentIndex(key, value))
         //return error("Unable to get spent index information");
         return false;
@@ -2483,6 +2546,7 @@ bool GetAddressIndex(const uint160& addressHash, int type,
     if (!fAddressIndex)
         return error("address index not enabled");
 
+    CScopedLatencyTimer timer(latencyIndexLookup);
     if (!pblocktree->ReadAddressIndex(addressHash, type, addressIndex, start, end))
         return error("unable to get txids for address");
 
@@ -2495,6 +2559,7 @@ bool GetAddressUnspent(const uint160& addressHash, int type,
     if (!fAddressIndex)
         return error("address index not enabled");
 
+    CScopedLatencyTimer timer(latencyIndexLookup);
     if (!pblocktree->ReadAddressUnspentIndex(addressHash, type, unspentOutputs))
         return error("unable to get txids for address");
 
@@ -3013,10 +3078,22 @@ void UpdateCoins(const CTransaction& tx, CCoinsViewCache& inputs, int nHeight)
     UpdateCoins(tx, inputs, txundo, nHeight);
 }
 
+bool CScriptCheck::CanDeferSignature() const
+{
+    // a push only scriptSig cannot check signatures itself, and for these output types the
+    // only signature check is the last opcode, leaving its result as the script result
+    return (scriptPubKey.IsPayToPublicKeyHash() || scriptPubKey.IsPayToPublicKey()) &&
+           ptxTo->vin[nIn].scriptSig.IsPushOnly();
+}
+
 bool CScriptCheck::operator()() {
     const CScript &scriptSig = ptxTo->vin[nIn].scriptSig;
     ServerTransactionSignatureChecker checker(ptxTo, nIn, amount, cacheStore, *txdata);
     checker.SetIDMap(idMap);
+    if (pSigBatch && CanDeferSignature())
+    {
+        checker.SetSignatureBatch(pSigBatch);
+    }
     if (!VerifyScript(scriptSig, scriptPubKey, nFlags, checker, consensusBranchId, &error)) {
         return ::error("CScriptCheck(): %s:%u VerifySignature failed: %s", ptxTo->vin[nIn].prevout.hash.GetHex(), ptxTo->vin[nIn].prevout.n, ScriptErrorString(error));
     }
@@ -3778,11 +3855,62 @@ void static FlushBlockFile(bool fFinalize = false)
 
 bool FindUndoPos(CValidationState &state, int nFile, CDiskBlockPos &pos, unsigned int nAddSize);
 
-static CCheckQueue<CScriptCheck> scriptcheckqueue(128);
-
 void ThreadScriptCheck() {
     RenameThread("verus-scriptch");
-    scriptcheckqueue.Thread();
+    validationcheckqueue.Thread();
+}
+
+void ThreadMempoolSaplingCheck() {
+    RenameThread("verus-saplingch");
+    mempoolsaplingcheckqueue.Thread();
+}
+
+/**
+ * Verifies all signatures deferred while checking the scripts of a block, in parallel chunks.
+ * If any chunk fails, each signature is checked on its own to report the offending inputs.
+ */
+static bool VerifySignatureBatch(const CSignatureBatch &sigBatch, const CBlockIndex *pindex)
+{
+    if (!sigBatch.Size())
+    {
+        return true;
+    }
+
+    CCheckQueueControl<CValidationCheck> batchControl(nScriptCheckThreads ? &validationcheckqueue : NULL);
+    std::vector<CSignatureBatchCheck> vChecks;
+    size_t nChunks = sigBatch.NumChunks();
+    vChecks.reserve(nChunks);
+    for (size_t i = 0; i < nChunks; i++)
+    {
+        vChecks.push_back(CSignatureBatchCheck(&sigBatch, i));
+    }
+
+    bool fOk;
+    if (nScriptCheckThreads)
+    {
+        batchControl.AddAny(vChecks);
+        fOk = batchControl.Wait();
+    }
+    else
+    {
+        fOk = true;
+        for (auto &oneCheck : vChecks)
+        {
+            if (!(fOk = oneCheck()))
+            {
+                break;
+            }
+        }
+    }
+
+    if (!fOk)
+    {
+        for (auto &oneInvalid : sigBatch.FindInvalid())
+        {
+            LogPrintf("%s: invalid signature for input %s:%u in block %s\n", __func__, oneInvalid.txid.GetHex(), oneInvalid.nIn, pindex->GetBlockHash().GetHex());
+        }
+    }
+    return fOk;
 }
 
 //
@@ -3868,6 +3996,7 @@ bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pin
     }
     //fprintf(stderr,"connectblock ht.%d\n",(int32_t)pindex->GetHeight());
     AssertLockHeld(cs_main);
+    CScopedLatencyTimer connectBlockTimer(latencyConnectBlock);
 
     // either set at activate best chain or when we connect block 1
     if (nHeight == 1)
@@ -3932,7 +4061,16 @@ bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pin
     std::vector<CAddressUnspentDbEntry> addressUnspentIndex;
     std::vector<CSpentIndexDbEntry> spentIndex;
 
-    CCheckQueueControl<CScriptCheck> control(fExpensiveChecks && nScriptCheckThreads ? &scriptcheckqueue : NULL);
+    // the signature batch must outlive the script check control, which waits for pending checks on exit
+    CSignatureBatch sigBatch;
+    bool fUseSigBatch = fExpensiveChecks && fBatchSigVerify && nScriptCheckThreads;
+    // Sapling proofs of transactions that are not accepted to the mempool are verified on the check queue
+    // alongside the scripts, keeping copies of the checks to find an invalid transaction if verification
+    // fails. transactions accepted to the mempool have their proofs verified before they are added to it
+    std::vector<CSaplingProofCheck> vSaplingChecks;
+    std::vector<CSaplingProofCheck> vDeferredSapling;
+    bool fDeferSapling = fExpensiveChecks && nScriptCheckThreads;
+    CCheckQueueControl<CValidationCheck> control(fExpensiveChecks && nScriptCheckThreads ? &validationcheckqueue : NULL);
     CCurrencyDefinition newThisChain;
     std::vector<uint256> vOrphanErase;
 
@@ -4069,9 +4207,9 @@ bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pin
 
         if ( ASSETCHAINS_CC != 0 )
         {
-            if ( scriptcheckqueue.IsIdle() == 0 )
+            if ( validationcheckqueue.IsIdle() == 0 )
             {
-                fprintf(stderr,"scriptcheckqueue isnt idle\n");
+                fprintf(stderr,"validationcheckqueue isnt idle\n");
                 sleep(1);
             }
         }
@@ -4154,7 +4292,7 @@ bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pin
             if (((tx.IsCoinBase() ||
                   isPosTx ||
                   chainActive.Height() >= pindex->GetHeight()) &&
-                 !ContextualCheckTransaction(tx, state, chainparams, nHeight, 10)) ||
+                 !ContextualCheckTransaction(tx, state, chainparams, nHeight, 10, IsInitialBlockDownload, fDeferSapling ? &vSaplingChecks : NULL)) ||
                 (!(tx.IsCoinBase() || isPosTx || chainActive.Height() >= pindex->GetHeight()) &&
                  !AcceptToMemoryPoolInt(mempool, state, tx, false, !ConnectedChains.IsEnhancedDustCheck(nHeight), &missingInputs, false, 10, nHeight, 0) &&
                  !(state.GetRejectReason() == "already in mempool" ||
@@ -4174,6 +4312,13 @@ bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pin
             }
             state = CValidationState();
 
+            if (vSaplingChecks.size())
+            {
+                vDeferredSapling.insert(vDeferredSapling.end(), vSaplingChecks.begin(), vSaplingChecks.end());
+                control.AddAny(vSaplingChecks);
+                vSaplingChecks.clear();
+            }
+
             CReserveTransactionDescriptor rtxd(tx, view, nHeight);
             if (rtxd.IsReject())
             {
@@ -4589,7 +4734,14 @@ bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pin
                 bool fCacheResults = fJustCheck; /* Don't cache results if we're actually connecting blocks (still consult the cache, though) */
                 if (!ContextualCheckInputs(tx, state, view, nHeight, fExpensiveChecks, flags, fCacheResults, txdata[i], chainparams.GetConsensus(), consensusBranchId, nScriptCheckThreads ? &vChecks : NULL))
                     return false;
-                control.Add(vChecks);
+                if (fUseSigBatch)
+                {
+                    for (auto &oneCheck : vChecks)
+                    {
+                        oneCheck.SetSignatureBatch(&sigBatch);
+                    }
+                }
+                control.AddAny(vChecks);
             }
             else if (isPBaaSBlockOne)
             {
@@ -5134,7 +5286,21 @@ bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pin
     }
 
     if (!control.Wait())
+    {
+        // if a deferred Sapling check is the reason for failure, report its transaction
+        for (auto &oneCheck : vDeferredSapling)
+        {
+            std::string strRejectReason;
+            if (!oneCheck.Verify(strRejectReason))
+            {
+                return state.DoS(100, error("ConnectBlock(): %s in transaction %s", strRejectReason, oneCheck.GetTransaction()->GetHash().GetHex()),
+                                 REJECT_INVALID, strRejectReason);
+            }
+        }
         return state.DoS(100, false);
+    }
+    if (!VerifySignatureBatch(sigBatch, pindex))
+        return state.DoS(100, error("ConnectBlock(): deferred signature verification failed"), REJECT_INVALID, "bad-txns-signature");
     int64_t nTime2 = GetTimeMicros(); nTimeVerify += nTime2 - nTimeStart;
     LogPrint("bench", "    - Verify %u txins: %.2fms (%.3fms/txin) [%.2fs]\n", nInputs - 1, 0.001 * (nTime2 - nTimeStart), nInputs <= 1 ? 0 : 0.001 * (nTime2 - nTimeStart) / (nInputs-1), nTimeVerify * 0.000001);
 
@@ -5363,6 +5529,10 @@ bool static FlushStateToDisk(CValidationState &state, FlushStateMode mode) {
                 if (!pblocktree->WriteBatchSync(vFiles, nLastBlockFile, vBlocks)) {
                     return AbortNode(state, "Failed to write to block index database");
                 }
+                // Now that the indexes are in the database, their solutions no longer need to be kept in memory
+                for (const CBlockIndex* pindex : vBlocks) {
+                    pindex->TrimSolution();
+                }
             }
             // Finally remove any pruned files
             if (fFlushForPrune)
@@ -5381,9 +5551,17 @@ bool static FlushStateToDisk(CValidationState &state, FlushStateMode mode) {
             // Flush the chainstate (which may refer to block index entries).
             if (!pcoinsTip->Flush())
                 return AbortNode(state, "Failed to write to coin database");
+            // The flush is written in the background. At shutdown and before block files are
+            // pruned, the coin database itself has to be up to date.
+            if ((mode == FLUSH_STATE_ALWAYS || fFlushForPrune) && pcoinsWriteBehind && !pcoinsWriteBehind->Sync())
+                return AbortNode(state, "Failed to write to coin database");
             nLastFlush = nNow;
         }
         if ((mode == FLUSH_STATE_ALWAYS || mode == FLUSH_STATE_PERIODIC) && nNow > nLastSetChain + (int64_t)DATABASE_WRITE_INTERVAL * 1000000) {
+            // The wallet's best block must not be saved ahead of the coin database, so a flush still
+            // being written in the background has to finish first.
+            if (pcoinsWriteBehind && !pcoinsWriteBehind->Sync())
+                return AbortNode(state, "Failed to write to coin database");
             // Update best block in wallet (so we can detect restored wallets).
             GetMainSignals().SetBestChain(chainActive.GetLocator());
             nLastSetChain = nNow;
@@ -7298,28 +7476,60 @@ CBlockIndex * InsertBlockIndex(uint256 hash)
 bool static LoadBlockIndexDB()
 {
     const CChainParams& chainparams = Params();
+    int nLoadThreads = std::max(1, std::min(GetNumCores(), MAX_BLOCK_INDEX_LOAD_THREADS));
+    int64_t nStart = GetTimeMillis();
     LogPrintf("%s: start loading guts\n", __func__);
-    if (!pblocktree->LoadBlockIndexGuts(InsertBlockIndex))
+    if (!pblocktree->LoadBlockIndexGuts(InsertBlockIndex, nLoadThreads))
         return false;
-    LogPrintf("%s: loaded guts\n", __func__);
+    LogPrintf("%s: loaded guts, %u entries in %dms\n", __func__, mapBlockIndex.size(), GetTimeMillis() - nStart);
     boost::this_thread::interruption_point();
 
     // Calculate chainPower
-    vector<pair<int, CBlockIndex*> > vSortedByHeight;
-    vSortedByHeight.reserve(mapBlockIndex.size());
-    BOOST_FOREACH(const PAIRTYPE(uint256, CBlockIndex*)& item, mapBlockIndex)
+    // Bucket the entries by height, which is linear rather than a sort of the whole index
+    nStart = GetTimeMillis();
+    vector<CBlockIndex*> vSortedByHeight(mapBlockIndex.size());
     {
-        CBlockIndex* pindex = item.second;
-        vSortedByHeight.push_back(make_pair(pindex->GetHeight(), pindex));
-        //komodo_pindex_init(pindex,(int32_t)pindex->GetHeight());
+        vector<size_t> vHeightStart;
+        BOOST_FOREACH(const PAIRTYPE(uint256, CBlockIndex*)& item, mapBlockIndex)
+        {
+            size_t nHeight = std::max(0, item.second->GetHeight());
+            if (nHeight + 2 > vHeightStart.size())
+                vHeightStart.resize(nHeight + 2, 0);
+            vHeightStart[nHeight + 1]++;
+        }
+        for (size_t i = 1; i < vHeightStart.size(); i++)
+            vHeightStart[i] += vHeightStart[i - 1];
+        BOOST_FOREACH(const PAIRTYPE(uint256, CBlockIndex*)& item, mapBlockIndex)
+        {
+            vSortedByHeight[vHeightStart[std::max(0, item.second->GetHeight())]++] = item.second;
+        }
     }
-    //fprintf(stderr,"load blockindexDB paired %u\n",(uint32_t)time(NULL));
-    sort(vSortedByHeight.begin(), vSortedByHeight.end());
-    //fprintf(stderr,"load blockindexDB sorted %u\n",(uint32_t)time(NULL));
-    BOOST_FOREACH(const PAIRTYPE(int, CBlockIndex*)& item, vSortedByHeight)
+
+    // The proof of each block does not depend on its ancestors, so it is calculated in parallel
+    // first, leaving only the additions along the chain for the pass in height order
     {
-        CBlockIndex* pindex = item.second;
-        pindex->chainPower = (pindex->pprev ? CChainPower(pindex) + pindex->pprev->chainPower : CChainPower(pindex)) + GetBlockProof(*pindex);
+        boost::thread_group proofThreads;
+        size_t nPerThread = (vSortedByHeight.size() + nLoadThreads - 1) / nLoadThreads;
+        for (size_t nBegin = 0; nBegin < vSortedByHeight.size(); nBegin += nPerThread)
+        {
+            size_t nEnd = std::min(vSortedByHeight.size(), nBegin + nPerThread);
+            proofThreads.create_thread([&vSortedByHeight, nBegin, nEnd]() {
+                for (size_t i = nBegin; i < nEnd; i++)
+                {
+                    CBlockIndex* pindex = vSortedByHeight[i];
+                    pindex->chainPower = CChainPower(pindex) + GetBlockProof(*pindex);
+                }
+            });
+        }
+        proofThreads.join_all();
+    }
+    LogPrintf("%s: sorted by height and calculated block proofs in %dms\n", __func__, GetTimeMillis() - nStart);
+
+    nStart = GetTimeMillis();
+    BOOST_FOREACH(CBlockIndex* pindex, vSortedByHeight)
+    {
+        if (pindex->pprev)
+            pindex->chainPower += pindex->pprev->chainPower;
         // We can link the chain of blocks for which we've received transactions at some point.
         // Pruned nodes may have deleted the block.
         if (pindex->nTx > 0) {
@@ -7382,9 +7592,10 @@ bool static LoadBlockIndexDB()
             pindexBestHeader = pindex;
         //komodo_pindex_init(pindex,(int32_t)pindex->GetHeight());
     }
-    //fprintf(stderr,"load blockindexDB chained %u\n",(uint32_t)time(NULL));
+    LogPrintf("%s: linked block index in %dms\n", __func__, GetTimeMillis() - nStart);
 
     // Load block file info
+    nStart = GetTimeMillis();
     pblocktree->ReadLastBlockFile(nLastBlockFile);
     vinfoBlockFile.resize(nLastBlockFile + 1);
     LogPrintf("%s: last block file = %i\n", __func__, nLastBlockFile);
@@ -7420,6 +7631,7 @@ bool static LoadBlockIndexDB()
             return false;
         }
     }
+    LogPrintf("%s: loaded block file info and checked block files in %dms\n", __func__, GetTimeMillis() - nStart);
 
     // Check whether we have ever pruned block & undo files
     pblocktree->ReadFlag("prunedblockfiles", fHavePruned);
@@ -9102,10 +9314,15 @@ bool static ProcessMessage(CNode* pfrom, string strCommand, CDataStream& vRecv,
             pfrom->lasthdrsreq = (int32_t)(pindex ? pindex->GetHeight() : -1);
             for (; pindex; pindex = chainActive.Next(pindex))
             {
-                CBlockHeader h = pindex->GetBlockHeader();
+                CBlockHeader h;
+                if (!pindex->GetBlockHeader(h))
+                {
+                    // send what we have, the peer asks again from the last header it gets
+                    break;
+                }
                 //printf("size.%i, solution size.%i\n", (int)sizeof(h), (int)h.nSolution.size());
                 //printf("hash.%s prevhash.%s nonce.%s\n", h.GetHash().ToString().c_str(), h.hashPrevBlock.ToString().c_str(), h.nNonce.ToString().c_str());
-                vHeaders.push_back(pindex->GetBlockHeader());
+                vHeaders.push_back(h);
                 if (--nLimit <= 0 || pindex->GetBlockHash() == hashStop)
                     break;
             }
@@ -50,6 +50,7 @@ class CBloomFilter;
 class CChainParams;
 class CInv;
 class CScriptCheck;
+class CSaplingProofCheck;
 class CValidationInterface;
 class CValidationState;
 class PrecomputedTransactionData;
@@ -95,6 +96,10 @@ static const unsigned int UNDOFILE_CHUNK_SIZE = 0x100000; // 1 MiB
 static const int MAX_SCRIPTCHECK_THREADS = 16;
 /** -par default (number of script-checking threads, 0 = auto) */
 static const int DEFAULT_SCRIPTCHECK_THREADS = 0;
+/** Maximum number of threads used to load the block index at startup */
+static const int MAX_BLOCK_INDEX_LOAD_THREADS = 16;
+/** Default for -batchsigverify, deferring signature verification of simple scripts when connecting blocks */
+static const bool DEFAULT_BATCH_SIG_VERIFY = true;
 /** Number of blocks that can be requested at any given time from a single peer. */
 static const int MAX_BLOCKS_IN_TRANSIT_PER_PEER = 16;
 /** Timeout in seconds during which a peer must stall block download progress before being disconnected. */
@@ -166,6 +171,7 @@ extern bool fExperimentalMode;
 extern bool fImporting;
 extern bool fReindex;
 extern int nScriptCheckThreads;
+extern bool fBatchSigVerify;
 extern bool fTxIndex;
 extern bool fIdIndex;
 extern bool fConversionIndex;
@@ -270,6 +276,8 @@ bool ProcessMessages(CNode* pfrom);
 bool SendMessages(CNode* pto, bool fSendTrickle);
 /** Run an instance of the script checking thread */
 void ThreadScriptCheck();
+/** Run the thread verifying Sapling proofs of transactions accepted to the mempool */
+void ThreadMempoolSaplingCheck();
 /** Try to detect Partition (network isolation) attacks against us */
 void PartitionCheck(bool (*initialDownloadCheck)(const CChainParams&), CCriticalSection& cs, const CBlockIndex *const &bestHeader);
 /** Check whether we are doing an initial block download (synchronizing from disk or network) */
@@ -383,10 +391,13 @@ bool ContextualCheckInputs(const CTransaction& tx, CValidationState &state, cons
                            const Consensus::Params& consensusParams, uint32_t consensusBranchId,
                            std::vector<CScriptCheck> *pvChecks = NULL);
 
-/** Check a transaction contextually against a set of consensus rules */
+/** Check a transaction contextually against a set of consensus rules. If pvSaplingChecks is
+ *  not NULL, Sapling proofs and signatures are returned as a check to be run later instead of
+ *  being verified in place. */
 bool ContextualCheckTransaction(const CTransaction& tx, CValidationState &state,
                                 const CChainParams& chainparams, int nHeight, int dosLevel,
-                                bool (*isInitBlockDownload)(const CChainParams&) = IsInitialBlockDownload);
+                                bool (*isInitBlockDownload)(const CChainParams&) = IsInitialBlockDownload,
+                                std::vector<CSaplingProofCheck> *pvSaplingChecks = NULL);
 
 /** Apply the effects of this transaction on the UTXO set represented by view */
 void UpdateCoins(const CTransaction& tx, CCoinsViewCache& inputs, int nHeight);
@@ -457,15 +468,20 @@ private:
     ScriptError error;
     PrecomputedTransactionData *txdata;
     std::map<uint160, std::pair<int, std::vector<std::vector<unsigned char>>>> idMap;
+    CSignatureBatch *pSigBatch;
 
 public:
-    CScriptCheck(): amount(0), ptxTo(0), nIn(0), nFlags(0), cacheStore(false), consensusBranchId(0), error(SCRIPT_ERR_UNKNOWN_ERROR) {}
+    CScriptCheck(): amount(0), ptxTo(0), nIn(0), nFlags(0), cacheStore(false), consensusBranchId(0), error(SCRIPT_ERR_UNKNOWN_ERROR), txdata(nullptr), pSigBatch(nullptr) {}
     CScriptCheck(const CCoins& txFromIn, const CTransaction& txToIn, unsigned int nInIn, unsigned int nFlagsIn, bool cacheIn, uint32_t consensusBranchIdIn, PrecomputedTransactionData* txdataIn) :
         scriptPubKey(CCoinsViewCache::GetSpendFor(&txFromIn, txToIn.vin[nInIn])), amount(txFromIn.vout[txToIn.vin[nInIn].prevout.n].nValue),
-        ptxTo(&txToIn), nIn(nInIn), nFlags(nFlagsIn), cacheStore(cacheIn), consensusBranchId(consensusBranchIdIn), error(SCRIPT_ERR_UNKNOWN_ERROR), txdata(txdataIn) { }
+        ptxTo(&txToIn), nIn(nInIn), nFlags(nFlagsIn), cacheStore(cacheIn), consensusBranchId(consensusBranchIdIn), error(SCRIPT_ERR_UNKNOWN_ERROR), txdata(txdataIn), pSigBatch(nullptr) { }
 
     bool operator()();
 
+    // true if the only signature check of this script is its final CHECKSIG, so a failed signature
+    // always fails the script and its verification can safely be deferred to a signature batch
+    bool CanDeferSignature() const;
+
     void swap(CScriptCheck &check) {
         scriptPubKey.swap(check.scriptPubKey);
         std::swap(ptxTo, check.ptxTo);
@@ -477,13 +493,64 @@ public:
         std::swap(error, check.error);
         std::swap(txdata, check.txdata);
         std::swap(idMap, check.idMap);
+        std::swap(pSigBatch, check.pSigBatch);
     }
 
     void SetIDMap(const std::map<uint160, std::pair<int, std::vector<std::vector<unsigned char>>>> &map) { idMap = map; }
+    void SetSignatureBatch(CSignatureBatch *pBatch) { pSigBatch = pBatch; }
 
     ScriptError GetScriptError() const { return error; }
 };
 
+/**
+ * Closure representing the verification of all Sapling spend and output proofs, spend
+ * authorization signatures and the binding signature of one transaction
+ * Note that this stores a reference to the transaction
+ */
+class CSaplingProofCheck
+{
+private:
+    const CTransaction *ptx;
+    uint256 dataToBeSigned;
+
+public:
+    CSaplingProofCheck() : ptx(nullptr) {}
+    CSaplingProofCheck(const CTransaction &txIn, const uint256 &dataToBeSignedIn) : ptx(&txIn), dataToBeSigned(dataToBeSignedIn) {}
+
+    // returns false and sets the reject reason if any part of the transaction's Sapling bundle is invalid
+    bool Verify(std::string &strRejectReason) const;
+
+    bool operator()();
+
+    const CTransaction *GetTransaction() const { return ptx; }
+
+    void swap(CSaplingProofCheck &check) {
+        std::swap(ptx, check.ptx);
+        std::swap(dataToBeSigned, check.dataToBeSigned);
+    }
+};
+
+/**
+ * Closure representing the verification of one chunk of deferred signatures
+ */
+class CSignatureBatchCheck
+{
+private:
+    const CSignatureBatch *pBatch;
+    size_t nChunk;
+
+public:
+    CSignatureBatchCheck() : pBatch(nullptr), nChunk(0) {}
+    CSignatureBatchCheck(const CSignatureBatch *pBatchIn, size_t nChunkIn) : pBatch(pBatchIn), nChunk(nChunkIn) {}
+
+    bool operator()() { return pBatch->VerifyChunk(nChunk); }
+
+    void swap(CSignatureBatchCheck &check) {
+        std::swap(pBatch, check.pBatch);
+        std::swap(nChunk, check.nChunk);
+    }
+};
+
 bool GetTimestampIndex(const unsigned int &high, const unsigned int &low, const bool fActiveOnly, std::vector<std::pair<uint256, unsigned int> > &hashes);
 bool GetSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value);
 bool GetAddressIndex(const uint160& addressHash, int type, std::vector<CAddressIndexDbEntry> &addressIndex, int start = 0, int end = 0);
@@ -568,6 +635,9 @@ extern CChain chainActive;
 /** Global variable that points to the active CCoinsView (protected by cs_main) */
 extern CCoinsViewCache *pcoinsTip;
 
+/** Writes what pcoinsTip flushes to disk in the background, NULL with -nobackgroundcoinsflush (protected by cs_main) */
+extern CCoinsViewWriteBehind *pcoinsWriteBehind;
+
 /** Global variable that points to the active block tree (protected by cs_main) */
 extern CBlockTreeDB *pblocktree;
 
@@ -5,10 +5,13 @@
 #ifndef BITCOIN_MEMUSAGE_H
 #define BITCOIN_MEMUSAGE_H
 
+#include "support/allocators/pool.h"
+
 #include <stdlib.h>
 
 #include <map>
 #include <set>
+#include <unordered_map>
 #include <vector>
 
 #include <boost/foreach.hpp>
@@ -130,6 +133,16 @@ static inline size_t DynamicUsage(const std::shared_ptr<X>& p)
     return p ? MallocUsage(sizeof(X)) + MallocUsage(sizeof(stl_shared_counter)) : 0;
 }
 
+template<typename X, typename Y, typename Z, typename E, size_t MAX_BLOCK_SIZE_BYTES, size_t ALIGN_BYTES>
+static inline size_t DynamicUsage(const std::unordered_map<X, Y, Z, E, CPoolAllocator<std::pair<const X, Y>, MAX_BLOCK_SIZE_BYTES, ALIGN_BYTES> >& m)
+{
+    // The nodes live in the pool's chunks, which are counted whole, whether they are in use or not
+    const auto* pResource = m.get_allocator().Resource();
+    return MallocUsage(sizeof(char*) * pResource->ChunkListCapacity()) +
+           MallocUsage(pResource->ChunkSizeBytes()) * pResource->NumAllocatedChunks() +
+           MallocUsage(sizeof(void*) * m.bucket_count());
+}
+
 // Boost data structures
 
 template<typename X>
@@ -14,6 +14,11 @@
 #include "utilmoneystr.h"
 #include "utilstrencodings.h"
 
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+
 #include <boost/thread.hpp>
 #include <boost/thread/synchronized_value.hpp>
 #include <string>
@@ -74,11 +79,205 @@ double AtomicTimer::rate(const AtomicCounter& count)
     return duration > 0 ? (double)count.get() / duration : 0;
 }
 
+static std::mutex &LatencyHistogramsMutex()
+{
+    static std::mutex mtx;
+    return mtx;
+}
+
+static std::map<std::string, const CLatencyHistogram *> &LatencyHistograms()
+{
+    static std::map<std::string, const CLatencyHistogram *> histograms;
+    return histograms;
+}
+
+CLatencyHistogram::CLatencyHistogram(const std::string &nameIn, const std::string &descriptionIn) :
+    name(nameIn), description(descriptionIn)
+{
+    for (auto &shard : shards)
+    {
+        shard.sumMicros = 0;
+        for (auto &bucket : shard.buckets)
+        {
+            bucket = 0;
+        }
+    }
+    std::unique_lock<std::mutex> lock(LatencyHistogramsMutex());
+    LatencyHistograms()[name] = this;
+}
+
+CLatencyHistogram::~CLatencyHistogram()
+{
+    std::unique_lock<std::mutex> lock(LatencyHistogramsMutex());
+    auto it = LatencyHistograms().find(name);
+    if (it != LatencyHistograms().end() && it->second == this)
+    {
+        LatencyHistograms().erase(it);
+    }
+}
+
+int CLatencyHistogram::BucketIndex(uint64_t micros)
+{
+    int bucket = 0;
+    while (micros && bucket < NUM_BUCKETS - 1)
+    {
+        micros >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+void CLatencyHistogram::Add(uint64_t micros)
+{
+    // threads are spread over the shards in the order they first record a sample
+    static std::atomic<unsigned int> nextShard(0);
+    thread_local unsigned int shardIndex = nextShard++ % NUM_SHARDS;
+
+    Shard &shard = shards[shardIndex];
+    shard.sumMicros.fetch_add(micros, std::memory_order_relaxed);
+    shard.buckets[BucketIndex(micros)].fetch_add(1, std::memory_order_relaxed);
+}
+
+CLatencyHistogram::Snapshot CLatencyHistogram::GetSnapshot() const
+{
+    Snapshot snapshot;
+    for (auto &shard : shards)
+    {
+        snapshot.sumMicros += shard.sumMicros.load(std::memory_order_relaxed);
+        for (int i = 0; i < NUM_BUCKETS; i++)
+        {
+            uint64_t n = shard.buckets[i].load(std::memory_order_relaxed);
+            snapshot.buckets[i] += n;
+            snapshot.count += n;
+        }
+    }
+    return snapshot;
+}
+
+uint64_t CLatencyHistogram::Snapshot::Percentile(double fraction) const
+{
+    if (!count)
+    {
+        return 0;
+    }
+    uint64_t target = std::max((uint64_t)1, (uint64_t)std::ceil(fraction * count));
+    uint64_t seen = 0;
+    for (int i = 0; i < NUM_BUCKETS; i++)
+    {
+        seen += buckets[i];
+        if (seen >= target)
+        {
+            return BucketUpperBound(i);
+        }
+    }
+    return BucketUpperBound(NUM_BUCKETS - 1);
+}
+
+//! histograms being recorded by a CScopedOuterLatencyTimer on this thread
+static thread_local std::vector<const CLatencyHistogram *> outerTimedHistograms;
+
+CScopedOuterLatencyTimer::CScopedOuterLatencyTimer(CLatencyHistogram &histogramIn) : pHistogram(nullptr)
+{
+    if (std::find(outerTimedHistograms.begin(), outerTimedHistograms.end(), &histogramIn) == outerTimedHistograms.end())
+    {
+        outerTimedHistograms.push_back(&histogramIn);
+        pHistogram = &histogramIn;
+        start = std::chrono::steady_clock::now();
+    }
+}
+
+CScopedOuterLatencyTimer::~CScopedOuterLatencyTimer()
+{
+    if (pHistogram)
+    {
+        pHistogram->Add(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+        outerTimedHistograms.erase(std::find(outerTimedHistograms.begin(), outerTimedHistograms.end(), pHistogram));
+    }
+}
+
+std::vector<const CLatencyHistogram *> GetLatencyHistograms()
+{
+    std::vector<const CLatencyHistogram *> result;
+    std::unique_lock<std::mutex> lock(LatencyHistogramsMutex());
+    for (auto &entry : LatencyHistograms())
+    {
+        result.push_back(entry.second);
+    }
+    return result;
+}
+
+CLatencyHistogram &GetRPCLatencyHistogram(const std::string &strMethod)
+{
+    // only called for methods in the RPC table, so the number of histograms is bounded
+    static std::mutex mtx;
+    static std::map<std::string, std::unique_ptr<CLatencyHistogram>> rpcHistograms;
+
+    std::unique_lock<std::mutex> lock(mtx);
+    auto it = rpcHistograms.find(strMethod);
+    if (it == rpcHistograms.end())
+    {
+        it = rpcHistograms.insert(std::make_pair(strMethod,
+            std::unique_ptr<CLatencyHistogram>(new CLatencyHistogram("rpc." + strMethod, "RPC " + strMethod)))).first;
+    }
+    return *it->second;
+}
+
+std::vector<std::pair<std::string, const AtomicCounter *>> GetHotPathCounters()
+{
+    return {
+        {"transactions_validated", &transactionsValidated},
+        {"eh_solver_runs", &ehSolverRuns},
+        {"solution_target_checks", &solutionTargetChecks},
+        {"coins_cache_hits", &coinsCacheHits},
+        {"coins_cache_misses", &coinsCacheMisses},
+        {"notifications_queued", &notificationsQueued},
+        {"notifications_dropped", &notificationsDropped},
+    };
+}
+
+std::string FormatPrometheusMetrics()
+{
+    std::string result;
+    result += "# HELP verus_latency_seconds Latency of node hot paths\n";
+    result += "# TYPE verus_latency_seconds histogram\n";
+    for (auto pHistogram : GetLatencyHistograms())
+    {
+        CLatencyHistogram::Snapshot snapshot = pHistogram->GetSnapshot();
+        uint64_t cumulative = 0;
+        for (int i = 0; i < CLatencyHistogram::NUM_BUCKETS - 1; i++)
+        {
+            cumulative += snapshot.buckets[i];
+            result += strprintf("verus_latency_seconds_bucket{path=\"%s\",le=\"%g\"} %u\n",
+                                pHistogram->name, CLatencyHistogram::BucketUpperBound(i) / 1000000.0, cumulative);
+        }
+        result += strprintf("verus_latency_seconds_bucket{path=\"%s\",le=\"+Inf\"} %u\n", pHistogram->name, snapshot.count);
+        result += strprintf("verus_latency_seconds_sum{path=\"%s\"} %.6f\n", pHistogram->name, snapshot.sumMicros / 1000000.0);
+        result += strprintf("verus_latency_seconds_count{path=\"%s\"} %u\n", pHistogram->name, snapshot.count);
+    }
+    for (auto &counter : GetHotPathCounters())
+    {
+        result += strprintf("# TYPE verus_%s_total counter\n", counter.first);
+        result += strprintf("verus_%s_total %u\n", counter.first, counter.second->get());
+    }
+    return result;
+}
+
+CLatencyHistogram latencyDBRead("leveldb_read", "LevelDB point reads");
+CLatencyHistogram latencyDBWrite("leveldb_write", "LevelDB batch writes");
+CLatencyHistogram latencyIndexLookup("index_lookup", "Address and spent index lookups");
+CLatencyHistogram latencyCCPrecheck("cc_precheck", "Crypto-condition prechecks of one transaction");
+CLatencyHistogram latencyNotarizationValidation("notarization_validation", "Notarization output validation");
+CLatencyHistogram latencyConnectBlock("connect_block", "ConnectBlock");
+
 boost::synchronized_value<int64_t> nNodeStartTime;
 boost::synchronized_value<int64_t> nNextRefresh;
 AtomicCounter transactionsValidated;
 AtomicCounter ehSolverRuns;
 AtomicCounter solutionTargetChecks;
+AtomicCounter coinsCacheHits;
+AtomicCounter coinsCacheMisses;
+AtomicCounter notificationsQueued;
+AtomicCounter notificationsDropped;
 static AtomicCounter minedBlocks;
 PerfCounterTimer miningTimer;
 CCriticalSection cs_metrics;
@@ -2,12 +2,18 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or https://www.opensource.org/licenses/mit-license.php .
 
+#ifndef ZCASH_METRICS_H
+#define ZCASH_METRICS_H
+
 #include "uint256.h"
 #include "consensus/params.h"
 
+#include <array>
 #include <atomic>
+#include <chrono>
 #include <mutex>
 #include <string>
+#include <vector>
 
 struct AtomicCounter {
     std::atomic<uint64_t> value;
@@ -76,9 +82,116 @@ public:
     double rate(const int64_t &count);
 };
 
+/**
+ * Histogram of latencies in microseconds, with power of two buckets. Bucket 0 holds samples under
+ * one microsecond, bucket i samples in [2^(i-1), 2^i), and the last bucket everything above. Adding a
+ * sample only touches the shard of the calling thread, so the hot paths it is used on do not
+ * contend for a lock or cache line. Every histogram registers itself by name for getmetrics.
+ */
+class CLatencyHistogram
+{
+public:
+    static const int NUM_BUCKETS = 32;
+    static const int NUM_SHARDS = 16;
+
+    struct Snapshot
+    {
+        uint64_t count;
+        uint64_t sumMicros;
+        std::array<uint64_t, NUM_BUCKETS> buckets;
+
+        Snapshot() : count(0), sumMicros(0) { buckets.fill(0); }
+
+        //! upper bound in microseconds of the bucket that holds the given fraction of the samples
+        uint64_t Percentile(double fraction) const;
+    };
+
+    const std::string name;
+    const std::string description;
+
+    CLatencyHistogram(const std::string &nameIn, const std::string &descriptionIn);
+    ~CLatencyHistogram();
+
+    CLatencyHistogram(const CLatencyHistogram &) = delete;
+    CLatencyHistogram &operator=(const CLatencyHistogram &) = delete;
+
+    static int BucketIndex(uint64_t micros);
+    static uint64_t BucketUpperBound(int bucket) { return (uint64_t)1 << bucket; }
+
+    void Add(uint64_t micros);
+    Snapshot GetSnapshot() const;
+
+private:
+    struct alignas(64) Shard
+    {
+        std::atomic<uint64_t> sumMicros;
+        std::atomic<uint64_t> buckets[NUM_BUCKETS];
+    };
+    Shard shards[NUM_SHARDS];
+};
+
+/**
+ * Adds the time from construction to destruction to a histogram, including when the scope is
+ * left by a return or exception.
+ */
+class CScopedLatencyTimer
+{
+public:
+    explicit CScopedLatencyTimer(CLatencyHistogram &histogramIn) :
+        histogram(histogramIn), start(std::chrono::steady_clock::now()) {}
+
+    ~CScopedLatencyTimer()
+    {
+        histogram.Add(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+
+private:
+    CLatencyHistogram &histogram;
+    std::chrono::steady_clock::time_point start;
+};
+
+/**
+ * Like CScopedLatencyTimer, for code that may call itself, such as a validation that validates
+ * another one of the same kind. Only the outermost timer of a histogram on a thread records, so
+ * time spent in nested calls is counted once, as part of the call that made them.
+ */
+class CScopedOuterLatencyTimer
+{
+public:
+    explicit CScopedOuterLatencyTimer(CLatencyHistogram &histogramIn);
+    ~CScopedOuterLatencyTimer();
+
+private:
+    CLatencyHistogram *pHistogram;
+    std::chrono::steady_clock::time_point start;
+};
+
+//! all registered histograms, sorted by name
+std::vector<const CLatencyHistogram *> GetLatencyHistograms();
+
+//! histogram of an RPC method, created on first use
+CLatencyHistogram &GetRPCLatencyHistogram(const std::string &strMethod);
+
+//! counters reported with the histograms, by name
+std::vector<std::pair<std::string, const AtomicCounter *>> GetHotPathCounters();
+
+//! histograms and counters in the Prometheus text exposition format
+std::string FormatPrometheusMetrics();
+
+extern CLatencyHistogram latencyDBRead;
+extern CLatencyHistogram latencyDBWrite;
+extern CLatencyHistogram latencyIndexLookup;
+extern CLatencyHistogram latencyCCPrecheck;
+extern CLatencyHistogram latencyNotarizationValidation;
+extern CLatencyHistogram latencyConnectBlock;
+
 extern AtomicCounter transactionsValidated;
 extern AtomicCounter ehSolverRuns;
 extern AtomicCounter solutionTargetChecks;
+extern AtomicCounter coinsCacheHits;
+extern AtomicCounter coinsCacheMisses;
+extern AtomicCounter notificationsQueued;
+extern AtomicCounter notificationsDropped;
 extern PerfCounterTimer miningTimer;
 
 void TrackMinedBlock(uint256 hash);
@@ -121,3 +234,5 @@ const std::string METRICS_ART =
 "       [0;34;40m      [0;31;40m:@[0;1;30;90;41m8[0;33;41m8[0;31;43m8@XXX@8[0;1;30;90;41m8[0;31;40m8:[0;34;40m      [0m                          [0;31;5;41;101mtt[0m                   \n"
 "         [0;34;40m                      [0m                                                 \n"
 "              [0;34;40m             [0m                                                     ";
+
+#endif // ZCASH_METRICS_H
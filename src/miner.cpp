@@ -47,6 +47,7 @@
 #include <mutex>
 
 #include "pbaas/pbaas.h"
+#include "pbaas/importcache.h"
 #include "pbaas/notarization.h"
 #include "pbaas/identity.h"
 #include "rpc/pbaasrpc.h"
@@ -528,7 +529,7 @@ void ProcessNewImports(const uint160 &sourceChainID, CPBaaSNotarization &lastCon
                         !txProof.GetPartialTransaction(exportTx).IsNull() &&
                         txProof.TransactionHash() == exportTxId &&
                         proofRootIt != lastConfirmed.proofRoots.end() &&
-                        proofRootIt->second.stateRoot == txProof.CheckPartialTransaction(exportTx) &&
+                        proofRootIt->second.stateRoot == ProofVerificationCache.CheckPartialTransaction(txProof, exportTx) &&
                         exportTx.vout.size() > exportTxOutNum))
                 {
                     /* printf("%s: proofRoot: %s, checkPartialRoot: %s, proofheight: %u, ischainproof: %s, blockhash: %s\n",
@@ -4310,6 +4311,7 @@ void static VerusStaker(CWallet *pwallet)
 
 typedef bool (*minefunction)(CBlockHeader &bh, CVerusHashV2bWriter &vhw, uint256 &finalHash, uint256 &target, uint64_t start, uint64_t *count);
 bool mine_verus_v2(CBlockHeader &bh, CVerusHashV2bWriter &vhw, uint256 &finalHash, uint256 &target, uint64_t start, uint64_t *count);
+bool mine_verus_v2_lanes(CBlockHeader &bh, CVerusHashV2bWriter &vhw, uint256 &finalHash, uint256 &target, uint64_t start, uint64_t *count);
 bool mine_verus_v2_port(CBlockHeader &bh, CVerusHashV2bWriter &vhw, uint256 &finalHash, uint256 &target, uint64_t start, uint64_t *count);
 
 void static BitcoinMiner_noeq(CWallet *pwallet)
@@ -4475,6 +4477,7 @@ void static BitcoinMiner_noeq()
             pblock->nNonce = RandomizedNonce();
 
             // set our easiest target, if V3+, no need to rebuild the merkle tree
+            uint64_t mergedGeneration = ConnectedChains.MergeMiningGeneration();
             IncrementExtraNonce(pblock, pindexPrev, nExtraNonce, true, &savebits);
 
             // cache the last block or copy of last
@@ -4578,7 +4581,7 @@ void static BitcoinMiner_noeq()
             u128 *hashKey;
             verusclhasher &vclh = vh2->vclh;
             minefunction mine_verus;
-            mine_verus = IsCPUVerusOptimized() ? &mine_verus_v2 : &mine_verus_v2_port;
+            mine_verus = IsCPUVerusOptimized() ? &mine_verus_v2_lanes : &mine_verus_v2_port;
 
             while (true)
             {
@@ -4651,9 +4654,10 @@ void static BitcoinMiner_noeq()
                         totalDone = 0;
                         do
                         {
-                            // pickup/remove any new/deleted headers
-                            if (ConnectedChains.dirty || (pblock->NumPBaaSHeaders() < ConnectedChains.mergeMinedChains.size() + 1))
+                            // pickup/remove any new/deleted headers. each thread tracks what it last combined, so all of them see every change
+                            if (ConnectedChains.MergeMiningGeneration() != mergedGeneration || (pblock->NumPBaaSHeaders() < ConnectedChains.mergeMinedChains.size() + 1))
                             {
+                                mergedGeneration = ConnectedChains.MergeMiningGeneration();
                                 IncrementExtraNonce(pblock, pindexPrev, nExtraNonce, true, &savebits);
 
                                 hashTarget.SetCompact(savebits);
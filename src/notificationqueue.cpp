@@ -0,0 +1,292 @@
+// Copyright (c) 2026 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#include "notificationqueue.h"
+
+#include "cc/eval.h"
+#include "chainparams.h"
+#include "consensus/validation.h"
+#include "main.h"
+#include "metrics.h"
+#include "primitives/block.h"
+#include "util.h"
+
+std::vector<std::string> GetNotificationTopics()
+{
+    return {NOTIFY_HASHBLOCK, NOTIFY_HASHTX, NOTIFY_RAWBLOCK, NOTIFY_RAWTX, NOTIFY_CHECKEDBLOCK,
+            NOTIFY_PBAASIMPORT, NOTIFY_PBAASEXPORT, NOTIFY_NOTARIZATION, NOTIFY_IDENTITY};
+}
+
+/** Serializes straight into a payload, which is sized up front */
+class CPayloadWriter
+{
+private:
+    std::vector<unsigned char> &vch;
+
+public:
+    CPayloadWriter(std::vector<unsigned char> &vchIn) : vch(vchIn) {}
+
+    int GetType() const { return SER_NETWORK; }
+    int GetVersion() const { return PROTOCOL_VERSION; }
+
+    void write(const char *pch, size_t size)
+    {
+        vch.insert(vch.end(), (const unsigned char *)pch, (const unsigned char *)pch + size);
+    }
+
+    template <typename T>
+    CPayloadWriter &operator<<(const T &obj)
+    {
+        ::Serialize(*this, obj);
+        return *this;
+    }
+};
+
+template <typename T>
+static CNotificationPayload SerializedPayload(const T &obj)
+{
+    std::shared_ptr<std::vector<unsigned char>> payload = std::make_shared<std::vector<unsigned char>>();
+    payload->reserve(GetSerializeSize(obj, SER_NETWORK, PROTOCOL_VERSION));
+    CPayloadWriter(*payload) << obj;
+    return payload;
+}
+
+// hashes are published in the byte order they are displayed in
+static CNotificationPayload HashPayload(const uint256 &hash)
+{
+    return std::make_shared<std::vector<unsigned char>>(std::reverse_iterator<const unsigned char *>(hash.end()),
+                                                        std::reverse_iterator<const unsigned char *>(hash.begin()));
+}
+
+CNotificationQueue::CNotificationQueue(const std::vector<CNotificationSink *> &sinksIn, size_t nMaxSizeIn, bool fDropMempoolIn) :
+    sinks(sinksIn), nMaxSize(std::max(nMaxSizeIn, (size_t)1)), fDropMempool(fDropMempoolIn), fStop(false), fDropping(false), fOverflowing(false)
+{
+    for (auto pSink : sinks)
+    {
+        std::set<std::string> sinkTopics = pSink->GetTopics();
+        topics.insert(sinkTopics.begin(), sinkTopics.end());
+    }
+}
+
+CNotificationQueue::~CNotificationQueue()
+{
+    Stop();
+}
+
+void CNotificationQueue::Start()
+{
+    thread = boost::thread(boost::bind(&CNotificationQueue::ThreadPublish, this));
+}
+
+void CNotificationQueue::Stop()
+{
+    {
+        boost::unique_lock<boost::mutex> lock(mutex);
+        fStop = true;
+    }
+    condNotEmpty.notify_all();
+    if (thread.joinable())
+    {
+        thread.join();
+    }
+}
+
+size_t CNotificationQueue::Size()
+{
+    boost::unique_lock<boost::mutex> lock(mutex);
+    return queue.size();
+}
+
+void CNotificationQueue::Enqueue(CQueuedNotification &&notification, bool fMayDrop)
+{
+    boost::unique_lock<boost::mutex> lock(mutex);
+    if (fStop)
+    {
+        return;
+    }
+    if (queue.size() >= nMaxSize)
+    {
+        if (fMayDrop && fDropMempool)
+        {
+            notificationsDropped.increment();
+            if (!fDropping)
+            {
+                LogPrintf("%s: notification queue full, dropping mempool transaction notifications\n", __func__);
+                fDropping = true;
+            }
+            return;
+        }
+        // this is called with cs_main held, so rather than wait for room, the queue grows
+        if (!fOverflowing)
+        {
+            LogPrintf("%s: notification queue full, queueing more than %u notifications until the sinks catch up\n", __func__, nMaxSize);
+            fOverflowing = true;
+        }
+    }
+    queue.push_back(std::move(notification));
+    notificationsQueued.increment();
+    condNotEmpty.notify_one();
+}
+
+void CNotificationQueue::SyncTransaction(const CTransaction &tx, const CBlock *pblock)
+{
+    // mempool transactions are the ones to drop when sinks cannot keep up
+    bool fMayDrop = pblock == nullptr;
+
+    if (HasTopic(NOTIFY_HASHTX))
+    {
+        Enqueue(CQueuedNotification(CNotificationMessage(NOTIFY_HASHTX, HashPayload(tx.GetHash()))), fMayDrop);
+    }
+    if (HasTopic(NOTIFY_RAWTX))
+    {
+        Enqueue(CQueuedNotification(CNotificationMessage(NOTIFY_RAWTX, SerializedPayload(tx))), fMayDrop);
+    }
+
+    // PBaaS objects are published once they are in a block, as the txid in the byte order of hashtx,
+    // the output index and height as little endian, and the object as it is serialized in the output
+    if (!pblock ||
+        !(HasTopic(NOTIFY_PBAASIMPORT) || HasTopic(NOTIFY_PBAASEXPORT) || HasTopic(NOTIFY_NOTARIZATION) || HasTopic(NOTIFY_IDENTITY)))
+    {
+        return;
+    }
+    int nHeight = pblock->GetHeight();
+    for (size_t i = 0; i < tx.vout.size(); i++)
+    {
+        COptCCParams p;
+        if (!tx.vout[i].scriptPubKey.IsPayToCryptoCondition(p) || !p.IsValid() || !p.vData.size())
+        {
+            continue;
+        }
+        const char *topic = nullptr;
+        switch (p.evalCode)
+        {
+            case EVAL_CROSSCHAIN_IMPORT:
+                topic = NOTIFY_PBAASIMPORT;
+                break;
+            case EVAL_CROSSCHAIN_EXPORT:
+                topic = NOTIFY_PBAASEXPORT;
+                break;
+            case EVAL_EARNEDNOTARIZATION:
+            case EVAL_ACCEPTEDNOTARIZATION:
+                topic = NOTIFY_NOTARIZATION;
+                break;
+            case EVAL_IDENTITY_PRIMARY:
+                topic = NOTIFY_IDENTITY;
+                break;
+        }
+        if (!topic || !HasTopic(topic))
+        {
+            continue;
+        }
+        const uint256 &txid = tx.GetHash();
+        std::shared_ptr<std::vector<unsigned char>> payload = std::make_shared<std::vector<unsigned char>>();
+        payload->reserve(txid.size() + 8 + p.vData[0].size());
+        payload->insert(payload->end(), std::reverse_iterator<const unsigned char *>(txid.end()),
+                        std::reverse_iterator<const unsigned char *>(txid.begin()));
+        CPayloadWriter(*payload) << (uint32_t)i << (uint32_t)nHeight;
+        payload->insert(payload->end(), p.vData[0].begin(), p.vData[0].end());
+        Enqueue(CQueuedNotification(CNotificationMessage(topic, payload)), false);
+    }
+}
+
+void CNotificationQueue::UpdatedBlockTip(const CBlockIndex *pindex)
+{
+    if (HasTopic(NOTIFY_HASHBLOCK))
+    {
+        Enqueue(CQueuedNotification(CNotificationMessage(NOTIFY_HASHBLOCK, HashPayload(pindex->GetBlockHash()))), false);
+    }
+    if (HasTopic(NOTIFY_RAWBLOCK))
+    {
+        // the block is read on the notification thread, from where it is now
+        CQueuedNotification notification(CNotificationMessage(NOTIFY_RAWBLOCK, nullptr));
+        {
+            LOCK(cs_main);
+            notification.blockPos = pindex->GetBlockPos();
+        }
+        notification.blockHash = pindex->GetBlockHash();
+        notification.nHeight = pindex->GetHeight();
+        Enqueue(std::move(notification), false);
+    }
+}
+
+void CNotificationQueue::BlockChecked(const CBlock &block, const CValidationState &state)
+{
+    if (state.IsInvalid() || !HasTopic(NOTIFY_CHECKEDBLOCK))
+    {
+        return;
+    }
+    // blocks are checked when they are connected, after they are stored, so like raw blocks, they are
+    // read and serialized on the notification thread rather than while validation waits
+    CQueuedNotification notification(CNotificationMessage(NOTIFY_CHECKEDBLOCK, nullptr));
+    notification.blockHash = block.GetHash();
+    {
+        LOCK(cs_main);
+        auto it = mapBlockIndex.find(notification.blockHash);
+        if (it != mapBlockIndex.end() && (it->second->nStatus & BLOCK_HAVE_DATA))
+        {
+            notification.blockPos = it->second->GetBlockPos();
+            notification.nHeight = it->second->GetHeight();
+        }
+        else
+        {
+            notification.message.payload = SerializedPayload(block);
+        }
+    }
+    Enqueue(std::move(notification), false);
+}
+
+void CNotificationQueue::ThreadPublish()
+{
+    RenameThread("verus-notify");
+
+    std::vector<CQueuedNotification> vQueued;
+    std::vector<CNotificationMessage> batch;
+    while (true)
+    {
+        {
+            boost::unique_lock<boost::mutex> lock(mutex);
+            while (queue.empty() && !fStop)
+            {
+                condNotEmpty.wait(lock);
+            }
+            // what is queued at shutdown is still published
+            if (queue.empty())
+            {
+                break;
+            }
+            size_t nBatch = std::min(queue.size(), MAX_NOTIFICATION_BATCH);
+            vQueued.assign(std::make_move_iterator(queue.begin()), std::make_move_iterator(queue.begin() + nBatch));
+            queue.erase(queue.begin(), queue.begin() + nBatch);
+            if ((fDropping || fOverflowing) && queue.size() < nMaxSize / 2)
+            {
+                LogPrintf("%s: notification queue has room again\n", __func__);
+                fDropping = false;
+                fOverflowing = false;
+            }
+        }
+
+        batch.clear();
+        for (auto &queued : vQueued)
+        {
+            if (!queued.message.payload)
+            {
+                CBlock block;
+                if (!ReadBlockFromDisk(queued.nHeight, block, queued.blockPos, Params().GetConsensus(), false) ||
+                    block.GetHash() != queued.blockHash)
+                {
+                    LogPrintf("%s: cannot read block %s to publish\n", __func__, queued.blockHash.GetHex());
+                    continue;
+                }
+                queued.message.payload = SerializedPayload(block);
+            }
+            batch.push_back(std::move(queued.message));
+        }
+        vQueued.clear();
+
+        for (auto pSink : sinks)
+        {
+            pSink->PublishBatch(batch);
+        }
+    }
+}
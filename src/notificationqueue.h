@@ -0,0 +1,129 @@
+// Copyright (c) 2026 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#ifndef VERUS_NOTIFICATIONQUEUE_H
+#define VERUS_NOTIFICATIONQUEUE_H
+
+#include "chain.h"
+#include "validationinterface.h"
+
+#include <deque>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <boost/thread.hpp>
+
+static const size_t DEFAULT_NOTIFICATION_QUEUE_SIZE = 10000;
+static const bool DEFAULT_NOTIFICATION_DROP_MEMPOOL = true;
+//! most messages handed to the sinks at once
+static const size_t MAX_NOTIFICATION_BATCH = 256;
+
+// topics, enabled for a sink with -zmqpub<topic> or -amqppub<topic>
+static const char * const NOTIFY_HASHBLOCK = "hashblock";
+static const char * const NOTIFY_HASHTX = "hashtx";
+static const char * const NOTIFY_RAWBLOCK = "rawblock";
+static const char * const NOTIFY_RAWTX = "rawtx";
+static const char * const NOTIFY_CHECKEDBLOCK = "checkedblock";
+static const char * const NOTIFY_PBAASIMPORT = "pbaasimport";
+static const char * const NOTIFY_PBAASEXPORT = "pbaasexport";
+static const char * const NOTIFY_NOTARIZATION = "notarization";
+static const char * const NOTIFY_IDENTITY = "identity";
+
+//! all topics a sink can publish
+std::vector<std::string> GetNotificationTopics();
+
+typedef std::shared_ptr<const std::vector<unsigned char>> CNotificationPayload;
+
+/**
+ * One notification. The payload is serialized once and shared by every sink that publishes the
+ * topic, so sinks must not change it.
+ */
+struct CNotificationMessage
+{
+    std::string topic;
+    CNotificationPayload payload;
+
+    CNotificationMessage() {}
+    CNotificationMessage(const std::string &topicIn, const CNotificationPayload &payloadIn) : topic(topicIn), payload(payloadIn) {}
+};
+
+/**
+ * Publisher of notifications to the outside, like the ZMQ and AMQP interfaces.
+ */
+class CNotificationSink
+{
+public:
+    virtual ~CNotificationSink() {}
+
+    //! topics this sink publishes, messages for other topics are never created
+    virtual std::set<std::string> GetTopics() const = 0;
+
+    //! publish messages in the order they happened, only called from the notification thread
+    virtual void PublishBatch(const std::vector<CNotificationMessage> &batch) = 0;
+};
+
+/**
+ * Takes validation notifications off the validation thread. Each notification is serialized once,
+ * only for topics a sink publishes, and queued in a bounded queue. A notification thread hands the
+ * queued messages to the sinks in batches, and raw blocks are read from disk on that thread.
+ *
+ * Notifications are queued while cs_main is held, so queueing never waits. When the queue is full,
+ * notifications of mempool transactions are dropped, unless -notificationdropmempool=0. Everything
+ * else is queued beyond the limit, so block, confirmed transaction and PBaaS notifications are never
+ * lost, and a slow sink only costs memory for as long as it falls behind.
+ *
+ * Final, as it is deleted through its own type and CValidationInterface has no virtual destructor.
+ */
+class CNotificationQueue final : public CValidationInterface
+{
+public:
+    CNotificationQueue(const std::vector<CNotificationSink *> &sinksIn, size_t nMaxSizeIn, bool fDropMempoolIn);
+    ~CNotificationQueue();
+
+    void Start();
+    //! publish what is queued and stop the notification thread
+    void Stop();
+
+    bool HasTopic(const std::string &topic) const { return topics.count(topic) != 0; }
+    size_t Size();
+
+protected:
+    // CValidationInterface
+    void SyncTransaction(const CTransaction &tx, const CBlock *pblock);
+    void UpdatedBlockTip(const CBlockIndex *pindex);
+    void BlockChecked(const CBlock &block, const CValidationState &state);
+
+private:
+    struct CQueuedNotification
+    {
+        CNotificationMessage message;
+        // for raw and checked blocks, which are read on the notification thread and have no payload yet
+        CDiskBlockPos blockPos;
+        uint256 blockHash;
+        int nHeight;
+
+        CQueuedNotification() : nHeight(0) {}
+        CQueuedNotification(const CNotificationMessage &messageIn) : message(messageIn), nHeight(0) {}
+    };
+
+    const std::vector<CNotificationSink *> sinks;
+    std::set<std::string> topics;
+    const size_t nMaxSize;
+    const bool fDropMempool;
+
+    boost::mutex mutex;
+    boost::condition_variable condNotEmpty;
+    std::deque<CQueuedNotification> queue;
+    bool fStop;
+    bool fDropping;
+    bool fOverflowing;
+    boost::thread thread;
+
+    void Enqueue(CQueuedNotification &&notification, bool fMayDrop);
+    void ThreadPublish();
+};
+
+#endif // VERUS_NOTIFICATIONQUEUE_H
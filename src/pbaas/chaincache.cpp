@@ -0,0 +1,41 @@
+// Copyright (c) 2026 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#include "pbaas/chaincache.h"
+
+#include "main.h"
+
+void CChainFollowingCache::CheckTip()
+{
+    AssertLockHeld(cs_main);
+    uint256 activeTipHash = chainActive.LastTip() ? chainActive.LastTip()->GetBlockHash() : uint256();
+    if (tipHash != activeTipHash)
+    {
+        Clear();
+        tipHash = activeTipHash;
+    }
+}
+
+bool CChainFollowingCache::FollowTip(const CBlockIndex *pindex, bool added)
+{
+    AssertLockHeld(cs_main);
+    uint256 prevHash = pindex->pprev ? pindex->pprev->GetBlockHash() : uint256();
+    uint256 oldTipHash = added ? prevHash : pindex->GetBlockHash();
+    bool inStep = tipHash == oldTipHash;
+    if (!inStep)
+    {
+        Clear();
+    }
+    tipHash = added ? pindex->GetBlockHash() : prevHash;
+    return inStep;
+}
+
+void CChainFollowingCache::ChainTip(const CBlockIndex *pindex, const CBlock *pblock, SproutMerkleTree sproutTree, SaplingMerkleTree saplingTree, bool added)
+{
+    LOCK(cs_main);
+    if (FollowTip(pindex, added) && !added)
+    {
+        Clear();
+    }
+}
@@ -0,0 +1,38 @@
+// Copyright (c) 2026 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+/*
+ * Base of the in-memory caches and indexes that load what they keep from the chain and follow it from
+ * block to block. Each remembers the tip it was loaded on, and everything it keeps is dropped when the
+ * chain moves without it seeing the change. By default, disconnects also drop everything, because what
+ * a block spent cannot be restored from the block alone.
+ */
+
+#ifndef PBAAS_CHAINCACHE_H
+#define PBAAS_CHAINCACHE_H
+
+#include "uint256.h"
+#include "validationinterface.h"
+
+class CChainFollowingCache : public CValidationInterface
+{
+public:
+    // drops everything kept
+    virtual void Clear() = 0;
+
+protected:
+    uint256 tipHash;
+
+    // clears the cache if the active tip is not the one it follows, callers hold cs_main
+    void CheckTip();
+
+    // moves the tip followed across the block at pindex. returns false, after clearing, if the cache was
+    // not on the tip the block was connected to or disconnected from, callers hold cs_main
+    bool FollowTip(const CBlockIndex *pindex, bool added);
+
+    // CValidationInterface
+    void ChainTip(const CBlockIndex *pindex, const CBlock *pblock, SproutMerkleTree sproutTree, SaplingMerkleTree saplingTree, bool added);
+};
+
+#endif // PBAAS_CHAINCACHE_H
@@ -0,0 +1,201 @@
+// Copyright (c) 2026 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#include "pbaas/convertergraph.h"
+
+#include "main.h"
+#include "pbaas/notarization.h"
+#include "rpc/pbaasrpc.h"
+
+CConverterGraph ConverterGraph;
+
+std::vector<std::pair<CUTXORef, CPBaaSNotarization>> CConverterGraph::GetConverters(const uint160 &currencyID)
+{
+    AssertLockHeld(cs_main);
+    CheckTip();
+
+    auto it = convertersByCurrency.find(currencyID);
+    if (it != convertersByCurrency.end())
+    {
+        return it->second;
+    }
+
+    std::vector<std::pair<CUTXORef, CPBaaSNotarization>> converters;
+    std::vector<CAddressUnspentDbEntry> fractionalNotarizations;
+    if (!GetAddressUnspent(CCoinbaseCurrencyState::IndexConverterKey(currencyID), CScript::P2IDX, fractionalNotarizations))
+    {
+        LogPrintf("%s: Error reading unspent index\n", __func__);
+        return converters;
+    }
+    for (auto &oneNotarization : fractionalNotarizations)
+    {
+        // notarizations that cannot be read are kept as invalid, so callers can report them
+        converters.push_back(std::make_pair(CUTXORef(oneNotarization.first.txhash, oneNotarization.first.index),
+                                            CPBaaSNotarization(oneNotarization.second.script)));
+    }
+    convertersByCurrency[currencyID] = converters;
+    return converters;
+}
+
+const CConverterCurrency &CConverterGraph::GetCurrency(const uint160 &currencyID)
+{
+    AssertLockHeld(cs_main);
+    CheckTip();
+
+    static const CConverterCurrency invalidCurrency;
+
+    auto it = currencies.find(currencyID);
+    if (it != currencies.end() && it->second.fLoaded)
+    {
+        return it->second;
+    }
+
+    // only currencies that are defined are kept, so looking up unknown IDs does not grow the graph
+    CConverterCurrency loaded;
+    int32_t curDefHeight;
+    if (!GetCurrencyDefinition(currencyID, loaded.currency, &curDefHeight, true))
+    {
+        return invalidCurrency;
+    }
+    if (it == currencies.end())
+    {
+        it = currencies.insert(std::make_pair(currencyID, CConverterCurrency())).first;
+    }
+    CConverterCurrency &entry = it->second;
+    entry.fLoaded = true;
+    entry.currency = loaded.currency;
+    entry.currencyState = ConnectedChains.GetCurrencyState(entry.currency, chainActive.Height(), curDefHeight, true);
+    entry.lastConfirmed = GetLastConfirmedNotarization(currencyID, chainActive.Height());
+    return entry;
+}
+
+bool CConverterGraph::GetLastUnspentNotarization(const uint160 &currencyID, CUTXORef &output, CPBaaSNotarization &notarization)
+{
+    AssertLockHeld(cs_main);
+    CheckTip();
+
+    // stored with the currency, so it is dropped together with it
+    auto it = currencies.find(currencyID);
+    if (it == currencies.end() || !it->second.fUnspentLoaded)
+    {
+        CUTXORef lastUnspentOutput;
+        CPBaaSNotarization lastUnspentNotarization;
+        int32_t lastUnspentOutNum = -1;
+        lastUnspentNotarization.GetLastUnspentNotarization(currencyID, lastUnspentOutput.hash, lastUnspentOutNum);
+        lastUnspentOutput.n = lastUnspentOutNum;
+
+        // currencies without notarizations are not kept, as above
+        if (it == currencies.end())
+        {
+            if (!lastUnspentNotarization.IsValid())
+            {
+                output = lastUnspentOutput;
+                notarization = lastUnspentNotarization;
+                return false;
+            }
+            it = currencies.insert(std::make_pair(currencyID, CConverterCurrency())).first;
+        }
+        it->second.lastUnspentOutput = lastUnspentOutput;
+        it->second.lastUnspentNotarization = lastUnspentNotarization;
+        it->second.fUnspentLoaded = true;
+    }
+    output = it->second.lastUnspentOutput;
+    notarization = it->second.lastUnspentNotarization;
+    return notarization.IsValid();
+}
+
+void CConverterGraph::Clear()
+{
+    convertersByCurrency.clear();
+    currencies.clear();
+}
+
+void CConverterGraph::Invalidate(const uint160 &currencyID)
+{
+    currencies.erase(currencyID);
+}
+
+void CConverterGraph::ChainTip(const CBlockIndex *pindex, const CBlock *pblock, SproutMerkleTree sproutTree, SaplingMerkleTree saplingTree, bool added)
+{
+    LOCK(cs_main);
+    if (!FollowTip(pindex, added) || (convertersByCurrency.empty() && currencies.empty()))
+    {
+        return;
+    }
+
+    // the native currency changes with every block
+    Invalidate(ASSETCHAINS_CHAINID);
+
+    // the same outputs change what a block adds and what it takes away when disconnected
+    for (auto &tx : pblock->vtx)
+    {
+        for (auto &oneOut : tx.vout)
+        {
+            COptCCParams p;
+            if (!oneOut.scriptPubKey.IsPayToCryptoCondition(p) || !p.IsValid() || !p.vData.size())
+            {
+                continue;
+            }
+            switch (p.evalCode)
+            {
+                case EVAL_ACCEPTEDNOTARIZATION:
+                case EVAL_EARNEDNOTARIZATION:
+                {
+                    CPBaaSNotarization notarization(p.vData[0]);
+                    if (notarization.IsValid())
+                    {
+                        Invalidate(notarization.currencyID);
+                        for (auto &oneState : notarization.currencyStates)
+                        {
+                            Invalidate(oneState.first);
+                        }
+                        // the converters of its reserves may have changed with its reserves
+                        for (auto &oneReserve : notarization.currencyState.currencies)
+                        {
+                            convertersByCurrency.erase(oneReserve);
+                        }
+                    }
+                    break;
+                }
+                case EVAL_FINALIZE_NOTARIZATION:
+                {
+                    CObjectFinalization finalization(p.vData[0]);
+                    if (finalization.IsValid())
+                    {
+                        Invalidate(finalization.currencyID);
+                    }
+                    break;
+                }
+                case EVAL_CROSSCHAIN_IMPORT:
+                {
+                    CCrossChainImport cci(p.vData[0]);
+                    if (cci.IsValid())
+                    {
+                        Invalidate(cci.importCurrencyID);
+                    }
+                    break;
+                }
+                case EVAL_CROSSCHAIN_EXPORT:
+                {
+                    CCrossChainExport ccx(p.vData[0]);
+                    if (ccx.IsValid())
+                    {
+                        Invalidate(ccx.destCurrencyID);
+                    }
+                    break;
+                }
+                case EVAL_RESERVE_TRANSFER:
+                {
+                    CReserveTransfer rt(p.vData[0]);
+                    if (rt.IsValid())
+                    {
+                        Invalidate(rt.destCurrencyID);
+                        Invalidate(rt.GetImportCurrency());
+                    }
+                    break;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,65 @@
+// Copyright (c) 2026 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+/*
+ * In-memory graph of the fractional currencies that can convert between currencies on this chain,
+ * with the currency states RPCs need to choose between them. Entries are loaded from the indexes
+ * when first requested, and dropped when a connected or disconnected block has a notarization,
+ * finalization, import, export or reserve transfer for their currency.
+ */
+
+#ifndef PBAAS_CONVERTERGRAPH_H
+#define PBAAS_CONVERTERGRAPH_H
+
+#include "pbaas/chaincache.h"
+#include "pbaas/pbaas.h"
+
+// a currency as a converter or conversion target, with the states it was last notarized with
+class CConverterCurrency
+{
+public:
+    bool fLoaded;
+    CCurrencyDefinition currency;
+    CCoinbaseCurrencyState currencyState;                               // state at the tip, with pending transfers loaded
+    std::tuple<uint32_t, CUTXORef, CPBaaSNotarization> lastConfirmed;   // last confirmed notarization at the tip
+
+    // last unspent notarization, which conversions are estimated from, loaded on first use
+    bool fUnspentLoaded;
+    CUTXORef lastUnspentOutput;
+    CPBaaSNotarization lastUnspentNotarization;
+
+    CConverterCurrency() : fLoaded(false), fUnspentLoaded(false) {}
+
+    bool IsValid() const { return currency.IsValid(); }
+};
+
+class CConverterGraph : public CChainFollowingCache
+{
+public:
+    // the unspent notarizations that list a fractional currency as converter for currencyID, the way
+    // the converter index returns them, including invalid ones that cannot be read, all calls must hold cs_main
+    std::vector<std::pair<CUTXORef, CPBaaSNotarization>> GetConverters(const uint160 &currencyID);
+
+    // the currency and its current states, or an invalid currency if its definition cannot be found
+    const CConverterCurrency &GetCurrency(const uint160 &currencyID);
+
+    // the last unspent notarization of a currency, false if there is none
+    bool GetLastUnspentNotarization(const uint160 &currencyID, CUTXORef &output, CPBaaSNotarization &notarization);
+
+    void Clear();
+
+protected:
+    // CValidationInterface
+    void ChainTip(const CBlockIndex *pindex, const CBlock *pblock, SproutMerkleTree sproutTree, SaplingMerkleTree saplingTree, bool added);
+
+private:
+    std::map<uint160, std::vector<std::pair<CUTXORef, CPBaaSNotarization>>> convertersByCurrency;
+    std::map<uint160, CConverterCurrency> currencies;
+
+    void Invalidate(const uint160 &currencyID);
+};
+
+extern CConverterGraph ConverterGraph;
+
+#endif // PBAAS_CONVERTERGRAPH_H
@@ -0,0 +1,233 @@
+// Copyright (c) 2026 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#include "pbaas/currencyregistry.h"
+
+#include "cc/CCinclude.h"
+#include "main.h"
+#include "rpc/pbaasrpc.h"
+
+CCurrencyRegistry CurrencyRegistry;
+
+// nodes of the notarization that follows a currency definition in its transaction
+static std::vector<CNodeData> DefinitionNodes(const CTransaction &tx, int definitionOut, const uint160 &currencyID)
+{
+    for (int i = definitionOut + 1; i < tx.vout.size(); i++)
+    {
+        COptCCParams p;
+        CPBaaSNotarization pbn;
+
+        if (tx.vout[i].scriptPubKey.IsPayToCryptoCondition(p) &&
+            p.IsValid() &&
+            (p.evalCode == EVAL_ACCEPTEDNOTARIZATION || p.evalCode == EVAL_EARNEDNOTARIZATION) &&
+            p.vData.size() &&
+            (pbn = CPBaaSNotarization(p.vData[0])).IsValid() &&
+            pbn.currencyID == currencyID)
+        {
+            return pbn.nodes;
+        }
+    }
+    return std::vector<CNodeData>();
+}
+
+bool CCurrencyRegistry::GetIndexedCurrencies(const uint160 &indexKey, std::set<uint160> &currencyIDs)
+{
+    AssertLockHeld(cs_main);
+    CheckTip();
+
+    auto keyIt = currenciesByKey.find(indexKey);
+    if (keyIt == currenciesByKey.end())
+    {
+        std::vector<CAddressUnspentDbEntry> unspentOutputs;
+        if (!GetAddressUnspent(indexKey, CScript::P2IDX, unspentOutputs))
+        {
+            return false;
+        }
+        keyIt = currenciesByKey.insert(std::make_pair(indexKey, std::map<COutPoint, uint160>())).first;
+        for (auto &oneOutput : unspentOutputs)
+        {
+            COutPoint output(oneOutput.first.txhash, oneOutput.first.index);
+            if (!AddIndexedOutput(indexKey, nullptr, output, oneOutput.second.script, oneOutput.second.blockHeight))
+            {
+                LogPrintf("%s: invalid currency definition or notarization found in index, txid %s, vout: %d\n", __func__, oneOutput.first.txhash.GetHex().c_str(), (int)oneOutput.first.index);
+            }
+        }
+    }
+
+    for (auto &oneOutput : keyIt->second)
+    {
+        currencyIDs.insert(oneOutput.second);
+    }
+    return true;
+}
+
+bool CCurrencyRegistry::AddIndexedOutput(const uint160 &indexKey, const CTransaction *pTx, const COutPoint &output, const CScript &script, int32_t height)
+{
+    COptCCParams p;
+    if (!script.IsPayToCryptoCondition(p) || !p.IsValid() || !p.vData.size())
+    {
+        return false;
+    }
+
+    uint160 currencyID;
+    if (p.evalCode == EVAL_CURRENCY_DEFINITION)
+    {
+        CCurrencyDefinition definition(p.vData[0]);
+        if (!definition.IsValid())
+        {
+            return false;
+        }
+        currencyID = definition.GetID();
+
+        // a definition output has all the registry needs, except the nodes in its transaction
+        if (!currencies.count(currencyID))
+        {
+            CTransaction tx;
+            uint256 blockHash;
+            if (!pTx && myGetTransaction(output.hash, tx, blockHash))
+            {
+                pTx = &tx;
+            }
+            if (!pTx)
+            {
+                LogPrintf("%s: Cannot load currency definition transaction, txid %s\n", __func__, output.hash.GetHex().c_str());
+                return false;
+            }
+            currencies[currencyID] = CCurrencyRegistryEntry(CUTXORef(output.hash, output.n), height, definition, DefinitionNodes(*pTx, output.n, currencyID));
+        }
+    }
+    else if (p.evalCode == EVAL_ACCEPTEDNOTARIZATION || p.evalCode == EVAL_EARNEDNOTARIZATION)
+    {
+        CPBaaSNotarization pbn(p.vData[0]);
+        if (!pbn.IsValid())
+        {
+            return false;
+        }
+        currencyID = pbn.currencyID;
+    }
+    else
+    {
+        return false;
+    }
+
+    currenciesByKey[indexKey][output] = currencyID;
+    keysByOutput.insert(std::make_pair(output, indexKey));
+    return true;
+}
+
+const CCurrencyRegistryEntry *CCurrencyRegistry::GetCurrency(const uint160 &currencyID)
+{
+    AssertLockHeld(cs_main);
+    CheckTip();
+
+    auto it = currencies.find(currencyID);
+    if (it != currencies.end())
+    {
+        return &it->second;
+    }
+
+    CCurrencyDefinition definition;
+    int32_t definitionHeight = 0;
+    CUTXORef definitionOutput;
+    if (!GetCurrencyDefinition(currencyID, definition, &definitionHeight, false, false, &definitionOutput))
+    {
+        return nullptr;
+    }
+
+    std::vector<CNodeData> nodes;
+    CTransaction tx;
+    uint256 blockHash;
+    if (definitionOutput.IsValid() && myGetTransaction(definitionOutput.hash, tx, blockHash))
+    {
+        nodes = DefinitionNodes(tx, definitionOutput.n, currencyID);
+    }
+    return &(currencies[currencyID] = CCurrencyRegistryEntry(definitionOutput, definitionHeight, definition, nodes));
+}
+
+CChainNotarizationData CCurrencyRegistry::GetNotarizationData(const uint160 &currencyID)
+{
+    AssertLockHeld(cs_main);
+    CheckTip();
+
+    auto it = currencies.find(currencyID);
+    if (it == currencies.end())
+    {
+        CChainNotarizationData cnd;
+        ::GetNotarizationData(currencyID, cnd);
+        return cnd;
+    }
+    if (!it->second.fNotarizationsLoaded)
+    {
+        it->second.notarizationData = CChainNotarizationData();
+        ::GetNotarizationData(currencyID, it->second.notarizationData);
+        it->second.fNotarizationsLoaded = true;
+    }
+    return it->second.notarizationData;
+}
+
+void CCurrencyRegistry::Clear()
+{
+    currencies.clear();
+    currenciesByKey.clear();
+    keysByOutput.clear();
+}
+
+void CCurrencyRegistry::SyncTransaction(const CTransaction &tx, const CBlock *pblock)
+{
+    // only confirmed definitions and notarizations are registered
+    if (!pblock)
+    {
+        return;
+    }
+
+    LOCK(cs_main);
+    if (currencies.empty() && currenciesByKey.empty())
+    {
+        return;
+    }
+
+    for (auto &oneIn : tx.vin)
+    {
+        auto keyRange = keysByOutput.equal_range(oneIn.prevout);
+        for (auto it = keyRange.first; it != keyRange.second; it++)
+        {
+            currenciesByKey[it->second].erase(oneIn.prevout);
+        }
+        keysByOutput.erase(keyRange.first, keyRange.second);
+    }
+
+    const uint256 &txid = tx.GetHash();
+    for (int i = 0; i < tx.vout.size(); i++)
+    {
+        COptCCParams p;
+        if (!tx.vout[i].scriptPubKey.IsPayToCryptoCondition(p) || !p.IsValid() || !p.vData.size())
+        {
+            continue;
+        }
+
+        // new notarizations and finalizations change what listings show for the currency
+        uint160 notarizedID;
+        if (p.evalCode == EVAL_ACCEPTEDNOTARIZATION || p.evalCode == EVAL_EARNEDNOTARIZATION)
+        {
+            notarizedID = CPBaaSNotarization(p.vData[0]).currencyID;
+        }
+        else if (p.evalCode == EVAL_FINALIZE_NOTARIZATION)
+        {
+            notarizedID = CObjectFinalization(p.vData[0]).currencyID;
+        }
+        auto curIt = notarizedID.IsNull() ? currencies.end() : currencies.find(notarizedID);
+        if (curIt != currencies.end())
+        {
+            curIt->second.fNotarizationsLoaded = false;
+        }
+
+        for (auto &oneDest : p.GetDestinations())
+        {
+            if (oneDest.which() == COptCCParams::ADDRTYPE_INDEX && currenciesByKey.count(GetDestinationID(oneDest)))
+            {
+                AddIndexedOutput(GetDestinationID(oneDest), &tx, COutPoint(txid, i), tx.vout[i].scriptPubKey, pblock->GetHeight());
+            }
+        }
+    }
+}
@@ -0,0 +1,65 @@
+// Copyright (c) 2026 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+/*
+ * In-memory registry of the currencies defined on or imported to this chain, keyed by currency ID,
+ * with the currencies found under each system, launch state and converter index key. A key is read
+ * from the unspent index the first time it is queried, and after that, connected blocks add the
+ * definitions and notarizations they index under it and remove the outputs they spend, so listing
+ * currencies does not read every definition and notarization again.
+ */
+
+#ifndef PBAAS_CURRENCYREGISTRY_H
+#define PBAAS_CURRENCYREGISTRY_H
+
+#include "pbaas/chaincache.h"
+#include "pbaas/notarization.h"
+
+// a currency definition, with the notarization data that listings show for it
+class CCurrencyRegistryEntry
+{
+public:
+    CUTXORef definitionOutput;
+    int32_t definitionHeight;
+    CCurrencyDefinition definition;
+    std::vector<CNodeData> definitionNodes;     // nodes in the notarization of the definition transaction
+
+    bool fNotarizationsLoaded;
+    CChainNotarizationData notarizationData;    // notarization data at the tip, loaded on first use
+
+    CCurrencyRegistryEntry() : definitionHeight(0), fNotarizationsLoaded(false) {}
+    CCurrencyRegistryEntry(const CUTXORef &output, int32_t height, const CCurrencyDefinition &def, const std::vector<CNodeData> &nodes) :
+        definitionOutput(output), definitionHeight(height), definition(def), definitionNodes(nodes), fNotarizationsLoaded(false) {}
+};
+
+class CCurrencyRegistry : public CChainFollowingCache
+{
+public:
+    // IDs of the currencies with unspent definitions or notarizations indexed under indexKey, or false if
+    // the index cannot be read. all calls must hold cs_main
+    bool GetIndexedCurrencies(const uint160 &indexKey, std::set<uint160> &currencyIDs);
+
+    // the currency's definition, or nullptr if it is not defined on this chain
+    const CCurrencyRegistryEntry *GetCurrency(const uint160 &currencyID);
+
+    // the notarization data of a defined currency at the tip
+    CChainNotarizationData GetNotarizationData(const uint160 &currencyID);
+
+    void Clear();
+
+protected:
+    // CValidationInterface
+    void SyncTransaction(const CTransaction &tx, const CBlock *pblock);
+
+private:
+    std::map<uint160, CCurrencyRegistryEntry> currencies;
+    std::map<uint160, std::map<COutPoint, uint160>> currenciesByKey;    // unspent outputs indexed under each loaded key, and their currency
+    std::multimap<COutPoint, uint160> keysByOutput;                     // the loaded keys each of those outputs is indexed under
+
+    bool AddIndexedOutput(const uint160 &indexKey, const CTransaction *pTx, const COutPoint &output, const CScript &script, int32_t height);
+};
+
+extern CCurrencyRegistry CurrencyRegistry;
+
+#endif // PBAAS_CURRENCYREGISTRY_H
@@ -17,6 +17,7 @@
 #include "pbaas/pbaas.h"
 #include "pbaas/notarization.h"
 #include "identity.h"
+#include "pbaas/identitycontent.h"
 #include "txdb.h"
 
 extern CTxMemPool mempool;
@@ -480,6 +481,12 @@ CIdentity::GetAggregatedIdentityMultimap(const uint160 &idID,
         }
     }
 
+    // confirmed content is kept materialised, only the mempool and proofs require the history to be read again
+    if (!checkMempool && !getProofs && sorted)
+    {
+        return IdentityContentCache.GetAggregatedContent(idID, indexKeys, startHeight, endHeight);
+    }
+
     auto identityHistory = LookupIdentities(idID, startHeight, endHeight, checkMempool, getProofs, proofHeight, indexKeys, sorted);
     for (auto &oneIdentity : identityHistory)
     {
@@ -722,7 +729,7 @@ uint160 CIdentity::IdentityPrimaryAddressKey(const CTxDestination &dest)
     return CCrossChainRPCData::GetConditionID(CVDXF::GetDataKey(IdentityPrimaryAddressKeyName(), nameSpace), hw.GetHash());
 }
 
-bool CIdentity::GetIdentityOutsByPrimaryAddress(const CTxDestination &address, std::map<uint160, std::pair<CAddressIndexDbEntry, CIdentity>> &identities, uint32_t start, uint32_t end)
+bool CIdentity::GetIdentityOutsWithIndexKey(const uint160 &indexKey, std::map<uint160, std::pair<CAddressIndexDbEntry, CIdentity>> &identities, uint32_t start, uint32_t end)
 {
     if (!fIdIndex)
     {
@@ -731,8 +738,8 @@ bool CIdentity::GetIdentityOutsByPrimaryAddress(const CTxDestination &address, s
     // which transaction are we in this block?
     std::vector<CAddressIndexDbEntry> addressIndex;
 
-    // get all export transactions including and since this one up to the confirmed cross-notarization
-    if (GetAddressIndex(CIdentity::IdentityPrimaryAddressKey(address),
+    // get all identity outputs indexed under this key in the height range
+    if (GetAddressIndex(indexKey,
                         CScript::P2IDX,
                         addressIndex,
                         start,
@@ -760,80 +767,19 @@ bool CIdentity::GetIdentityOutsByPrimaryAddress(const CTxDestination &address, s
     return false;
 }
 
-bool CIdentity::GetIdentityOutsWithRevocationID(const CIdentityID &idID, std::map<uint160, std::pair<CAddressIndexDbEntry, CIdentity>> &identities, uint32_t start, uint32_t end)
+bool CIdentity::GetIdentityOutsByPrimaryAddress(const CTxDestination &address, std::map<uint160, std::pair<CAddressIndexDbEntry, CIdentity>> &identities, uint32_t start, uint32_t end)
 {
-    if (!fIdIndex)
-    {
-        return false;
-    }
-    // which transaction are we in this block?
-    std::vector<CAddressIndexDbEntry> addressIndex;
+    return GetIdentityOutsWithIndexKey(CIdentity::IdentityPrimaryAddressKey(address), identities, start, end);
+}
 
-    // get all export transactions including and since this one up to the confirmed cross-notarization
-    if (GetAddressIndex(CIdentity::IdentityRevocationKey(idID),
-                        CScript::P2IDX,
-                        addressIndex,
-                        start,
-                        end))
-    {
-        for (auto &idx : addressIndex)
-        {
-            uint256 blkHash;
-            CTransaction identityTx;
-            if (!idx.first.spending && myGetTransaction(idx.first.txhash, identityTx, blkHash))
-            {
-                CIdentity identity;
-                if ((identity = CIdentity(identityTx.vout[idx.first.index].scriptPubKey)).IsValid())
-                {
-                    identities.insert(std::make_pair(identity.GetID(), std::make_pair(idx, identity)));
-                }
-                else
-                {
-                    LogPrintf("%s: invalid identity output: %s, %lu\n", __func__, idx.first.txhash.GetHex().c_str(), idx.first.index);
-                }
-            }
-        }
-        return true;
-    }
-    return false;
+bool CIdentity::GetIdentityOutsWithRevocationID(const CIdentityID &idID, std::map<uint160, std::pair<CAddressIndexDbEntry, CIdentity>> &identities, uint32_t start, uint32_t end)
+{
+    return GetIdentityOutsWithIndexKey(CIdentity::IdentityRevocationKey(idID), identities, start, end);
 }
 
 bool CIdentity::GetIdentityOutsWithRecoveryID(const CIdentityID &idID, std::map<uint160, std::pair<CAddressIndexDbEntry, CIdentity>> &identities, uint32_t start, uint32_t end)
 {
-    if (!fIdIndex)
-    {
-        return false;
-    }
-    // which transaction are we in this block?
-    std::vector<CAddressIndexDbEntry> addressIndex;
-
-    // get all export transactions including and since this one up to the confirmed cross-notarization
-    if (GetAddressIndex(CIdentity::IdentityRecoveryKey(idID),
-                        CScript::P2IDX,
-                        addressIndex,
-                        start,
-                        end))
-    {
-        for (auto &idx : addressIndex)
-        {
-            uint256 blkHash;
-            CTransaction identityTx;
-            if (!idx.first.spending && myGetTransaction(idx.first.txhash, identityTx, blkHash))
-            {
-                CIdentity identity;
-                if ((identity = CIdentity(identityTx.vout[idx.first.index].scriptPubKey)).IsValid())
-                {
-                    identities.insert(std::make_pair(identity.GetID(), std::make_pair(idx, identity)));
-                }
-                else
-                {
-                    LogPrintf("%s: invalid identity output: %s, %lu\n", __func__, idx.first.txhash.GetHex().c_str(), idx.first.index);
-                }
-            }
-        }
-        return true;
-    }
-    return false;
+    return GetIdentityOutsWithIndexKey(CIdentity::IdentityRecoveryKey(idID), identities, start, end);
 }
 
 bool CIdentity::GetActiveIdentitiesByPrimaryAddress(const CTxDestination &address, std::map<uint160, std::pair<CAddressUnspentDbEntry, CIdentity>> &identities)
@@ -0,0 +1,283 @@
+// Copyright (c) 2026 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#include "pbaas/identitycontent.h"
+
+#include "cc/CCinclude.h"
+#include "main.h"
+
+CIdentityContentCache IdentityContentCache;
+
+CIdentityContentUpdate::CIdentityContentUpdate(const CIdentity &identity, const uint256 &BlockHash, uint32_t Height, const CUTXORef &Output) :
+    blockHash(BlockHash), height(Height), output(Output)
+{
+    for (auto it = identity.contentMultiMap.begin(); it != identity.contentMultiMap.end(); it++)
+    {
+        // an empty removal is kept as a value, as it always has been
+        if (it->first == CVDXF_Data::ContentMultiMapRemoveKey() && it->second.size())
+        {
+            CDataStream ss(it->second, PROTOCOL_VERSION, SER_DISK);
+            uint160 objTypeKey;
+            uint32_t serVersion;
+            size_t serSize;
+            CContentMultiMapRemove removeAction;
+
+            ss >> objTypeKey;
+            ss >> VARINT(serVersion);
+            ss >> VARINT(serSize);
+            ss >> removeAction;
+
+            if (objTypeKey == CVDXF_Data::ContentMultiMapRemoveKey() && removeAction.IsValid())
+            {
+                actions.push_back(CIdentityContentAction(removeAction));
+            }
+        }
+        else
+        {
+            CNativeHashWriter hw;
+            hw.write((const char *)it->second.data(), it->second.size());
+            actions.push_back(CIdentityContentAction(it->first, CIdentityContentValue(it->second, hw.GetHash(), blockHash, height, output)));
+        }
+    }
+}
+
+void CIdentityContentUpdate::Apply(std::multimap<uint160, CIdentityContentValue> &contentMap) const
+{
+    for (auto &oneAction : actions)
+    {
+        if (!oneAction.IsRemoval())
+        {
+            contentMap.insert(std::make_pair(oneAction.key, oneAction.value));
+            continue;
+        }
+
+        const CContentMultiMapRemove &removeAction = oneAction.removal;
+        if (removeAction.action == removeAction.ACTION_CLEAR_MAP)
+        {
+            contentMap.clear();
+        }
+        else if (removeAction.action == removeAction.ACTION_REMOVE_ALL_KEY)
+        {
+            contentMap.erase(removeAction.entryKey);
+        }
+        else if (removeAction.action == removeAction.ACTION_REMOVE_ALL_KEYVALUE || removeAction.action == removeAction.ACTION_REMOVE_ONE_KEYVALUE)
+        {
+            auto removeItemRange = contentMap.equal_range(removeAction.entryKey);
+            for (auto removeItemCursor = removeItemRange.first; removeItemCursor != removeItemRange.second;)
+            {
+                if (removeItemCursor->second.valueHash != removeAction.valueHash)
+                {
+                    removeItemCursor++;
+                    continue;
+                }
+                removeItemCursor = contentMap.erase(removeItemCursor);
+                if (removeAction.action == removeAction.ACTION_REMOVE_ONE_KEYVALUE)
+                {
+                    break;
+                }
+            }
+        }
+    }
+}
+
+CIdentityContentCache::AggregatedMap CIdentityContentCache::GetAggregatedContent(const uint160 &idID,
+                                                                                 const std::vector<uint160> &indexKeys,
+                                                                                 uint32_t startHeight,
+                                                                                 uint32_t endHeight)
+{
+    LOCK(cs_main);
+    CheckTip();
+
+    uint32_t tipHeight = chainActive.Height();
+    if (!endHeight || endHeight > tipHeight)
+    {
+        endHeight = tipHeight;
+    }
+
+    ContentKey cacheKey(idID, indexKeys);
+    auto it = contentByIdentity.find(cacheKey);
+    if (it == contentByIdentity.end())
+    {
+        // the whole history is read before anything is kept, in case an update in it throws
+        CContentVersions loaded;
+        for (auto &oneIdentity : CIdentity::LookupIdentities(idID, 0, 0, false, false, 0, indexKeys, true))
+        {
+            loaded.versions.push_back(CIdentityContentUpdate(std::get<0>(oneIdentity), std::get<1>(oneIdentity), std::get<2>(oneIdentity), std::get<3>(oneIdentity)));
+        }
+        if (contentByIdentity.size() >= MAX_CONTENT_ENTRIES)
+        {
+            Remove(contentByIdentity.find(lruOrder.back()));
+        }
+        lruOrder.push_front(cacheKey);
+        loaded.lruPos = lruOrder.begin();
+        it = contentByIdentity.insert(std::make_pair(cacheKey, loaded)).first;
+    }
+    else
+    {
+        lruOrder.splice(lruOrder.begin(), lruOrder, it->second.lruPos);
+    }
+    CContentVersions &entry = it->second;
+
+    // the whole history is kept applied, anything narrower is replayed from the versions in range
+    std::multimap<uint160, CIdentityContentValue> rangeMap;
+    const std::multimap<uint160, CIdentityContentValue> *pContentMap = &rangeMap;
+    if ((!entry.versions.size() || startHeight <= entry.versions.front().height) && endHeight == tipHeight)
+    {
+        if (!entry.fTipMapValid)
+        {
+            entry.tipMap.clear();
+            for (auto &oneVersion : entry.versions)
+            {
+                oneVersion.Apply(entry.tipMap);
+            }
+            entry.fTipMapValid = true;
+        }
+        pContentMap = &entry.tipMap;
+    }
+    else
+    {
+        for (auto &oneVersion : entry.versions)
+        {
+            if (oneVersion.height >= startHeight && oneVersion.height <= endHeight)
+            {
+                oneVersion.Apply(rangeMap);
+            }
+        }
+    }
+
+    AggregatedMap retMap;
+    for (auto &oneEntry : *pContentMap)
+    {
+        retMap.insert(std::make_pair(oneEntry.first,
+                                     std::make_tuple(oneEntry.second.value, oneEntry.second.blockHash, oneEntry.second.height, oneEntry.second.output, CPartialTransactionProof())));
+    }
+    return retMap;
+}
+
+void CIdentityContentCache::Remove(std::map<ContentKey, CContentVersions>::iterator it)
+{
+    lruOrder.erase(it->second.lruPos);
+    contentByIdentity.erase(it);
+}
+
+void CIdentityContentCache::Clear()
+{
+    contentByIdentity.clear();
+    lruOrder.clear();
+}
+
+void CIdentityContentCache::SyncTransaction(const CTransaction &tx, const CBlock *pblock)
+{
+    // only confirmed updates are versioned, the mempool is read directly when requested
+    if (!pblock)
+    {
+        return;
+    }
+
+    LOCK(cs_main);
+    if (contentByIdentity.empty())
+    {
+        return;
+    }
+
+    const uint256 &txid = tx.GetHash();
+    for (int i = 0; i < tx.vout.size(); i++)
+    {
+        COptCCParams p;
+        CIdentity identity;
+        if (!tx.vout[i].scriptPubKey.IsPayToCryptoCondition(p) ||
+            !p.IsValid() ||
+            p.evalCode != EVAL_IDENTITY_PRIMARY ||
+            !p.vData.size() ||
+            !(identity = CIdentity(p.vData[0])).IsValid())
+        {
+            continue;
+        }
+
+        uint160 idID = identity.GetID();
+        auto it = contentByIdentity.lower_bound(std::make_pair(idID, std::vector<uint160>()));
+        if (it == contentByIdentity.end() || it->first.first != idID)
+        {
+            continue;
+        }
+
+        uint256 blockHash = pblock->GetHash();
+        auto blockIt = mapBlockIndex.find(blockHash);
+        if (blockIt == mapBlockIndex.end())
+        {
+            continue;
+        }
+        uint32_t height = blockIt->second->GetHeight();
+
+        // an update is a version of each loaded set of keys that the address index stores it under
+        std::set<CIndexID> outputKeys = p.GetIndexKeys();
+        CIdentityContentUpdate update;
+        try
+        {
+            update = CIdentityContentUpdate(identity, blockHash, height, CUTXORef(txid, i));
+        }
+        catch (...)
+        {
+            // queries of this identity fail on the update as they read it, so nothing is kept for them
+            LogPrint("identity", "%s: cannot read content removal in %s, %d\n", __func__, txid.GetHex().c_str(), i);
+            while (it != contentByIdentity.end() && it->first.first == idID)
+            {
+                Remove(it++);
+            }
+            continue;
+        }
+        for (; it != contentByIdentity.end() && it->first.first == idID; it++)
+        {
+            std::vector<uint160> lookupKeys = it->first.second.size() ?
+                                                it->first.second :
+                                                std::vector<uint160>({CCrossChainRPCData::GetConditionID(idID, EVAL_IDENTITY_PRIMARY)});
+            bool isIndexed = false;
+            for (auto &oneKey : lookupKeys)
+            {
+                if (outputKeys.count(CIndexID(oneKey)))
+                {
+                    isIndexed = true;
+                    break;
+                }
+            }
+            if (!isIndexed)
+            {
+                continue;
+            }
+            it->second.versions.push_back(update);
+            if (it->second.fTipMapValid)
+            {
+                update.Apply(it->second.tipMap);
+            }
+        }
+    }
+}
+
+void CIdentityContentCache::ChainTip(const CBlockIndex *pindex, const CBlock *pblock, SproutMerkleTree sproutTree, SaplingMerkleTree saplingTree, bool added)
+{
+    LOCK(cs_main);
+    // the versions a connected block adds come from its transactions as they are synced
+    if (!FollowTip(pindex, added) || added)
+    {
+        return;
+    }
+    uint256 blockHash = pindex->GetBlockHash();
+
+    // drop the versions this block added, and rebuild the tip map without them when it is next read
+    for (auto &oneEntry : contentByIdentity)
+    {
+        auto &versions = oneEntry.second.versions;
+        bool removed = false;
+        while (versions.size() && versions.back().blockHash == blockHash)
+        {
+            versions.pop_back();
+            removed = true;
+        }
+        if (removed)
+        {
+            oneEntry.second.fTipMapValid = false;
+            oneEntry.second.tipMap.clear();
+        }
+    }
+}
@@ -0,0 +1,108 @@
+// Copyright (c) 2026 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+/*
+ * Materialised content multimaps of identities. The first query of an identity and set of index keys
+ * reads its update history once, decoding removal actions and hashing values as it goes, and keeps
+ * each update as a version along with the aggregated map at the tip. Connected blocks add their
+ * updates as new versions and apply them to the tip map, and disconnected blocks drop the versions
+ * they added, so aggregating content no longer replays the identity's history from the index on every
+ * call. Queries over height ranges are answered by replaying the kept versions in that range. The
+ * least recently queried identities are dropped once a fixed number of them are kept.
+ */
+
+#ifndef PBAAS_IDENTITYCONTENT_H
+#define PBAAS_IDENTITYCONTENT_H
+
+#include "pbaas/chaincache.h"
+#include "pbaas/identity.h"
+
+#include <list>
+
+// one value in an aggregated content multimap, with the hash that removals are matched against
+class CIdentityContentValue
+{
+public:
+    std::vector<unsigned char> value;
+    uint256 valueHash;
+    uint256 blockHash;
+    uint32_t height;
+    CUTXORef output;
+
+    CIdentityContentValue() : height(0) {}
+    CIdentityContentValue(const std::vector<unsigned char> &Value, const uint256 &ValueHash, const uint256 &BlockHash, uint32_t Height, const CUTXORef &Output) :
+        value(Value), valueHash(ValueHash), blockHash(BlockHash), height(Height), output(Output) {}
+};
+
+// a value added to a content multimap, or a valid removal action
+class CIdentityContentAction
+{
+public:
+    CContentMultiMapRemove removal;
+    uint160 key;
+    CIdentityContentValue value;
+
+    CIdentityContentAction(const CContentMultiMapRemove &Removal) : removal(Removal) {}
+    CIdentityContentAction(const uint160 &Key, const CIdentityContentValue &Value) : key(Key), value(Value) {}
+
+    bool IsRemoval() const { return removal.IsValid(); }
+};
+
+// the content changes of one identity update, in the order of its content multimap
+class CIdentityContentUpdate
+{
+public:
+    uint256 blockHash;
+    uint32_t height;
+    CUTXORef output;
+    std::vector<CIdentityContentAction> actions;
+
+    CIdentityContentUpdate() : height(0) {}
+    // throws if a removal cannot be deserialized, which fails the query the way reading the history always has
+    CIdentityContentUpdate(const CIdentity &identity, const uint256 &BlockHash, uint32_t Height, const CUTXORef &Output);
+
+    void Apply(std::multimap<uint160, CIdentityContentValue> &contentMap) const;
+};
+
+class CIdentityContentCache : public CChainFollowingCache
+{
+public:
+    typedef std::multimap<uint160, std::tuple<std::vector<unsigned char>, uint256, uint32_t, CUTXORef, CPartialTransactionProof>> AggregatedMap;
+
+    // the content of idID aggregated over the confirmed updates found under indexKeys from startHeight through
+    // endHeight, as CIdentity::GetAggregatedIdentityMultimap returns it without the mempool or proofs. takes cs_main
+    AggregatedMap GetAggregatedContent(const uint160 &idID, const std::vector<uint160> &indexKeys, uint32_t startHeight, uint32_t endHeight);
+
+    void Clear();
+
+protected:
+    // CValidationInterface
+    void SyncTransaction(const CTransaction &tx, const CBlock *pblock);
+    void ChainTip(const CBlockIndex *pindex, const CBlock *pblock, SproutMerkleTree sproutTree, SaplingMerkleTree saplingTree, bool added);
+
+private:
+    typedef std::pair<uint160, std::vector<uint160>> ContentKey;   // identity and the index keys its updates are read from
+
+    class CContentVersions
+    {
+    public:
+        std::vector<CIdentityContentUpdate> versions;               // confirmed updates in chain order
+        bool fTipMapValid;
+        std::multimap<uint160, CIdentityContentValue> tipMap;       // all versions applied, rebuilt after disconnects
+        std::list<ContentKey>::iterator lruPos;                     // position in lruOrder
+
+        CContentVersions() : fTipMapValid(false) {}
+    };
+
+    static const size_t MAX_CONTENT_ENTRIES = 1000;
+
+    std::map<ContentKey, CContentVersions> contentByIdentity;
+    std::list<ContentKey> lruOrder;                                 // keys of contentByIdentity, most recently queried first
+
+    void Remove(std::map<ContentKey, CContentVersions>::iterator it);
+};
+
+extern CIdentityContentCache IdentityContentCache;
+
+#endif // PBAAS_IDENTITYCONTENT_H
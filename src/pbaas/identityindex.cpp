@@ -0,0 +1,285 @@
+// Copyright (c) 2026 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#include "pbaas/identityindex.h"
+
+#include "cc/CCinclude.h"
+#include "main.h"
+
+CIdentityIndex IdentityIndex;
+
+bool CIdentityIndex::GetIdentities(const uint160 &indexKey,
+                                   std::vector<CIndexedIdentity> &identities,
+                                   const uint160 &afterID,
+                                   uint32_t maxCount,
+                                   bool *pfMore)
+{
+    AssertLockHeld(cs_main);
+    CheckTip();
+
+    if (!fIdIndex)
+    {
+        return false;
+    }
+
+    auto keyIt = identitiesByKey.find(indexKey);
+    if (keyIt == identitiesByKey.end())
+    {
+        std::vector<CAddressUnspentDbEntry> unspentOutputs;
+        if (!GetAddressUnspent(indexKey, CScript::P2IDX, unspentOutputs))
+        {
+            return false;
+        }
+        keyIt = identitiesByKey.insert(std::make_pair(indexKey, std::map<uint160, CIndexedIdentity>())).first;
+        for (auto &oneOutput : unspentOutputs)
+        {
+            CIdentity identity(oneOutput.second.script);
+            if (!identity.IsValid())
+            {
+                LogPrintf("%s: invalid identity in unspent index: %s, %lu\n", __func__, oneOutput.first.txhash.GetHex().c_str(), oneOutput.first.index);
+                continue;
+            }
+            AddIdentity(indexKey, COutPoint(oneOutput.first.txhash, oneOutput.first.index), oneOutput.second.blockHeight, identity);
+        }
+    }
+
+    if (pfMore)
+    {
+        *pfMore = false;
+    }
+    for (auto it = afterID.IsNull() ? keyIt->second.begin() : keyIt->second.upper_bound(afterID); it != keyIt->second.end(); it++)
+    {
+        if (maxCount && identities.size() >= maxCount)
+        {
+            if (pfMore)
+            {
+                *pfMore = true;
+            }
+            break;
+        }
+        identities.push_back(it->second);
+    }
+    return true;
+}
+
+bool CIdentityIndex::GetIdentityOuts(const uint160 &indexKey,
+                                     std::vector<std::pair<CAddressIndexDbEntry, CIdentity>> &identities,
+                                     uint32_t start,
+                                     uint32_t end,
+                                     const uint160 &afterID,
+                                     uint32_t maxCount,
+                                     bool *pfMore)
+{
+    AssertLockHeld(cs_main);
+
+    std::vector<CAddressIndexDbEntry> addressIndex;
+    if (!fIdIndex || !GetAddressIndex(indexKey, CScript::P2IDX, addressIndex, start, end))
+    {
+        return false;
+    }
+
+    // the first output of each identity after afterID, with the identities read while finding them
+    std::map<uint160, const CAddressIndexDbEntry *> firstOutputs;
+    std::map<COutPoint, CIdentity> readIdentities;
+    for (auto &idx : addressIndex)
+    {
+        if (idx.first.spending)
+        {
+            continue;
+        }
+        COutPoint output(idx.first.txhash, idx.first.index);
+        uint160 idID;
+        CIdentity identity;
+        if (!idsByOutput.Get(output, idID))
+        {
+            uint256 blkHash;
+            CTransaction identityTx;
+            if (!myGetTransaction(output.hash, identityTx, blkHash))
+            {
+                continue;
+            }
+            if (!(identity = CIdentity(identityTx.vout[output.n].scriptPubKey)).IsValid())
+            {
+                LogPrintf("%s: invalid identity output: %s, %lu\n", __func__, output.hash.GetHex().c_str(), output.n);
+                continue;
+            }
+            idID = identity.GetID();
+            idsByOutput.Put(output, idID);
+        }
+        if ((afterID.IsNull() || afterID < idID) && firstOutputs.insert(std::make_pair(idID, &idx)).second && identity.IsValid())
+        {
+            readIdentities[output] = identity;
+        }
+    }
+
+    if (pfMore)
+    {
+        *pfMore = false;
+    }
+    for (auto &oneOutput : firstOutputs)
+    {
+        if (maxCount && identities.size() >= maxCount)
+        {
+            if (pfMore)
+            {
+                *pfMore = true;
+            }
+            break;
+        }
+        const CAddressIndexDbEntry &idx = *oneOutput.second;
+        COutPoint output(idx.first.txhash, idx.first.index);
+        auto readIt = readIdentities.find(output);
+        CIdentity identity;
+        if (readIt != readIdentities.end())
+        {
+            identity = readIt->second;
+        }
+        else
+        {
+            uint256 blkHash;
+            CTransaction identityTx;
+            if (!myGetTransaction(output.hash, identityTx, blkHash) ||
+                !(identity = CIdentity(identityTx.vout[output.n].scriptPubKey)).IsValid())
+            {
+                continue;
+            }
+        }
+        identities.push_back(std::make_pair(idx, identity));
+    }
+    return true;
+}
+
+void CIdentityIndex::AddIdentity(const uint160 &indexKey, const COutPoint &output, int32_t height, const CIdentity &identity)
+{
+    uint160 idID = identity.GetID();
+    auto &keyIdentities = identitiesByKey[indexKey];
+
+    // an identity has only one current output, so a newer one replaces whatever was indexed for it
+    auto idIt = keyIdentities.find(idID);
+    if (idIt != keyIdentities.end())
+    {
+        auto keyRange = keysByOutput.equal_range(idIt->second.output);
+        for (auto it = keyRange.first; it != keyRange.second; it++)
+        {
+            if (it->second.first == indexKey)
+            {
+                keysByOutput.erase(it);
+                break;
+            }
+        }
+    }
+    keyIdentities[idID] = CIndexedIdentity(output, height, identity);
+    keysByOutput.insert(std::make_pair(output, std::make_pair(indexKey, idID)));
+}
+
+// adds an identity output under the loaded keys the address index stores it under
+void CIdentityIndex::AddOutput(const COutPoint &output, int32_t height, const CScript &script)
+{
+    COptCCParams p;
+    CIdentity identity;
+    if (!script.IsPayToCryptoCondition(p) ||
+        !p.IsValid() ||
+        p.evalCode != EVAL_IDENTITY_PRIMARY ||
+        !p.vData.size() ||
+        !(identity = CIdentity(p.vData[0])).IsValid())
+    {
+        return;
+    }
+
+    // the same keys the address index stores identity outputs under
+    std::set<uint160> indexKeys;
+    for (auto &oneDest : identity.primaryAddresses)
+    {
+        indexKeys.insert(CIdentity::IdentityPrimaryAddressKey(oneDest));
+    }
+    indexKeys.insert(CIdentity::IdentityRecoveryKey(identity.recoveryAuthority));
+    indexKeys.insert(CIdentity::IdentityRevocationKey(identity.revocationAuthority));
+    indexKeys.insert(CIdentity::IdentityParentKey(identity.parent));
+
+    for (auto &oneKey : indexKeys)
+    {
+        if (identitiesByKey.count(oneKey))
+        {
+            AddIdentity(oneKey, output, height, identity);
+        }
+    }
+}
+
+void CIdentityIndex::RemoveOutput(const COutPoint &output)
+{
+    auto keyRange = keysByOutput.equal_range(output);
+    for (auto it = keyRange.first; it != keyRange.second; it++)
+    {
+        identitiesByKey[it->second.first].erase(it->second.second);
+    }
+    keysByOutput.erase(keyRange.first, keyRange.second);
+}
+
+void CIdentityIndex::Clear()
+{
+    identitiesByKey.clear();
+    keysByOutput.clear();
+}
+
+void CIdentityIndex::SyncTransaction(const CTransaction &tx, const CBlock *pblock)
+{
+    // only confirmed identity outputs are indexed
+    if (!pblock)
+    {
+        return;
+    }
+
+    LOCK(cs_main);
+    if (identitiesByKey.empty())
+    {
+        return;
+    }
+
+    for (auto &oneIn : tx.vin)
+    {
+        RemoveOutput(oneIn.prevout);
+    }
+
+    const uint256 &txid = tx.GetHash();
+    for (int i = 0; i < tx.vout.size(); i++)
+    {
+        AddOutput(COutPoint(txid, i), pblock->GetHeight(), tx.vout[i].scriptPubKey);
+    }
+}
+
+void CIdentityIndex::ChainTip(const CBlockIndex *pindex, const CBlock *pblock, SproutMerkleTree sproutTree, SaplingMerkleTree saplingTree, bool added)
+{
+    LOCK(cs_main);
+    // connected blocks are followed as their transactions are synced
+    if (!FollowTip(pindex, added) || added || identitiesByKey.empty())
+    {
+        return;
+    }
+
+    // undo the block from its last transaction to its first. the outputs it spent are unspent in the coins view again
+    for (int i = pblock->vtx.size() - 1; i >= 0; i--)
+    {
+        const CTransaction &tx = pblock->vtx[i];
+        const uint256 &txid = tx.GetHash();
+        for (int j = 0; j < tx.vout.size(); j++)
+        {
+            RemoveOutput(COutPoint(txid, j));
+        }
+        if (tx.IsCoinBase())
+        {
+            continue;
+        }
+        for (auto &oneIn : tx.vin)
+        {
+            CCoins coins;
+            if (!pcoinsTip->GetCoins(oneIn.prevout.hash, coins) || !coins.IsAvailable(oneIn.prevout.n))
+            {
+                // without the output, nothing kept can be trusted
+                Clear();
+                return;
+            }
+            AddOutput(oneIn.prevout, coins.nHeight, coins.vout[oneIn.prevout.n].scriptPubKey);
+        }
+    }
+}
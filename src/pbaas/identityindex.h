@@ -0,0 +1,77 @@
+// Copyright (c) 2026 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+/*
+ * In-memory secondary indexes from primary addresses, revocation and recovery authorities, and parents
+ * to the current outputs of the identities indexed under them. Each index key is read from the unspent
+ * index the first time it is queried, and from then on, connected blocks add the identity outputs they
+ * index under it and remove the outputs they spend, and disconnected blocks put back the outputs they
+ * spent from the coins view. Identities under a key are kept in ID order, so callers can page through
+ * them with the last ID they returned as a cursor.
+ */
+
+#ifndef PBAAS_IDENTITYINDEX_H
+#define PBAAS_IDENTITYINDEX_H
+
+#include "lrucache.h"
+#include "pbaas/chaincache.h"
+#include "pbaas/identity.h"
+
+// the current output of an identity
+class CIndexedIdentity
+{
+public:
+    COutPoint output;
+    int32_t blockHeight;
+    CIdentity identity;
+
+    CIndexedIdentity() : blockHeight(0) {}
+    CIndexedIdentity(const COutPoint &out, int32_t height, const CIdentity &id) : output(out), blockHeight(height), identity(id) {}
+};
+
+class CIdentityIndex : public CChainFollowingCache
+{
+public:
+    // up to maxCount identities indexed under indexKey with IDs after afterID, in ID order, with a null afterID
+    // starting from the first and a maxCount of 0 returning all. returns false if the index cannot be read, and
+    // sets fMore if there are more identities after those returned. all calls must hold cs_main
+    bool GetIdentities(const uint160 &indexKey,
+                       std::vector<CIndexedIdentity> &identities,
+                       const uint160 &afterID=uint160(),
+                       uint32_t maxCount=0,
+                       bool *pfMore=nullptr);
+
+    // the first output of each identity indexed under indexKey between heights start and end, with IDs after afterID,
+    // in ID order and paged the same way. the ID of each output read is kept, so later pages only read the outputs
+    // they return. returns false if the index cannot be read. all calls must hold cs_main
+    bool GetIdentityOuts(const uint160 &indexKey,
+                         std::vector<std::pair<std::pair<CAddressIndexKey, CAmount>, CIdentity>> &identities,
+                         uint32_t start=0,
+                         uint32_t end=0,
+                         const uint160 &afterID=uint160(),
+                         uint32_t maxCount=0,
+                         bool *pfMore=nullptr);
+
+    void Clear();
+
+protected:
+    // CValidationInterface
+    void SyncTransaction(const CTransaction &tx, const CBlock *pblock);
+    void ChainTip(const CBlockIndex *pindex, const CBlock *pblock, SproutMerkleTree sproutTree, SaplingMerkleTree saplingTree, bool added);
+
+private:
+    static const int MAX_OUTPUT_IDS = 50000;
+
+    std::map<uint160, std::map<uint160, CIndexedIdentity>> identitiesByKey;    // current identities under each loaded key, by ID
+    std::multimap<COutPoint, std::pair<uint160, uint160>> keysByOutput;        // loaded key and identity ID of each of those outputs
+    LRUCache<COutPoint, uint160> idsByOutput{MAX_OUTPUT_IDS};                  // identity ID of confirmed outputs, which never changes
+
+    void AddIdentity(const uint160 &indexKey, const COutPoint &output, int32_t height, const CIdentity &identity);
+    void AddOutput(const COutPoint &output, int32_t height, const CScript &script);
+    void RemoveOutput(const COutPoint &output);
+};
+
+extern CIdentityIndex IdentityIndex;
+
+#endif // PBAAS_IDENTITYINDEX_H
@@ -0,0 +1,115 @@
+// Copyright (c) 2026 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#include "pbaas/importcache.h"
+
+#include "main.h"
+
+CProofVerificationCache ProofVerificationCache;
+CImportStageCache ImportStages;
+
+uint256 CProofVerificationCache::CheckPartialTransaction(const CPartialTransactionProof &proof, CTransaction &outTx, bool *pIsPartial, bool optimizedETH)
+{
+    CHashWriter hw(SER_GETHASH, PROTOCOL_VERSION);
+    hw << proof;
+    hw << optimizedETH;
+    uint256 proofHash = hw.GetHash();
+
+    {
+        LOCK(cs);
+        auto it = verifiedProofs.find(proofHash);
+        if (it != verifiedProofs.end())
+        {
+            outTx = it->second.tx;
+            if (pIsPartial)
+            {
+                *pIsPartial = it->second.isPartial;
+            }
+            return it->second.root;
+        }
+    }
+
+    // proofs are checked outside of the lock, and if two threads check the same one, both get the same result
+    bool isPartial = false;
+    uint256 root = proof.CheckPartialTransaction(outTx, &isPartial, optimizedETH);
+    if (pIsPartial)
+    {
+        *pIsPartial = isPartial;
+    }
+
+    LOCK(cs);
+    if (verifiedProofs.insert(std::make_pair(proofHash, CVerifiedProof(root, outTx, isPartial))).second)
+    {
+        proofOrder.push_back(proofHash);
+        if (proofOrder.size() > MAX_PROOFS)
+        {
+            verifiedProofs.erase(proofOrder.front());
+            proofOrder.pop_front();
+        }
+    }
+    return root;
+}
+
+void CProofVerificationCache::Clear()
+{
+    LOCK(cs);
+    verifiedProofs.clear();
+    proofOrder.clear();
+}
+
+uint256 CImportStageCache::StageInputHash(const CPBaaSNotarization &lastNotarization,
+                                          const CCurrencyDefinition &sourceSystem,
+                                          const CCurrencyDefinition &destCurrency,
+                                          uint32_t lastExportHeight,
+                                          uint32_t notaHeight,
+                                          const std::vector<CReserveTransfer> &exportTransfers,
+                                          const CTransferDestination &feeRecipient,
+                                          bool lastImportBeforeComplete)
+{
+    CHashWriter hw(SER_GETHASH, PROTOCOL_VERSION);
+    hw << lastNotarization;
+    hw << sourceSystem;
+    hw << destCurrency;
+    hw << lastExportHeight;
+    hw << notaHeight;
+    hw << exportTransfers;
+    hw << feeRecipient;
+    hw << lastImportBeforeComplete;
+    return hw.GetHash();
+}
+
+bool CImportStageCache::GetStage(const CUTXORef &exportOut, const uint256 &inputHash, CImportStage &stage)
+{
+    AssertLockHeld(cs_main);
+    CheckTip();
+
+    auto it = stagesByExport.find(exportOut);
+    if (it == stagesByExport.end() || it->second.first != inputHash)
+    {
+        return false;
+    }
+    stage = it->second.second;
+    return true;
+}
+
+void CImportStageCache::SetStage(const CUTXORef &exportOut, const uint256 &inputHash, const CImportStage &stage)
+{
+    AssertLockHeld(cs_main);
+    CheckTip();
+
+    stagesByExport[exportOut] = std::make_pair(inputHash, stage);
+}
+
+void CImportStageCache::Clear()
+{
+    stagesByExport.clear();
+}
+
+void CImportStageCache::ChainTip(const CBlockIndex *pindex, const CBlock *pblock, SproutMerkleTree sproutTree, SaplingMerkleTree saplingTree, bool added)
+{
+    // the next notarization also depends on the chain it is made on, such as for its entropy, so every new tip starts again
+    LOCK(cs_main);
+    FollowTip(pindex, added);
+    Clear();
+}
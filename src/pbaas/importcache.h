@@ -0,0 +1,96 @@
+// Copyright (c) 2026 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+/*
+ * Work kept between attempts to import exports. Checking a partial transaction proof, and for ETH proofs
+ * verifying the PATRICIA branches behind it, depends on nothing but the proof, so results are kept by
+ * the hash of the proof and are shared by import creation, import validation and the miner's export
+ * requests. The currency state an export moves its destination to is kept per export, along with the
+ * hash of everything it was calculated from, so that failed or repeated imports and block template
+ * rebuilds on the same tip take the result of the last calculation instead of making it again.
+ */
+
+#ifndef PBAAS_IMPORTCACHE_H
+#define PBAAS_IMPORTCACHE_H
+
+#include "pbaas/chaincache.h"
+#include "pbaas/pbaas.h"
+
+#include <deque>
+
+class CProofVerificationCache
+{
+public:
+    // the same as proof.CheckPartialTransaction, from the cache after the first time a proof is checked
+    uint256 CheckPartialTransaction(const CPartialTransactionProof &proof, CTransaction &outTx, bool *pIsPartial=nullptr, bool optimizedETH=true);
+
+    void Clear();
+
+private:
+    class CVerifiedProof
+    {
+    public:
+        uint256 root;
+        CTransaction tx;
+        bool isPartial;
+
+        CVerifiedProof() : isPartial(false) {}
+        CVerifiedProof(const uint256 &Root, const CTransaction &Tx, bool IsPartial) : root(Root), tx(Tx), isPartial(IsPartial) {}
+    };
+
+    static const size_t MAX_PROOFS = 1000;
+
+    CCriticalSection cs;
+    std::map<uint256, CVerifiedProof> verifiedProofs;
+    std::deque<uint256> proofOrder;                                 // oldest first, to drop when full
+};
+
+// the result of calculating the next notarization for one export
+class CImportStage
+{
+public:
+    bool isValid;
+    std::vector<CReserveTransfer> exportTransfers;                  // as NextNotarizationInfo leaves them
+    uint256 transferHash;
+    CPBaaSNotarization newNotarization;
+    std::vector<CTxOut> importOutputs;
+    CCurrencyValueMap importedCurrency;
+    CCurrencyValueMap gatewayDepositsUsed;
+    CCurrencyValueMap spentCurrencyOut;
+
+    CImportStage() : isValid(false) {}
+};
+
+class CImportStageCache : public CChainFollowingCache
+{
+public:
+    // hash of all the arguments that NextNotarizationInfo calculates an import's currency state from
+    static uint256 StageInputHash(const CPBaaSNotarization &lastNotarization,
+                                  const CCurrencyDefinition &sourceSystem,
+                                  const CCurrencyDefinition &destCurrency,
+                                  uint32_t lastExportHeight,
+                                  uint32_t notaHeight,
+                                  const std::vector<CReserveTransfer> &exportTransfers,
+                                  const CTransferDestination &feeRecipient,
+                                  bool lastImportBeforeComplete);
+
+    // the stage calculated for the export at exportOut from inputs with inputHash on the current tip, if any.
+    // all calls must hold cs_main
+    bool GetStage(const CUTXORef &exportOut, const uint256 &inputHash, CImportStage &stage);
+    void SetStage(const CUTXORef &exportOut, const uint256 &inputHash, const CImportStage &stage);
+
+    void Clear();
+
+protected:
+    // CValidationInterface
+    void ChainTip(const CBlockIndex *pindex, const CBlock *pblock, SproutMerkleTree sproutTree, SaplingMerkleTree saplingTree, bool added);
+
+private:
+    std::map<CUTXORef, std::pair<uint256, CImportStage>> stagesByExport;
+};
+
+extern CProofVerificationCache ProofVerificationCache;
+extern CImportStageCache ImportStages;
+
+#endif // PBAAS_IMPORTCACHE_H
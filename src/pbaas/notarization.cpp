@@ -13,6 +13,7 @@
 
 #include <univalue.h>
 #include "main.h"
+#include "metrics.h"
 #include "txdb.h"
 #include "rpc/pbaasrpc.h"
 #include "transaction_builder.h"
@@ -5674,7 +5675,7 @@ bool ProvePosBlock(uint32_t lastProofRootHeight, const CBlockIndex *pindex, CNot
     }
 
     uint32_t heightAfterFirstEntropy = firstHeight + 1;
-    if (!(CConstVerusSolutionVector::Version(chainActive[heightAfterFirstEntropy]->nSolution.nSolution()) >= CActivationHeight::ACTIVATE_PBAAS))
+    if (!(chainActive[heightAfterFirstEntropy]->nSolutionVersion >= CActivationHeight::ACTIVATE_PBAAS))
     {
         heightAfterFirstEntropy++;
     }
@@ -9924,6 +9925,8 @@ std::vector<uint256> CPBaaSNotarization::SubmitFinalizedNotarizations(const CRPC
  */
 bool ValidateAcceptedNotarization(struct CCcontract_info *cp, Eval* eval, const CTransaction &tx, uint32_t nIn, bool fulfilled)
 {
+    CScopedOuterLatencyTimer timer(latencyNotarizationValidation);
+
     // the spending transaction must be a notarization in the same thread of notarizations
     // check the following things:
     // 1. It represents a valid PoS or merge mined block on the other chain, and contains the header in the opret
@@ -12201,6 +12204,8 @@ bool IsAcceptedNotarizationInput(const CScript &scriptSig)
 // confirmed notarization
 bool ValidateEarnedNotarization(struct CCcontract_info *cp, Eval* eval, const CTransaction &tx, uint32_t nIn, bool fulfilled)
 {
+    CScopedOuterLatencyTimer timer(latencyNotarizationValidation);
+
     // first, determine our notarization finalization protocol
     CUTXORef spendingOutput(tx.vin[nIn].prevout.hash, tx.vin[nIn].prevout.n);
     CTransaction sourceTx;
@@ -12298,6 +12303,8 @@ CObjectFinalization GetOldFinalization(const CTransaction &spendingTx, uint32_t
  */
 bool ValidateFinalizeNotarization(struct CCcontract_info *cp, Eval* eval, const CTransaction &tx, uint32_t nIn, bool fulfilled)
 {
+    CScopedOuterLatencyTimer timer(latencyNotarizationValidation);
+
     // to validate a finalization spend, we need to validate the spender's assertion of confirmation or rejection as proven
 
     // first, determine our notarization finalization protocol
@@ -0,0 +1,153 @@
+// Copyright (c) 2026 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#include "pbaas/offerbook.h"
+
+#include "cc/CCinclude.h"
+#include "key_io.h"
+#include "main.h"
+#include "rpc/pbaasrpc.h"
+#include "txmempool.h"
+
+COfferBook OfferBook;
+
+bool COfferBook::GetPostedOutputs(const uint160 &offerKey, std::vector<COutPoint> &postedOutputs)
+{
+    AssertLockHeld(cs_main);
+    CheckTip();
+
+    auto keyIt = offersByKey.find(offerKey);
+    if (keyIt == offersByKey.end())
+    {
+        std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue>> unspentOutputs;
+        if (!GetAddressUnspent(offerKey, CScript::P2PKH, unspentOutputs))
+        {
+            return false;
+        }
+        keyIt = offersByKey.insert(std::make_pair(offerKey, std::set<COutPoint>())).first;
+        for (auto &oneOutput : unspentOutputs)
+        {
+            COutPoint output(oneOutput.first.txhash, oneOutput.first.index);
+            keyIt->second.insert(output);
+            keysByOutput.insert(std::make_pair(output, offerKey));
+        }
+    }
+    postedOutputs.insert(postedOutputs.end(), keyIt->second.begin(), keyIt->second.end());
+    return true;
+}
+
+bool COfferBook::GetOffer(const uint256 &txid, uint32_t height, std::shared_ptr<const COpenOffer> &offer)
+{
+    AssertLockHeld(cs_main);
+    CheckTip();
+
+    offer = nullptr;
+    auto it = offers.find(txid);
+    if (it != offers.end())
+    {
+        offer = IsOpen(it->second, height) ? it->second : nullptr;
+        return true;
+    }
+
+    // decode at height 0, which accepts every offer that expires at all, and leave expiry to the caller
+    CTransaction postedTx, offerTx, inputToOfferTx;
+    uint256 blockHash, offerBlockHash;
+    if (!myGetTransaction(txid, postedTx, blockHash))
+    {
+        return false;
+    }
+
+    // only offers that decode are kept, as one that does not may only be taken in the mempool,
+    // and is open again if that transaction never makes it into a block
+    if (GetOpRetChainOffer(postedTx, offerTx, inputToOfferTx, 0, true, false, offerBlockHash))
+    {
+        std::shared_ptr<const COpenOffer> decoded = std::make_shared<const COpenOffer>(postedTx, offerTx, inputToOfferTx);
+        offers[txid] = decoded;
+        offersByOfferedOutput[decoded->OfferedOutput()] = txid;
+        offer = IsOpen(decoded, height) ? decoded : nullptr;
+    }
+    return true;
+}
+
+bool COfferBook::IsOpen(const std::shared_ptr<const COpenOffer> &offer, uint32_t height) const
+{
+    if (!offer || offer->offerTx.nExpiryHeight <= height)
+    {
+        return false;
+    }
+
+    // spends in blocks close offers as they are connected, only the mempool needs to be checked
+    CSpentIndexKey spentKey(offer->OfferedOutput().hash, offer->OfferedOutput().n);
+    CSpentIndexValue spentValue;
+    return !mempool.getSpentIndex(spentKey, spentValue);
+}
+
+void COfferBook::Clear()
+{
+    offersByKey.clear();
+    keysByOutput.clear();
+    offers.clear();
+    offersByOfferedOutput.clear();
+}
+
+void COfferBook::SyncTransaction(const CTransaction &tx, const CBlock *pblock)
+{
+    // the book follows blocks, mempool transactions are checked when offers are read
+    if (!pblock)
+    {
+        return;
+    }
+
+    LOCK(cs_main);
+    if (offersByKey.empty() && offers.empty())
+    {
+        return;
+    }
+
+    for (auto &oneIn : tx.vin)
+    {
+        // spending the posted output removes the offer from the index
+        auto keyRange = keysByOutput.equal_range(oneIn.prevout);
+        for (auto it = keyRange.first; it != keyRange.second; it++)
+        {
+            offersByKey[it->second].erase(oneIn.prevout);
+        }
+        keysByOutput.erase(keyRange.first, keyRange.second);
+
+        // spending the offered output takes or closes the offer
+        auto offerIt = offersByOfferedOutput.find(oneIn.prevout);
+        if (offerIt != offersByOfferedOutput.end())
+        {
+            offers[offerIt->second] = nullptr;
+            offersByOfferedOutput.erase(offerIt);
+        }
+    }
+
+    if (offersByKey.empty())
+    {
+        return;
+    }
+    const uint256 &txid = tx.GetHash();
+    for (int i = 0; i < tx.vout.size(); i++)
+    {
+        COptCCParams p;
+        if (!tx.vout[i].scriptPubKey.IsPayToCryptoCondition(p) || !p.IsValid())
+        {
+            continue;
+        }
+        for (auto &oneDest : p.GetDestinations())
+        {
+            if (oneDest.which() != COptCCParams::ADDRTYPE_PKH)
+            {
+                continue;
+            }
+            uint160 destID = GetDestinationID(oneDest);
+            auto keyIt = offersByKey.find(destID);
+            if (keyIt != offersByKey.end() && keyIt->second.insert(COutPoint(txid, i)).second)
+            {
+                keysByOutput.insert(std::make_pair(COutPoint(txid, i), destID));
+            }
+        }
+    }
+}
@@ -0,0 +1,64 @@
+// Copyright (c) 2026 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+/*
+ * In-memory book of the open marketplace offers posted to each currency and identity offer key.
+ * The offers of a key are read from the unspent index the first time the key is requested, and
+ * each offer transaction is decoded only once. From then on, connected blocks add newly posted
+ * offers and drop offers that are taken, closed, or reclaimed, rather than every block requiring
+ * the whole book to be read again.
+ */
+
+#ifndef PBAAS_OFFERBOOK_H
+#define PBAAS_OFFERBOOK_H
+
+#include "pbaas/chaincache.h"
+#include "primitives/transaction.h"
+
+#include <memory>
+
+// an offer as it was posted, with the transaction it offers an output of
+class COpenOffer
+{
+public:
+    CTransaction postedTx;          // transaction that posted the offer
+    CTransaction offerTx;           // partial transaction that takes the offer when completed
+    CTransaction inputToOfferTx;    // transaction with the output that is offered
+
+    COpenOffer() {}
+    COpenOffer(const CTransaction &posted, const CTransaction &offer, const CTransaction &inputToOffer) :
+        postedTx(posted), offerTx(offer), inputToOfferTx(inputToOffer) {}
+
+    const COutPoint &OfferedOutput() const { return offerTx.vin[0].prevout; }
+};
+
+class COfferBook : public CChainFollowingCache
+{
+public:
+    // outputs posted to an offer key that are still unspent, ordered by outpoint, or false if the
+    // index cannot be read. all calls must hold cs_main
+    bool GetPostedOutputs(const uint160 &offerKey, std::vector<COutPoint> &postedOutputs);
+
+    // the offer posted in txid, nullptr if it is not an open, unexpired offer, or false if the
+    // posted transaction cannot be found
+    bool GetOffer(const uint256 &txid, uint32_t height, std::shared_ptr<const COpenOffer> &offer);
+
+    void Clear();
+
+protected:
+    // CValidationInterface
+    void SyncTransaction(const CTransaction &tx, const CBlock *pblock);
+
+private:
+    std::map<uint160, std::set<COutPoint>> offersByKey;                 // indexed outputs of the offers posted to each loaded key
+    std::multimap<COutPoint, uint160> keysByOutput;                     // the loaded keys each of those outputs is indexed under
+    std::map<uint256, std::shared_ptr<const COpenOffer>> offers;        // decoded offers by posted txid, nullptr once closed in a block
+    std::map<COutPoint, uint256> offersByOfferedOutput;                 // posted txid of each decoded offer by the output it offers
+
+    bool IsOpen(const std::shared_ptr<const COpenOffer> &offer, uint32_t height) const;
+};
+
+extern COfferBook OfferBook;
+
+#endif // PBAAS_OFFERBOOK_H
@@ -12,6 +12,7 @@
 
 #include "base58.h"
 #include "main.h"
+#include "pbaas/importcache.h"
 #include "rpc/pbaasrpc.h"
 #include "timedata.h"
 #include "transaction_builder.h"
@@ -5684,6 +5685,16 @@ uint160 CEthGateway::GatewayID() const
     return CCrossChainRPCData::GetID("veth@");
 }
 
+CMergeMinedSlot::CMergeMinedSlot(const uint160 &chainID, const CBlock &block) :
+    preHeaderHash(CPBaaSBlockHeader(chainID, CPBaaSPreHeader(block)).hashPreHeader)
+{
+    target.SetCompact(block.nBits);
+    if (block.GetPBaaSHeader(header, chainID) == -1)
+    {
+        header = CPBaaSBlockHeader();
+    }
+}
+
 bool CConnectedChains::RemoveMergedBlock(uint160 chainID)
 {
     bool retval = false;
@@ -5691,24 +5702,23 @@ bool CConnectedChains::RemoveMergedBlock(uint160 chainID)
 
     //printf("RemoveMergedBlock ID: %s\n", chainID.GetHex().c_str());
 
-    auto chainIt = mergeMinedChains.find(chainID);
-    if (chainIt != mergeMinedChains.end())
+    auto slotIt = mergeMinedSlots.find(chainID);
+    if (slotIt != mergeMinedSlots.end())
     {
-        arith_uint256 target;
-        target.SetCompact(chainIt->second.block.nBits);
-        std::multimap<arith_uint256, CPBaaSMergeMinedChainData *>::iterator removeIt;
-        std::multimap<arith_uint256, CPBaaSMergeMinedChainData *>::iterator nextIt = mergeMinedTargets.begin();
-        for (removeIt = nextIt; removeIt != mergeMinedTargets.end(); removeIt = nextIt)
+        // only chains with the same target need to be checked by ID
+        auto targetRange = mergeMinedTargets.equal_range(slotIt->second.target);
+        for (auto removeIt = targetRange.first; removeIt != targetRange.second; removeIt++)
         {
-            nextIt++;
-            // make sure we don't just match by target
             if (removeIt->second->GetID() == chainID)
             {
                 mergeMinedTargets.erase(removeIt);
+                break;
             }
         }
+        mergeMinedSlots.erase(slotIt);
         mergeMinedChains.erase(chainID);
-        dirty = retval = true;
+        mergeMiningGeneration++;
+        retval = true;
 
         // if we get to 0, give the thread a kick to stop waiting for mining
         //if (!mergeMinedChains.size())
@@ -5749,18 +5759,18 @@ bool CConnectedChains::AddMergedBlock(CPBaaSMergeMinedChainData &blkData)
     {
         LOCK(cs_mergemining);
 
-        arith_uint256 target;
         uint160 cID = blkData.GetID();
         auto it = mergeMinedChains.find(cID);
         if (it != mergeMinedChains.end())
         {
             RemoveMergedBlock(cID);             // remove it if already there
         }
-        target.SetCompact(blkData.block.nBits);
+        CMergeMinedSlot slot(cID, blkData.block);
 
         mergeMinedChains.insert(make_pair(cID, blkData));
-        mergeMinedTargets.insert(make_pair(target, &(mergeMinedChains[cID])));
-        dirty = true;
+        mergeMinedTargets.insert(make_pair(slot.target, &(mergeMinedChains[cID])));
+        mergeMinedSlots[cID] = slot;
+        mergeMiningGeneration++;
         dirtygbt = true;
         nextBlockTimeUpdateRequired = true;
     }
@@ -5911,13 +5921,10 @@ uint32_t CConnectedChains::GetNextBlockTime(const CBlockIndex *pindexPrev)
 // matching blocks to be found
 vector<pair<string, UniValue>> CConnectedChains::SubmitQualifiedBlocks()
 {
-    std::set<uint160> inHeader;
     bool submissionFound;
     CPBaaSMergeMinedChainData chainData;
     vector<pair<string, UniValue>>  results;
 
-    CBlockHeader bh;
-    arith_uint256 lastHash;
     CPBaaSBlockHeader pbh;
 
     do
@@ -5929,47 +5936,36 @@ vector<pair<string, UniValue>> CConnectedChains::SubmitQualifiedBlocks()
             // common, merge mined headers for notarization, drop out on any submission
             for (auto headerIt = qualifiedHeaders.begin(); !submissionFound && headerIt != qualifiedHeaders.end(); headerIt = qualifiedHeaders.begin())
             {
-                // add the PBaaS chain ids from this header to a set for search
-                for (uint32_t i = 0; headerIt->second.GetPBaaSHeader(pbh, i); i++)
-                {
-                    inHeader.insert(pbh.chainID);
-                }
-
+                // a header qualifies for the chains in it that have targets at or above its hash and whose blocks
+                // hash to what the header holds for them. of those, the one with the lowest target is submitted
                 uint160 chainID;
-                // now look through all targets that are equal to or above the hash of this header
-                for (auto chainIt = mergeMinedTargets.lower_bound(headerIt->first); !submissionFound && chainIt != mergeMinedTargets.end(); chainIt++)
+                const CMergeMinedSlot *pBestSlot = nullptr;
+                if (mergeMinedTargets.size() && headerIt->first <= mergeMinedTargets.rbegin()->first)
                 {
-                    chainID = chainIt->second->GetID();
-                    if (inHeader.count(chainID))
+                    for (uint32_t i = 0; headerIt->second.GetPBaaSHeader(pbh, i); i++)
                     {
-                        // first, check that the winning header matches the block that is there
-                        CPBaaSPreHeader preHeader(chainIt->second->block);
-                        preHeader.SetBlockData(headerIt->second);
-
-                        // check if the block header matches the block's specific data, only then can we create a submission from this block
-                        if (headerIt->second.CheckNonCanonicalData(chainID))
+                        auto slotIt = mergeMinedSlots.find(pbh.chainID);
+                        if (slotIt != mergeMinedSlots.end() &&
+                            headerIt->first <= slotIt->second.target &&
+                            pbh.hashPreHeader == slotIt->second.preHeaderHash &&
+                            (!pBestSlot || slotIt->second.target < pBestSlot->target))
                         {
-                            // save block as is, remove the block from merged headers, replace header, and submit
-                            chainData = *chainIt->second;
-
-                            *(CBlockHeader *)&chainData.block = headerIt->second;
-
-                            submissionFound = true;
+                            chainID = pbh.chainID;
+                            pBestSlot = &slotIt->second;
                         }
-                        //else // not an error condition. code is here for debugging
-                        //{
-                        //    printf("Mismatch in non-canonical data for chain %s\n", chainIt->second->chainDefinition.name.c_str());
-                        //}
                     }
-                    //else // not an error condition. code is here for debugging
-                    //{
-                    //    printf("Not found in header %s\n", chainIt->second->chainDefinition.name.c_str());
-                    //}
                 }
 
                 // if this header matched no block, discard and move to the next, otherwise, we'll drop through
-                if (submissionFound)
+                if (pBestSlot)
                 {
+                    // save block as is, replace its header with the winning one, filled with the block's data, and submit
+                    chainData = mergeMinedChains[chainID];
+                    CPBaaSPreHeader preHeader(chainData.block);
+                    preHeader.SetBlockData(headerIt->second);
+                    *(CBlockHeader *)&chainData.block = headerIt->second;
+                    submissionFound = true;
+
                     // once it is going to be submitted, remove block from this chain until a new one is added again
                     RemoveMergedBlock(chainID);
                     break;
@@ -6016,67 +6012,79 @@ vector<pair<string, UniValue>> CConnectedChains::SubmitQualifiedBlocks()
 // add all merge mined chain PBaaS headers into the blockheader and return the easiest nBits target in the header
 uint32_t CConnectedChains::CombineBlocks(CBlockHeader &bh)
 {
-    vector<uint160> inHeader;
-    vector<UniValue> toCombine;
-    arith_uint256 blkHash = UintToArith256(bh.GetHash());
     arith_uint256 target(0);
     target.SetCompact(bh.nBits);
 
-    CPBaaSBlockHeader pbh;
-
     {
         LOCK(cs_mergemining);
 
-        CPBaaSSolutionDescriptor descr = CVerusSolutionVector::solutionTools.GetDescriptor(bh.nSolution);
+        // the same requirement AddUpdatePBaaSHeader has for a block to take PBaaS headers
+        bool canAddHeaders = bh.nVersion == CBlockHeader::VERUS_V2 &&
+                             CConstVerusSolutionVector::Version(bh.nSolution) >= CActivationHeight::ACTIVATE_PBAAS_HEADER;
 
-        for (uint32_t i = 0; i < descr.numPBaaSHeaders; i++)
+        // headers already in the block only change if the chain's block has. those of chains no longer merge mined
+        // are removed, which moves the last header into their place, so this goes from the last to the first
+        std::set<uint160> inHeader;
+        CPBaaSBlockHeader pbh;
+        for (int32_t i = bh.NumPBaaSHeaders() - 1; i >= 0; i--)
         {
-            if (bh.GetPBaaSHeader(pbh, i))
+            if (!bh.GetPBaaSHeader(pbh, (uint32_t)i))
             {
-                inHeader.push_back(pbh.chainID);
+                continue;
+            }
+            if (pbh.chainID == ASSETCHAINS_CHAINID)
+            {
+                inHeader.insert(pbh.chainID);
+                continue;
             }
-        }
 
-        // loop through the existing PBaaS chain ids in the header
-        // remove any that are not either this Chain ID or in our local collection and then add all that are present
-        for (uint32_t i = 0; i < inHeader.size(); i++)
-        {
-            auto it = mergeMinedChains.find(inHeader[i]);
-            if (inHeader[i] != ASSETCHAINS_CHAINID && (it == mergeMinedChains.end()))
+            auto slotIt = mergeMinedSlots.find(pbh.chainID);
+            if (slotIt == mergeMinedSlots.end() || slotIt->second.header.IsNull())
             {
                 bh.DeletePBaaSHeader(i);
+                continue;
+            }
+            if (pbh.hashPreHeader != slotIt->second.header.hashPreHeader)
+            {
+                pbh = slotIt->second.header;
+                if (!bh.SavePBaaSHeader(pbh, i))
+                {
+                    // a stale header would not be accepted by its chain
+                    LogPrintf("Failure to update PBaaS block header for %s chain\n", EncodeDestination(CIdentityID(pbh.chainID)).c_str());
+                    bh.DeletePBaaSHeader(i);
+                    continue;
+                }
+            }
+            inHeader.insert(pbh.chainID);
+            if (slotIt->second.target > target)
+            {
+                target = slotIt->second.target;
             }
         }
 
-        for (auto chain : mergeMinedChains)
+        for (auto &oneSlot : mergeMinedSlots)
         {
-            // get the native PBaaS header for each chain and put it into the
-            // header we are given
-            // it must have itself in as a PBaaS header
-            uint160 cid = chain.second.GetID();
-            if (chain.second.block.GetPBaaSHeader(pbh, cid) != -1)
+            if (inHeader.count(oneSlot.first))
             {
-                if (!bh.AddUpdatePBaaSHeader(pbh))
-                {
-                    LogPrintf("Failure to add PBaaS block header for %s chain\n", chain.second.chainDefinition.name.c_str());
-                    break;
-                }
-                else
-                {
-                    arith_uint256 t;
-                    t.SetCompact(chain.second.block.nBits);
-                    if (t > target)
-                    {
-                        target = t;
-                    }
-                }
+                continue;
             }
-            else
+
+            // a block must have itself in as a PBaaS header
+            const std::string &chainName = mergeMinedChains[oneSlot.first].chainDefinition.name;
+            if (oneSlot.second.header.IsNull())
+            {
+                LogPrintf("Merge mined block for %s does not contain PBaaS information\n", chainName.c_str());
+            }
+            else if (!canAddHeaders || bh.AddPBaaSHeader(oneSlot.second.header) == -1)
+            {
+                LogPrintf("Failure to add PBaaS block header for %s chain\n", chainName.c_str());
+                break;
+            }
+            else if (oneSlot.second.target > target)
             {
-                LogPrintf("Merge mined block for %s does not contain PBaaS information\n", chain.second.chainDefinition.name.c_str());
+                target = oneSlot.second.target;
             }
         }
-        dirty = false;
     }
 
     saveBits = target.GetCompact();
@@ -7721,7 +7729,7 @@ bool CConnectedChains::CreateLatestImports(const CCurrencyDefinition &sourceSyst
                 continue;
             }
 
-            if (proofNotarization.proofRoots[sourceSystemID].stateRoot != oneIT.first.second.CheckPartialTransaction(exportTx, nullptr, ConnectedChains.ShouldOptimizeETHProof()))
+            if (proofNotarization.proofRoots[sourceSystemID].stateRoot != ProofVerificationCache.CheckPartialTransaction(oneIT.first.second, exportTx, nullptr, ConnectedChains.ShouldOptimizeETHProof()))
             {
                 LogPrintf("%s: export tx %s fails verification\n", __func__, oneIT.first.first.txIn.prevout.hash.GetHex().c_str());
                 continue;
@@ -8179,19 +8187,45 @@ bool CConnectedChains::CreateLatestImports(const CCurrencyDefinition &sourceSyst
         }
         else
         {
-            if (!lastNotarization.NextNotarizationInfo(sourceSystemDef,
-                                                       destCur,
-                                                       ccx.sourceHeightStart,
-                                                       nextHeight,
-                                                       exportTransfers,
-                                                       transferHash,
-                                                       newNotarization,
-                                                       newOutputs,
-                                                       importedCurrency,
-                                                       gatewayDepositsUsed,
-                                                       spentCurrencyOut,
-                                                       ccx.exporter,
-                                                       ccx.IsClearLaunch()))
+            // if this export was already taken to its next state from the same inputs on this tip, the
+            // earlier result is used rather than converting and pricing all of its transfers again
+            CUTXORef exportOut(oneIT.first.first.txIn.prevout.hash, oneIT.first.first.txIn.prevout.n);
+            uint256 stageHash = CImportStageCache::StageInputHash(lastNotarization,
+                                                                  sourceSystemDef,
+                                                                  destCur,
+                                                                  ccx.sourceHeightStart,
+                                                                  nextHeight,
+                                                                  exportTransfers,
+                                                                  ccx.exporter,
+                                                                  ccx.IsClearLaunch());
+            CImportStage stage;
+            if (!ImportStages.GetStage(exportOut, stageHash, stage))
+            {
+                stage.exportTransfers = exportTransfers;
+                stage.isValid = lastNotarization.NextNotarizationInfo(sourceSystemDef,
+                                                                      destCur,
+                                                                      ccx.sourceHeightStart,
+                                                                      nextHeight,
+                                                                      stage.exportTransfers,
+                                                                      stage.transferHash,
+                                                                      stage.newNotarization,
+                                                                      stage.importOutputs,
+                                                                      stage.importedCurrency,
+                                                                      stage.gatewayDepositsUsed,
+                                                                      stage.spentCurrencyOut,
+                                                                      ccx.exporter,
+                                                                      ccx.IsClearLaunch());
+                ImportStages.SetStage(exportOut, stageHash, stage);
+            }
+            exportTransfers = stage.exportTransfers;
+            transferHash = stage.transferHash;
+            newNotarization = stage.newNotarization;
+            newOutputs = stage.importOutputs;
+            importedCurrency = stage.importedCurrency;
+            gatewayDepositsUsed = stage.gatewayDepositsUsed;
+            spentCurrencyOut = stage.spentCurrencyOut;
+
+            if (!stage.isValid)
             {
                 LogPrintf("%s: invalid export for currency %s on system %s\n", __func__, destCur.name.c_str(), EncodeDestination(CIdentityID(destCur.systemID)).c_str());
                 failedCurrencyDest = ccx.destCurrencyID;
@@ -9678,16 +9712,12 @@ std::vector<ChainTransferData> CConnectedChains::CalcTxInputs(const CCurrencyDef
 
     bool isPrelaunch = (isClearLaunchExport || (_curDef.launchSystemID == ASSETCHAINS_CHAINID && sinceHeight + 1 < _curDef.startBlock));
 
+    // transfers at or below sinceHeight have already been exported
     std::multimap<uint32_t, ChainTransferData>::const_iterator it;
-    for (it = _txInputs.begin(); it != _txInputs.end(); it++)
+    for (it = _txInputs.upper_bound(sinceHeight); it != _txInputs.end(); it++)
     {
         auto &oneInput = *it;
 
-        if (oneInput.first <= sinceHeight)
-        {
-            continue;
-        }
-
         if (addHeight != oneInput.first)
         {
             // if this is a launch export, we create one at the boundary
@@ -11372,7 +11402,7 @@ GetPendingExports(const CCurrencyDefinition &sourceChain,
                     !txProof.GetPartialTransaction(exportTx).IsNull() &&
                     txProof.TransactionHash() == exportTxId &&
                     proofRootIt != lastConfirmed.proofRoots.end() &&
-                    proofRootIt->second.stateRoot == txProof.CheckPartialTransaction(exportTx) &&
+                    proofRootIt->second.stateRoot == ProofVerificationCache.CheckPartialTransaction(txProof, exportTx) &&
                     exportTx.vout.size() > exportTxOutNum))
             {
                 LogPrint("notarization", "%s: proofRoot: %s,\nGetPartialTransaction: %s, checkPartialTransaction: %s, TransactionHash: %s, exportTxId: %s,\nproofheight: %u,\nischainproof: %s,\nblockhash: %s\n",
@@ -953,6 +953,18 @@ public:
     {}
 };
 
+// what merge mining needs of a chain's block, computed once when the block is added
+class CMergeMinedSlot
+{
+public:
+    arith_uint256 target;                   // target of the block
+    CPBaaSBlockHeader header;               // the block's own PBaaS header, null if it has none
+    uint256 preHeaderHash;                  // what a winning header's slot for the chain must hold
+
+    CMergeMinedSlot() {}
+    CMergeMinedSlot(const uint160 &chainID, const CBlock &block);
+};
+
 class CConnectedChains
 {
 protected:
@@ -963,6 +975,8 @@ public:
     CBlock lastBlock;
     std::map<uint160, CPBaaSMergeMinedChainData> mergeMinedChains;
     std::multimap<arith_uint256, CPBaaSMergeMinedChainData *> mergeMinedTargets;
+    std::map<uint160, CMergeMinedSlot> mergeMinedSlots;
+    uint64_t mergeMiningGeneration;             // changes with every block added or removed
 
     uint32_t nextBlockTime;
     bool nextBlockTimeUpdateRequired;
@@ -985,7 +999,6 @@ public:
     CBlock earnedNotarizationBlock;
     int32_t earnedNotarizationIndex;            // index of earned notarization in block
 
-    bool dirty;
     bool dirtygbt;
     bool lastSubmissionFailed;                  // if we submit a failed block, make another
 
@@ -997,19 +1010,19 @@ public:
     CSemaphore sem_submitthread;
 
     CConnectedChains() :
+        lastBlockHeight(0),
+        mergeMiningGeneration(0),
+        nextBlockTime(0),
+        nextBlockTimeUpdateRequired(0),
         currencyDefCache(3000, 0.1F, false),
         currencyStateCache(1000, 0.1F, false),
-        lastBlockHeight(0),
         readyToStart(false),
         earnedNotarizationHeight(0),
         earnedNotarizationIndex(0),
-        dirty(false),
         dirtygbt(false),
-        saveBits(0),
         lastSubmissionFailed(false),
-        sem_submitthread(0),
-        nextBlockTime(0),
-        nextBlockTimeUpdateRequired(0) {}
+        saveBits(0),
+        sem_submitthread(0) {}
 
     uint32_t SetNextBlockTime(uint32_t NextBlockTime);
     uint32_t GetNextBlockTime(const CBlockIndex *pindexPrev);
@@ -1026,6 +1039,13 @@ public:
         }
     }
 
+    // miners rebuild their merged headers whenever this changes from what they last combined
+    uint64_t MergeMiningGeneration()
+    {
+        LOCK(cs_mergemining);
+        return mergeMiningGeneration;
+    }
+
     void SubmissionThread();
     static void SubmissionThreadStub();
     std::vector<std::pair<std::string, UniValue>> SubmitQualifiedBlocks();
@@ -10,6 +10,7 @@
 
 #include "main.h"
 #include "pbaas/pbaas.h"
+#include "pbaas/importcache.h"
 #include "pbaas/reserves.h"
 #include "pbaas/notarization.h"
 #include "rpc/pbaasrpc.h"
@@ -17,6 +18,8 @@
 #include "key_io.h"
 #include <random>
 
+#include <boost/multiprecision/cpp_int.hpp>
+
 LRUCache<CUTXORef, std::tuple<int, CCrossChainExport, CPBaaSNotarization, std::vector<CReserveTransfer>, CCurrencyDefinition::EProofProtocol>>
     CCrossChainExport::exportInfoCache(200, 0.1F, false);
 
@@ -621,7 +624,10 @@ bool CCrossChainImport::GetImportInfo(const CTransaction &importTx,
 
                 if (!(transactionProof.evidence.chainObjects.size() &&
                     importNotarization.proofRoots[pBaseImport->sourceSystemID].stateRoot ==
-                        ((CChainObject<CPartialTransactionProof> *)transactionProof.evidence.chainObjects[0])->object.CheckPartialTransaction(exportTx, &isPartial, optimizeETHProof) &&
+                        ProofVerificationCache.CheckPartialTransaction(((CChainObject<CPartialTransactionProof> *)transactionProof.evidence.chainObjects[0])->object,
+                                                                       exportTx,
+                                                                       &isPartial,
+                                                                       optimizeETHProof) &&
                     ((CChainObject<CPartialTransactionProof> *)transactionProof.evidence.chainObjects[0])->object.TransactionHash() == pBaseImport->exportTxId &&
                     exportTx.vout.size() > pBaseImport->exportTxOutNum &&
                     exportTx.vout[pBaseImport->exportTxOutNum].scriptPubKey.IsPayToCryptoCondition(p) &&
@@ -1884,7 +1890,7 @@ CCoinbaseCurrencyState::CCoinbaseCurrencyState(const UniValue &obj) : CCurrencyS
     }
 }
 
-CAmount CalculateFractionalOut(CAmount NormalizedReserveIn, CAmount Supply, CAmount NormalizedReserve, int32_t reserveRatio)
+CAmount CalculateFractionalOutDecimal(CAmount NormalizedReserveIn, CAmount Supply, CAmount NormalizedReserve, int32_t reserveRatio)
 {
     static cpp_dec_float_50 one("1");
     static cpp_dec_float_50 bigSatoshi("100000000");
@@ -1915,7 +1921,7 @@ CAmount CalculateFractionalOut(CAmount NormalizedReserveIn, CAmount Supply, CAmo
     return fractionalOut;
 }
 
-CAmount CalculateReserveOut(CAmount FractionalIn, CAmount Supply, CAmount NormalizedReserve, int32_t reserveRatio)
+CAmount CalculateReserveOutDecimal(CAmount FractionalIn, CAmount Supply, CAmount NormalizedReserve, int32_t reserveRatio)
 {
     static cpp_dec_float_50 one("1");
     static cpp_dec_float_50 bigSatoshi("100000000");
@@ -1947,6 +1953,172 @@ CAmount CalculateReserveOut(CAmount FractionalIn, CAmount Supply, CAmount Normal
 }
 
 
+// Conversions in unsigned fixed point with 128 fraction bits, held in 512 bit integers so that
+// products of two values never overflow. Within the ratios and amounts the fixed point versions
+// accept, their error stays below 2^-48 of a satoshi. Any result within CONVERSION_FIXED_MARGIN
+// of a whole satoshi is left to the decimal functions, so results truncate the same as theirs.
+typedef boost::multiprecision::uint512_t conversion_fixed_t;
+
+static const int CONVERSION_FIXED_BITS = 128;
+static const conversion_fixed_t CONVERSION_FIXED_ONE = conversion_fixed_t(1) << CONVERSION_FIXED_BITS;
+static const conversion_fixed_t CONVERSION_FIXED_MARGIN = conversion_fixed_t(1) << (CONVERSION_FIXED_BITS - 32);
+// steps of the tables that reduce arguments of the ln and exp series
+static const int CONVERSION_TABLE_STEPS = 64;
+
+static conversion_fixed_t FixedMul(const conversion_fixed_t &a, const conversion_fixed_t &b)
+{
+    return (a * b) >> CONVERSION_FIXED_BITS;
+}
+
+// ln(m) for m in [1, 2], as 2 * atanh((m - 1) / (m + 1))
+static conversion_fixed_t FixedLnSeries(const conversion_fixed_t &m)
+{
+    conversion_fixed_t z = ((m - CONVERSION_FIXED_ONE) << CONVERSION_FIXED_BITS) / (m + CONVERSION_FIXED_ONE);
+    conversion_fixed_t z2 = FixedMul(z, z);
+    conversion_fixed_t term = z, sum = 0;
+    for (int i = 1; term != 0; i += 2)
+    {
+        sum += term / i;
+        term = FixedMul(term, z2);
+    }
+    return sum << 1;
+}
+
+// exp(r) for r in [0, 1)
+static conversion_fixed_t FixedExpSeries(const conversion_fixed_t &r)
+{
+    conversion_fixed_t term = CONVERSION_FIXED_ONE, sum = CONVERSION_FIXED_ONE;
+    for (int n = 1; term != 0; n++)
+    {
+        term = FixedMul(term, r) / n;
+        sum += term;
+    }
+    return sum;
+}
+
+struct CConversionTables
+{
+    conversion_fixed_t ln2;
+    conversion_fixed_t ln[CONVERSION_TABLE_STEPS];      // ln(1 + j / CONVERSION_TABLE_STEPS)
+    conversion_fixed_t exp[CONVERSION_TABLE_STEPS];     // exp(j / CONVERSION_TABLE_STEPS)
+
+    CConversionTables()
+    {
+        ln2 = FixedLnSeries(CONVERSION_FIXED_ONE << 1);
+        for (int j = 0; j < CONVERSION_TABLE_STEPS; j++)
+        {
+            ln[j] = FixedLnSeries(CONVERSION_FIXED_ONE + CONVERSION_FIXED_ONE * j / CONVERSION_TABLE_STEPS);
+            exp[j] = FixedExpSeries(CONVERSION_FIXED_ONE * j / CONVERSION_TABLE_STEPS);
+        }
+    }
+};
+
+static const CConversionTables &ConversionTables()
+{
+    static const CConversionTables tables;
+    return tables;
+}
+
+// ln(a / b) for a >= b > 0
+static conversion_fixed_t FixedLnRatio(int64_t a, int64_t b)
+{
+    const CConversionTables &tables = ConversionTables();
+    conversion_fixed_t x = (conversion_fixed_t(a) << CONVERSION_FIXED_BITS) / b;
+
+    // x = 2^k * (1 + j / steps) * m, with m in [1, 1 + 1 / steps)
+    int k = boost::multiprecision::msb(x) - CONVERSION_FIXED_BITS;
+    conversion_fixed_t m = x >> k;
+    int j = (int)(((m - CONVERSION_FIXED_ONE) * CONVERSION_TABLE_STEPS) >> CONVERSION_FIXED_BITS);
+    m = m * CONVERSION_TABLE_STEPS / (CONVERSION_TABLE_STEPS + j);
+    return tables.ln2 * k + tables.ln[j] + FixedLnSeries(m);
+}
+
+// exp(t) as 2^k * exp(r), with k returned separately, so callers can shift either way
+static conversion_fixed_t FixedExpReduced(const conversion_fixed_t &t, conversion_fixed_t &k)
+{
+    const CConversionTables &tables = ConversionTables();
+    k = t / tables.ln2;
+    conversion_fixed_t r = t - tables.ln2 * k;
+
+    // r = j / steps + s, with s in [0, 1 / steps)
+    int j = (int)((r * CONVERSION_TABLE_STEPS) >> CONVERSION_FIXED_BITS);
+    r -= CONVERSION_FIXED_ONE * j / CONVERSION_TABLE_STEPS;
+    return FixedMul(tables.exp[j], FixedExpSeries(r));
+}
+
+// truncates a fixed point amount the way CCurrencyState::to_int64 truncates, or returns false if it is too
+// close to a whole satoshi or too large to be sure of the result
+static bool FixedToAmount(const conversion_fixed_t &amount, CAmount &out)
+{
+    conversion_fixed_t fraction = amount & (CONVERSION_FIXED_ONE - 1);
+    conversion_fixed_t whole = amount >> CONVERSION_FIXED_BITS;
+    if (fraction < CONVERSION_FIXED_MARGIN || fraction > CONVERSION_FIXED_ONE - CONVERSION_FIXED_MARGIN ||
+        whole >= (conversion_fixed_t(1) << 62))
+    {
+        return false;
+    }
+    out = (CAmount)whole;
+    return true;
+}
+
+CAmount CalculateFractionalOut(CAmount NormalizedReserveIn, CAmount Supply, CAmount NormalizedReserve, int32_t reserveRatio)
+{
+    if (!NormalizedReserveIn)
+    {
+        return 0;
+    }
+    CAmount supply = Supply ? Supply : 1;
+    CAmount reserve = NormalizedReserve ? NormalizedReserve : 1;
+
+    // supply * ((1 + reservein / reserve) ^ ratio - 1)
+    CAmount fractionalOut;
+    if (NormalizedReserveIn > 0 && supply > 0 && reserve > 0 &&
+        NormalizedReserveIn <= INT64_MAX - reserve &&
+        reserveRatio >= CCurrencyState::MIN_RESERVE_RATIO && reserveRatio <= CCurrencyState::MAX_RESERVE_RATIO)
+    {
+        conversion_fixed_t t = FixedLnRatio(reserve + NormalizedReserveIn, reserve) * reserveRatio / CCurrencyState::MAX_RESERVE_RATIO;
+        conversion_fixed_t k;
+        conversion_fixed_t power = FixedExpReduced(t, k);
+        if (k < 62)
+        {
+            power <<= (unsigned)k;
+            if (power >= CONVERSION_FIXED_ONE &&
+                FixedToAmount(supply * (power - CONVERSION_FIXED_ONE), fractionalOut))
+            {
+                return fractionalOut;
+            }
+        }
+    }
+    return CalculateFractionalOutDecimal(NormalizedReserveIn, Supply, NormalizedReserve, reserveRatio);
+}
+
+CAmount CalculateReserveOut(CAmount FractionalIn, CAmount Supply, CAmount NormalizedReserve, int32_t reserveRatio)
+{
+    if (!FractionalIn)
+    {
+        return 0;
+    }
+    CAmount supply = Supply ? Supply : 1;
+    CAmount reserve = NormalizedReserve ? NormalizedReserve : 1;
+
+    // reserve * (1 - (1 - fractionalin / supply) ^ (1 / ratio)), where the power is exp(-ln(supply / (supply - fractionalin)) / ratio)
+    CAmount reserveOut;
+    if (FractionalIn > 0 && FractionalIn < supply && reserve > 0 &&
+        reserveRatio >= CCurrencyState::MIN_RESERVE_RATIO && reserveRatio <= CCurrencyState::MAX_RESERVE_RATIO)
+    {
+        conversion_fixed_t t = FixedLnRatio(supply, supply - FractionalIn) * CCurrencyState::MAX_RESERVE_RATIO / reserveRatio;
+        conversion_fixed_t k;
+        conversion_fixed_t power = FixedExpReduced(t, k);
+        power = k < CONVERSION_FIXED_BITS ? ((CONVERSION_FIXED_ONE << CONVERSION_FIXED_BITS) / power) >> (unsigned)k : 0;
+        if (FixedToAmount(reserve * (CONVERSION_FIXED_ONE - power), reserveOut))
+        {
+            return reserveOut;
+        }
+    }
+    return CalculateReserveOutDecimal(FractionalIn, Supply, NormalizedReserve, reserveRatio);
+}
+
+
 void DumpConvertData(const std::vector<CAmount> &_inputReserves,
                      const std::vector<CAmount> &_inputFractional,
                      CCurrencyState &_newState,
@@ -1933,4 +1933,11 @@ bool PrecheckFeePool(const CTransaction &tx, int32_t outNum, CValidationState &s
 bool PrecheckReserveTransfer(const CTransaction &tx, int32_t outNum, CValidationState &state, uint32_t height);
 bool PrecheckReserveDeposit(const CTransaction &tx, int32_t outNum, CValidationState &state, uint32_t height);
 
+// conversions of one reserve layer, computed in fixed point and only falling back to the decimal versions
+// when a result is too close to a whole satoshi to be sure it truncates the same way
+CAmount CalculateFractionalOut(CAmount NormalizedReserveIn, CAmount Supply, CAmount NormalizedReserve, int32_t reserveRatio);
+CAmount CalculateReserveOut(CAmount FractionalIn, CAmount Supply, CAmount NormalizedReserve, int32_t reserveRatio);
+CAmount CalculateFractionalOutDecimal(CAmount NormalizedReserveIn, CAmount Supply, CAmount NormalizedReserve, int32_t reserveRatio);
+CAmount CalculateReserveOutDecimal(CAmount FractionalIn, CAmount Supply, CAmount NormalizedReserve, int32_t reserveRatio);
+
 #endif // PBAAS_RESERVES_H
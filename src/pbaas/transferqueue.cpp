@@ -0,0 +1,157 @@
+// Copyright (c) 2026 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#include "pbaas/transferqueue.h"
+
+#include "cc/CCinclude.h"
+#include "main.h"
+
+CPendingTransferQueue PendingTransfers;
+
+bool CPendingTransferQueue::DecodeTransfer(const CTxOut &output, const COutPoint &outPoint, uint32_t height, uint160 &destID, ChainTransferData &transfer)
+{
+    COptCCParams p;
+    COptCCParams m;
+    CReserveTransfer rt;
+    if (output.scriptPubKey.IsPayToCryptoCondition(p) &&
+        p.evalCode == EVAL_RESERVE_TRANSFER &&
+        p.vData.size() &&
+        p.version >= p.VERSION_V3 &&
+        (m = COptCCParams(p.vData.back())).IsValid() &&
+        (rt = CReserveTransfer(p.vData[0])).IsValid() &&
+        !(destID = rt.GetImportCurrency()).IsNull())
+    {
+        transfer = ChainTransferData(height, CInputDescriptor(output.scriptPubKey, output.nValue, CTxIn(outPoint)), rt);
+        return true;
+    }
+    return false;
+}
+
+bool CPendingTransferQueue::GetTransfers(const uint160 &destID, std::vector<ChainTransferData> &transfers, uint32_t afterHeight)
+{
+    AssertLockHeld(cs_main);
+    CheckTip();
+
+    if (!Load())
+    {
+        return false;
+    }
+
+    auto destIt = transfersByDest.find(destID);
+    if (destIt != transfersByDest.end())
+    {
+        for (auto it = destIt->second.lower_bound(std::make_pair(afterHeight + 1, COutPoint(uint256(), 0))); it != destIt->second.end(); it++)
+        {
+            transfers.push_back(it->second);
+        }
+    }
+    return true;
+}
+
+bool CPendingTransferQueue::GetAllTransfers(std::multimap<uint160, ChainTransferData> &transfers)
+{
+    AssertLockHeld(cs_main);
+    CheckTip();
+
+    if (!Load())
+    {
+        return false;
+    }
+
+    for (auto &oneDest : transfersByDest)
+    {
+        for (auto &oneTransfer : oneDest.second)
+        {
+            transfers.insert(std::make_pair(oneDest.first, oneTransfer.second));
+        }
+    }
+    return true;
+}
+
+void CPendingTransferQueue::AddTransfer(const uint160 &destID, const ChainTransferData &transfer)
+{
+    const COutPoint &output = std::get<1>(transfer).txIn.prevout;
+    uint32_t height = std::get<0>(transfer);
+    transfersByDest[destID][std::make_pair(height, output)] = transfer;
+    destByOutput[output] = std::make_pair(destID, height);
+}
+
+bool CPendingTransferQueue::Load()
+{
+    if (fLoaded)
+    {
+        return true;
+    }
+
+    std::vector<CAddressUnspentDbEntry> unspentOutputs;
+    if (!GetAddressUnspent(CReserveTransfer::ReserveTransferKey(), CScript::P2IDX, unspentOutputs))
+    {
+        return false;
+    }
+
+    for (auto &oneOutput : unspentOutputs)
+    {
+        uint160 destID;
+        ChainTransferData transfer;
+        if (DecodeTransfer(CTxOut(oneOutput.second.satoshis, oneOutput.second.script),
+                           COutPoint(oneOutput.first.txhash, oneOutput.first.index),
+                           oneOutput.second.blockHeight,
+                           destID,
+                           transfer))
+        {
+            AddTransfer(destID, transfer);
+        }
+    }
+    fLoaded = true;
+    return true;
+}
+
+void CPendingTransferQueue::Clear()
+{
+    transfersByDest.clear();
+    destByOutput.clear();
+    fLoaded = false;
+}
+
+void CPendingTransferQueue::SyncTransaction(const CTransaction &tx, const CBlock *pblock)
+{
+    // only confirmed transfers are queued
+    if (!pblock)
+    {
+        return;
+    }
+
+    LOCK(cs_main);
+    if (!fLoaded)
+    {
+        return;
+    }
+
+    // exports and refunds dequeue the transfers they spend
+    for (auto &oneIn : tx.vin)
+    {
+        auto outIt = destByOutput.find(oneIn.prevout);
+        if (outIt != destByOutput.end())
+        {
+            auto destIt = transfersByDest.find(outIt->second.first);
+            destIt->second.erase(std::make_pair(outIt->second.second, oneIn.prevout));
+            if (destIt->second.empty())
+            {
+                transfersByDest.erase(destIt);
+            }
+            destByOutput.erase(outIt);
+        }
+    }
+
+    const uint256 &txid = tx.GetHash();
+    for (int i = 0; i < tx.vout.size(); i++)
+    {
+        uint160 destID;
+        ChainTransferData transfer;
+        if (DecodeTransfer(tx.vout[i], COutPoint(txid, i), pblock->GetHeight(), destID, transfer))
+        {
+            AddTransfer(destID, transfer);
+        }
+    }
+}
@@ -0,0 +1,52 @@
+// Copyright (c) 2026 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+/*
+ * Confirmed reserve transfers that have not yet been aggregated into an export, queued by the currency
+ * they import into. The queue is read from the unspent index the first time it is needed, and from then
+ * on, connected blocks add the transfers they make and remove those their exports spend. Each destination
+ * keeps its transfers in order of height and output, which is the order exports consume them in, so
+ * callers can start from the first transfer after the last export instead of walking all of them.
+ * Transfers in the mempool are not queued, and are added by callers that need them.
+ */
+
+#ifndef PBAAS_TRANSFERQUEUE_H
+#define PBAAS_TRANSFERQUEUE_H
+
+#include "pbaas/chaincache.h"
+#include "pbaas/pbaas.h"
+
+class CPendingTransferQueue : public CChainFollowingCache
+{
+public:
+    // decodes an output as a pending reserve transfer, with the currency it imports into
+    static bool DecodeTransfer(const CTxOut &output, const COutPoint &outPoint, uint32_t height, uint160 &destID, ChainTransferData &transfer);
+
+    // confirmed transfers to destID above afterHeight, in order of height and output. returns false if
+    // the index cannot be read. all calls must hold cs_main
+    bool GetTransfers(const uint160 &destID, std::vector<ChainTransferData> &transfers, uint32_t afterHeight=0);
+
+    // confirmed transfers to all destinations, grouped by destination and otherwise ordered as above
+    bool GetAllTransfers(std::multimap<uint160, ChainTransferData> &transfers);
+
+    void Clear();
+
+protected:
+    // CValidationInterface
+    void SyncTransaction(const CTransaction &tx, const CBlock *pblock);
+
+private:
+    typedef std::map<std::pair<uint32_t, COutPoint>, ChainTransferData> TransferMap;
+
+    bool fLoaded = false;
+    std::map<uint160, TransferMap> transfersByDest;
+    std::map<COutPoint, std::pair<uint160, uint32_t>> destByOutput;        // destination and height of each queued output
+
+    void AddTransfer(const uint160 &destID, const ChainTransferData &transfer);
+    bool Load();
+};
+
+extern CPendingTransferQueue PendingTransfers;
+
+#endif // PBAAS_TRANSFERQUEUE_H
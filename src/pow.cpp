@@ -295,7 +295,7 @@ uint32_t lwmaGetNextPOSRequired(const CBlockIndex* pindexLast, const Consensus::
             return nProofOfStakeDefault;
         }
 
-        CBlockHeader hdr = pindexFirst->GetBlockHeader();
+        CBlockHeader hdr = pindexFirst->GetPOSHeader();
 
         if (hdr.IsVerusPOSBlock())
         {
@@ -323,7 +323,7 @@ uint32_t lwmaGetNextPOSRequired(const CBlockIndex* pindexLast, const Consensus::
                 return nProofOfStakeDefault;
             }
 
-            CBlockHeader hdr = pindexFirst->GetBlockHeader();
+            CBlockHeader hdr = pindexFirst->GetPOSHeader();
             if (hdr.IsVerusPOSBlock())
             {
                 nBits = hdr.GetVerusPOSTarget();
@@ -580,7 +580,8 @@ CChainPower GetBlockProof(const CBlockIndex& block)
     if (fNegative || fOverflow || bnWorkTarget == 0)
         return CChainPower(0);
 
-    CBlockHeader header = block.GetBlockHeader();
+    // only the version and nonce are needed to check for and read a POS target
+    CBlockHeader header = block.GetPOSHeader();
 
     // if POS block, add stake
     if (!Params().GetConsensus().NetworkUpgradeActive(block.GetHeight(), Consensus::UPGRADE_SAPLING) || !header.IsVerusPOSBlock())
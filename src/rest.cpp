@@ -154,7 +154,10 @@ static bool rest_headers(HTTPRequest* req,
 
     CDataStream ssHeader(SER_NETWORK, PROTOCOL_VERSION);
     BOOST_FOREACH(const CBlockIndex *pindex, headers) {
-        ssHeader << pindex->GetBlockHeader();
+        CBlockHeader header;
+        if (!pindex->GetBlockHeader(header))
+            return RESTERR(req, HTTP_INTERNAL_SERVER_ERROR, pindex->GetBlockHash().GetHex() + " header not available");
+        ssHeader << header;
     }
 
     switch (rf) {
@@ -14,6 +14,7 @@
 #include "key_io.h"
 #include "main.h"
 #include "primitives/transaction.h"
+#include "rpc/jsonstream.h"
 #include "rpc/server.h"
 #include "streams.h"
 #include "sync.h"
@@ -116,11 +117,12 @@ UniValue blockheaderToJSON(const CBlockIndex* blockindex)
         return(result);
     }
     result.push_back(Pair("hash", blockindex->GetBlockHash().GetHex()));
-    result.push_back(Pair("calchash", blockindex->GetBlockHeader().GetHash().GetHex()));
+    CBlockHeader block;
+    if (!blockindex->GetBlockHeader(block))
+        throw JSONRPCError(RPC_DATABASE_ERROR, "Cannot read block header solution");
+    result.push_back(Pair("calchash", block.GetHash().GetHex()));
     int confirmations = -1;
 
-    CBlockHeader block = blockindex->GetBlockHeader();
-
     if (block.IsVerusPOSBlock())
     {
         result.push_back(Pair("validationtype", "stake"));
@@ -147,7 +149,7 @@ UniValue blockheaderToJSON(const CBlockIndex* blockindex)
     result.push_back(Pair("finalsaplingroot", blockindex->hashFinalSaplingRoot.GetHex()));
     result.push_back(Pair("time", (int64_t)blockindex->nTime));
     result.push_back(Pair("nonce", blockindex->nNonce.GetHex()));
-    result.push_back(Pair("solution", HexStr(blockindex->nSolution.nSolution())));
+    result.push_back(Pair("solution", HexStr(block.nSolution)));
     result.push_back(Pair("bits", strprintf("%08x", blockindex->nBits)));
     result.push_back(Pair("difficulty", GetDifficulty(blockindex)));
     result.push_back(Pair("chainwork", blockindex->chainPower.chainWork.GetHex()));
@@ -460,6 +462,33 @@ bool myIsutxo_spentinmempool(uint256 txid,int32_t vout)
     return(false);
 }
 
+static UniValue MempoolEntryToJSON(const CTxMemPoolEntry& e)
+{
+    UniValue info(UniValue::VOBJ);
+    info.push_back(Pair("size", (int)e.GetTxSize()));
+    info.push_back(Pair("fee", ValueFromAmount(e.GetFee())));
+    info.push_back(Pair("time", e.GetTime()));
+    info.push_back(Pair("height", (int)e.GetHeight()));
+    info.push_back(Pair("startingpriority", e.GetPriority(e.GetHeight())));
+    info.push_back(Pair("currentpriority", e.GetPriority(chainActive.Height())));
+    const CTransaction& tx = e.GetTx();
+    set<string> setDepends;
+    BOOST_FOREACH(const CTxIn& txin, tx.vin)
+    {
+        if (mempool.exists(txin.prevout.hash))
+            setDepends.insert(txin.prevout.hash.ToString());
+    }
+
+    UniValue depends(UniValue::VARR);
+    BOOST_FOREACH(const string& dep, setDepends)
+    {
+        depends.push_back(dep);
+    }
+
+    info.push_back(Pair("depends", depends));
+    return info;
+}
+
 UniValue mempoolToJSON(bool fVerbose = false)
 {
     if (fVerbose)
@@ -468,30 +497,7 @@ UniValue mempoolToJSON(bool fVerbose = false)
         UniValue o(UniValue::VOBJ);
         BOOST_FOREACH(const CTxMemPoolEntry& e, mempool.mapTx)
         {
-            const uint256& hash = e.GetTx().GetHash();
-            UniValue info(UniValue::VOBJ);
-            info.push_back(Pair("size", (int)e.GetTxSize()));
-            info.push_back(Pair("fee", ValueFromAmount(e.GetFee())));
-            info.push_back(Pair("time", e.GetTime()));
-            info.push_back(Pair("height", (int)e.GetHeight()));
-            info.push_back(Pair("startingpriority", e.GetPriority(e.GetHeight())));
-            info.push_back(Pair("currentpriority", e.GetPriority(chainActive.Height())));
-            const CTransaction& tx = e.GetTx();
-            set<string> setDepends;
-            BOOST_FOREACH(const CTxIn& txin, tx.vin)
-            {
-                if (mempool.exists(txin.prevout.hash))
-                    setDepends.insert(txin.prevout.hash.ToString());
-            }
-
-            UniValue depends(UniValue::VARR);
-            BOOST_FOREACH(const string& dep, setDepends)
-            {
-                depends.push_back(dep);
-            }
-
-            info.push_back(Pair("depends", depends));
-            o.push_back(Pair(hash.ToString(), info));
+            o.push_back(Pair(e.GetTx().GetHash().ToString(), MempoolEntryToJSON(e)));
         }
         return o;
     }
@@ -549,6 +555,28 @@ UniValue getrawmempool(const UniValue& params, bool fHelp)
     return mempoolToJSON(fVerbose);
 }
 
+static void getrawmempool_stream(const UniValue& params, CJSONStreamWriter& result)
+{
+    LOCK2(cs_main, mempool.cs);
+
+    bool fVerbose = false;
+    if (params.size() > 0)
+        fVerbose = params[0].get_bool();
+
+    if (!fVerbose)
+    {
+        result.Value(mempoolToJSON(false));
+        return;
+    }
+
+    result.BeginObject();
+    BOOST_FOREACH(const CTxMemPoolEntry& e, mempool.mapTx)
+    {
+        result.KeyValue(e.GetTx().GetHash().ToString(), MempoolEntryToJSON(e));
+    }
+    result.EndObject();
+}
+
 UniValue clearrawmempool(const UniValue& params, bool fHelp)
 {
     if (fHelp || params.size() > 0)
@@ -1018,8 +1046,11 @@ UniValue getblockheader(const UniValue& params, bool fHelp)
 
     if (!fVerbose)
     {
+        CBlockHeader header;
+        if (!pblockindex->GetBlockHeader(header))
+            throw JSONRPCError(RPC_DATABASE_ERROR, "Cannot read block header solution");
         CDataStream ssBlock(SER_NETWORK, PROTOCOL_VERSION);
-        ssBlock << pblockindex->GetBlockHeader();
+        ssBlock << header;
         std::string strHex = HexStr(ssBlock.begin(), ssBlock.end());
         return strHex;
     }
@@ -1027,6 +1058,76 @@ UniValue getblockheader(const UniValue& params, bool fHelp)
     return blockheaderToJSON(pblockindex);
 }
 
+// Finds and reads the block requested by the parameters of getblock, and parses the verbosity
+static CBlockIndex* ReadBlockForRPC(const UniValue& params, CBlock& block, int& verbosity)
+{
+    std::string strHash = params[0].get_str();
+
+    // If height is supplied, find the hash
+    if (strHash.size() < (2 * sizeof(uint256))) {
+        // std::stoi allows characters, whereas we want to be strict
+        regex r("[[:digit:]]+");
+        if (!regex_match(strHash, r)) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid block height parameter");
+        }
+
+        int nHeight = -1;
+        try {
+            nHeight = std::stoi(strHash);
+        }
+        catch (const std::exception &e) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid block height parameter");
+        }
+
+        if (nHeight < 0 || nHeight > chainActive.Height()) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Block height out of range");
+        }
+        strHash = chainActive[nHeight]->GetBlockHash().GetHex();
+    }
+
+    uint256 hash(uint256S(strHash));
+
+    verbosity = 1;
+    if (params.size() > 1) {
+        if(params[1].isNum()) {
+            verbosity = params[1].get_int();
+        } else {
+            verbosity = params[1].get_bool() ? 1 : 0;
+        }
+    }
+
+    if (verbosity < 0 || verbosity > 2) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Verbosity must be in range from 0 to 2");
+    }
+
+    if (mapBlockIndex.count(hash) == 0)
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
+
+    CBlockIndex* pblockindex = mapBlockIndex[hash];
+
+    if (fHavePruned && !(pblockindex->nStatus & BLOCK_HAVE_DATA) && pblockindex->nTx > 0)
+        throw JSONRPCError(RPC_INTERNAL_ERROR, "Block not available (pruned data)");
+
+    if(!ReadBlockFromDisk(block, pblockindex, Params().GetConsensus(), 1))
+        throw JSONRPCError(RPC_INTERNAL_ERROR, "Can't read block from disk");
+
+    return pblockindex;
+}
+
+static UniValue BlockToRPCJSON(const CBlock& block, CBlockIndex* pblockindex, bool txDetails)
+{
+    UniValue blockUni = blockToJSON(block, pblockindex, txDetails);
+    if (pblockindex)
+    {
+        blockUni.pushKV("proofroot", CProofRoot::GetProofRoot(pblockindex->GetHeight()).ToUniValue());
+        if (CConstVerusSolutionVector::GetVersionByHeight(pblockindex->GetHeight()) >= CActivationHeight::ACTIVATE_PBAAS_HEADER)
+        {
+            blockUni.pushKV("prevmmrroot", block.GetPrevMMRRoot().GetHex());
+        }
+    }
+    return blockUni;
+}
+
 UniValue getblock(const UniValue& params, bool fHelp)
 {
     if (fHelp || params.size() < 1 || params.size() > 2)
@@ -1077,74 +1178,73 @@ UniValue getblock(const UniValue& params, bool fHelp)
 
     LOCK(cs_main);
 
-    std::string strHash = params[0].get_str();
-
-    // If height is supplied, find the hash
-    if (strHash.size() < (2 * sizeof(uint256))) {
-        // std::stoi allows characters, whereas we want to be strict
-        regex r("[[:digit:]]+");
-        if (!regex_match(strHash, r)) {
-            throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid block height parameter");
-        }
-
-        int nHeight = -1;
-        try {
-            nHeight = std::stoi(strHash);
-        }
-        catch (const std::exception &e) {
-            throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid block height parameter");
-        }
-
-        if (nHeight < 0 || nHeight > chainActive.Height()) {
-            throw JSONRPCError(RPC_INVALID_PARAMETER, "Block height out of range");
-        }
-        strHash = chainActive[nHeight]->GetBlockHash().GetHex();
-    }
-
-    uint256 hash(uint256S(strHash));
-
+    CBlock block;
     int verbosity = 1;
-    if (params.size() > 1) {
-        if(params[1].isNum()) {
-            verbosity = params[1].get_int();
-        } else {
-            verbosity = params[1].get_bool() ? 1 : 0;
-        }
+    CBlockIndex* pblockindex = ReadBlockForRPC(params, block, verbosity);
+
+    if (verbosity == 0)
+    {
+        CDataStream ssBlock(SER_NETWORK, PROTOCOL_VERSION);
+        ssBlock << block;
+        std::string strHex = HexStr(ssBlock.begin(), ssBlock.end());
+        return strHex;
     }
+    return BlockToRPCJSON(block, pblockindex, verbosity >= 2);
+}
 
-    if (verbosity < 0 || verbosity > 2) {
-        throw JSONRPCError(RPC_INVALID_PARAMETER, "Verbosity must be in range from 0 to 2");
+static void getblock_stream(const UniValue& params, CJSONStreamWriter& result)
+{
+    if (params.size() < 1 || params.size() > 2)
+    {
+        // reports usage
+        result.Value(getblock(params, false));
+        return;
     }
 
-    if (mapBlockIndex.count(hash) == 0)
-        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
+    LOCK(cs_main);
 
     CBlock block;
-    CBlockIndex* pblockindex = mapBlockIndex[hash];
-
-    if (fHavePruned && !(pblockindex->nStatus & BLOCK_HAVE_DATA) && pblockindex->nTx > 0)
-        throw JSONRPCError(RPC_INTERNAL_ERROR, "Block not available (pruned data)");
-
-    if(!ReadBlockFromDisk(block, pblockindex, Params().GetConsensus(), 1))
-        throw JSONRPCError(RPC_INTERNAL_ERROR, "Can't read block from disk");
+    int verbosity = 1;
+    CBlockIndex* pblockindex = ReadBlockForRPC(params, block, verbosity);
 
     if (verbosity == 0)
     {
         CDataStream ssBlock(SER_NETWORK, PROTOCOL_VERSION);
         ssBlock << block;
-        std::string strHex = HexStr(ssBlock.begin(), ssBlock.end());
-        return strHex;
+        result.Value(HexStr(ssBlock.begin(), ssBlock.end()));
+        return;
     }
-    UniValue blockUni = blockToJSON(block, pblockindex, verbosity >= 2);
-    if (pblockindex)
+
+    UniValue blockUni = BlockToRPCJSON(block, pblockindex, false);
+    if (verbosity == 1)
     {
-        blockUni.pushKV("proofroot", CProofRoot::GetProofRoot(pblockindex->GetHeight()).ToUniValue());
-        if (CConstVerusSolutionVector::GetVersionByHeight(pblockindex->GetHeight()) >= CActivationHeight::ACTIVATE_PBAAS_HEADER)
+        result.Value(blockUni);
+        return;
+    }
+
+    // write the block with transaction ids, replacing them with each transaction's details as they are rendered
+    const std::vector<std::string>& keys = blockUni.getKeys();
+    const std::vector<UniValue>& values = blockUni.getValues();
+
+    result.BeginObject();
+    for (int i = 0; i < keys.size(); i++)
+    {
+        if (keys[i] != "tx")
         {
-            blockUni.pushKV("prevmmrroot", block.GetPrevMMRRoot().GetHex());
+            result.KeyValue(keys[i], values[i]);
+            continue;
         }
+        result.Key("tx");
+        result.BeginArray();
+        for (const CTransaction& tx : block.vtx)
+        {
+            UniValue objTx(UniValue::VOBJ);
+            TxToJSON(tx, uint256(), objTx);
+            result.Value(objTx);
+        }
+        result.EndArray();
     }
-    return blockUni;
+    result.EndObject();
 }
 
 UniValue gettxoutsetinfo(const UniValue& params, bool fHelp)
@@ -1997,7 +2097,7 @@ static const CRPCCommand commands[] =
     { "blockchain",         "getblockchaininfo",      &getblockchaininfo,      true  },
     { "blockchain",         "getbestblockhash",       &getbestblockhash,       true  },
     { "blockchain",         "getblockcount",          &getblockcount,          true  },
-    { "blockchain",         "getblock",               &getblock,               true  },
+    { "blockchain",         "getblock",               &getblock,               true,  &getblock_stream },
     { "blockchain",         "getblockhash",           &getblockhash,           true  },
     { "blockchain",         "getblockheader",         &getblockheader,         true  },
     { "blockchain",         "getchaintips",           &getchaintips,           true  },
@@ -2005,7 +2105,7 @@ static const CRPCCommand commands[] =
     { "blockchain",         "getchaintxstats",        &getchaintxstats,        true  },
     { "blockchain",         "getdifficulty",          &getdifficulty,          true  },
     { "blockchain",         "getmempoolinfo",         &getmempoolinfo,         true  },
-    { "blockchain",         "getrawmempool",          &getrawmempool,          true  },
+    { "blockchain",         "getrawmempool",          &getrawmempool,          true,  &getrawmempool_stream },
     { "blockchain",         "clearrawmempool",        &clearrawmempool,        true  },
     { "blockchain",         "gettxout",               &gettxout,               true  },
     { "blockchain",         "gettxoutsetinfo",        &gettxoutsetinfo,        true  },
@@ -0,0 +1,155 @@
+// Copyright (c) 2026 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#ifndef BITCOIN_RPC_BLOCKTEMPLATE_H
+#define BITCOIN_RPC_BLOCKTEMPLATE_H
+
+#include "chainparams.h"
+#include "core_io.h"
+#include "main.h"
+#include "miner.h"
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <univalue.h>
+
+/**
+ * JSON of the transactions in the current block template, which is only rebuilt when the template
+ * itself changes, and the transaction lists of recent templates by longpollid, to answer delta requests.
+ * The transactions are also kept serialized, to be written into replies without copying them.
+ * Only used under cs_main.
+ */
+class CBlockTemplateCache
+{
+public:
+    static const size_t MAX_RECENT_TEMPLATES = 16;
+
+    uint64_t nTemplate;                     // generation of the template the cached entries were made from
+    uint256 hashPrevBlock;                  // a new tip always makes a new template
+    uint256 hashCoinbase;                   // coinbase may change without a new template when merge mined headers change
+    UniValue transactions;
+    std::shared_ptr<const std::string> transactionsJSON;    // transactions, as written in a reply
+    UniValue coinbase;
+    std::vector<uint256> txIds;             // non-coinbase transactions, in the same order as transactions
+    std::deque<std::pair<std::string, std::vector<uint256>>> recent;
+
+    CBlockTemplateCache() : nTemplate(0), transactions(UniValue::VARR), transactionsJSON(std::make_shared<const std::string>("[]")) {}
+
+    bool IsCurrent(uint64_t nTemplateIn, const CBlockTemplate *pblocktemplate) const
+    {
+        return nTemplate == nTemplateIn &&
+               hashPrevBlock == pblocktemplate->block.hashPrevBlock &&
+               hashCoinbase == pblocktemplate->block.vtx[0].GetHash();
+    }
+
+    void Update(uint64_t nTemplateIn, const CBlockTemplate *pblocktemplate, int32_t height)
+    {
+        const CBlock &block = pblocktemplate->block;
+        bool fSameTransactions = nTemplate == nTemplateIn && hashPrevBlock == block.hashPrevBlock;
+
+        nTemplate = nTemplateIn;
+        hashPrevBlock = block.hashPrevBlock;
+        hashCoinbase = block.vtx[0].GetHash();
+        coinbase = NullUniValue;
+        if (!fSameTransactions)
+        {
+            transactions = UniValue(UniValue::VARR);
+            txIds.clear();
+        }
+
+        std::map<uint256, int64_t> setTxIndex;
+        for (size_t i = 0; i < block.vtx.size(); i++)
+        {
+            const CTransaction &tx = block.vtx[i];
+            uint256 txHash = tx.GetHash();
+            setTxIndex[txHash] = i;
+
+            if (fSameTransactions && !tx.IsCoinBase())
+                continue;
+
+            UniValue entry(UniValue::VOBJ);
+            entry.push_back(Pair("data", EncodeHexTx(tx)));
+            entry.push_back(Pair("hash", txHash.GetHex()));
+
+            UniValue deps(UniValue::VARR);
+            for (auto &in : tx.vin)
+            {
+                if (setTxIndex.count(in.prevout.hash))
+                    deps.push_back(setTxIndex[in.prevout.hash]);
+            }
+            entry.push_back(Pair("depends", deps));
+            entry.push_back(Pair("fee", pblocktemplate->vTxFees[i]));
+            entry.push_back(Pair("sigops", pblocktemplate->vTxSigOps[i]));
+
+            if (tx.IsCoinBase())
+            {
+                CAmount nReward = GetBlockSubsidy(height, Params().GetConsensus());
+                entry.push_back(Pair("coinbasevalue", nReward));
+                entry.push_back(Pair("required", true));
+                coinbase = entry;
+            }
+            else
+            {
+                transactions.push_back(entry);
+                txIds.push_back(txHash);
+            }
+        }
+
+        // replies still being written keep the JSON they started with
+        if (!fSameTransactions)
+            transactionsJSON = std::make_shared<const std::string>(transactions.write());
+    }
+
+    void Remember(const std::string &templateId)
+    {
+        if (recent.size() && recent.back().first == templateId)
+        {
+            recent.back().second = txIds;
+            return;
+        }
+        recent.push_back(std::make_pair(templateId, txIds));
+        if (recent.size() > MAX_RECENT_TEMPLATES)
+            recent.pop_front();
+    }
+
+    // returns a delta object against the template with the given id, or NullUniValue if it is not known
+    UniValue Delta(const std::string &sinceId) const
+    {
+        auto it = std::find_if(recent.begin(), recent.end(),
+                               [&sinceId](const std::pair<std::string, std::vector<uint256>> &one) { return one.first == sinceId; });
+        if (it == recent.end())
+            return NullUniValue;
+
+        std::set<uint256> oldIds(it->second.begin(), it->second.end());
+        std::set<uint256> newIds(txIds.begin(), txIds.end());
+
+        UniValue hashes(UniValue::VARR), added(UniValue::VARR), removed(UniValue::VARR);
+        for (size_t i = 0; i < txIds.size(); i++)
+        {
+            hashes.push_back(txIds[i].GetHex());
+            if (!oldIds.count(txIds[i]))
+                added.push_back(transactions[i]);
+        }
+        for (auto &oneId : it->second)
+        {
+            if (!newIds.count(oneId))
+                removed.push_back(oneId.GetHex());
+        }
+
+        UniValue delta(UniValue::VOBJ);
+        delta.push_back(Pair("since", sinceId));
+        delta.push_back(Pair("transactionhashes", hashes));
+        delta.push_back(Pair("added", added));
+        delta.push_back(Pair("removed", removed));
+        return delta;
+    }
+};
+
+#endif // BITCOIN_RPC_BLOCKTEMPLATE_H
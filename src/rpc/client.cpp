@@ -1723,6 +1723,7 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "zcrawjoinsplit", 4 },
     { "zcbenchmark", 1 },
     { "zcbenchmark", 2 },
+    { "zcbenchmark", 3 },
     { "getblocksubsidy", 0},
     { "z_listaddresses", 0},
     { "z_listreceivedbyaddress", 1},
@@ -1793,9 +1794,11 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "signdata", 0},
     { "decryptdata", 0},
     { "verifysignature", 0},
+    { "listidentities", 4},
     { "getidentitieswithaddress", 0},
     { "getidentitieswithrevocation", 0},
     { "getidentitieswithrecovery", 0},
+    { "getidentitieswithparent", 0},
     { "estimateconversion", 1},
     { "makeoffer", 1},
     { "takeoffer", 1},
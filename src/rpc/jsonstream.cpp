@@ -0,0 +1,131 @@
+// Copyright (c) 2026 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#include "rpc/jsonstream.h"
+
+#include <assert.h>
+
+CJSONStreamWriter::CJSONStreamWriter(const Sink& sinkIn, size_t nFlushSizeIn) :
+    sink(sinkIn), nFlushSize(nFlushSizeIn), fFlushed(false), fAfterKey(false)
+{
+}
+
+void CJSONStreamWriter::Write(const std::string& text)
+{
+    buffer += text;
+    if (buffer.size() >= nFlushSize)
+        Flush();
+}
+
+void CJSONStreamWriter::Flush()
+{
+    if (buffer.empty())
+        return;
+    sink(buffer);
+    buffer.clear();
+    fFlushed = true;
+}
+
+void CJSONStreamWriter::BeginValue()
+{
+    if (fAfterKey)
+    {
+        fAfterKey = false;
+        return;
+    }
+    if (levels.empty())
+        return;
+    // values in objects need a key first
+    assert(!levels.back().fObject);
+    if (!levels.back().fEmpty)
+        Write(",");
+    levels.back().fEmpty = false;
+}
+
+void CJSONStreamWriter::Key(const std::string& key)
+{
+    assert(!levels.empty() && levels.back().fObject && !fAfterKey);
+    if (!levels.back().fEmpty)
+        Write(",");
+    levels.back().fEmpty = false;
+    Write(UniValue(key).write() + ":");
+    fAfterKey = true;
+}
+
+void CJSONStreamWriter::BeginObject()
+{
+    BeginValue();
+    levels.push_back({true, true});
+    Write("{");
+}
+
+void CJSONStreamWriter::EndObject()
+{
+    assert(!levels.empty() && levels.back().fObject && !fAfterKey);
+    levels.pop_back();
+    Write("}");
+}
+
+void CJSONStreamWriter::BeginArray()
+{
+    BeginValue();
+    levels.push_back({false, true});
+    Write("[");
+}
+
+void CJSONStreamWriter::EndArray()
+{
+    assert(!levels.empty() && !levels.back().fObject);
+    levels.pop_back();
+    Write("]");
+}
+
+void CJSONStreamWriter::Value(const UniValue& value)
+{
+    if (value.isObject())
+    {
+        BeginObject();
+        const std::vector<std::string>& keys = value.getKeys();
+        const std::vector<UniValue>& values = value.getValues();
+        for (size_t i = 0; i < keys.size(); i++)
+            KeyValue(keys[i], values[i]);
+        EndObject();
+    }
+    else if (value.isArray())
+    {
+        BeginArray();
+        for (const UniValue& element : value.getValues())
+            Value(element);
+        EndArray();
+    }
+    else
+    {
+        BeginValue();
+        Write(value.write());
+    }
+}
+
+void CJSONStreamWriter::ValueJSON(const std::string& json)
+{
+    BeginValue();
+    Write(json);
+}
+
+void CJSONStreamWriter::Raw(const std::string& text)
+{
+    Write(text);
+}
+
+void CJSONStreamWriter::CloseLevels(size_t nDepth)
+{
+    if (fAfterKey)
+        Value(NullUniValue);
+    while (levels.size() > nDepth)
+    {
+        if (levels.back().fObject)
+            EndObject();
+        else
+            EndArray();
+    }
+}
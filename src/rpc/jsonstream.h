@@ -0,0 +1,86 @@
+// Copyright (c) 2026 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#ifndef BITCOIN_RPC_JSONSTREAM_H
+#define BITCOIN_RPC_JSONSTREAM_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <univalue.h>
+
+/**
+ * Writes compact JSON, byte for byte the same as UniValue::write(), incrementally. Output is
+ * buffered and handed to the sink in pieces of about nFlushSize bytes, so large results can be
+ * sent while they are being produced, without first building a UniValue tree and one string of
+ * the whole result.
+ *
+ * Nothing reaches the sink before the buffer fills up or Flush() is called. Until then, a caller
+ * may still drop everything written and report an error instead.
+ */
+class CJSONStreamWriter
+{
+public:
+    typedef std::function<void(const std::string&)> Sink;
+
+    static const size_t DEFAULT_FLUSH_SIZE = 64 * 1024;
+
+    CJSONStreamWriter(const Sink& sinkIn, size_t nFlushSizeIn = DEFAULT_FLUSH_SIZE);
+
+    void BeginObject();
+    void EndObject();
+    void BeginArray();
+    void EndArray();
+
+    //! Name of the next value in the current object
+    void Key(const std::string& key);
+
+    //! Write a complete value. Arrays and objects are written one element at a time.
+    void Value(const UniValue& value);
+
+    //! Write a complete value that is already serialized as compact JSON
+    void ValueJSON(const std::string& json);
+
+    void KeyValue(const std::string& key, const UniValue& value)
+    {
+        Key(key);
+        Value(value);
+    }
+
+    //! Append text outside of any JSON value, such as the newline ending a reply
+    void Raw(const std::string& text);
+
+    //! End the arrays and objects opened after the first nDepth, writing null for a key without
+    //! a value, so that a value cut short is still valid JSON
+    void CloseLevels(size_t nDepth);
+
+    //! Hand all buffered output to the sink
+    void Flush();
+
+    //! True once any output has been handed to the sink
+    bool Flushed() const { return fFlushed; }
+
+    //! Output that has not been handed to the sink yet
+    const std::string& GetBuffer() const { return buffer; }
+
+private:
+    struct Level
+    {
+        bool fObject;
+        bool fEmpty;
+    };
+
+    Sink sink;
+    size_t nFlushSize;
+    bool fFlushed;
+    bool fAfterKey;
+    std::string buffer;
+    std::vector<Level> levels;
+
+    void BeginValue();
+    void Write(const std::string& text);
+};
+
+#endif // BITCOIN_RPC_JSONSTREAM_H
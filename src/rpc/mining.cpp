@@ -17,6 +17,8 @@
 #include "miner.h"
 #include "net.h"
 #include "pow.h"
+#include "rpc/blocktemplate.h"
+#include "rpc/jsonstream.h"
 #include "rpc/server.h"
 #include "txmempool.h"
 #include "util.h"
@@ -674,7 +676,13 @@ UniValue getminingdistribution(const UniValue& params, bool fHelp)
     return distributionObj;
 }
 
-UniValue getblocktemplate(const UniValue& params, bool fHelp)
+static CBlockTemplateCache templateCache;
+
+/**
+ * The block template reply. If pTransactionsJSON is not null, the transactions are left null in the
+ * result, and are returned as the cached JSON to write in their place instead.
+ */
+static UniValue GetBlockTemplateJSON(const UniValue& params, bool fHelp, std::shared_ptr<const std::string> *pTransactionsJSON)
 {
     if (fHelp || params.size() > 1)
         throw runtime_error(
@@ -695,7 +703,10 @@ UniValue getblocktemplate(const UniValue& params, bool fHelp)
             "       \"capabilities\":[      (array, optional) A list of strings\n"
             "           \"support\"         (string) client side supported feature, 'longpoll', 'coinbasetxn', 'coinbasevalue', 'proposal', 'serverlist', 'workid'\n"
             "           ,...\n"
-            "         ]\n"
+            "         ],\n"
+            "       \"longpollid\":\"id\"   (string, optional) wait to return until the template differs from the one with this longpollid\n"
+            "       \"delta\":\"id\"        (string, optional) if the template with this longpollid is still known, only return the\n"
+            "                                transactions that were added and removed since that template in a \"delta\" object\n"
             "     }\n"
             "\n"
 
@@ -722,6 +733,12 @@ UniValue getblocktemplate(const UniValue& params, bool fHelp)
 //            "      \"flags\" : \"flags\"            (string) \n"
 //            "  },\n"
 //            "  \"coinbasevalue\" : n,               (numeric) maximum allowable input to coinbase transaction, including the generation award and transaction fees (in Satoshis)\n"
+            "  \"delta\" : {                        (json object, only if requested and known) replaces \"transactions\"\n"
+            "      \"since\" : \"id\",                 (string) longpollid of the template this delta applies to\n"
+            "      \"transactionhashes\" : [...],     (array) hashes of all non-coinbase transactions of this template, in order\n"
+            "      \"added\" : [...],                 (array) transactions not in the earlier template, in the same format as \"transactions\"\n"
+            "      \"removed\" : [...]                (array) hashes of transactions of the earlier template that are no longer included\n"
+            "  },\n"
             "  \"coinbasetxn\" : { ... },           (json object) information for coinbase transaction\n"
             "  \"target\" : \"xxxx\",               (string) The hash target\n"
             "  \"mintime\" : xxx,                   (numeric) The minimum timestamp appropriate for next block time in seconds since epoch (Jan 1 1970 GMT)\n"
@@ -757,6 +774,7 @@ UniValue getblocktemplate(const UniValue& params, bool fHelp)
 
     std::string strMode = "template";
     UniValue lpval = NullUniValue;
+    UniValue deltaval = NullUniValue;
 
     // TODO: Re-enable coinbasevalue once a specification has been written
     bool coinbasetxn = true;
@@ -775,6 +793,7 @@ UniValue getblocktemplate(const UniValue& params, bool fHelp)
         else
             throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid mode");
         lpval = find_value(oparam, "longpollid");
+        deltaval = find_value(oparam, "delta");
 
         if (strMode == "proposal")
         {
@@ -839,6 +858,8 @@ UniValue getblocktemplate(const UniValue& params, bool fHelp)
         {
             // Format: <hashBestChain><nTransactionsUpdatedLast>
             std::string lpstr = lpval.get_str();
+            if (lpstr.size() <= 64)
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid longpollid");
 
             hashWatchedChain.SetHex(lpstr.substr(0, 64));
             nTransactionsUpdatedLastLP = atoi64(lpstr.substr(64));
@@ -878,6 +899,7 @@ UniValue getblocktemplate(const UniValue& params, bool fHelp)
     static CBlockIndex* pindexPrev;
     static int64_t nStart;
     static CBlockTemplate* pblocktemplate;
+    static uint64_t nTemplateGeneration;
     if (pindexPrev != chainActive.LastTip() ||
         (mempool.GetTransactionsUpdated() != nTransactionsUpdatedLast && GetTime() - nStart > 5))
     {
@@ -890,6 +912,7 @@ UniValue getblocktemplate(const UniValue& params, bool fHelp)
         nStart = GetTime();
 
         // Create new block
+        nTemplateGeneration++;
         if(pblocktemplate)
         {
             delete pblocktemplate;
@@ -968,48 +991,16 @@ UniValue getblocktemplate(const UniValue& params, bool fHelp)
 
     UniValue aCaps(UniValue::VARR); aCaps.push_back("proposal");
 
-    UniValue txCoinbase = NullUniValue;
-    UniValue transactions(UniValue::VARR);
-    map<uint256, int64_t> setTxIndex;
-    int i = 0;
-    BOOST_FOREACH (const CTransaction& tx, pblock->vtx) {
-        uint256 txHash = tx.GetHash();
-        setTxIndex[txHash] = i++;
-
-        if (tx.IsCoinBase() && !coinbasetxn)
-            continue;
-
-        UniValue entry(UniValue::VOBJ);
-
-        entry.push_back(Pair("data", EncodeHexTx(tx)));
-
-        entry.push_back(Pair("hash", txHash.GetHex()));
-
-        UniValue deps(UniValue::VARR);
-        BOOST_FOREACH (const CTxIn &in, tx.vin)
-        {
-            if (setTxIndex.count(in.prevout.hash))
-                deps.push_back(setTxIndex[in.prevout.hash]);
-        }
-        entry.push_back(Pair("depends", deps));
-
-        int index_in_template = i - 1;
-        entry.push_back(Pair("fee", pblocktemplate->vTxFees[index_in_template]));
-        entry.push_back(Pair("sigops", pblocktemplate->vTxSigOps[index_in_template]));
-
-        if (tx.IsCoinBase()) {
-            // Show founders' reward if it is required
-            //if (pblock->vtx[0].vout.size() > 1) {
-                // Correct this if GetBlockTemplate changes the order
-            //    entry.push_back(Pair("foundersreward", (int64_t)tx.vout[1].nValue));
-            //}
-            CAmount nReward = GetBlockSubsidy(chainActive.LastTip()->GetHeight()+1, Params().GetConsensus());
-            entry.push_back(Pair("coinbasevalue", nReward));
-            entry.push_back(Pair("required", true));
-            txCoinbase = entry;
-        } else
-            transactions.push_back(entry);
+    // the template's transactions are only serialized again when the template or its coinbase changes
+    if (!templateCache.IsCurrent(nTemplateGeneration, pblocktemplate))
+    {
+        templateCache.Update(nTemplateGeneration, pblocktemplate, Mining_height);
     }
+    std::string templateId = pindexPrev->GetBlockHash().GetHex() + i64tostr(nTransactionsUpdatedLast);
+    templateCache.Remember(templateId);
+
+    UniValue txCoinbase = templateCache.coinbase;
+    UniValue delta = deltaval.isStr() ? templateCache.Delta(deltaval.get_str()) : NullUniValue;
 
     UniValue aux(UniValue::VOBJ);
     aux.push_back(Pair("flags", HexStr(COINBASE_FLAGS.begin(), COINBASE_FLAGS.end())));
@@ -1034,7 +1025,19 @@ UniValue getblocktemplate(const UniValue& params, bool fHelp)
     {
         result.push_back(Pair("solution", HexBytes(pblock->nSolution.data(), pblock->nSolution.size())));
     }
-    result.push_back(Pair("transactions", transactions));
+    if (delta.isNull() && pTransactionsJSON)
+    {
+        *pTransactionsJSON = templateCache.transactionsJSON;
+        result.push_back(Pair("transactions", NullUniValue));
+    }
+    else if (delta.isNull())
+    {
+        result.push_back(Pair("transactions", templateCache.transactions));
+    }
+    else
+    {
+        result.push_back(Pair("delta", delta));
+    }
     if (coinbasetxn) {
         assert(txCoinbase.isObject());
         result.push_back(Pair("coinbasetxn", txCoinbase));
@@ -1042,7 +1045,7 @@ UniValue getblocktemplate(const UniValue& params, bool fHelp)
         result.push_back(Pair("coinbaseaux", aux));
         result.push_back(Pair("coinbasevalue", (int64_t)pblock->vtx[0].vout[0].nValue));
     }
-    result.push_back(Pair("longpollid", chainActive.LastTip()->GetBlockHash().GetHex() + i64tostr(nTransactionsUpdatedLast)));
+    result.push_back(Pair("longpollid", templateId));
     if ( ASSETCHAINS_STAKED != 0 )
     {
         arith_uint256 POWtarget; int32_t PoSperc;
@@ -1067,6 +1070,41 @@ UniValue getblocktemplate(const UniValue& params, bool fHelp)
     return result;
 }
 
+UniValue getblocktemplate(const UniValue& params, bool fHelp)
+{
+    return GetBlockTemplateJSON(params, fHelp, nullptr);
+}
+
+static void getblocktemplate_stream(const UniValue& params, CJSONStreamWriter& result)
+{
+    std::shared_ptr<const std::string> transactionsJSON;
+    UniValue templateUni = GetBlockTemplateJSON(params, false, &transactionsJSON);
+    if (!transactionsJSON)
+    {
+        result.Value(templateUni);
+        return;
+    }
+
+    // write the transactions from the cached JSON, rather than copying them into every reply
+    const std::vector<std::string>& keys = templateUni.getKeys();
+    const std::vector<UniValue>& values = templateUni.getValues();
+
+    result.BeginObject();
+    for (size_t i = 0; i < keys.size(); i++)
+    {
+        if (keys[i] == "transactions")
+        {
+            result.Key(keys[i]);
+            result.ValueJSON(*transactionsJSON);
+        }
+        else
+        {
+            result.KeyValue(keys[i], values[i]);
+        }
+    }
+    result.EndObject();
+}
+
 class submitblock_StateCatcher : public CValidationInterface
 {
 public:
@@ -1278,7 +1316,7 @@ static const CRPCCommand commands[] =
     { "mining",             "prioritisetransaction",  &prioritisetransaction,  true  },
     { "mining",             "setminingdistribution",  &setminingdistribution,  true  },
     { "mining",             "getminingdistribution",  &getminingdistribution,  true  },
-    { "mining",             "getblocktemplate",       &getblocktemplate,       true  },
+    { "mining",             "getblocktemplate",       &getblocktemplate,       true,  &getblocktemplate_stream },
     { "mining",             "submitblock",            &submitblock,            true  },
     { "mining",             "getblocksubsidy",        &getblocksubsidy,        true  },
 
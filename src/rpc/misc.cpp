@@ -5,11 +5,14 @@
 
 #include <univalue.h>
 #include "clientversion.h"
+#include "httpserver.h"
 #include "init.h"
 #include "key_io.h"
 #include "main.h"
+#include "metrics.h"
 #include "net.h"
 #include "netbase.h"
+#include "rpc/jsonstream.h"
 #include "rpc/server.h"
 #include "timedata.h"
 #include "txmempool.h"
@@ -2143,71 +2146,48 @@ UniValue getaddressutxos(const UniValue& params, bool fHelp)
     }
 }
 
-UniValue getaddressdeltas(const UniValue& params, bool fHelp)
+/**
+ * The index entries and options of a getaddressdeltas request, so that the deltas can be
+ * rendered one at a time.
+ */
+class CAddressDeltasQuery
 {
-    if (fHelp || params.size() != 1 || !params[0].isObject())
-        throw runtime_error(
-            "getaddressdeltas\n"
-            "\nReturns all changes for an address (requires addressindex to be enabled).\n"
-            "\nArguments:\n"
-            "{\n"
-            "  \"addresses\"\n"
-            "    [\n"
-            "      \"address\"  (string) The base58check encoded address\n"
-            "      ,...\n"
-            "    ]\n"
-            "  \"start\" (number) The start block height\n"
-            "  \"end\" (number) The end block height\n"
-            "  \"chaininfo\" (boolean) Include chain info in results, only applies if start and end specified\n"
-            "  \"friendlynames\" (boolean) Include additional array of friendly names keyed by currency i-addresses\n"
-            "  \"verbosity\" (number) (default == 0), if 1, include output information for spends, including all reserve amounts and destinations\n"
-            "}\n"
-            "\nResult:\n"
-            "[\n"
-            "  {\n"
-            "    \"satoshis\"  (number) The difference of satoshis\n"
-            "    \"txid\"  (string) The related txid\n"
-            "    \"index\"  (number) The related input or output index\n"
-            "    \"height\"  (number) The block height\n"
-            "    \"address\"  (string) The base58check encoded address\n"
-            "  }\n"
-            "]\n"
-            "\nExamples:\n"
-            + HelpExampleCli("getaddressdeltas", "'{\"addresses\": [\"RY5LccmGiX9bUHYGtSWQouNy1yFhc5rM87\"]}'")
-            + HelpExampleRpc("getaddressdeltas", "{\"addresses\": [\"RY5LccmGiX9bUHYGtSWQouNy1yFhc5rM87\"]}")
-        );
-
+public:
+    bool friendlyNames;
+    int verbosity;
+    UniValue startInfo;     // start and end are only set if chain info was requested
+    UniValue endInfo;
+    std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
 
-    bool includeChainInfo = uni_get_bool(find_value(params[0].get_obj(), "chaininfo"));
-    bool friendlyNames = uni_get_bool(find_value(params[0].get_obj(), "friendlynames"));
-    int verbosity = uni_get_bool(find_value(params[0].get_obj(), "verbosity"));
+    CAddressDeltasQuery(const UniValue& params)
+    {
+        bool includeChainInfo = uni_get_bool(find_value(params[0].get_obj(), "chaininfo"));
+        friendlyNames = uni_get_bool(find_value(params[0].get_obj(), "friendlynames"));
+        verbosity = uni_get_bool(find_value(params[0].get_obj(), "verbosity"));
 
-    UniValue startValue = find_value(params[0].get_obj(), "start");
-    UniValue endValue = find_value(params[0].get_obj(), "end");
+        UniValue startValue = find_value(params[0].get_obj(), "start");
+        UniValue endValue = find_value(params[0].get_obj(), "end");
 
-    int start = 0;
-    int end = 0;
+        int start = 0;
+        int end = 0;
 
-    if (startValue.isNum() && endValue.isNum()) {
-        start = startValue.get_int();
-        end = endValue.get_int();
-        if (start <= 0 || end <= 0) {
-            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Start and end is expected to be greater than zero");
-        }
-        if (end < start) {
-            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "End value is expected to be greater than start");
+        if (startValue.isNum() && endValue.isNum()) {
+            start = startValue.get_int();
+            end = endValue.get_int();
+            if (start <= 0 || end <= 0) {
+                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Start and end is expected to be greater than zero");
+            }
+            if (end < start) {
+                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "End value is expected to be greater than start");
+            }
         }
-    }
 
-    std::vector<std::pair<uint160, int> > addresses;
-
-    if (!getAddressesFromParams(params, addresses)) {
-        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address");
-    }
+        std::vector<std::pair<uint160, int> > addresses;
 
-    std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
+        if (!getAddressesFromParams(params, addresses)) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address");
+        }
 
-    {
         LOCK(cs_main);
         for (std::vector<std::pair<uint160, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
             if (start > 0 && end > 0) {
@@ -2220,9 +2200,29 @@ UniValue getaddressdeltas(const UniValue& params, bool fHelp)
                 }
             }
         }
+
+        if (includeChainInfo && start > 0 && end > 0) {
+            if (start > chainActive.Height() || end > chainActive.Height()) {
+                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Start or end is outside chain range");
+            }
+
+            CBlockIndex* startIndex = chainActive[start];
+            CBlockIndex* endIndex = chainActive[end];
+
+            startInfo = UniValue(UniValue::VOBJ);
+            endInfo = UniValue(UniValue::VOBJ);
+
+            startInfo.push_back(Pair("hash", startIndex->GetBlockHash().GetHex()));
+            startInfo.push_back(Pair("height", start));
+
+            endInfo.push_back(Pair("hash", endIndex->GetBlockHash().GetHex()));
+            endInfo.push_back(Pair("height", end));
+        }
     }
 
-    UniValue deltas(UniValue::VARR);
+    bool IncludeChainInfo() const { return !startInfo.isNull(); }
+
+    void ForEachDelta(const std::function<void(const UniValue&)>& fn) const
     {
         LOCK2(cs_main, mempool.cs);
 
@@ -2257,41 +2257,87 @@ UniValue getaddressdeltas(const UniValue& params, bool fHelp)
                 }
             }
 
-            deltas.push_back(delta);
+            fn(delta);
         }
     }
+};
 
-    UniValue result(UniValue::VOBJ);
-
-    if (includeChainInfo && start > 0 && end > 0) {
-        LOCK(cs_main);
-
-        if (start > chainActive.Height() || end > chainActive.Height()) {
-            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Start or end is outside chain range");
-        }
-
-        CBlockIndex* startIndex = chainActive[start];
-        CBlockIndex* endIndex = chainActive[end];
+UniValue getaddressdeltas(const UniValue& params, bool fHelp)
+{
+    if (fHelp || params.size() != 1 || !params[0].isObject())
+        throw runtime_error(
+            "getaddressdeltas\n"
+            "\nReturns all changes for an address (requires addressindex to be enabled).\n"
+            "\nArguments:\n"
+            "{\n"
+            "  \"addresses\"\n"
+            "    [\n"
+            "      \"address\"  (string) The base58check encoded address\n"
+            "      ,...\n"
+            "    ]\n"
+            "  \"start\" (number) The start block height\n"
+            "  \"end\" (number) The end block height\n"
+            "  \"chaininfo\" (boolean) Include chain info in results, only applies if start and end specified\n"
+            "  \"friendlynames\" (boolean) Include additional array of friendly names keyed by currency i-addresses\n"
+            "  \"verbosity\" (number) (default == 0), if 1, include output information for spends, including all reserve amounts and destinations\n"
+            "}\n"
+            "\nResult:\n"
+            "[\n"
+            "  {\n"
+            "    \"satoshis\"  (number) The difference of satoshis\n"
+            "    \"txid\"  (string) The related txid\n"
+            "    \"index\"  (number) The related input or output index\n"
+            "    \"height\"  (number) The block height\n"
+            "    \"address\"  (string) The base58check encoded address\n"
+            "  }\n"
+            "]\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getaddressdeltas", "'{\"addresses\": [\"RY5LccmGiX9bUHYGtSWQouNy1yFhc5rM87\"]}'")
+            + HelpExampleRpc("getaddressdeltas", "{\"addresses\": [\"RY5LccmGiX9bUHYGtSWQouNy1yFhc5rM87\"]}")
+        );
 
-        UniValue startInfo(UniValue::VOBJ);
-        UniValue endInfo(UniValue::VOBJ);
 
-        startInfo.push_back(Pair("hash", startIndex->GetBlockHash().GetHex()));
-        startInfo.push_back(Pair("height", start));
+    CAddressDeltasQuery query(params);
 
-        endInfo.push_back(Pair("hash", endIndex->GetBlockHash().GetHex()));
-        endInfo.push_back(Pair("height", end));
+    UniValue deltas(UniValue::VARR);
+    query.ForEachDelta([&deltas](const UniValue& delta) { deltas.push_back(delta); });
 
+    if (query.IncludeChainInfo()) {
+        UniValue result(UniValue::VOBJ);
         result.push_back(Pair("deltas", deltas));
-        result.push_back(Pair("start", startInfo));
-        result.push_back(Pair("end", endInfo));
-
+        result.push_back(Pair("start", query.startInfo));
+        result.push_back(Pair("end", query.endInfo));
         return result;
     } else {
         return deltas;
     }
 }
 
+static void getaddressdeltas_stream(const UniValue& params, CJSONStreamWriter& result)
+{
+    if (params.size() != 1 || !params[0].isObject())
+    {
+        // reports usage
+        result.Value(getaddressdeltas(params, false));
+        return;
+    }
+
+    CAddressDeltasQuery query(params);
+
+    if (query.IncludeChainInfo()) {
+        result.BeginObject();
+        result.Key("deltas");
+    }
+    result.BeginArray();
+    query.ForEachDelta([&result](const UniValue& delta) { result.Value(delta); });
+    result.EndArray();
+    if (query.IncludeChainInfo()) {
+        result.KeyValue("start", query.startInfo);
+        result.KeyValue("end", query.endInfo);
+        result.EndObject();
+    }
+}
+
 UniValue getaddressbalance(const UniValue& params, bool fHelp)
 {
     if (fHelp || params.size() != 1)
@@ -2638,10 +2684,119 @@ UniValue processupgradedata(const UniValue& params, bool fHelp)
 }
 
 
+UniValue getmetrics(const UniValue& params, bool fHelp)
+{
+    if (fHelp || params.size() > 1)
+        throw runtime_error(
+            "getmetrics ( \"prefix\" )\n"
+            "\nReturns latency histograms of node hot paths and RPC methods, and hot path counters.\n"
+            "Latencies are in microseconds. Bucket i counts samples under 2^i microseconds and at least\n"
+            "2^(i-1), and percentiles are the upper bound of the bucket they fall in.\n"
+            "\nArguments:\n"
+            "1. \"prefix\"     (string, optional) Only return histograms whose name starts with prefix, e.g. \"rpc.\"\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"histograms\": {\n"
+            "    \"name\": {\n"
+            "      \"description\": \"xxx\", (string) What is timed\n"
+            "      \"count\": n,          (numeric) Number of samples\n"
+            "      \"sum\": n,            (numeric) Total time\n"
+            "      \"mean\": n,           (numeric) Mean time\n"
+            "      \"p50\": n,            (numeric) Median\n"
+            "      \"p90\": n,            (numeric) 90th percentile\n"
+            "      \"p99\": n,            (numeric) 99th percentile\n"
+            "      \"buckets\": [n, ...]  (array) Samples per bucket, up to the last non-empty bucket\n"
+            "    }, ...\n"
+            "  },\n"
+            "  \"counters\": {\n"
+            "    \"name\": n,             (numeric) Counter value\n"
+            "    ...\n"
+            "  },\n"
+            "  \"rpcqueues\": {          (object) RPC work queues by cost class: cheap, heavyread and walletwrite\n"
+            "    \"class\": {\n"
+            "      \"threads\": n,        (numeric) Worker threads\n"
+            "      \"busy\": n,           (numeric) Workers running a request\n"
+            "      \"depth\": n,          (numeric) Requests waiting\n"
+            "      \"maxdepth\": n,       (numeric) Depth at which requests are rejected\n"
+            "      \"peakdepth\": n,      (numeric) Most requests ever waiting\n"
+            "      \"admitted\": n,       (numeric) Requests queued\n"
+            "      \"rejected\": n,       (numeric) Requests rejected because the queue was full\n"
+            "      \"cancelled\": n       (numeric) Queued requests dropped because the client disconnected\n"
+            "    }, ...\n"
+            "  }\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getmetrics", "")
+            + HelpExampleCli("getmetrics", "\"rpc.\"")
+            + HelpExampleRpc("getmetrics", "\"leveldb\"")
+        );
+
+    std::string prefix = params.size() ? uni_get_str(params[0]) : "";
+
+    UniValue histograms(UniValue::VOBJ);
+    for (auto pHistogram : GetLatencyHistograms())
+    {
+        if (pHistogram->name.compare(0, prefix.size(), prefix))
+        {
+            continue;
+        }
+        CLatencyHistogram::Snapshot snapshot = pHistogram->GetSnapshot();
+        UniValue histogram(UniValue::VOBJ);
+        histogram.pushKV("description", pHistogram->description);
+        histogram.pushKV("count", (int64_t)snapshot.count);
+        histogram.pushKV("sum", (int64_t)snapshot.sumMicros);
+        histogram.pushKV("mean", snapshot.count ? (double)snapshot.sumMicros / snapshot.count : 0.0);
+        histogram.pushKV("p50", (int64_t)snapshot.Percentile(0.5));
+        histogram.pushKV("p90", (int64_t)snapshot.Percentile(0.9));
+        histogram.pushKV("p99", (int64_t)snapshot.Percentile(0.99));
+
+        int nLast = CLatencyHistogram::NUM_BUCKETS - 1;
+        while (nLast >= 0 && !snapshot.buckets[nLast])
+        {
+            nLast--;
+        }
+        UniValue buckets(UniValue::VARR);
+        for (int i = 0; i <= nLast; i++)
+        {
+            buckets.push_back((int64_t)snapshot.buckets[i]);
+        }
+        histogram.pushKV("buckets", buckets);
+        histograms.pushKV(pHistogram->name, histogram);
+    }
+
+    UniValue counters(UniValue::VOBJ);
+    for (auto &counter : GetHotPathCounters())
+    {
+        counters.pushKV(counter.first, (int64_t)counter.second->get());
+    }
+
+    UniValue queues(UniValue::VOBJ);
+    for (auto &stats : GetHTTPWorkQueueStats())
+    {
+        UniValue queue(UniValue::VOBJ);
+        queue.pushKV("threads", stats.nThreads);
+        queue.pushKV("busy", stats.nBusy);
+        queue.pushKV("depth", (int64_t)stats.nDepth);
+        queue.pushKV("maxdepth", (int64_t)stats.nMaxDepth);
+        queue.pushKV("peakdepth", (int64_t)stats.nPeakDepth);
+        queue.pushKV("admitted", (int64_t)stats.nAdmitted);
+        queue.pushKV("rejected", (int64_t)stats.nRejected);
+        queue.pushKV("cancelled", (int64_t)stats.nCancelled);
+        queues.pushKV(stats.name, queue);
+    }
+
+    UniValue ret(UniValue::VOBJ);
+    ret.pushKV("histograms", histograms);
+    ret.pushKV("counters", counters);
+    ret.pushKV("rpcqueues", queues);
+    return ret;
+}
+
 static const CRPCCommand commands[] =
 { //  category              name                      actor (function)         okSafeMode
   //  --------------------- ------------------------  -----------------------  ----------
     { "control",            "getinfo",                &getinfo,                true  }, /* uses wallet if enabled */
+    { "control",            "getmetrics",             &getmetrics,             true  },
     { "util",               "validateaddress",        &validateaddress,        true  }, /* uses wallet if enabled */
     { "util",               "z_validateaddress",      &z_validateaddress,      true  }, /* uses wallet if enabled */
     { "util",               "createmultisig",         &createmultisig,         true  },
@@ -2656,7 +2811,7 @@ static const CRPCCommand commands[] =
     /* Address index */
     { "addressindex",       "getaddresstxids",        &getaddresstxids,        false }, /* insight explorer */
     { "addressindex",       "getaddressbalance",      &getaddressbalance,      false }, /* insight explorer */
-    { "addressindex",       "getaddressdeltas",       &getaddressdeltas,       false }, /* insight explorer */
+    { "addressindex",       "getaddressdeltas",       &getaddressdeltas,       false, &getaddressdeltas_stream }, /* insight explorer */
     { "addressindex",       "getaddressutxos",        &getaddressutxos,        false }, /* insight explorer */
     { "addressindex",       "getaddressmempool",      &getaddressmempool,      true  }, /* insight explorer */
     { "blockchain",         "getspentinfo",           &getspentinfo,           false }, /* insight explorer */
@@ -17,7 +17,13 @@
 #include "metrics.h"
 #include "miner.h"
 #include "net.h"
+#include "pbaas/convertergraph.h"
+#include "pbaas/currencyregistry.h"
+#include "pbaas/identityindex.h"
+#include "pbaas/offerbook.h"
+#include "pbaas/transferqueue.h"
 #include "pow.h"
+#include "rpc/jsonstream.h"
 #include "rpc/server.h"
 #include "txmempool.h"
 #include "util.h"
@@ -939,6 +945,135 @@ void GetCurrencyDefinitions(const uint160 &systemIDQualifier,
     }
 }
 
+// returns the same currencies as GetCurrencyDefinitions with no block range, from the currency registry
+static void GetRegisteredCurrencies(const uint160 &systemIDQualifier,
+                                    std::vector<std::pair<std::pair<CUTXORef, std::vector<CNodeData>>, CCurrencyDefinition>> &chains,
+                                    CCurrencyDefinition::EQueryOptions launchStateQuery,
+                                    CCurrencyDefinition::EQueryOptions systemTypeQuery,
+                                    const std::set<uint160> &converters)
+{
+    std::set<uint160> currenciesFound;
+    bool isNarrowing = false;
+
+    // each query narrows what the ones before it found
+    auto narrowTo = [&currenciesFound, &isNarrowing](const uint160 &indexKey)
+    {
+        std::set<uint160> indexedCurrencies;
+        CurrencyRegistry.GetIndexedCurrencies(indexKey, indexedCurrencies);
+        if (!isNarrowing)
+        {
+            currenciesFound = indexedCurrencies;
+            isNarrowing = true;
+            return;
+        }
+        for (auto it = currenciesFound.begin(); it != currenciesFound.end();)
+        {
+            it = indexedCurrencies.count(*it) ? std::next(it) : currenciesFound.erase(it);
+        }
+    };
+
+    uint160 systemQueryID;
+    if (systemTypeQuery == CCurrencyDefinition::QUERY_SYSTEMTYPE_LOCAL)
+    {
+        systemQueryID = CCrossChainRPCData::GetConditionID(systemIDQualifier, CCurrencyDefinition::CurrencySystemKey());
+    }
+    else if (systemTypeQuery == CCurrencyDefinition::QUERY_SYSTEMTYPE_IMPORTED)
+    {
+        systemQueryID = CCrossChainRPCData::GetConditionID(ASSETCHAINS_CHAINID, CCurrencyDefinition::ExternalCurrencyKey());
+    }
+    else if (systemTypeQuery == CCurrencyDefinition::QUERY_SYSTEMTYPE_PBAAS)
+    {
+        systemQueryID = CCrossChainRPCData::GetConditionID(ASSETCHAINS_CHAINID, CCurrencyDefinition::PBaaSChainKey());
+    }
+    else if (systemTypeQuery == CCurrencyDefinition::QUERY_SYSTEMTYPE_GATEWAY)
+    {
+        systemQueryID = CCrossChainRPCData::GetConditionID(ASSETCHAINS_CHAINID, CCurrencyDefinition::CurrencyGatewayKey());
+    }
+    else if (launchStateQuery == CCurrencyDefinition::QUERY_NULL && !converters.size())
+    {
+        // no qualifiers, so we default to this system's currencies
+        systemQueryID = CCrossChainRPCData::GetConditionID(ASSETCHAINS_CHAINID, CCurrencyDefinition::CurrencySystemKey());
+    }
+
+    // currencies found by system are listed with the nodes of their definitions, others with their notarizations' as well
+    bool definitionNodesOnly = !systemQueryID.IsNull();
+    if (definitionNodesOnly)
+    {
+        narrowTo(systemQueryID);
+    }
+
+    if (launchStateQuery != CCurrencyDefinition::QUERY_NULL)
+    {
+        uint160 launchQueryID;
+        if (launchStateQuery == CCurrencyDefinition::QUERY_LAUNCHSTATE_PRELAUNCH)
+        {
+            launchQueryID = CCrossChainRPCData::GetConditionID(ASSETCHAINS_CHAINID, CPBaaSNotarization::LaunchPrelaunchKey());
+        }
+        else if (launchStateQuery == CCurrencyDefinition::QUERY_LAUNCHSTATE_REFUND)
+        {
+            launchQueryID = CCrossChainRPCData::GetConditionID(ASSETCHAINS_CHAINID, CPBaaSNotarization::LaunchRefundKey());
+        }
+        else if (launchStateQuery == CCurrencyDefinition::QUERY_LAUNCHSTATE_COMPLETE)
+        {
+            launchQueryID = CCrossChainRPCData::GetConditionID(ASSETCHAINS_CHAINID, CPBaaSNotarization::LaunchCompleteKey());
+        }
+        else if (launchStateQuery == CCurrencyDefinition::QUERY_LAUNCHSTATE_CONFIRM)
+        {
+            launchQueryID = CCrossChainRPCData::GetConditionID(ASSETCHAINS_CHAINID, CPBaaSNotarization::LaunchConfirmKey());
+        }
+        else
+        {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid launchStateQuery");
+        }
+        narrowTo(launchQueryID);
+    }
+
+    for (auto &oneCurID : converters)
+    {
+        narrowTo(CCoinbaseCurrencyState::IndexConverterKey(oneCurID));
+    }
+
+    uint32_t curHeight = chainActive.Height();
+    std::map<CUTXORef, std::pair<std::vector<CNodeData>, CCurrencyDefinition>> definitionsFound;
+    for (auto &oneCurID : currenciesFound)
+    {
+        const CCurrencyRegistryEntry *pEntry = CurrencyRegistry.GetCurrency(oneCurID);
+        if (!pEntry)
+        {
+            LogPrintf("%s: Error getting currency definition %s\n", __func__, EncodeDestination(CIdentityID(oneCurID)).c_str());
+            continue;
+        }
+        if (launchStateQuery == CCurrencyDefinition::QUERY_LAUNCHSTATE_PRELAUNCH && pEntry->definition.startBlock < curHeight)
+        {
+            continue;
+        }
+        std::vector<CNodeData> nodes = pEntry->definitionNodes;
+        if (!definitionNodesOnly)
+        {
+            std::vector<CNodeData> extraNodes;
+            if (oneCurID == ASSETCHAINS_CHAINID)
+            {
+                extraNodes = GetGoodNodes();
+            }
+            else
+            {
+                CChainNotarizationData cnd = CurrencyRegistry.GetNotarizationData(oneCurID);
+                if (cnd.IsConfirmed())
+                {
+                    extraNodes = cnd.vtx[cnd.lastConfirmed].second.nodes;
+                }
+            }
+            nodes.insert(nodes.end(), extraNodes.begin(), extraNodes.end());
+        }
+        definitionsFound.insert(std::make_pair(pEntry->definitionOutput, std::make_pair(nodes, pEntry->definition)));
+    }
+
+    for (auto &oneDef : definitionsFound)
+    {
+        chains.push_back(std::make_pair(std::make_pair(oneDef.first, oneDef.second.first), oneDef.second.second));
+    }
+}
+
 static LRUCache<CUTXORef, std::vector<std::vector<int>>> importMappingCache;    // keyed on import UTXO with the vector of 1->many input/output numbers corresponding 1:1 to reserve transfers
 
 // returns the reserve transfer input to output mapping for an import
@@ -1902,8 +2037,6 @@ bool GetOpRetChainOffer(const CTransaction &postedTx,
     return GetOpRetChainOffer(postedTx, offerTx, inputToOfferTx, height, getUnexpired, getExpired, offerBlockHash);
 }
 
-LRUCache<std::tuple<int, uint256, uint160>, std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue>>> OfferMapCache(50);
-
 // Get internal, compact form of an offer map (on-chain order book) for a currency or ID
 //
 // This will retrieve all offers for the indicated currency in all currencies or as specified in the filter,
@@ -1957,33 +2090,31 @@ GetOfferMap(const uint160 &currencyOrId, bool isCurrency, bool acceptOnlyCurrenc
     std::multimap<std::pair<uint160, CAmount>, UniValue> uniBuyWithCurrency;
     std::multimap<std::pair<uint160, CAmount>, UniValue> uniSellToCurrency;
 
-    std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue>> unspentOutputOffers;
-    std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue>> unspentOutputs = OfferMapCache.Get({(int)isCurrency, chainActive[height]->GetBlockHash(), currencyOrId});
+    std::vector<COutPoint> unspentOutputOffers;
+    std::vector<COutPoint> unspentOutputs;
 
     //printf("%s: looking up keys: %s, %s\n", __func__, EncodeDestination(CKeyID(lookupID)).c_str(), EncodeDestination(CKeyID(lookupForID)).c_str());
 
-    if (!unspentOutputs.size() &&
-        (!GetAddressUnspent(lookupID, CScript::P2PKH, unspentOutputOffers) ||
-         !GetAddressUnspent(lookupForID, CScript::P2PKH, unspentOutputs) ||
-         (!unspentOutputOffers.size() && !unspentOutputs.size())))
+    if (!OfferBook.GetPostedOutputs(lookupID, unspentOutputOffers) ||
+        !OfferBook.GetPostedOutputs(lookupForID, unspentOutputs) ||
+        (!unspentOutputOffers.size() && !unspentOutputs.size()))
     {
         return retVal;
     }
     else
     {
         unspentOutputs.insert(unspentOutputs.end(), unspentOutputOffers.begin(), unspentOutputOffers.end());
-        OfferMapCache.Put({(int)isCurrency, chainActive[height]->GetBlockHash(), currencyOrId}, unspentOutputs);
 
         for (auto &oneOffer : unspentOutputs)
         {
-            CTransaction postedTx, offerTx, inputToOfferTx;
-            uint256 blockHash;
-            CPartialTransactionProof offerTxProof;
+            std::shared_ptr<const COpenOffer> openOffer;
             COptCCParams p;
-            if (myGetTransaction(oneOffer.first.txhash, postedTx, blockHash))
+            if (OfferBook.GetOffer(oneOffer.hash, height, openOffer))
             {
-                if (GetOpRetChainOffer(postedTx, offerTx, inputToOfferTx, height))
+                if (openOffer)
                 {
+                    const CTransaction &offerTx = openOffer->offerTx;
+                    const CTransaction &inputToOfferTx = openOffer->inputToOfferTx;
                     // find out what the transaction is requesting for payment
                     CCurrencyValueMap offerToPay, wePay;
                     CIdentity offerToTransfer, weTransfer;
@@ -2057,7 +2188,7 @@ GetOfferMap(const uint160 &currencyOrId, bool isCurrency, bool acceptOnlyCurrenc
                                                          std::make_pair(std::make_pair((int64_t)0, CCurrencyValueMap(std::vector<uint160>({weTransfer.GetID()}), std::vector<int64_t>({0}))),
                                                                         std::make_pair(CInputDescriptor(offerOuts.second.scriptPubKey,
                                                                                                         offerOuts.second.nValue,
-                                                                                                        CTxIn(COutPoint(oneOffer.first.txhash, 0))),
+                                                                                                        CTxIn(COutPoint(oneOffer.hash, 0))),
                                                                                        offerTx))));
                         }
                         else // this is an offer to buy the ID specified in currencyOrId for either currency or another ID, which is in the first output
@@ -2078,7 +2209,7 @@ GetOfferMap(const uint160 &currencyOrId, bool isCurrency, bool acceptOnlyCurrenc
                                                              std::make_pair(std::make_pair((int64_t)0, CCurrencyValueMap(std::vector<uint160>({currencyOrId}), std::vector<int64_t>({0}))),
                                                                             std::make_pair(CInputDescriptor(offerOuts.second.scriptPubKey,
                                                                                                             offerOuts.second.nValue,
-                                                                                                            CTxIn(COutPoint(oneOffer.first.txhash, 0))),
+                                                                                                            CTxIn(COutPoint(oneOffer.hash, 0))),
                                                                                            offerTx))));
                             }
                             else if (!acceptOnlyId && !offerToTransfer.IsValid())
@@ -2104,7 +2235,7 @@ GetOfferMap(const uint160 &currencyOrId, bool isCurrency, bool acceptOnlyCurrenc
                                                             std::make_pair(std::make_pair((int64_t)0, CCurrencyValueMap(std::vector<uint160>({weTransfer.GetID()}), std::vector<int64_t>({0}))),
                                                                             std::make_pair(CInputDescriptor(offerOuts.second.scriptPubKey,
                                                                                                             offerOuts.second.nValue,
-                                                                                                            CTxIn(COutPoint(oneOffer.first.txhash, 0))),
+                                                                                                            CTxIn(COutPoint(oneOffer.hash, 0))),
                                                                                         offerTx))));
                             }
                         }
@@ -2138,7 +2269,7 @@ GetOfferMap(const uint160 &currencyOrId, bool isCurrency, bool acceptOnlyCurrenc
                                                              std::make_pair(std::make_pair((int64_t)1, CCurrencyValueMap(std::vector<uint160>({currencyOrId}), std::vector<int64_t>({wePay.valueMap[currencyOrId]}))),
                                                                             std::make_pair(CInputDescriptor(offerOuts.second.scriptPubKey,
                                                                                                             offerOuts.second.nValue,
-                                                                                                            CTxIn(COutPoint(oneOffer.first.txhash, 0))),
+                                                                                                            CTxIn(COutPoint(oneOffer.hash, 0))),
                                                                                            offerTx))));
                             }
                             // exchange with other currency
@@ -2208,7 +2339,7 @@ GetOfferMap(const uint160 &currencyOrId, bool isCurrency, bool acceptOnlyCurrenc
                                                              std::make_pair(std::make_pair(1, CCurrencyValueMap(std::vector<uint160>({currencyOrId}), std::vector<int64_t>({wePay.valueMap[currencyOrId]}))),
                                                                             std::make_pair(CInputDescriptor(offerOuts.second.scriptPubKey,
                                                                                                             offerOuts.second.nValue,
-                                                                                                            CTxIn(COutPoint(oneOffer.first.txhash, 0))),
+                                                                                                            CTxIn(COutPoint(oneOffer.hash, 0))),
                                                                                            offerTx))));
                             }
                         }
@@ -2256,7 +2387,7 @@ GetOfferMap(const uint160 &currencyOrId, bool isCurrency, bool acceptOnlyCurrenc
                                                          std::make_pair(std::make_pair(1, CCurrencyValueMap(std::vector<uint160>({currencyID}), std::vector<int64_t>({payAmount}))),
                                                                         std::make_pair(CInputDescriptor(offerOuts.second.scriptPubKey,
                                                                                                         offerOuts.second.nValue,
-                                                                                                        CTxIn(COutPoint(oneOffer.first.txhash, 0))),
+                                                                                                        CTxIn(COutPoint(oneOffer.hash, 0))),
                                                                                        offerTx))));
                         }
                         // offer to sell the specified ID for a currency
@@ -2285,7 +2416,7 @@ GetOfferMap(const uint160 &currencyOrId, bool isCurrency, bool acceptOnlyCurrenc
                                                             std::make_pair(std::make_pair(1, CCurrencyValueMap(std::vector<uint160>({currencyID}), std::vector<int64_t>({payAmount}))),
                                                                         std::make_pair(CInputDescriptor(offerOuts.second.scriptPubKey,
                                                                                                         offerOuts.second.nValue,
-                                                                                                        CTxIn(COutPoint(oneOffer.first.txhash, 0))),
+                                                                                                        CTxIn(COutPoint(oneOffer.hash, 0))),
                                                                                         offerTx))));
                         }
                     }
@@ -2297,7 +2428,7 @@ GetOfferMap(const uint160 &currencyOrId, bool isCurrency, bool acceptOnlyCurrenc
             }
             else
             {
-                LogPrint("marketplace", "%s: cannot retrieve transaction %s, the local index is likely corrupted and either requires reindex, bootstrap, or resync\n", __func__, oneOffer.first.txhash.GetHex().c_str());
+                LogPrint("marketplace", "%s: cannot retrieve transaction %s, the local index is likely corrupted and either requires reindex, bootstrap, or resync\n", __func__, oneOffer.hash.GetHex().c_str());
                 return retVal;
             }
         }
@@ -3603,84 +3734,9 @@ UniValue getimports(const UniValue& params, bool fHelp)
     return NullUniValue;
 }
 
-UniValue listcurrencies(const UniValue& params, bool fHelp)
+// Finds the currencies selected by the parameters of listcurrencies and passes each one's JSON to fn
+static void ListCurrencies(const UniValue& params, const std::function<void(const UniValue&)>& fn)
 {
-    if (fHelp || params.size() > 3)
-    {
-        throw runtime_error(
-            "listcurrencies ({query object}) startblock endblock\n"
-            "\nReturns a complete definition for any given chain if it is registered on the blockchain. If the chain requested\n"
-            "\nis NULL, chain definition of the current chain is returned.\n"
-
-            "\nArguments\n"
-            "{                                    (json, optional) specify valid query conditions\n"
-            "   \"launchstate\" :                   (\"prelaunch\" | \"launched\" | \"refund\" | \"complete\") (optional) return only currencies in that state\n"
-            "   \"systemtype\" :                    (\"local\" | \"imported\" | \"gateway\" | \"pbaas\")\n"
-            "   \"fromsystem\" :                    (\"systemnameeorid\") default is the local chain, but if currency is from another system, specify here\n"
-            "   \"converter\": [\"currency1\", (\"currency2\")] (array, optional) default empty, only return fractional currency converters of one or more currencies\n"
-            "}\n"
-
-            "\nResult:\n"
-            "[\n"
-            "  {\n"
-            "    \"version\" : n,                           (int) version of this chain definition\n"
-            "    \"name\" : \"string\",                     (string) name or symbol of the chain, same as passed\n"
-            "    \"fullyqualifiedname\" : \"string\",       (string) name or symbol of the chain with all parent namespaces, separated by \".\"\n"
-            "    \"currencyid\" : \"i-address\",            (string) string that represents the currency ID, same as the ID behind the currency\n"
-            "    \"currencyidhex\" : \"hex\",               (string) hex representation of currency ID, getcurrency API supports \"hex:currencyidhex\"\n"
-            "    \"parent\" : \"i-address\",                (string) parent blockchain ID\n"
-            "    \"systemid\" : \"i-address\",              (string) system on which this currency is considered to run\n"
-            "    \"launchsystemid\" : \"i-address\",        (string) system from which this currency was launched\n"
-            "    \"notarizationprotocol\" : n               (int) protocol number that determines variations in cross-chain or bridged notarizations\n"
-            "    \"proofprotocol\" : n                      (int) protocol number that determines variations in cross-chain or bridged proofs\n"
-            "    \"startblock\" : n,                        (int) block # on this chain, which must be notarized into block one of the chain\n"
-            "    \"endblock\" : n,                          (int) block # after which, this chain's useful life is considered to be over\n"
-            "    \"currencies\" : \"[\"i-address\", ...]\", (stringarray) currencies that can be converted to this currency at launch or makeup a liquidity basket\n"
-            "    \"weights\" : \"[n, ...]\",                (numberarray) relative currency weights (only returned for a liquidity basket)\n"
-            "    \"conversions\" : \"[n, ...]\",            (numberarray) pre-launch conversion rates for non-fractional currencies\n"
-            "    \"minpreconversion\" : \"[n, ...]\",       (numberarray) minimum amounts required in pre-conversions for currency to launch\n"
-            "    \"currencies\" : \"[\"i-address\", ...]\", (stringarray) currencies that can be converted to this currency at launch or makeup a liquidity basket\n"
-            "    \"currencynames\" : \"{\"i-address\":\"fullname\",...}\", (obj) i-addresses mapped to fully qualified names of all sub-currencies\n"
-            "    \"initialsupply\" : n,                     (number) initial currency supply for fractional currencies before preallocation or issuance\n"
-            "    \"prelaunchcarveout\" : n,                 (number) pre-launch percentage of proceeds for fractional currency sent to launching ID\n"
-            "    \"preallocations\" : \"[{\"i-address\":n}, ...]\", (objarray) VerusIDs and amounts for pre-allocation at launch\n"
-            "    \"initialcontributions\" : \"[n, ...]\",   (numberarray) amounts of pre-conversions reserved for launching ID\n"
-            "    \"idregistrationfees\" : n,                (number) base cost of IDs for this currency namespace in this currency\n"
-            "    \"idreferrallevels\" : n,                  (int) levels of ID referrals (only for native PBaaS chains and IDs)\n"
-            "    \"idimportfees\" : n,                      (number) fees required to import an ID to this system (only for native PBaaS chains and IDs)\n"
-            "    \"eras\" : \"[obj, ...]\",                 (objarray) different chain phases of rewards and convertibility\n"
-            "    {\n"
-            "      \"reward\" : \"[n, ...]\",               (int) reward start for each era in native coin\n"
-            "      \"decay\" : \"[n, ...]\",                (int) exponential or linear decay of rewards during each era\n"
-            "      \"halving\" : \"[n, ...]\",              (int) blocks between halvings during each era\n"
-            "      \"eraend\" : \"[n, ...]\",               (int) block marking the end of each era\n"
-            "      \"eraoptions\" : \"[n, ...]\",           (int) options (reserved)\n"
-            "    }\n"
-            "    \"nodes\"      : \"[obj, ..]\",    (objectarray, optional) up to 8 nodes that can be used to connect to the blockchain"
-            "      [{\n"
-            "         \"nodeidentity\" : \"txid\", (string,  optional) internet, TOR, or other supported address for node\n"
-            "         \"paymentaddress\" : n,     (int,     optional) rewards payment address\n"
-            "       }, .. ]\n"
-            "    \"lastconfirmedcurrencystate\" : {\n"
-            "     }\n"
-            "    \"besttxid\" : \"txid\"\n"
-            "     }\n"
-            "    \"confirmednotarization\" : {\n"
-            "     }\n"
-            "    \"confirmedtxid\" : \"txid\"\n"
-            "  }, ...\n"
-            "]\n"
-
-            "\nExamples:\n"
-            + HelpExampleCli("listcurrencies", "true")
-            + HelpExampleRpc("listcurrencies", "true")
-        );
-    }
-
-    CheckPBaaSAPIsValid();
-
-    UniValue ret(UniValue::VARR);
-
     uint160 querySystem;
     static std::map<std::string, CCurrencyDefinition::EQueryOptions> launchStates(
         {{"prelaunch", CCurrencyDefinition::QUERY_LAUNCHSTATE_PRELAUNCH},
@@ -3701,6 +3757,9 @@ UniValue listcurrencies(const UniValue& params, bool fHelp)
     uint32_t endBlock = 0;
     std::set<uint160> converters;
     uint160 fromSystemID = ASSETCHAINS_CHAINID;
+    uint160 parentID;
+    int64_t fromIndex = 0;
+    int64_t maxCount = -1;
     if (params.size())
     {
         if (!params[0].isObject())
@@ -3739,6 +3798,35 @@ UniValue listcurrencies(const UniValue& params, bool fHelp)
                 converters.insert(oneCurID);
             }
         }
+        std::string parentStr = uni_get_str(find_value(params[0], "parent"));
+        if (parentStr.size())
+        {
+            CTxDestination parentDest = DecodeDestination(parentStr);
+            parentID = parentDest.which() == COptCCParams::ADDRTYPE_ID ? GetDestinationID(parentDest) : ValidateCurrencyName(parentStr, true);
+            if (parentID.IsNull())
+            {
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid parent: " + parentStr);
+            }
+            numKeys--;
+        }
+        UniValue fromUni = find_value(params[0], "from");
+        if (!fromUni.isNull())
+        {
+            if ((fromIndex = uni_get_int64(fromUni, -1)) < 0)
+            {
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "\"from\" must be zero or more");
+            }
+            numKeys--;
+        }
+        UniValue countUni = find_value(params[0], "count");
+        if (!countUni.isNull())
+        {
+            if ((maxCount = uni_get_int64(countUni, -1)) < 0)
+            {
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "\"count\" must be zero or more");
+            }
+            numKeys--;
+        }
         if (launchStates.count(launchState))
         {
             launchStateQuery = launchStates[launchState];
@@ -3766,7 +3854,30 @@ UniValue listcurrencies(const UniValue& params, bool fHelp)
     std::vector<std::pair<std::pair<CUTXORef, std::vector<CNodeData>>, CCurrencyDefinition>> chains;
     {
         LOCK2(cs_main, mempool.cs);
-        GetCurrencyDefinitions(fromSystemID, chains, launchStateQuery, systemTypeQuery, converters, startBlock, endBlock);
+        // the registry follows the tip, so only queries of a block range go to the indexes
+        if (startBlock || endBlock)
+        {
+            GetCurrencyDefinitions(fromSystemID, chains, launchStateQuery, systemTypeQuery, converters, startBlock, endBlock);
+        }
+        else
+        {
+            GetRegisteredCurrencies(fromSystemID, chains, launchStateQuery, systemTypeQuery, converters);
+        }
+    }
+
+    if (!parentID.IsNull())
+    {
+        chains.erase(std::remove_if(chains.begin(), chains.end(),
+                                    [&parentID](const std::pair<std::pair<CUTXORef, std::vector<CNodeData>>, CCurrencyDefinition> &oneDef)
+                                    {
+                                        return oneDef.second.parent != parentID;
+                                    }),
+                     chains.end());
+    }
+    chains.erase(chains.begin(), chains.begin() + std::min((size_t)fromIndex, chains.size()));
+    if (maxCount >= 0 && chains.size() > (size_t)maxCount)
+    {
+        chains.resize(maxCount);
     }
 
     for (auto oneDef : chains)
@@ -3797,8 +3908,7 @@ UniValue listcurrencies(const UniValue& params, bool fHelp)
 
         oneChain.push_back(Pair("currencydefinition", oneDefUni));
 
-        CChainNotarizationData cnd;
-        GetNotarizationData(def.GetID(), cnd);
+        CChainNotarizationData cnd = CurrencyRegistry.GetNotarizationData(def.GetID());
 
         int32_t confirmedHeight = -1, bestHeight = -1;
         confirmedHeight = cnd.vtx.size() && cnd.lastConfirmed != -1 ? cnd.vtx[cnd.lastConfirmed].second.notarizationHeight : -1;
@@ -3821,11 +3931,110 @@ UniValue listcurrencies(const UniValue& params, bool fHelp)
             oneChain.push_back(Pair("besttxout", (uint64_t)cnd.vtx[cnd.forks[cnd.bestChain].back()].first.n));
             oneChain.push_back(Pair("bestcurrencystate", cnd.vtx[cnd.forks[cnd.bestChain].back()].second.currencyState.ToUniValue()));
         }
-        ret.push_back(oneChain);
+        fn(oneChain);
+    }
+}
+
+UniValue listcurrencies(const UniValue& params, bool fHelp)
+{
+    if (fHelp || params.size() > 3)
+    {
+        throw runtime_error(
+            "listcurrencies ({query object}) startblock endblock\n"
+            "\nReturns a complete definition for any given chain if it is registered on the blockchain. If the chain requested\n"
+            "\nis NULL, chain definition of the current chain is returned.\n"
+
+            "\nArguments\n"
+            "{                                    (json, optional) specify valid query conditions\n"
+            "   \"launchstate\" :                   (\"prelaunch\" | \"launched\" | \"refund\" | \"complete\") (optional) return only currencies in that state\n"
+            "   \"systemtype\" :                    (\"local\" | \"imported\" | \"gateway\" | \"pbaas\")\n"
+            "   \"fromsystem\" :                    (\"systemnameeorid\") default is the local chain, but if currency is from another system, specify here\n"
+            "   \"converter\": [\"currency1\", (\"currency2\")] (array, optional) default empty, only return fractional currency converters of one or more currencies\n"
+            "   \"parent\" :                        (\"parentnameorid\") (optional) only return currencies in this namespace\n"
+            "   \"from\" :                          n (optional) default 0, number of matching currencies to skip\n"
+            "   \"count\" :                         n (optional) default all, maximum number of currencies to return\n"
+            "}\n"
+
+            "\nResult:\n"
+            "[\n"
+            "  {\n"
+            "    \"version\" : n,                           (int) version of this chain definition\n"
+            "    \"name\" : \"string\",                     (string) name or symbol of the chain, same as passed\n"
+            "    \"fullyqualifiedname\" : \"string\",       (string) name or symbol of the chain with all parent namespaces, separated by \".\"\n"
+            "    \"currencyid\" : \"i-address\",            (string) string that represents the currency ID, same as the ID behind the currency\n"
+            "    \"currencyidhex\" : \"hex\",               (string) hex representation of currency ID, getcurrency API supports \"hex:currencyidhex\"\n"
+            "    \"parent\" : \"i-address\",                (string) parent blockchain ID\n"
+            "    \"systemid\" : \"i-address\",              (string) system on which this currency is considered to run\n"
+            "    \"launchsystemid\" : \"i-address\",        (string) system from which this currency was launched\n"
+            "    \"notarizationprotocol\" : n               (int) protocol number that determines variations in cross-chain or bridged notarizations\n"
+            "    \"proofprotocol\" : n                      (int) protocol number that determines variations in cross-chain or bridged proofs\n"
+            "    \"startblock\" : n,                        (int) block # on this chain, which must be notarized into block one of the chain\n"
+            "    \"endblock\" : n,                          (int) block # after which, this chain's useful life is considered to be over\n"
+            "    \"currencies\" : \"[\"i-address\", ...]\", (stringarray) currencies that can be converted to this currency at launch or makeup a liquidity basket\n"
+            "    \"weights\" : \"[n, ...]\",                (numberarray) relative currency weights (only returned for a liquidity basket)\n"
+            "    \"conversions\" : \"[n, ...]\",            (numberarray) pre-launch conversion rates for non-fractional currencies\n"
+            "    \"minpreconversion\" : \"[n, ...]\",       (numberarray) minimum amounts required in pre-conversions for currency to launch\n"
+            "    \"currencies\" : \"[\"i-address\", ...]\", (stringarray) currencies that can be converted to this currency at launch or makeup a liquidity basket\n"
+            "    \"currencynames\" : \"{\"i-address\":\"fullname\",...}\", (obj) i-addresses mapped to fully qualified names of all sub-currencies\n"
+            "    \"initialsupply\" : n,                     (number) initial currency supply for fractional currencies before preallocation or issuance\n"
+            "    \"prelaunchcarveout\" : n,                 (number) pre-launch percentage of proceeds for fractional currency sent to launching ID\n"
+            "    \"preallocations\" : \"[{\"i-address\":n}, ...]\", (objarray) VerusIDs and amounts for pre-allocation at launch\n"
+            "    \"initialcontributions\" : \"[n, ...]\",   (numberarray) amounts of pre-conversions reserved for launching ID\n"
+            "    \"idregistrationfees\" : n,                (number) base cost of IDs for this currency namespace in this currency\n"
+            "    \"idreferrallevels\" : n,                  (int) levels of ID referrals (only for native PBaaS chains and IDs)\n"
+            "    \"idimportfees\" : n,                      (number) fees required to import an ID to this system (only for native PBaaS chains and IDs)\n"
+            "    \"eras\" : \"[obj, ...]\",                 (objarray) different chain phases of rewards and convertibility\n"
+            "    {\n"
+            "      \"reward\" : \"[n, ...]\",               (int) reward start for each era in native coin\n"
+            "      \"decay\" : \"[n, ...]\",                (int) exponential or linear decay of rewards during each era\n"
+            "      \"halving\" : \"[n, ...]\",              (int) blocks between halvings during each era\n"
+            "      \"eraend\" : \"[n, ...]\",               (int) block marking the end of each era\n"
+            "      \"eraoptions\" : \"[n, ...]\",           (int) options (reserved)\n"
+            "    }\n"
+            "    \"nodes\"      : \"[obj, ..]\",    (objectarray, optional) up to 8 nodes that can be used to connect to the blockchain"
+            "      [{\n"
+            "         \"nodeidentity\" : \"txid\", (string,  optional) internet, TOR, or other supported address for node\n"
+            "         \"paymentaddress\" : n,     (int,     optional) rewards payment address\n"
+            "       }, .. ]\n"
+            "    \"lastconfirmedcurrencystate\" : {\n"
+            "     }\n"
+            "    \"besttxid\" : \"txid\"\n"
+            "     }\n"
+            "    \"confirmednotarization\" : {\n"
+            "     }\n"
+            "    \"confirmedtxid\" : \"txid\"\n"
+            "  }, ...\n"
+            "]\n"
+
+            "\nExamples:\n"
+            + HelpExampleCli("listcurrencies", "true")
+            + HelpExampleRpc("listcurrencies", "true")
+        );
     }
+
+    CheckPBaaSAPIsValid();
+
+    UniValue ret(UniValue::VARR);
+    ListCurrencies(params, [&ret](const UniValue& oneChain) { ret.push_back(oneChain); });
     return ret;
 }
 
+static void listcurrencies_stream(const UniValue& params, CJSONStreamWriter& result)
+{
+    if (params.size() > 3)
+    {
+        // reports usage
+        result.Value(listcurrencies(params, false));
+        return;
+    }
+
+    CheckPBaaSAPIsValid();
+
+    result.BeginArray();
+    ListCurrencies(params, [&result](const UniValue& oneChain) { result.Value(oneChain); });
+    result.EndArray();
+}
+
 // returns all chain transfer outputs, both spent and unspent between a specific start and end block with an optional chainFilter. if the chainFilter is not
 // NULL, only transfers to that system are returned
 bool GetChainTransfers(multimap<uint160, std::pair<CInputDescriptor, CReserveTransfer>> &inputDescriptors, uint160 chainFilter, int start, int end, uint32_t flags)
@@ -4171,139 +4380,80 @@ bool GetChainTransfersBetween(std::multimap<std::pair<uint32_t, uint160>, std::p
                 std::vector<CInputDescriptor> cacheVec;
                 for (auto it = itpair.first; it != itpair.second; it++)
                 {
-                    cacheVec.push_back(it->second.first);
-                }
-                chainTransferCache.Put({chainFilter, chainActive[i]->GetBlockHash(), 0}, cacheVec);
-            }
-        }
-        return true;
-    }
-}
-
-// returns all unspent chain transfer outputs with an optional chainFilter. if the chainFilter is not
-// NULL, only transfers to that chain are returned
-bool GetUnspentChainTransfers(std::multimap<uint160, ChainTransferData> &inputDescriptors, uint160 chainFilter)
-{
-    bool nofilter = chainFilter.IsNull();
-
-    std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > unspentOutputs;
-
-    LOCK(cs_main);
-
-    if (!GetAddressUnspent(CReserveTransfer::ReserveTransferKey(), CScript::P2IDX, unspentOutputs))
-    {
-        return false;
-    }
-    else
-    {
-        CCoins coins;
-        CCoinsView dummy;
-        CCoinsViewCache view(&dummy);
-
-        LOCK2(smartTransactionCS, mempool.cs);
-        CCoinsViewMemPool viewMemPool(pcoinsTip, mempool);
-        view.SetBackend(viewMemPool);
-
-        for (auto it = unspentOutputs.begin(); it != unspentOutputs.end(); it++)
-        {
-            CCoins coins;
-
-            if (view.GetCoins(it->first.txhash, coins))
-            {
-                if (coins.IsAvailable(it->first.index))
-                {
-                    // if this is a transfer output, optionally to this chain, add it to the input vector
-                    // chain filter was applied in index search
-                    COptCCParams p;
-                    COptCCParams m;
-                    CReserveTransfer rt;
-                    uint160 destCID;
-                    if (coins.vout[it->first.index].scriptPubKey.IsPayToCryptoCondition(p) &&
-                        p.evalCode == EVAL_RESERVE_TRANSFER &&
-                        p.vData.size() &&
-                        p.version >= p.VERSION_V3 &&
-                        (m = COptCCParams(p.vData.back())).IsValid() &&
-                        (rt = CReserveTransfer(p.vData[0])).IsValid() &&
-                        !(destCID = ((rt.flags & rt.IMPORT_TO_SOURCE) ? rt.FirstCurrency() : rt.destCurrencyID)).IsNull() &&
-                        (nofilter || destCID == chainFilter))
-                    {
-                        inputDescriptors.insert(make_pair(destCID,
-                                                          ChainTransferData(coins.nHeight,
-                                                                            CInputDescriptor(coins.vout[it->first.index].scriptPubKey,
-                                                                                            coins.vout[it->first.index].nValue,
-                                                                                            CTxIn(COutPoint(it->first.txhash, it->first.index))),
-                                                                            rt)));
-                    }
+                    cacheVec.push_back(it->second.first);
                 }
-            }
-            else
-            {
-                LogPrint("crosschainexports", "%s: cannot retrieve transaction %s from height %u\n", __func__, it->first.txhash.GetHex().c_str(), it->second.blockHeight);
+                chainTransferCache.Put({chainFilter, chainActive[i]->GetBlockHash(), 0}, cacheVec);
             }
         }
         return true;
     }
 }
 
+// returns all unspent chain transfer outputs with an optional chainFilter. if the chainFilter is not
+// NULL, only transfers to that chain are returned
+bool GetUnspentChainTransfers(std::multimap<uint160, ChainTransferData> &inputDescriptors, uint160 chainFilter)
+{
+    LOCK(cs_main);
+
+    if (chainFilter.IsNull())
+    {
+        return PendingTransfers.GetAllTransfers(inputDescriptors);
+    }
+
+    std::vector<ChainTransferData> transfers;
+    if (!PendingTransfers.GetTransfers(chainFilter, transfers))
+    {
+        return false;
+    }
+    for (auto &oneTransfer : transfers)
+    {
+        inputDescriptors.insert(make_pair(chainFilter, oneTransfer));
+    }
+    return true;
+}
+
 // returns all unspent chain transfer outputs, * including from the mempool *
 bool GetUnspentChainTransfers(std::vector<ChainTransferData> &inputDescriptors, uint160 chainID)
 {
-    std::vector<std::pair<CInputDescriptor, uint32_t>> unspentOutputs;
+    std::vector<std::pair<CMempoolAddressDeltaKey, CMempoolAddressDelta>> unconfirmedUTXOs;
+    std::vector<ChainTransferData> confirmedTransfers;
 
     LOCK(cs_main);
     LOCK2(smartTransactionCS, mempool.cs);
 
-    if (!ConnectedChains.GetUnspentByIndex(CReserveTransfer::ReserveTransferKey(), unspentOutputs))
+    if (!PendingTransfers.GetTransfers(chainID, confirmedTransfers) ||
+        !mempool.getAddressIndex(std::vector<std::pair<uint160, int32_t>>({{CReserveTransfer::ReserveTransferKey(), CScript::P2IDX}}), unconfirmedUTXOs))
     {
+        LogPrintf("%s: Cannot read address indexes\n", __func__);
         return false;
     }
-    else
-    {
-        CCoins coins;
-        CCoinsView dummy;
-        CCoinsViewCache view(&dummy);
-
-        CCoinsViewMemPool viewMemPool(pcoinsTip, mempool);
-        view.SetBackend(viewMemPool);
 
-        for (auto it = unspentOutputs.begin(); it != unspentOutputs.end(); it++)
+    // confirmed transfers already being exported in the mempool are no longer pending
+    for (auto &oneTransfer : confirmedTransfers)
+    {
+        if (!mempool.mapNextTx.count(std::get<1>(oneTransfer).txIn.prevout))
         {
-            CCoins coins;
+            inputDescriptors.push_back(oneTransfer);
+        }
+    }
 
-            if (view.GetCoins(it->first.txIn.prevout.hash, coins))
-            {
-                if (coins.IsAvailable(it->first.txIn.prevout.n))
-                {
-                    // if this is a transfer output, optionally to this chain, add it to the input vector
-                    // chain filter was applied in index search
-                    COptCCParams p;
-                    COptCCParams m;
-                    CReserveTransfer rt;
-                    uint160 destCID;
-                    if (coins.vout[it->first.txIn.prevout.n].scriptPubKey.IsPayToCryptoCondition(p) &&
-                        p.evalCode == EVAL_RESERVE_TRANSFER &&
-                        p.vData.size() &&
-                        p.version >= p.VERSION_V3 &&
-                        (m = COptCCParams(p.vData.back())).IsValid() &&
-                        (rt = CReserveTransfer(p.vData[0])).IsValid() &&
-                        !(destCID = rt.GetImportCurrency()).IsNull() &&
-                        destCID == chainID)
-                    {
-                        inputDescriptors.push_back(ChainTransferData(it->second,
-                                                                     CInputDescriptor(coins.vout[it->first.txIn.prevout.n].scriptPubKey,
-                                                                                      coins.vout[it->first.txIn.prevout.n].nValue,
-                                                                                      CTxIn(COutPoint(it->first.txIn.prevout.hash, it->first.txIn.prevout.n))),
-                                                                     rt));
-                    }
-                }
-            }
-            else
-            {
-                LogPrint("crosschainexports", "%s: cannot retrieve transaction %s from height %u\n", __func__, it->first.txIn.prevout.hash.GetHex().c_str(), coins.nHeight);
-            }
+    std::set<COutPoint> spentInMempool;
+    for (auto &oneUnconfirmed : mempool.FilterUnspent(unconfirmedUTXOs, spentInMempool))
+    {
+        const CTransaction &oneTx = mempool.mapTx.find(oneUnconfirmed.first.txhash)->GetTx();
+        uint160 destID;
+        ChainTransferData oneTransfer;
+        if (CPendingTransferQueue::DecodeTransfer(oneTx.vout[oneUnconfirmed.first.index],
+                                                  COutPoint(oneUnconfirmed.first.txhash, oneUnconfirmed.first.index),
+                                                  0,
+                                                  destID,
+                                                  oneTransfer) &&
+            destID == chainID)
+        {
+            inputDescriptors.push_back(oneTransfer);
         }
-        return true;
     }
+    return true;
 }
 
 void CChainNotarizationData::SetBestChain(const CCurrencyDefinition &fromChainDef,
@@ -6368,17 +6518,6 @@ CCoinbaseCurrencyState GetInitialCurrencyState(const CCurrencyDefinition &chainD
     return retVal;
 }
 
-std::vector<CAddressUnspentDbEntry> GetFractionalNotarizationsForReserve(const uint160 &currencyID)
-{
-    std::vector<CAddressUnspentDbEntry> fractionalNotarizations;
-    CIndexID indexKey = CCoinbaseCurrencyState::IndexConverterKey(currencyID);
-    if (!GetAddressUnspent(indexKey, CScript::P2IDX, fractionalNotarizations))
-    {
-        LogPrintf("%s: Error reading unspent index\n", __func__);
-    }
-    return fractionalNotarizations;
-}
-
 // calculate the amount necessary for conversion, starting from the currency state & given a max slippage and price target to be less than or equal to
 // if we can't meet slippage or target price, we return 0
 CAmount GetNecessaryAmountForConversion(const CCurrencyDefinition &destSystem,
@@ -6695,20 +6834,23 @@ UniValue getcurrencyconverters(const UniValue& params, bool fHelp)
         }
     }
 
+    // the converter graph is only read and updated under cs_main
+    LOCK(cs_main);
+
     // get all currencies that contain all specified reserves in our fractionalsFound set
     // use latest notarizations of the currencies to do so
-    std::vector<CAddressUnspentDbEntry> activeFractionals;
+    std::vector<std::pair<CUTXORef, CPBaaSNotarization>> activeFractionals;
     std::set<int32_t> toRemove;
-    if ((activeFractionals = GetFractionalNotarizationsForReserve(toCurID)).size() &&
+    if ((activeFractionals = ConverterGraph.GetConverters(toCurID)).size() &&
         reserves.size())
     {
         auto resIt = reserves.begin();
         for (int i = 0; i < activeFractionals.size(); i++)
         {
-            CPBaaSNotarization pbn(activeFractionals[i].second.script);
+            const CPBaaSNotarization &pbn = activeFractionals[i].second;
             if (!pbn.IsValid())
             {
-                throw JSONRPCError(RPC_DESERIALIZATION_ERROR, "Cannot read currency notarization in transaction " + activeFractionals[i].first.txhash.GetHex());
+                throw JSONRPCError(RPC_DESERIALIZATION_ERROR, "Cannot read currency notarization in transaction " + activeFractionals[i].first.hash.GetHex());
             }
             if (!(pbn.currencyState.IsLaunchConfirmed() && pbn.currencyState.IsLaunchCompleteMarker()))
             {
@@ -6752,7 +6894,7 @@ UniValue getcurrencyconverters(const UniValue& params, bool fHelp)
         }
     }
 
-    CCoinbaseCurrencyState toState = ConnectedChains.GetCurrencyState(toCurID, chainActive.Height(), true);
+    CCoinbaseCurrencyState toState = ConverterGraph.GetCurrency(toCurID).currencyState;
     if (toCurrencyDef.systemID == ASSETCHAINS_CHAINID && !(toState.IsValid() && toState.IsLaunchConfirmed()))
     {
         throw JSONRPCError(RPC_INVALID_PARAMETER, "Cannot get converters for pre-launch or refunded currency " + EncodeDestination(CIdentityID(toCurID)));
@@ -6789,7 +6931,7 @@ UniValue getcurrencyconverters(const UniValue& params, bool fHelp)
     {
         if (oneReserve.second.first.IsFractional())
         {
-            CCoinbaseCurrencyState oneState = ConnectedChains.GetCurrencyState(oneReserve.first, chainActive.Height(), true);
+            CCoinbaseCurrencyState oneState = ConverterGraph.GetCurrency(oneReserve.first).currencyState;
             if (!(oneState.IsValid() && oneState.IsLaunchConfirmed() && oneState.IsLaunchCompleteMarker()))
             {
                 throw JSONRPCError(RPC_INVALID_PARAMETER, "Cannot convert pre-launch or refunded currency " + EncodeDestination(CIdentityID(toCurID)));
@@ -6832,23 +6974,28 @@ UniValue getcurrencyconverters(const UniValue& params, bool fHelp)
 
     for (int i = 0; i < activeFractionals.size(); i++)
     {
-        CPBaaSNotarization pbn(activeFractionals[i].second.script);
+        const CPBaaSNotarization &pbn = activeFractionals[i].second;
         CCurrencyDefinition oneCur;
         // if we already have it, move on
         if (converterCurrencyOptions.count(pbn.currencyID))
         {
             continue;
         }
+        const CConverterCurrency &converter = ConverterGraph.GetCurrency(pbn.currencyID);
         if (reserves.count(pbn.currencyID))
         {
             oneCur = reserves[pbn.currencyID].first;
         }
-        else if (!GetCurrencyDefinition(pbn.currencyID, oneCur))
+        else if (!converter.IsValid())
         {
             throw JSONRPCError(RPC_INVALID_PARAMETER, "Cannot get currency definition for currency " + EncodeDestination(CIdentityID(pbn.currencyID)));
         }
+        else
+        {
+            oneCur = converter.currency;
+        }
 
-        CCoinbaseCurrencyState oneState = ConnectedChains.GetCurrencyState(pbn.currencyID, chainActive.Height(), true);
+        CCoinbaseCurrencyState oneState = converter.currencyState;
         if (!(oneState.IsValid() && oneState.IsLaunchConfirmed() && oneState.IsLaunchCompleteMarker()))
         {
             continue;
@@ -6936,7 +7083,7 @@ UniValue getcurrencyconverters(const UniValue& params, bool fHelp)
         UniValue oneCurrency(UniValue::VOBJ);
         oneCurrency.push_back(Pair(EncodeDestination(CIdentityID(std::get<0>(oneConverter.second).GetID())), std::get<0>(oneConverter.second).ToUniValue()));
         oneCurrency.pushKV("fullyqualifiedname", ConnectedChains.GetFriendlyCurrencyName(std::get<0>(oneConverter.second).GetID()));
-        std::tuple<uint32_t, CUTXORef, CPBaaSNotarization> lastNotarization = GetLastConfirmedNotarization(oneConverter.first, chainActive.Height());
+        std::tuple<uint32_t, CUTXORef, CPBaaSNotarization> lastNotarization = ConverterGraph.GetCurrency(oneConverter.first).lastConfirmed;
         oneCurrency.push_back(Pair("height", int64_t(std::get<0>(lastNotarization))));
         oneCurrency.push_back(Pair("output", std::get<1>(lastNotarization).ToUniValue()));
         oneCurrency.push_back(Pair("lastnotarization", std::get<2>(lastNotarization).ToUniValue()));
@@ -7196,14 +7343,11 @@ UniValue estimateconversion(const UniValue& params, bool fHelp)
         uint160 fractionalCurrencyID = fractionalCurrency.GetID();
 
         CUTXORef lastUnspentUTXO;
-        CTransaction lastUnspentTx;
 
         if (fractionalCurrency.systemID == ASSETCHAINS_CHAINID)
         {
-            notarization.GetLastUnspentNotarization(fractionalCurrencyID,
-                                                    lastUnspentUTXO.hash,
-                                                    *((int32_t *)&lastUnspentUTXO.n),
-                                                    &lastUnspentTx);
+            // pending conversions include the mempool, so only the notarization they start from is cached
+            ConverterGraph.GetLastUnspentNotarization(fractionalCurrencyID, lastUnspentUTXO, notarization);
         }
         else
         {
@@ -8665,18 +8809,19 @@ UniValue takeoffer(const UniValue& params, bool fHelp)
             {
                 throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid txid specified");
             }
-            uint256 blockHash;
-            CTransaction postedTx;
-            if (!myGetTransaction(txIdToTake, postedTx, blockHash))
+            std::shared_ptr<const COpenOffer> offer;
+            if (!OfferBook.GetOffer(txIdToTake, height, offer))
             {
                 throw JSONRPCError(RPC_INVALID_PARAMETER, "Transaction " + txIdToTake.GetHex() + " not found");
             }
 
             // get the actual transaction from the op return
-            if (!GetOpRetChainOffer(postedTx, txToTake, inputTxToOffer, height))
+            if (!offer)
             {
                 throw JSONRPCError(RPC_INVALID_PARAMETER, "Unable to retrieve valid offer");
             }
+            txToTake = offer->offerTx;
+            inputTxToOffer = offer->inputToOfferTx;
         }
         else if (!txStringToTake.empty())
         {
@@ -9426,8 +9571,8 @@ UniValue getoffers(const UniValue& params, bool fHelp)
         currencyOrIdID = identity.GetID();
     }
 
-    std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue>> unspentOutputOffers;
-    std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue>> unspentOutputs;
+    std::vector<COutPoint> unspentOutputOffers;
+    std::vector<COutPoint> unspentOutputs;
 
     uint32_t height = chainActive.Height();
 
@@ -9442,7 +9587,7 @@ UniValue getoffers(const UniValue& params, bool fHelp)
 
     //printf("%s: looking up keys: %s, %s\n", __func__, EncodeDestination(CKeyID(lookupID)).c_str(), EncodeDestination(CKeyID(lookupForID)).c_str());
 
-    if (!GetAddressUnspent(lookupID, CScript::P2PKH, unspentOutputOffers) || !GetAddressUnspent(lookupForID, CScript::P2PKH, unspentOutputs))
+    if (!OfferBook.GetPostedOutputs(lookupID, unspentOutputOffers) || !OfferBook.GetPostedOutputs(lookupForID, unspentOutputs))
     {
         return false;
     }
@@ -9453,14 +9598,15 @@ UniValue getoffers(const UniValue& params, bool fHelp)
 
         for (auto &oneOffer : unspentOutputs)
         {
-            CTransaction postedTx, offerTx, inputToOfferTx;
-            uint256 blockHash;
-            CPartialTransactionProof offerTxProof;
+            std::shared_ptr<const COpenOffer> openOffer;
             COptCCParams p;
-            if (myGetTransaction(oneOffer.first.txhash, postedTx, blockHash))
+            if (OfferBook.GetOffer(oneOffer.hash, height, openOffer))
             {
-                if (GetOpRetChainOffer(postedTx, offerTx, inputToOfferTx, height))
+                if (openOffer)
                 {
+                    const CTransaction &postedTx = openOffer->postedTx;
+                    const CTransaction &offerTx = openOffer->offerTx;
+                    const CTransaction &inputToOfferTx = openOffer->inputToOfferTx;
                     // find out what the transaction is requesting for payment
                     CCurrencyValueMap offerToPay, wePay;
                     CIdentity offerToTransfer, weTransfer;
@@ -9696,7 +9842,7 @@ UniValue getoffers(const UniValue& params, bool fHelp)
             }
             else
             {
-                throw JSONRPCError(RPC_INVALID_PARAMETER, "Cannot retrieve transaction " + oneOffer.first.txhash.GetHex() + ", the local index is likely corrupted and either requires reindex, bootstrap, or resync");
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "Cannot retrieve transaction " + oneOffer.hash.GetHex() + ", the local index is likely corrupted and either requires reindex, bootstrap, or resync");
             }
         }
         if (isCurrency)
@@ -12888,20 +13034,31 @@ UniValue getsaplingtree(const UniValue& params, bool fHelp)
 
     std::string networkIDName = EncodeDestination(CIdentityID(ASSETCHAINS_CHAINID));
 
+    // blocks without shielded outputs share the tree of the block before, which is only looked up and encoded once
+    uint256 lastRoot;
+    std::string lastTreeHex;
+
     for (int i = start; i <= end; i += step)
     {
         CBlockIndex &blkIndex = *(chainActive[i]);
-        if (view.GetSaplingAnchorAt(blkIndex.hashFinalSaplingRoot, tree))
+        if (lastTreeHex.empty() || blkIndex.hashFinalSaplingRoot != lastRoot)
         {
-            UniValue entry(UniValue::VOBJ);
-            entry.push_back(Pair("network", networkIDName));
-            entry.push_back(Pair("height", blkIndex.GetHeight()));
-            entry.push_back(Pair("hash", blkIndex.GetBlockHash().GetHex()));
-            entry.push_back(Pair("time", (uint64_t)chainActive.LastTip()->nTime));
+            lastTreeHex.clear();
+            if (!view.GetSaplingAnchorAt(blkIndex.hashFinalSaplingRoot, tree))
+            {
+                continue;
+            }
             std::vector<unsigned char> treeBytes = ::AsVector(tree);
-            entry.push_back(Pair("tree", HexBytes(treeBytes.data(), treeBytes.size())));
-            ret.push_back(entry);
+            lastRoot = blkIndex.hashFinalSaplingRoot;
+            lastTreeHex = HexBytes(treeBytes.data(), treeBytes.size());
         }
+        UniValue entry(UniValue::VOBJ);
+        entry.push_back(Pair("network", networkIDName));
+        entry.push_back(Pair("height", blkIndex.GetHeight()));
+        entry.push_back(Pair("hash", blkIndex.GetBlockHash().GetHex()));
+        entry.push_back(Pair("time", (uint64_t)chainActive.LastTip()->nTime));
+        entry.push_back(Pair("tree", lastTreeHex));
+        ret.push_back(entry);
     }
     return ret;
 }
@@ -17163,21 +17320,27 @@ UniValue IdentityPairToUni(const std::pair<CIdentityMapKey, CIdentityMapValue> &
 
 UniValue listidentities(const UniValue& params, bool fHelp)
 {
-    if (fHelp || params.size() > 3)
+    if (fHelp || params.size() > 5)
     {
         throw runtime_error(
-            "listidentities (includecanspend) (includecansign) (includewatchonly)\n"
+            "listidentities (includecanspend) (includecansign) (includewatchonly) (afteridentity) (count)\n"
             "\n\n"
 
             "\nArguments\n"
             "    \"includecanspend\"    (bool, optional, default=true)    Include identities for which we can spend/authorize\n"
             "    \"includecansign\"     (bool, optional, default=true)    Include identities that we can only sign for but not spend\n"
             "    \"includewatchonly\"   (bool, optional, default=false)   Include identities that we can neither sign nor spend, but are either watched or are co-signers with us\n"
+            "    \"afteridentity\"      (string, optional, default=\"\")   Only include identities that follow this ID or i-address in ID order\n"
+            "    \"count\"              (number, optional, default=0)     Return at most this many identities (0 == no limit)\n"
+            "\n"
+            "If either afteridentity or count is specified, identities of all included kinds are returned together in ID order, and\n"
+            "the next page starts after the last identity returned.\n"
 
             "\nResult:\n"
 
             "\nExamples:\n"
             + HelpExampleCli("listidentities", "true")
+            + HelpExampleCli("listidentities", "true true false \"\" 100")
             + HelpExampleRpc("listidentities", "true")
         );
     }
@@ -17192,130 +17355,177 @@ UniValue listidentities(const UniValue& params, bool fHelp)
     bool includeCanSign = params.size() > 1 ? uni_get_bool(params[1], true) : true;
     bool includeWatchOnly = params.size() > 2 ? uni_get_bool(params[2], false) : false;
 
+    uint160 afterID;
+    std::string afterString = params.size() > 3 ? uni_get_str(params[3]) : "";
+    if (!afterString.empty())
+    {
+        CTxDestination afterDest = DecodeDestination(afterString);
+        if (afterDest.which() != COptCCParams::ADDRTYPE_ID)
+        {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "afteridentity must be a valid identity or i-address");
+        }
+        afterID = GetDestinationID(afterDest);
+    }
+    int64_t maxCount = params.size() > 4 ? uni_get_int64(params[4], -1) : 0;
+    if (maxCount < 0)
+    {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "count must be zero or more");
+    }
+
     LOCK2(cs_main, pwalletMain->cs_wallet);
 
     if (pwalletMain->GetIdentities(mine, imsigner, notmine))
     {
-        UniValue ret(UniValue::VARR);
+        std::vector<std::pair<CIdentityMapKey, CIdentityMapValue>> identities;
         if (includeCanSpend)
         {
-            for (auto identity : mine)
-            {
-                uint160 parent;
-                if (identity.second.IsValid() && identity.second.name == CleanName(identity.second.name, parent))
-                {
-                    oneIdentity = CIdentity::LookupIdentity(identity.first.idID, 0, &oneIdentityHeight);
+            identities.insert(identities.end(), mine.begin(), mine.end());
+        }
+        if (includeCanSign)
+        {
+            identities.insert(identities.end(), imsigner.begin(), imsigner.end());
+        }
+        if (includeWatchOnly)
+        {
+            identities.insert(identities.end(), notmine.begin(), notmine.end());
+        }
 
-                    if (!oneIdentity.IsValid())
-                    {
-                        if (identity.first.idID != VERUS_CHAINID)
-                        {
-                            continue;
-                        }
-                        std::vector<CTxDestination> primary({CTxDestination(CKeyID(uint160()))});
-                        std::vector<std::pair<uint160, uint256>> contentmap;
-                        std::multimap<uint160, std::vector<unsigned char>> contentmultimap;
-                        oneIdentity = CIdentity(CConstVerusSolutionVector::GetVersionByHeight(oneIdentityHeight) >= CActivationHeight::ACTIVATE_PBAAS ?
-                                                                                                        CIdentity::VERSION_PBAAS :
-                                                                                                        CIdentity::VERSION_VAULT,
-                                                CIdentity::FLAG_ACTIVECURRENCY,
-                                                primary,
-                                                1,
-                                                ConnectedChains.ThisChain().parent,
-                                                VERUS_CHAINNAME,
-                                                contentmap,
-                                                contentmultimap,
-                                                ConnectedChains.ThisChain().GetID(),
-                                                ConnectedChains.ThisChain().GetID(),
-                                                std::vector<libzcash::SaplingPaymentAddress>());
-                    }
-                    (*(CIdentity *)&identity.second) = oneIdentity;
-                    // TODO: confirm that missing block order is fine for this API
-                    identity.first.blockHeight = oneIdentityHeight;
-                    ret.push_back(IdentityPairToUni(identity));
-                }
+        // select the page before looking any identities up, since that is where the time goes
+        if (!afterID.IsNull() || maxCount)
+        {
+            std::sort(identities.begin(), identities.end(),
+                [](const std::pair<CIdentityMapKey, CIdentityMapValue> &a, const std::pair<CIdentityMapKey, CIdentityMapValue> &b)
+                {
+                    return a.first.idID < b.first.idID;
+                });
+            auto pageStart = identities.begin();
+            while (pageStart != identities.end() && !afterID.IsNull() && !(afterID < pageStart->first.idID))
+            {
+                pageStart++;
+            }
+            identities.erase(identities.begin(), pageStart);
+            if (maxCount && identities.size() > (size_t)maxCount)
+            {
+                identities.resize(maxCount);
             }
         }
-        if (includeCanSign)
+
+        UniValue ret(UniValue::VARR);
+        for (auto identity : identities)
         {
-            for (auto identity : imsigner)
+            uint160 parent;
+            if (identity.second.IsValid() && identity.second.name == CleanName(identity.second.name, parent))
             {
-                uint160 parent;
-                if (identity.second.IsValid() && identity.second.name == CleanName(identity.second.name, parent))
-                {
-                    oneIdentity = CIdentity::LookupIdentity(identity.first.idID, 0, &oneIdentityHeight);
+                oneIdentity = CIdentity::LookupIdentity(identity.first.idID, 0, &oneIdentityHeight);
 
-                    if (!oneIdentity.IsValid())
+                if (!oneIdentity.IsValid())
+                {
+                    if (identity.first.idID != VERUS_CHAINID)
                     {
-                        if (identity.first.idID != VERUS_CHAINID)
-                        {
-                            continue;
-                        }
-                        std::vector<CTxDestination> primary({CTxDestination(CKeyID(uint160()))});
-                        std::vector<std::pair<uint160, uint256>> contentmap;
-                        std::multimap<uint160, std::vector<unsigned char>> contentmultimap;
-                        oneIdentity = CIdentity(CConstVerusSolutionVector::GetVersionByHeight(oneIdentityHeight) >= CActivationHeight::ACTIVATE_PBAAS ?
-                                                                                                        CIdentity::VERSION_PBAAS :
-                                                                                                        CIdentity::VERSION_VAULT,
-                                                CIdentity::FLAG_ACTIVECURRENCY,
-                                                primary,
-                                                1,
-                                                ConnectedChains.ThisChain().parent,
-                                                VERUS_CHAINNAME,
-                                                contentmap,
-                                                contentmultimap,
-                                                ConnectedChains.ThisChain().GetID(),
-                                                ConnectedChains.ThisChain().GetID(),
-                                                std::vector<libzcash::SaplingPaymentAddress>());
+                        continue;
                     }
-                    (*(CIdentity *)&identity.second) = oneIdentity;
-                    ret.push_back(IdentityPairToUni(identity));
+                    std::vector<CTxDestination> primary({CTxDestination(CKeyID(uint160()))});
+                    std::vector<std::pair<uint160, uint256>> contentmap;
+                    std::multimap<uint160, std::vector<unsigned char>> contentmultimap;
+                    oneIdentity = CIdentity(CConstVerusSolutionVector::GetVersionByHeight(oneIdentityHeight) >= CActivationHeight::ACTIVATE_PBAAS ?
+                                                                                                    CIdentity::VERSION_PBAAS :
+                                                                                                    CIdentity::VERSION_VAULT,
+                                            CIdentity::FLAG_ACTIVECURRENCY,
+                                            primary,
+                                            1,
+                                            ConnectedChains.ThisChain().parent,
+                                            VERUS_CHAINNAME,
+                                            contentmap,
+                                            contentmultimap,
+                                            ConnectedChains.ThisChain().GetID(),
+                                            ConnectedChains.ThisChain().GetID(),
+                                            std::vector<libzcash::SaplingPaymentAddress>());
+                }
+                (*(CIdentity *)&identity.second) = oneIdentity;
+                if (identity.first.flags & identity.first.CAN_SPEND)
+                {
+                    // TODO: confirm that missing block order is fine for this API
+                    identity.first.blockHeight = oneIdentityHeight;
                 }
+                ret.push_back(IdentityPairToUni(identity));
             }
         }
-        if (includeWatchOnly)
+        return ret;
+    }
+    else
+    {
+        return NullUniValue;
+    }
+}
+
+// identities indexed under indexKey for the getidentitieswith* APIs, in ID order, optionally paged with an identity
+// to start after and a count. current identities are read from the identity index, earlier outputs from the address index
+// through the IDs the identity index keeps for them
+static UniValue GetIdentitiesWithIndexKey(const uint160 &indexKey, const UniValue &query)
+{
+    UniValue retVal(UniValue::VARR);
+
+    uint32_t fromHeight = uni_get_int64(find_value(query, "fromheight"));
+    uint32_t toHeight = uni_get_int64(find_value(query, "toheight"));
+
+    uint160 afterID;
+    std::string afterString = uni_get_str(find_value(query, "after"));
+    if (!afterString.empty())
+    {
+        CTxDestination afterDest = DecodeDestination(afterString);
+        if (afterDest.which() != COptCCParams::ADDRTYPE_ID)
+        {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "\"after\" must be a valid identity or i-address");
+        }
+        afterID = GetDestinationID(afterDest);
+    }
+    int64_t maxCount = 0;
+    UniValue countUni = find_value(query, "count");
+    if (!countUni.isNull() && (maxCount = uni_get_int64(countUni, -1)) < 0)
+    {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "\"count\" must be zero or more");
+    }
+
+    if (uni_get_bool(find_value(query, "unspent")))
+    {
+        LOCK(cs_main);
+        std::vector<CIndexedIdentity> identities;
+
+        // heights filter what is returned, so a page can only be limited in the index without them
+        bool heightFiltered = fromHeight || toHeight;
+        if (IdentityIndex.GetIdentities(indexKey, identities, afterID, heightFiltered ? 0 : maxCount))
         {
-            for (auto identity : notmine)
+            for (auto &oneIdentity : identities)
             {
-                uint160 parent;
-                if (identity.second.IsValid() && identity.second.name == CleanName(identity.second.name, parent))
+                if (maxCount && retVal.size() >= (size_t)maxCount)
                 {
-                    oneIdentity = CIdentity::LookupIdentity(identity.first.idID, 0, &oneIdentityHeight);
-
-                    if (!oneIdentity.IsValid())
-                    {
-                        if (identity.first.idID != VERUS_CHAINID)
-                        {
-                            continue;
-                        }
-                        std::vector<CTxDestination> primary({CTxDestination(CKeyID(uint160()))});
-                        std::vector<std::pair<uint160, uint256>> contentmap;
-                        std::multimap<uint160, std::vector<unsigned char>> contentmultimap;
-                        oneIdentity = CIdentity(CConstVerusSolutionVector::GetVersionByHeight(oneIdentityHeight) >= CActivationHeight::ACTIVATE_PBAAS ?
-                                                                                                        CIdentity::VERSION_PBAAS :
-                                                                                                        CIdentity::VERSION_VAULT,
-                                                CIdentity::FLAG_ACTIVECURRENCY,
-                                                primary,
-                                                1,
-                                                ConnectedChains.ThisChain().parent,
-                                                VERUS_CHAINNAME,
-                                                contentmap,
-                                                contentmultimap,
-                                                ConnectedChains.ThisChain().GetID(),
-                                                ConnectedChains.ThisChain().GetID(),
-                                                std::vector<libzcash::SaplingPaymentAddress>());
-                    }
-                    (*(CIdentity *)&identity.second) = oneIdentity;
-                    ret.push_back(IdentityPairToUni(identity));
+                    break;
+                }
+                if ((!fromHeight || oneIdentity.blockHeight >= fromHeight) &&
+                    (!toHeight || oneIdentity.blockHeight <= toHeight))
+                {
+                    UniValue idUni = oneIdentity.identity.ToUniValue();
+                    idUni.pushKV("txout", CUTXORef(oneIdentity.output.hash, oneIdentity.output.n).ToUniValue());
+                    retVal.push_back(idUni);
                 }
             }
         }
-        return ret;
     }
     else
     {
-        return NullUniValue;
+        LOCK(cs_main);
+        std::vector<std::pair<CAddressIndexDbEntry, CIdentity>> identities;
+        if (IdentityIndex.GetIdentityOuts(indexKey, identities, fromHeight, toHeight, afterID, maxCount))
+        {
+            for (auto &oneIdentity : identities)
+            {
+                UniValue idUni = oneIdentity.second.ToUniValue();
+                idUni.pushKV("txout", CUTXORef(oneIdentity.first.first.txhash, oneIdentity.first.first.index).ToUniValue());
+                retVal.push_back(idUni);
+            }
+        }
     }
+    return retVal;
 }
 
 UniValue getidentitieswithaddress(const UniValue& params, bool fHelp)
@@ -17332,10 +17542,12 @@ UniValue getidentitieswithaddress(const UniValue& params, bool fHelp)
             "    \"fromheight\":n               (number, optional, default=0) Search for qualified identities modified from this height forward only\n"
             "    \"toheight\":n                 (number, optional, default=0) Search for qualified identities only up until this height (0 == no limit)\n"
             "    \"unspent\":bool               (bool, optional, default=false) if true, this will only return active ID UTXOs as of the current block height\n"
+            "    \"after\":\"idori-address\"      (string, optional) only return identities that follow this one in ID order, to page from the last identity returned\n"
+            "    \"count\":n                    (number, optional, default=0) return at most this many identities (0 == no limit)\n"
             "}\n"
 
             "\nResult:\n"
-            "[                                  (array) array of matching identities\n"
+            "[                                  (array) array of matching identities, in order of identity ID\n"
             "  {identityobject},                (object) identity with additional member \"txout\" with txhash and output index\n"
             "  ...\n"
             "]\n"
@@ -17351,7 +17563,6 @@ UniValue getidentitieswithaddress(const UniValue& params, bool fHelp)
     {
         throw JSONRPCError(RPC_INVALID_PARAMS, "getidentitieswithaddress requires -idindex=1 when starting the daemon\n");
     }
-    UniValue retVal(UniValue::VARR);
 
     std::string addressString = uni_get_str(find_value(params[0], "address"));
     CTxDestination addressDest = DecodeDestination(addressString);
@@ -17359,40 +17570,7 @@ UniValue getidentitieswithaddress(const UniValue& params, bool fHelp)
     {
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "no valid PKH or PK address\n");
     }
-    uint32_t fromHeight = uni_get_int64(find_value(params[0], "fromheight"));
-    uint32_t toHeight = uni_get_int64(find_value(params[0], "toheight"));
-
-    if (uni_get_bool(find_value(params[0], "unspent")))
-    {
-        std::map<uint160, std::pair<CAddressUnspentDbEntry, CIdentity>> identities;
-        if (CIdentity::GetActiveIdentitiesByPrimaryAddress(addressDest, identities))
-        {
-            for (auto &oneIdentity : identities)
-            {
-                if ((!fromHeight || oneIdentity.second.first.second.blockHeight >= fromHeight) &&
-                    (!toHeight || oneIdentity.second.first.second.blockHeight <= toHeight))
-                {
-                    UniValue idUni = oneIdentity.second.second.ToUniValue();
-                    idUni.pushKV("txout", CUTXORef(oneIdentity.second.first.first.txhash, oneIdentity.second.first.first.index).ToUniValue());
-                    retVal.push_back(idUni);
-                }
-            }
-        }
-    }
-    else
-    {
-        std::map<uint160, std::pair<CAddressIndexDbEntry, CIdentity>> identities;
-        if (CIdentity::GetIdentityOutsByPrimaryAddress(addressDest, identities, fromHeight, toHeight))
-        {
-            for (auto &oneIdentity : identities)
-            {
-                UniValue idUni = oneIdentity.second.second.ToUniValue();
-                idUni.pushKV("txout", CUTXORef(oneIdentity.second.first.first.txhash, oneIdentity.second.first.first.index).ToUniValue());
-                retVal.push_back(idUni);
-            }
-        }
-    }
-    return retVal;
+    return GetIdentitiesWithIndexKey(CIdentity::IdentityPrimaryAddressKey(addressDest), params[0]);
 }
 
 UniValue getidentitieswithrevocation(const UniValue& params, bool fHelp)
@@ -17409,10 +17587,12 @@ UniValue getidentitieswithrevocation(const UniValue& params, bool fHelp)
             "    \"fromheight\":n               (number, optional, default=0) Search for qualified identities modified from this height forward only\n"
             "    \"toheight\":n                 (number, optional, default=0) Search for qualified identities only up until this height (0 == no limit)\n"
             "    \"unspent\":bool               (bool, optional, default=false) if true, this will only return active ID UTXOs as of the current block height\n"
+            "    \"after\":\"idori-address\"      (string, optional) only return identities that follow this one in ID order, to page from the last identity returned\n"
+            "    \"count\":n                    (number, optional, default=0) return at most this many identities (0 == no limit)\n"
             "}\n"
 
             "\nResult:\n"
-            "[                                  (array) array of matching identities\n"
+            "[                                  (array) array of matching identities, in order of identity ID\n"
             "  {identityobject},                (object) identity with additional member \"txout\" with txhash and output index\n"
             "  ...\n"
             "]\n"
@@ -17428,7 +17608,6 @@ UniValue getidentitieswithrevocation(const UniValue& params, bool fHelp)
     {
         throw JSONRPCError(RPC_INVALID_PARAMS, "getidentitieswithrevocation requires -idindex=1 when starting the daemon\n");
     }
-    UniValue retVal(UniValue::VARR);
 
     std::string addressString = uni_get_str(find_value(params[0], "identityid"));
     CTxDestination addressDest = DecodeDestination(addressString);
@@ -17438,41 +17617,7 @@ UniValue getidentitieswithrevocation(const UniValue& params, bool fHelp)
     }
 
     CIdentityID idID = GetDestinationID(addressDest);
-
-    uint32_t fromHeight = uni_get_int64(find_value(params[0], "fromheight"));
-    uint32_t toHeight = uni_get_int64(find_value(params[0], "toheight"));
-
-    if (uni_get_bool(find_value(params[0], "unspent")))
-    {
-        std::map<uint160, std::pair<CAddressUnspentDbEntry, CIdentity>> identities;
-        if (CIdentity::GetActiveIdentitiesWithRevocationID(idID, identities))
-        {
-            for (auto &oneIdentity : identities)
-            {
-                if ((!fromHeight || oneIdentity.second.first.second.blockHeight >= fromHeight) &&
-                    (!toHeight || oneIdentity.second.first.second.blockHeight <= toHeight))
-                {
-                    UniValue idUni = oneIdentity.second.second.ToUniValue();
-                    idUni.pushKV("txout", CUTXORef(oneIdentity.second.first.first.txhash, oneIdentity.second.first.first.index).ToUniValue());
-                    retVal.push_back(idUni);
-                }
-            }
-        }
-    }
-    else
-    {
-        std::map<uint160, std::pair<CAddressIndexDbEntry, CIdentity>> identities;
-        if (CIdentity::GetIdentityOutsWithRevocationID(idID, identities, fromHeight, toHeight))
-        {
-            for (auto &oneIdentity : identities)
-            {
-                UniValue idUni = oneIdentity.second.second.ToUniValue();
-                idUni.pushKV("txout", CUTXORef(oneIdentity.second.first.first.txhash, oneIdentity.second.first.first.index).ToUniValue());
-                retVal.push_back(idUni);
-            }
-        }
-    }
-    return retVal;
+    return GetIdentitiesWithIndexKey(CIdentity::IdentityRevocationKey(idID), params[0]);
 }
 
 UniValue getidentitieswithrecovery(const UniValue& params, bool fHelp)
@@ -17489,10 +17634,12 @@ UniValue getidentitieswithrecovery(const UniValue& params, bool fHelp)
             "    \"fromheight\":n               (number, optional, default=0) Search for qualified identities modified from this height forward only\n"
             "    \"toheight\":n                 (number, optional, default=0) Search for qualified identities only up until this height (0 == no limit)\n"
             "    \"unspent\":bool               (bool, optional, default=false) if true, this will only return active ID UTXOs as of the current block height\n"
+            "    \"after\":\"idori-address\"      (string, optional) only return identities that follow this one in ID order, to page from the last identity returned\n"
+            "    \"count\":n                    (number, optional, default=0) return at most this many identities (0 == no limit)\n"
             "}\n"
 
             "\nResult:\n"
-            "[                                  (array) array of matching identities\n"
+            "[                                  (array) array of matching identities, in order of identity ID\n"
             "  {identityobject},                (object) identity with additional member \"txout\" with txhash and output index\n"
             "  ...\n"
             "]\n"
@@ -17508,7 +17655,6 @@ UniValue getidentitieswithrecovery(const UniValue& params, bool fHelp)
     {
         throw JSONRPCError(RPC_INVALID_PARAMS, "getidentitieswithrecovery requires -idindex=1 when starting the daemon\n");
     }
-    UniValue retVal(UniValue::VARR);
 
     std::string addressString = uni_get_str(find_value(params[0], "identityid"));
     CTxDestination addressDest = DecodeDestination(addressString);
@@ -17518,41 +17664,54 @@ UniValue getidentitieswithrecovery(const UniValue& params, bool fHelp)
     }
 
     CIdentityID idID = GetDestinationID(addressDest);
+    return GetIdentitiesWithIndexKey(CIdentity::IdentityRecoveryKey(idID), params[0]);
+}
+
+UniValue getidentitieswithparent(const UniValue& params, bool fHelp)
+{
+    if (fHelp || params.size() != 1)
+    {
+        throw runtime_error(
+            "getidentitieswithparent '{\"identityid\":\"idori-address\", \"fromheight\":height, \"toheight\":height, \"unspent\":false}'\n"
+            "\n\n"
+
+            "\nArguments\n"
+            "{\n"
+            "    \"identityid\":\"idori-address\" (string, required) returns all identities where this ID or i-address is the parent\n"
+            "    \"fromheight\":n               (number, optional, default=0) Search for qualified identities modified from this height forward only\n"
+            "    \"toheight\":n                 (number, optional, default=0) Search for qualified identities only up until this height (0 == no limit)\n"
+            "    \"unspent\":bool               (bool, optional, default=false) if true, this will only return active ID UTXOs as of the current block height\n"
+            "    \"after\":\"idori-address\"      (string, optional) only return identities that follow this one in ID order, to page from the last identity returned\n"
+            "    \"count\":n                    (number, optional, default=0) return at most this many identities (0 == no limit)\n"
+            "}\n"
+
+            "\nResult:\n"
+            "[                                  (array) array of matching identities, in order of identity ID\n"
+            "  {identityobject},                (object) identity with additional member \"txout\" with txhash and output index\n"
+            "  ...\n"
+            "]\n"
 
-    uint32_t fromHeight = uni_get_int64(find_value(params[0], "fromheight"));
-    uint32_t toHeight = uni_get_int64(find_value(params[0], "toheight"));
+            "\nExamples:\n"
+            + HelpExampleCli("getidentitieswithparent", "\'{\"identityid\":\"idori-address\",\"fromheight\":height,\"toheight\":height,\"unspent\":false}\'")
+            + HelpExampleRpc("getidentitieswithparent", "\'{\"identityid\":\"idori-address\",\"fromheight\":height,\"toheight\":height,\"unspent\":false}\'")
+        );
+    }
 
-    if (uni_get_bool(find_value(params[0], "unspent")))
+    CheckIdentityAPIsValid();
+    if (!fIdIndex)
     {
-        std::map<uint160, std::pair<CAddressUnspentDbEntry, CIdentity>> identities;
-        if (CIdentity::GetActiveIdentitiesWithRecoveryID(idID, identities))
-        {
-            for (auto &oneIdentity : identities)
-            {
-                if ((!fromHeight || oneIdentity.second.first.second.blockHeight >= fromHeight) &&
-                    (!toHeight || oneIdentity.second.first.second.blockHeight <= toHeight))
-                {
-                    UniValue idUni = oneIdentity.second.second.ToUniValue();
-                    idUni.pushKV("txout", CUTXORef(oneIdentity.second.first.first.txhash, oneIdentity.second.first.first.index).ToUniValue());
-                    retVal.push_back(idUni);
-                }
-            }
-        }
+        throw JSONRPCError(RPC_INVALID_PARAMS, "getidentitieswithparent requires -idindex=1 when starting the daemon\n");
     }
-    else
+
+    std::string addressString = uni_get_str(find_value(params[0], "identityid"));
+    CTxDestination addressDest = DecodeDestination(addressString);
+    if (addressDest.which() != COptCCParams::ADDRTYPE_ID)
     {
-        std::map<uint160, std::pair<CAddressIndexDbEntry, CIdentity>> identities;
-        if (CIdentity::GetIdentityOutsWithRecoveryID(idID, identities, fromHeight, toHeight))
-        {
-            for (auto &oneIdentity : identities)
-            {
-                UniValue idUni = oneIdentity.second.second.ToUniValue();
-                idUni.pushKV("txout", CUTXORef(oneIdentity.second.first.first.txhash, oneIdentity.second.first.first.index).ToUniValue());
-                retVal.push_back(idUni);
-            }
-        }
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "no valid ID address\n");
     }
-    return retVal;
+
+    CIdentityID idID = GetDestinationID(addressDest);
+    return GetIdentitiesWithIndexKey(CIdentity::IdentityParentKey(idID), params[0]);
 }
 
 UniValue setidentitytrust(const UniValue& params, bool fHelp)
@@ -18016,6 +18175,7 @@ static const CRPCCommand commands[] =
     { "identity",     "getidentitieswithaddress",     &getidentitieswithaddress, true  },
     { "identity",     "getidentitieswithrevocation",  &getidentitieswithrevocation, true  },
     { "identity",     "getidentitieswithrecovery",    &getidentitieswithrecovery, true  },
+    { "identity",     "getidentitieswithparent",      &getidentitieswithparent, true  },
     { "identity",     "setidentitytrust",             &setidentitytrust,       true  },
     { "identity",     "getidentitytrust",             &getidentitytrust,       true  },
     { "multichain",   "setcurrencytrust",             &setcurrencytrust,       true  },
@@ -18027,7 +18187,7 @@ static const CRPCCommand commands[] =
     { "marketplace",  "listopenoffers",               &listopenoffers,         true  },
     { "marketplace",  "closeoffers",                  &closeoffers,            true  },
     { "multichain",   "definecurrency",               &definecurrency,         true  },
-    { "multichain",   "listcurrencies",               &listcurrencies,         true  },
+    { "multichain",   "listcurrencies",               &listcurrencies,         true,  &listcurrencies_stream },
     { "multichain",   "getcurrencyconverters",        &getcurrencyconverters,  true  },
     { "multichain",   "getcurrency",                  &getcurrency,            true  },
     { "multichain",   "getreservedeposits",           &getreservedeposits,     true  },
@@ -4,9 +4,11 @@
 // file COPYING or https://www.opensource.org/licenses/mit-license.php .
 
 #include "rpc/server.h"
+#include "rpc/jsonstream.h"
 
 #include "init.h"
 #include "key_io.h"
+#include "metrics.h"
 #include "random.h"
 #include "sync.h"
 #include "ui_interface.h"
@@ -709,7 +711,7 @@ std::string JSONRPCExecBatch(const UniValue& vReq)
     return ret.write() + "\n";
 }
 
-UniValue CRPCTable::execute(const std::string &strMethod, const UniValue &params) const
+static const CRPCCommand *GetRPCCommand(const CRPCTable &table, const std::string &strMethod, const UniValue &params)
 {
     // Return immediately if in warmup
     {
@@ -726,7 +728,7 @@ UniValue CRPCTable::execute(const std::string &strMethod, const UniValue &params
     //printf("RPC call: %s\n", strMethod.c_str());
 
     // Find method
-    const CRPCCommand *pcmd = tableRPC[strMethod];
+    const CRPCCommand *pcmd = table[strMethod];
     if (!pcmd)
     {
         throw JSONRPCError(RPC_METHOD_NOT_FOUND, "Method " + strMethod + " not found");
@@ -735,6 +737,13 @@ UniValue CRPCTable::execute(const std::string &strMethod, const UniValue &params
     LogPrint("rpcrequests", "command %s, params:\n%s\n", strMethod.c_str(), params.write(1,2).c_str());
 
     g_rpcSignals.PreCommand(*pcmd);
+    return pcmd;
+}
+
+UniValue CRPCTable::execute(const std::string &strMethod, const UniValue &params) const
+{
+    const CRPCCommand *pcmd = GetRPCCommand(*this, strMethod, params);
+    CScopedLatencyTimer timer(GetRPCLatencyHistogram(pcmd->name));
 
     try
     {
@@ -749,6 +758,31 @@ UniValue CRPCTable::execute(const std::string &strMethod, const UniValue &params
     g_rpcSignals.PostCommand(*pcmd);
 }
 
+void CRPCTable::execute(const std::string &strMethod, const UniValue &params, CJSONStreamWriter &result) const
+{
+    const CRPCCommand *pcmd = GetRPCCommand(*this, strMethod, params);
+    CScopedLatencyTimer timer(GetRPCLatencyHistogram(pcmd->name));
+
+    try
+    {
+        // Execute
+        if (pcmd->streamActor)
+        {
+            pcmd->streamActor(params, result);
+        }
+        else
+        {
+            result.Value(pcmd->actor(params, false));
+        }
+    }
+    catch (const std::exception& e)
+    {
+        throw JSONRPCError(RPC_MISC_ERROR, e.what());
+    }
+
+    g_rpcSignals.PostCommand(*pcmd);
+}
+
 std::string HelpExampleCli(const std::string& methodname, const std::string& args)
 {
     return "> verus " + methodname + " " + args + "\n";
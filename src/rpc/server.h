@@ -120,6 +120,11 @@ void RPCRunLater(const std::string& name, boost::function<void(void)> func, int6
 
 typedef UniValue(*rpcfn_type)(const UniValue& params, bool fHelp);
 
+class CJSONStreamWriter;
+
+/** Writes the result of a call to a stream rather than returning it, see CJSONStreamWriter */
+typedef void(*rpcstreamfn_type)(const UniValue& params, CJSONStreamWriter& result);
+
 class CRPCCommand
 {
 public:
@@ -127,6 +132,7 @@ public:
     std::string name;
     rpcfn_type actor;
     bool okSafeMode;
+    rpcstreamfn_type streamActor = nullptr;     // optional, for commands with large results
 };
 
 /**
@@ -150,6 +156,14 @@ public:
      */
     UniValue execute(const std::string &method, const UniValue &params) const;
 
+    /**
+     * Execute a method, writing its result to a stream. Commands without a streaming
+     * handler have their result written to the stream one element at a time.
+     * @throws an exception (UniValue) when an error happens, after which the stream
+     * may hold a partial result.
+     */
+    void execute(const std::string &method, const UniValue &params, CJSONStreamWriter &result) const;
+
 
     /**
      * Appends a CRPCCommand to the dispatch table.
@@ -209,13 +209,25 @@ std::map<uint160, std::pair<int, std::vector<std::vector<unsigned char>>>> Serve
     return idAddresses;
 }
 
-bool ServerTransactionSignatureChecker::VerifySignature(const std::vector<unsigned char>& vchSig, const CPubKey& pubkey, const uint256& sighash) const
+static CSignatureCache &ServerSignatureCache()
 {
     static CSignatureCache signatureCache;
+    return signatureCache;
+}
+
+bool ServerTransactionSignatureChecker::VerifySignature(const std::vector<unsigned char>& vchSig, const CPubKey& pubkey, const uint256& sighash) const
+{
+    CSignatureCache &signatureCache = ServerSignatureCache();
 
     if (signatureCache.Get(sighash, vchSig, pubkey))
         return true;
 
+    if (pSigBatch)
+    {
+        pSigBatch->Add(pubkey, sighash, vchSig, txTo->GetHash(), nIn, store);
+        return true;
+    }
+
     if (!TransactionSignatureChecker::VerifySignature(vchSig, pubkey, sighash))
         return false;
 
@@ -224,6 +236,60 @@ bool ServerTransactionSignatureChecker::VerifySignature(const std::vector<unsign
     return true;
 }
 
+void CSignatureBatch::Add(const CPubKey &pubKey, const uint256 &sighash, const std::vector<unsigned char> &vchSig, const uint256 &txid, uint32_t nIn, bool store)
+{
+    boost::unique_lock<boost::mutex> lock(cs);
+    entries.push_back(CEntry(pubKey, sighash, vchSig, txid, nIn, store));
+}
+
+size_t CSignatureBatch::Size() const
+{
+    boost::unique_lock<boost::mutex> lock(cs);
+    return entries.size();
+}
+
+bool CSignatureBatch::VerifyChunk(size_t nChunk) const
+{
+    // no lock needed, since entries are not added while chunks are verified
+    size_t begin = nChunk * CHUNK_SIZE;
+    size_t end = std::min(begin + CHUNK_SIZE, entries.size());
+    CSignatureCache &signatureCache = ServerSignatureCache();
+
+    for (size_t i = begin; i < end; i++)
+    {
+        const CEntry &entry = entries[i];
+        if (!entry.pubKey.Verify(entry.sighash, entry.vchSig))
+        {
+            return false;
+        }
+        if (entry.store)
+        {
+            signatureCache.Set(entry.sighash, entry.vchSig, entry.pubKey);
+        }
+    }
+    return true;
+}
+
+std::vector<CSignatureBatch::CEntry> CSignatureBatch::FindInvalid() const
+{
+    boost::unique_lock<boost::mutex> lock(cs);
+    std::vector<CEntry> invalid;
+    for (auto &entry : entries)
+    {
+        if (!entry.pubKey.Verify(entry.sighash, entry.vchSig))
+        {
+            invalid.push_back(entry);
+        }
+    }
+    return invalid;
+}
+
+void CSignatureBatch::Clear()
+{
+    boost::unique_lock<boost::mutex> lock(cs);
+    entries.clear();
+}
+
 /*
  * The reason that these functions are here is that the what used to be the
  * CachingTransactionSignatureChecker, now the ServerTransactionSignatureChecker,
@@ -7,19 +7,71 @@
 #define BITCOIN_SCRIPT_SERVERCHECKER_H
 
 #include "script/interpreter.h"
+#include "pubkey.h"
+#include "uint256.h"
 
 #include <vector>
 
-class CPubKey;
+#include <boost/thread/mutex.hpp>
+
+/**
+ * Signatures whose verification has been deferred while running the scripts of a block.
+ * Scripts only defer a signature when its failure would make the whole script fail, so
+ * the block is valid exactly when every script passed and every deferred signature is valid.
+ * Entries are added concurrently by script check threads and verified afterwards in
+ * fixed size chunks, which spreads the ECDSA work evenly over all verification threads.
+ */
+class CSignatureBatch
+{
+public:
+    //! number of signatures verified by one job on the signature check queue
+    static const size_t CHUNK_SIZE = 64;
+
+    struct CEntry
+    {
+        CPubKey pubKey;
+        uint256 sighash;
+        std::vector<unsigned char> vchSig;
+        uint256 txid;
+        uint32_t nIn;
+        bool store;
+
+        CEntry() : nIn(0), store(false) {}
+        CEntry(const CPubKey &pubKeyIn, const uint256 &sighashIn, const std::vector<unsigned char> &vchSigIn, const uint256 &txidIn, uint32_t nInIn, bool storeIn) :
+            pubKey(pubKeyIn), sighash(sighashIn), vchSig(vchSigIn), txid(txidIn), nIn(nInIn), store(storeIn) {}
+    };
+
+    void Add(const CPubKey &pubKey, const uint256 &sighash, const std::vector<unsigned char> &vchSig, const uint256 &txid, uint32_t nIn, bool store);
+    size_t Size() const;
+    size_t NumChunks() const { return (Size() + CHUNK_SIZE - 1) / CHUNK_SIZE; }
+
+    // verifies entries in the chunk, storing valid signatures in the signature cache if requested.
+    // must only be called after all scripts that may add to this batch have completed
+    bool VerifyChunk(size_t nChunk) const;
+
+    // verifies each entry on its own and returns the ones that are invalid
+    std::vector<CEntry> FindInvalid() const;
+
+    void Clear();
+
+private:
+    mutable boost::mutex cs;
+    std::vector<CEntry> entries;
+};
 
 class ServerTransactionSignatureChecker : public TransactionSignatureChecker
 {
 private:
     bool store;
+    CSignatureBatch *pSigBatch;
 
 public:
-    ServerTransactionSignatureChecker(const CTransaction* txToIn, unsigned int nIn, const CAmount& amount, bool storeIn, const PrecomputedTransactionData& txdataIn) : TransactionSignatureChecker(txToIn, nIn, amount, txdataIn), store(storeIn) { idMapSet = true; }
-    ServerTransactionSignatureChecker(const CTransaction* txToIn, unsigned int nIn, const CAmount& amount, bool storeIn) : TransactionSignatureChecker(txToIn, nIn, amount), store(storeIn) { idMapSet = true; }
+    ServerTransactionSignatureChecker(const CTransaction* txToIn, unsigned int nIn, const CAmount& amount, bool storeIn, const PrecomputedTransactionData& txdataIn) : TransactionSignatureChecker(txToIn, nIn, amount, txdataIn), store(storeIn), pSigBatch(nullptr) { idMapSet = true; }
+    ServerTransactionSignatureChecker(const CTransaction* txToIn, unsigned int nIn, const CAmount& amount, bool storeIn) : TransactionSignatureChecker(txToIn, nIn, amount), store(storeIn), pSigBatch(nullptr) { idMapSet = true; }
+
+    // when set, signatures that are not in the signature cache are recorded in the batch and
+    // assumed valid. only set this for scripts where a failed signature check fails the script.
+    void SetSignatureBatch(CSignatureBatch *pBatch) { pSigBatch = pBatch; }
 
     static std::map<uint160, std::pair<int, std::vector<std::vector<unsigned char>>>> ExtractIDMap(const CScript &scriptPubKeyIn, uint32_t spendHeight, bool isStake);
     bool CanValidateIDs() const { return true; }
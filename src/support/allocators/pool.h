@@ -0,0 +1,177 @@
+// Copyright (c) 2026 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#ifndef BITCOIN_SUPPORT_ALLOCATORS_POOL_H
+#define BITCOIN_SUPPORT_ALLOCATORS_POOL_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <new>
+#include <vector>
+
+/**
+ * Memory resource for node based containers. Blocks of up to MAX_BLOCK_SIZE_BYTES are carved out
+ * of large chunks, and freed blocks are kept in a free list per size to be handed out again. Chunks
+ * are only given back when the resource is destroyed, so a container that repeatedly fills up and
+ * is cleared, like the coins cache between flushes, does not fragment the heap, and the memory it
+ * holds is known exactly. Larger allocations, such as bucket arrays, go to operator new.
+ */
+template <std::size_t MAX_BLOCK_SIZE_BYTES, std::size_t ALIGN_BYTES>
+class CPoolResource
+{
+private:
+    struct ListNode
+    {
+        ListNode* pNext;
+    };
+
+    //! Every block is a multiple of this size and aligned to it
+    static const std::size_t ELEM_ALIGN_BYTES = alignof(ListNode) > ALIGN_BYTES ? alignof(ListNode) : ALIGN_BYTES;
+
+    static_assert((ELEM_ALIGN_BYTES & (ELEM_ALIGN_BYTES - 1)) == 0, "alignment must be a power of two");
+    static_assert(ELEM_ALIGN_BYTES <= alignof(std::max_align_t), "chunks are not aligned beyond max_align_t");
+    static_assert(MAX_BLOCK_SIZE_BYTES >= ELEM_ALIGN_BYTES, "blocks must be able to hold a free list node");
+
+    const std::size_t nChunkSizeBytes;
+    std::vector<char*> vChunks;
+    std::array<ListNode*, MAX_BLOCK_SIZE_BYTES / ELEM_ALIGN_BYTES + 1> freeLists;
+    char* pAvailable;
+    char* pAvailableEnd;
+
+    static std::size_t NumElemAlignBytes(std::size_t nBytes)
+    {
+        return (nBytes + ELEM_ALIGN_BYTES - 1) / ELEM_ALIGN_BYTES + (nBytes == 0);
+    }
+
+    static bool IsPooled(std::size_t nBytes, std::size_t nAlignment)
+    {
+        return nBytes <= MAX_BLOCK_SIZE_BYTES && nAlignment <= ELEM_ALIGN_BYTES;
+    }
+
+    void PushFree(void* p, std::size_t nElems)
+    {
+        ListNode* pNode = new (p) ListNode;
+        pNode->pNext = freeLists[nElems];
+        freeLists[nElems] = pNode;
+    }
+
+    void AllocateChunk()
+    {
+        // what is left of the current chunk is smaller than the block requested, keep it for smaller ones
+        std::size_t nRemaining = pAvailableEnd - pAvailable;
+        if (nRemaining)
+            PushFree(pAvailable, nRemaining / ELEM_ALIGN_BYTES);
+
+        char* pChunk = static_cast<char*>(::operator new(nChunkSizeBytes));
+        vChunks.push_back(pChunk);
+        pAvailable = pChunk;
+        pAvailableEnd = pChunk + nChunkSizeBytes;
+    }
+
+public:
+    static const std::size_t DEFAULT_CHUNK_SIZE_BYTES = 256 * 1024;
+
+    explicit CPoolResource(std::size_t nChunkSizeBytesIn = DEFAULT_CHUNK_SIZE_BYTES) :
+        nChunkSizeBytes(std::max(nChunkSizeBytesIn / ELEM_ALIGN_BYTES, MAX_BLOCK_SIZE_BYTES / ELEM_ALIGN_BYTES + 1) * ELEM_ALIGN_BYTES),
+        pAvailable(nullptr), pAvailableEnd(nullptr)
+    {
+        freeLists.fill(nullptr);
+    }
+
+    CPoolResource(const CPoolResource&) = delete;
+    CPoolResource& operator=(const CPoolResource&) = delete;
+
+    ~CPoolResource()
+    {
+        for (char* pChunk : vChunks)
+            ::operator delete(pChunk);
+    }
+
+    void* Allocate(std::size_t nBytes, std::size_t nAlignment)
+    {
+        if (!IsPooled(nBytes, nAlignment))
+            return ::operator new(nBytes);
+
+        std::size_t nElems = NumElemAlignBytes(nBytes);
+        if (freeLists[nElems])
+        {
+            ListNode* pNode = freeLists[nElems];
+            freeLists[nElems] = pNode->pNext;
+            return pNode;
+        }
+        std::size_t nBlockBytes = nElems * ELEM_ALIGN_BYTES;
+        if ((std::size_t)(pAvailableEnd - pAvailable) < nBlockBytes)
+            AllocateChunk();
+        void* p = pAvailable;
+        pAvailable += nBlockBytes;
+        return p;
+    }
+
+    void Deallocate(void* p, std::size_t nBytes, std::size_t nAlignment) noexcept
+    {
+        if (!IsPooled(nBytes, nAlignment))
+        {
+            ::operator delete(p);
+            return;
+        }
+        PushFree(p, NumElemAlignBytes(nBytes));
+    }
+
+    std::size_t NumAllocatedChunks() const { return vChunks.size(); }
+    std::size_t ChunkSizeBytes() const { return nChunkSizeBytes; }
+    std::size_t ChunkListCapacity() const { return vChunks.capacity(); }
+};
+
+/**
+ * Allocator handing out memory from a CPoolResource, for containers that allocate one node at a
+ * time. Copies and rebound allocators share the resource, which must outlive the container.
+ */
+template <class T, std::size_t MAX_BLOCK_SIZE_BYTES, std::size_t ALIGN_BYTES = alignof(T)>
+class CPoolAllocator
+{
+public:
+    typedef T value_type;
+    typedef CPoolResource<MAX_BLOCK_SIZE_BYTES, ALIGN_BYTES> ResourceType;
+
+    template <class U>
+    struct rebind
+    {
+        typedef CPoolAllocator<U, MAX_BLOCK_SIZE_BYTES, ALIGN_BYTES> other;
+    };
+
+    CPoolAllocator(ResourceType* pResourceIn) noexcept : pResource(pResourceIn) {}
+
+    template <class U>
+    CPoolAllocator(const CPoolAllocator<U, MAX_BLOCK_SIZE_BYTES, ALIGN_BYTES>& other) noexcept : pResource(other.Resource()) {}
+
+    T* allocate(std::size_t n)
+    {
+        return static_cast<T*>(pResource->Allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept
+    {
+        pResource->Deallocate(p, n * sizeof(T), alignof(T));
+    }
+
+    ResourceType* Resource() const noexcept { return pResource; }
+
+private:
+    ResourceType* pResource;
+};
+
+template <class T1, class T2, std::size_t MAX_BLOCK_SIZE_BYTES, std::size_t ALIGN_BYTES>
+bool operator==(const CPoolAllocator<T1, MAX_BLOCK_SIZE_BYTES, ALIGN_BYTES>& a, const CPoolAllocator<T2, MAX_BLOCK_SIZE_BYTES, ALIGN_BYTES>& b) noexcept
+{
+    return a.Resource() == b.Resource();
+}
+
+template <class T1, class T2, std::size_t MAX_BLOCK_SIZE_BYTES, std::size_t ALIGN_BYTES>
+bool operator!=(const CPoolAllocator<T1, MAX_BLOCK_SIZE_BYTES, ALIGN_BYTES>& a, const CPoolAllocator<T2, MAX_BLOCK_SIZE_BYTES, ALIGN_BYTES>& b) noexcept
+{
+    return !(a == b);
+}
+
+#endif // BITCOIN_SUPPORT_ALLOCATORS_POOL_H
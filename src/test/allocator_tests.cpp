@@ -2,11 +2,17 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or https://www.opensource.org/licenses/mit-license.php .
 
+#include "random.h"
 #include "util.h"
 
+#include "support/allocators/pool.h"
 #include "support/allocators/secure.h"
 #include "test/test_bitcoin.h"
 
+#include <map>
+#include <string>
+#include <unordered_map>
+
 #include <boost/test/unit_test.hpp>
 
 BOOST_FIXTURE_TEST_SUITE(allocator_tests, BasicTestingSetup)
@@ -117,4 +123,52 @@ BOOST_AUTO_TEST_CASE(test_LockedPageManagerBase)
     BOOST_CHECK((last_unlock_len & (test_page_size-1)) == 0); // always unlock entire pages
 }
 
+BOOST_AUTO_TEST_CASE(pool_resource_blocks)
+{
+    CPoolResource<64, 8> resource(1024);
+    void* a = resource.Allocate(24, 8);
+    void* b = resource.Allocate(24, 8);
+    BOOST_CHECK(a != b);
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), 1);
+
+    // freed blocks are handed out again for the same size
+    resource.Deallocate(a, 24, 8);
+    BOOST_CHECK(resource.Allocate(20, 8) == a);
+
+    // large blocks do not come from the pool
+    void* large = resource.Allocate(4096, 8);
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), 1);
+    resource.Deallocate(large, 4096, 8);
+
+    for (int i = 0; i < 100; i++)
+        resource.Allocate(64, 8);
+    BOOST_CHECK(resource.NumAllocatedChunks() > 1);
+}
+
+BOOST_AUTO_TEST_CASE(pool_allocator_map)
+{
+    typedef std::pair<const uint64_t, std::string> Value;
+    typedef CPoolAllocator<Value, sizeof(Value) + sizeof(void*) * 4> Allocator;
+    typedef std::unordered_map<uint64_t, std::string, std::hash<uint64_t>, std::equal_to<uint64_t>, Allocator> Map;
+
+    Allocator::ResourceType resource(4096);
+    Map map(0, std::hash<uint64_t>(), std::equal_to<uint64_t>(), Allocator(&resource));
+    std::map<uint64_t, std::string> expected;
+    for (int i = 0; i < 20000; i++) {
+        uint64_t key = insecure_rand() % 500;
+        if (insecure_rand() % 3) {
+            std::string value(insecure_rand() % 40, 'a' + key % 26);
+            map[key] = value;
+            expected[key] = value;
+        } else {
+            map.erase(key);
+            expected.erase(key);
+        }
+    }
+    BOOST_CHECK_EQUAL(map.size(), expected.size());
+    for (const auto& entry : expected) {
+        BOOST_CHECK(map.count(entry.first) && map.at(entry.first) == entry.second);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
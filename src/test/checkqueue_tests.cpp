@@ -0,0 +1,167 @@
+// Copyright (c) 2026 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#include "checkqueue.h"
+#include "test/test_bitcoin.h"
+
+#include <atomic>
+
+#include <boost/bind.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(checkqueue_tests, BasicTestingSetup)
+
+namespace {
+
+struct CCountingCheck
+{
+    std::atomic<int> *pCount;
+    bool fResult;
+
+    CCountingCheck() : pCount(nullptr), fResult(true) {}
+    CCountingCheck(std::atomic<int> *pCountIn, bool fResultIn) : pCount(pCountIn), fResult(fResultIn) {}
+
+    bool operator()()
+    {
+        (*pCount)++;
+        return fResult;
+    }
+
+    void swap(CCountingCheck &check)
+    {
+        std::swap(pCount, check.pCount);
+        std::swap(fResult, check.fResult);
+    }
+};
+
+// a second type of check, which counts separately
+struct CTallyCheck
+{
+    std::vector<int> *pTally;
+    size_t nIndex;
+
+    CTallyCheck() : pTally(nullptr), nIndex(0) {}
+    CTallyCheck(std::vector<int> *pTallyIn, size_t nIndexIn) : pTally(pTallyIn), nIndex(nIndexIn) {}
+
+    bool operator()()
+    {
+        (*pTally)[nIndex]++;
+        return true;
+    }
+
+    void swap(CTallyCheck &check)
+    {
+        std::swap(pTally, check.pTally);
+        std::swap(nIndex, check.nIndex);
+    }
+};
+
+typedef CCheckVariant<CCountingCheck, CTallyCheck> CTestCheck;
+
+}
+
+BOOST_AUTO_TEST_CASE(checkqueue_all_checks_run)
+{
+    CCheckQueue<CTestCheck> checkqueue(16);
+    boost::thread_group threadGroup;
+    for (int i = 0; i < 4; i++)
+        threadGroup.create_thread(boost::bind(&CCheckQueue<CTestCheck>::Thread, boost::ref(checkqueue)));
+
+    for (int round = 0; round < 50; round++) {
+        std::atomic<int> count(0);
+        int total = 0;
+        {
+            CCheckQueueControl<CTestCheck> control(&checkqueue);
+            for (int batch = 0; batch < 10; batch++) {
+                std::vector<CCountingCheck> vChecks(round + batch, CCountingCheck(&count, true));
+                total += vChecks.size();
+                control.AddAny(vChecks);
+            }
+            BOOST_CHECK(control.Wait());
+        }
+        BOOST_CHECK_EQUAL(count, total);
+        BOOST_CHECK(checkqueue.IsIdle());
+    }
+
+    threadGroup.interrupt_all();
+    threadGroup.join_all();
+}
+
+BOOST_AUTO_TEST_CASE(checkqueue_failure_resets)
+{
+    CCheckQueue<CTestCheck> checkqueue(16);
+    boost::thread_group threadGroup;
+    for (int i = 0; i < 4; i++)
+        threadGroup.create_thread(boost::bind(&CCheckQueue<CTestCheck>::Thread, boost::ref(checkqueue)));
+
+    std::atomic<int> count(0);
+    {
+        CCheckQueueControl<CTestCheck> control(&checkqueue);
+        std::vector<CCountingCheck> vChecks(1000, CCountingCheck(&count, true));
+        vChecks[500] = CCountingCheck(&count, false);
+        control.AddAny(vChecks);
+        BOOST_CHECK(!control.Wait());
+    }
+
+    // the failure must not leak into the next set of checks
+    {
+        CCheckQueueControl<CTestCheck> control(&checkqueue);
+        std::vector<CCountingCheck> vChecks(1000, CCountingCheck(&count, true));
+        control.AddAny(vChecks);
+        BOOST_CHECK(control.Wait());
+    }
+
+    threadGroup.interrupt_all();
+    threadGroup.join_all();
+}
+
+BOOST_AUTO_TEST_CASE(checkqueue_mixed_checks)
+{
+    CCheckQueue<CTestCheck> checkqueue(16);
+    boost::thread_group threadGroup;
+    for (int i = 0; i < 4; i++)
+        threadGroup.create_thread(boost::bind(&CCheckQueue<CTestCheck>::Thread, boost::ref(checkqueue)));
+
+    // each check of either type runs once, on whichever worker takes it
+    std::atomic<int> count(0);
+    std::vector<int> tally(500, 0);
+    {
+        CCheckQueueControl<CTestCheck> control(&checkqueue);
+        for (size_t batch = 0; batch < 10; batch++) {
+            std::vector<CCountingCheck> vCounting(50, CCountingCheck(&count, true));
+            std::vector<CTallyCheck> vTally;
+            for (size_t i = batch * 50; i < (batch + 1) * 50; i++)
+                vTally.push_back(CTallyCheck(&tally, i));
+            control.AddAny(vCounting);
+            control.AddAny(vTally);
+            // the checks are swapped out, leaving empty ones behind
+            BOOST_CHECK(vTally[0].pTally == nullptr);
+        }
+        BOOST_CHECK(control.Wait());
+    }
+    BOOST_CHECK_EQUAL(count, 500);
+    BOOST_CHECK(std::all_of(tally.begin(), tally.end(), [](int n) { return n == 1; }));
+
+    // an empty check passes
+    CTestCheck empty;
+    BOOST_CHECK(empty());
+
+    threadGroup.interrupt_all();
+    threadGroup.join_all();
+}
+
+BOOST_AUTO_TEST_CASE(checkqueue_master_only)
+{
+    // without worker threads, the master runs every check itself
+    CCheckQueue<CTestCheck> checkqueue(16);
+    std::atomic<int> count(0);
+    CCheckQueueControl<CTestCheck> control(&checkqueue);
+    std::vector<CCountingCheck> vChecks(100, CCountingCheck(&count, true));
+    control.AddAny(vChecks);
+    BOOST_CHECK(control.Wait());
+    BOOST_CHECK_EQUAL(count, 100);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -565,6 +565,197 @@ BOOST_AUTO_TEST_CASE(nullifiers_test)
     checkNullifierCache(cache3, txWithNullifiers, false);
 }
 
+BOOST_AUTO_TEST_CASE(coins_write_behind)
+{
+    CCoinsViewDB db(1 << 20, true);
+    uint256 txid = GetRandHash();
+    uint256 hashBlock = GetRandHash();
+    TxWithNullifiers txWithNullifiers;
+    {
+        CCoinsViewWriteBehind writeBehind(&db, &db);
+        {
+            CCoinsViewCacheTest cache(&writeBehind);
+            {
+                CCoinsModifier coins = cache.ModifyCoins(txid);
+                coins->vout.resize(1);
+                coins->vout[0].nValue = 50;
+                coins->nHeight = 1;
+            }
+            cache.SetNullifiers(txWithNullifiers.tx, true);
+            cache.SetBestBlock(hashBlock);
+            BOOST_CHECK(cache.Flush());
+        }
+
+        // reads see the flush whether or not it has reached the database yet
+        CCoinsViewCacheTest cache(&writeBehind);
+        const CCoins *pcoins = cache.AccessCoins(txid);
+        BOOST_CHECK(pcoins && pcoins->vout[0].nValue == 50);
+        BOOST_CHECK(cache.GetBestBlock() == hashBlock);
+        checkNullifierCache(cache, txWithNullifiers, true);
+
+        BOOST_CHECK(writeBehind.Sync());
+        CCoins coins;
+        BOOST_CHECK(db.GetCoins(txid, coins) && coins.vout[0].nValue == 50);
+        BOOST_CHECK(db.GetBestBlock() == hashBlock);
+        BOOST_CHECK(db.GetNullifier(txWithNullifiers.saplingNullifier, SAPLING));
+
+        // spend it, the destructor waits for the write
+        {
+            CCoinsModifier coins = cache.ModifyCoins(txid);
+            coins->Spend(0);
+        }
+        cache.SetNullifiers(txWithNullifiers.tx, false);
+        BOOST_CHECK(cache.Flush());
+        BOOST_CHECK(!writeBehind.HaveCoins(txid));
+    }
+    BOOST_CHECK(!db.HaveCoins(txid));
+    BOOST_CHECK(!db.GetNullifier(txWithNullifiers.saplingNullifier, SAPLING));
+}
+
+class CCoinsViewDBFailingWrites : public CCoinsViewDB
+{
+public:
+    CCoinsViewDBFailingWrites() : CCoinsViewDB(1 << 20, true) {}
+
+    bool WriteCoinsBatch(const CCoinsMap &mapCoins,
+                         const uint256 &hashBlock,
+                         const uint256 &hashSproutAnchor,
+                         const uint256 &hashSaplingAnchor,
+                         const CAnchorsSproutMap &mapSproutAnchors,
+                         const CAnchorsSaplingMap &mapSaplingAnchors,
+                         const CNullifiersMap &mapSproutNullifiers,
+                         const CNullifiersMap &mapSaplingNullifiers)
+    {
+        return false;
+    }
+};
+
+BOOST_AUTO_TEST_CASE(coins_write_behind_failure)
+{
+    CCoinsViewDBFailingWrites db;
+    uint256 txid = GetRandHash();
+    uint256 hashBlock = GetRandHash();
+    {
+        CCoinsViewWriteBehind writeBehind(&db, &db);
+        {
+            CCoinsViewCacheTest cache(&writeBehind);
+            {
+                CCoinsModifier coins = cache.ModifyCoins(txid);
+                coins->vout.resize(1);
+                coins->vout[0].nValue = 50;
+                coins->nHeight = 1;
+            }
+            cache.SetBestBlock(hashBlock);
+            BOOST_CHECK(cache.Flush());
+        }
+        BOOST_CHECK(!writeBehind.Sync());
+
+        // the generation that never reached the database is still what reads see
+        CCoins coins;
+        BOOST_CHECK(writeBehind.GetCoins(txid, coins) && coins.vout[0].nValue == 50);
+        BOOST_CHECK(writeBehind.HaveCoins(txid));
+        BOOST_CHECK(writeBehind.GetBestBlock() == hashBlock);
+        BOOST_CHECK(!db.HaveCoins(txid));
+
+        // and no more flushes are taken over
+        CCoinsViewCacheTest cache(&writeBehind);
+        {
+            CCoinsModifier coins = cache.ModifyCoins(GetRandHash());
+            coins->vout.resize(1);
+            coins->vout[0].nValue = 10;
+            coins->nHeight = 2;
+        }
+        BOOST_CHECK(!cache.Flush());
+    }
+}
+
+class CCoinsViewDBAnchorTest : public CCoinsViewDB
+{
+public:
+    CCoinsViewDBAnchorTest() : CCoinsViewDB(1 << 20, true) {}
+
+    void ClearAnchorCache()
+    {
+        sproutAnchorCache.Clear();
+        saplingAnchorCache.Clear();
+    }
+
+    //! Move the best block the way a release without the version record would
+    void WriteBestBlockOnly(const uint256 &hashBlock)
+    {
+        db.Write('B', hashBlock);
+    }
+};
+
+BOOST_AUTO_TEST_CASE(anchors_delta_storage)
+{
+    CCoinsViewDBAnchorTest db;
+    std::vector<SproutMerkleTree> trees;
+    SproutMerkleTree tree;
+    SproutMerkleTree read;
+
+    // several anchors per flush, far enough to need more than one full tree
+    for (uint32_t i = 0; i < ANCHOR_CHECKPOINT_INTERVAL; i++)
+    {
+        CCoinsViewCacheTest cache(&db);
+        for (int j = 0; j < 3; j++)
+        {
+            for (int k = insecure_rand() % 4; k >= 0; k--)
+                tree.append(GetRandHash());
+            cache.PushAnchor(tree);
+            trees.push_back(tree);
+        }
+        BOOST_CHECK(cache.Flush());
+    }
+    db.ClearAnchorCache();
+    for (auto &t : trees)
+    {
+        BOOST_CHECK(db.GetSproutAnchorAt(t.root(), read));
+        BOOST_CHECK(read == t);
+    }
+
+    // erase the last two anchors, the second to last is the base of the last one
+    size_t n = trees.size();
+    {
+        CCoinsViewCacheTest cache(&db);
+        cache.PopAnchor(trees[n - 2].root(), SPROUT);
+        cache.PopAnchor(trees[n - 3].root(), SPROUT);
+        BOOST_CHECK(cache.Flush());
+    }
+    db.ClearAnchorCache();
+    BOOST_CHECK(!db.GetSproutAnchorAt(trees[n - 1].root(), read));
+    BOOST_CHECK(!db.GetSproutAnchorAt(trees[n - 2].root(), read));
+    BOOST_CHECK(db.GetSproutAnchorAt(trees[n - 3].root(), read) && read == trees[n - 3]);
+
+    // enter them again, one at a time
+    for (size_t i = n - 2; i < n; i++)
+    {
+        CCoinsViewCacheTest cache(&db);
+        cache.PushAnchor(trees[i]);
+        BOOST_CHECK(cache.Flush());
+    }
+    db.ClearAnchorCache();
+    for (size_t i = n - 3; i < n; i++)
+        BOOST_CHECK(db.GetSproutAnchorAt(trees[i].root(), read) && read == trees[i]);
+    BOOST_CHECK(db.GetBestAnchor(SPROUT) == trees[n - 1].root());
+}
+
+BOOST_AUTO_TEST_CASE(chainstate_version)
+{
+    CCoinsViewDBAnchorTest db;
+    // nothing written yet reads as the old format
+    BOOST_CHECK(db.CheckVersion());
+    {
+        CCoinsViewCacheTest cache(&db);
+        cache.SetBestBlock(GetRandHash());
+        BOOST_CHECK(cache.Flush());
+    }
+    BOOST_CHECK(db.CheckVersion());
+
+    db.WriteBestBlockOnly(GetRandHash());
+    BOOST_CHECK(!db.CheckVersion());
+}
+
 template<typename Tree> void anchorsFlushImpl(ShieldedType type)
 {
     CCoinsViewTest base;
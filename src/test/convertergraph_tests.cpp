@@ -0,0 +1,95 @@
+// Copyright (c) 2026 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#include "pbaas/convertergraph.h"
+#include "test/test_chaincache.h"
+
+#include <boost/test/unit_test.hpp>
+
+/*
+ * The converter graph checked against the converter index across connected, spent and disconnected notarizations.
+ */
+
+namespace
+{
+
+// checks the converters of currencyID from the graph, on the first call and from the cache, against the converter index
+size_t CheckConverters(const uint160 &currencyID)
+{
+    LOCK(cs_main);
+    std::vector<CAddressUnspentDbEntry> unspent;
+    BOOST_REQUIRE(GetAddressUnspent(CCoinbaseCurrencyState::IndexConverterKey(currencyID), CScript::P2IDX, unspent));
+    for (int pass = 0; pass < 2; pass++)
+    {
+        std::vector<std::pair<CUTXORef, CPBaaSNotarization>> converters = ConverterGraph.GetConverters(currencyID);
+        BOOST_REQUIRE_EQUAL(converters.size(), unspent.size());
+        for (int i = 0; i < converters.size(); i++)
+        {
+            BOOST_CHECK(converters[i].first == CUTXORef(unspent[i].first.txhash, unspent[i].first.index));
+            BOOST_CHECK(::AsVector(converters[i].second) == ::AsVector(CPBaaSNotarization(unspent[i].second.script)));
+        }
+    }
+    return unspent.size();
+}
+
+// the native reserve of converterID in the graph's converters of currencyID, or -1 if it is not one of them
+CAmount ConverterNativeReserve(const uint160 &currencyID, const uint160 &converterID)
+{
+    LOCK(cs_main);
+    for (auto &oneConverter : ConverterGraph.GetConverters(currencyID))
+    {
+        if (oneConverter.second.currencyID == converterID)
+        {
+            return oneConverter.second.currencyState.reserves[0];
+        }
+    }
+    return -1;
+}
+
+}
+
+BOOST_FIXTURE_TEST_SUITE(convertergraph_tests, ChainCacheTestingSetup)
+
+BOOST_AUTO_TEST_CASE(converter_graph_follows_converter_index)
+{
+    Follow(&ConverterGraph);
+    uint160 reserveID = CCrossChainRPCData::GetID("chaincachereserve");
+    uint160 fracAID = CCrossChainRPCData::GetID("chaincachefraca");
+    uint160 fracBID = CCrossChainRPCData::GetID("chaincachefracb");
+
+    BOOST_CHECK_EQUAL(CheckConverters(reserveID), 0);
+
+    // currencies that are not defined are not kept
+    {
+        LOCK(cs_main);
+        BOOST_CHECK(!ConverterGraph.GetCurrency(CCrossChainRPCData::GetID("chaincacheundefined")).IsValid());
+    }
+
+    CBlock block1 = ConnectBlock({SpendingTx({}, {EvalOutput(EVAL_ACCEPTEDNOTARIZATION, ConverterNotarization(fracAID, reserveID, 100000000)),
+                                                  EvalOutput(EVAL_ACCEPTEDNOTARIZATION, ConverterNotarization(fracBID, reserveID, 100000000))})});
+    BOOST_CHECK_EQUAL(CheckConverters(reserveID), 2);
+    BOOST_CHECK_EQUAL(CheckConverters(ASSETCHAINS_CHAINID), 2);
+    BOOST_CHECK_EQUAL(ConverterNativeReserve(reserveID, fracAID), 100000000);
+
+    // the next notarization of A has too little native reserve to be indexed as a converter
+    ConnectBlock({SpendingTx({COutPoint(block1.vtx[1].GetHash(), 0)},
+                             {EvalOutput(EVAL_ACCEPTEDNOTARIZATION, ConverterNotarization(fracAID, reserveID, 1000))})});
+    BOOST_CHECK_EQUAL(CheckConverters(reserveID), 1);
+    BOOST_CHECK_EQUAL(ConverterNativeReserve(reserveID, fracAID), -1);
+
+    // a later notarization makes A a converter again, with the reserves it was notarized with
+    ConnectBlock({SpendingTx({}, {EvalOutput(EVAL_ACCEPTEDNOTARIZATION, ConverterNotarization(fracAID, reserveID, 200000000))})});
+    BOOST_CHECK_EQUAL(CheckConverters(reserveID), 2);
+    BOOST_CHECK_EQUAL(ConverterNativeReserve(reserveID, fracAID), 200000000);
+
+    DisconnectBlock();
+    BOOST_CHECK_EQUAL(CheckConverters(reserveID), 1);
+
+    DisconnectBlock();
+    BOOST_CHECK_EQUAL(CheckConverters(reserveID), 2);
+    BOOST_CHECK_EQUAL(CheckConverters(ASSETCHAINS_CHAINID), 2);
+    BOOST_CHECK_EQUAL(ConverterNativeReserve(reserveID, fracAID), 100000000);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
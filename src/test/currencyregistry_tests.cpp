@@ -0,0 +1,90 @@
+// Copyright (c) 2026 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#include "pbaas/currencyregistry.h"
+#include "test/test_chaincache.h"
+
+#include <boost/test/unit_test.hpp>
+
+/*
+ * The currency registry checked against the unspent index of the keys notarizations are indexed under.
+ */
+
+namespace
+{
+
+// checks the currencies indexed under indexKey from the registry, on the first call and from the cache, against the unspent index
+size_t CheckIndexedCurrencies(const uint160 &indexKey)
+{
+    LOCK(cs_main);
+    std::vector<CAddressUnspentDbEntry> unspent;
+    BOOST_REQUIRE(GetAddressUnspent(indexKey, CScript::P2IDX, unspent));
+    std::set<uint160> indexed;
+    for (auto &oneOutput : unspent)
+    {
+        CPBaaSNotarization pbn(oneOutput.second.script);
+        BOOST_REQUIRE(pbn.IsValid());
+        indexed.insert(pbn.currencyID);
+    }
+    for (int pass = 0; pass < 2; pass++)
+    {
+        std::set<uint160> currencyIDs;
+        BOOST_REQUIRE(CurrencyRegistry.GetIndexedCurrencies(indexKey, currencyIDs));
+        BOOST_CHECK(currencyIDs == indexed);
+    }
+    return indexed.size();
+}
+
+}
+
+BOOST_FIXTURE_TEST_SUITE(currencyregistry_tests, ChainCacheTestingSetup)
+
+BOOST_AUTO_TEST_CASE(currency_registry_follows_notarization_index)
+{
+    Follow(&CurrencyRegistry);
+    uint160 reserveID = CCrossChainRPCData::GetID("chaincacheregistryreserve");
+    uint160 fracAID = CCrossChainRPCData::GetID("chaincacheregistrya");
+    uint160 fracBID = CCrossChainRPCData::GetID("chaincacheregistryb");
+    uint160 converterKey = CCoinbaseCurrencyState::IndexConverterKey(reserveID);
+    uint160 notaryKeyA = CCrossChainRPCData::GetConditionID(fracAID, CPBaaSNotarization::NotaryNotarizationKey());
+
+    BOOST_CHECK_EQUAL(CheckIndexedCurrencies(converterKey), 0);
+    BOOST_CHECK_EQUAL(CheckIndexedCurrencies(notaryKeyA), 0);
+
+    CBlock block1 = ConnectBlock({SpendingTx({}, {EvalOutput(EVAL_ACCEPTEDNOTARIZATION, ConverterNotarization(fracAID, reserveID, 100000000)),
+                                                  EvalOutput(EVAL_ACCEPTEDNOTARIZATION, ConverterNotarization(fracBID, reserveID, 100000000))})});
+    BOOST_CHECK_EQUAL(CheckIndexedCurrencies(converterKey), 2);
+    BOOST_CHECK_EQUAL(CheckIndexedCurrencies(notaryKeyA), 1);
+
+    // A stops being a converter, but its notarization is still indexed under its notary key
+    ConnectBlock({SpendingTx({COutPoint(block1.vtx[1].GetHash(), 0)},
+                             {EvalOutput(EVAL_ACCEPTEDNOTARIZATION, ConverterNotarization(fracAID, reserveID, 1000))})});
+    BOOST_CHECK_EQUAL(CheckIndexedCurrencies(converterKey), 1);
+    BOOST_CHECK_EQUAL(CheckIndexedCurrencies(notaryKeyA), 1);
+    {
+        LOCK(cs_main);
+        std::set<uint160> currencyIDs;
+        BOOST_REQUIRE(CurrencyRegistry.GetIndexedCurrencies(converterKey, currencyIDs));
+        BOOST_CHECK(currencyIDs == std::set<uint160>({fracBID}));
+
+        // notarized here, but not defined on this chain
+        BOOST_CHECK(CurrencyRegistry.GetCurrency(fracAID) == nullptr);
+    }
+
+    ConnectBlock({SpendingTx({COutPoint(block1.vtx[1].GetHash(), 1)}, {CTxOut(0, GetScriptForDestination(testKeyID))})});
+    BOOST_CHECK_EQUAL(CheckIndexedCurrencies(converterKey), 0);
+
+    DisconnectBlock();
+    BOOST_CHECK_EQUAL(CheckIndexedCurrencies(converterKey), 1);
+
+    DisconnectBlock();
+    BOOST_CHECK_EQUAL(CheckIndexedCurrencies(converterKey), 2);
+    BOOST_CHECK_EQUAL(CheckIndexedCurrencies(notaryKeyA), 1);
+
+    DisconnectBlock();
+    BOOST_CHECK_EQUAL(CheckIndexedCurrencies(converterKey), 0);
+    BOOST_CHECK_EQUAL(CheckIndexedCurrencies(notaryKeyA), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
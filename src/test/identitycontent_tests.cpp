@@ -0,0 +1,117 @@
+// Copyright (c) 2026 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#include "pbaas/identitycontent.h"
+#include "test/test_chaincache.h"
+
+#include <boost/test/unit_test.hpp>
+
+/*
+ * The identity content cache checked against replaying the history of an identity.
+ */
+
+namespace
+{
+
+// a content multimap removal, encoded the way the identity RPCs encode it
+std::pair<uint160, std::vector<unsigned char>> ContentRemoval(uint32_t action, const uint160 &entryKey=uint160(), const std::string &value=std::string())
+{
+    CContentMultiMapRemove removal;
+    removal.version = CContentMultiMapRemove::VERSION_CURRENT;
+    removal.action = action;
+    removal.entryKey = entryKey;
+    CNativeHashWriter hw;
+    hw.write(value.data(), value.size());
+    removal.valueHash = hw.GetHash();
+
+    CDataStream ss(SER_DISK, PROTOCOL_VERSION);
+    ss << CVDXF_Data::ContentMultiMapRemoveKey();
+    ss << VARINT(removal.version);
+    ss << COMPACTSIZE((uint64_t)GetSerializeSize(ss, removal));
+    ss << removal;
+    return std::make_pair(CVDXF_Data::ContentMultiMapRemoveKey(), std::vector<unsigned char>(ss.begin(), ss.end()));
+}
+
+// checks the content of idID from startHeight through endHeight from the content cache, on the first call and from
+// the cache, against replaying the identity's history
+size_t CheckContent(const uint160 &idID, uint32_t startHeight=0, uint32_t endHeight=0)
+{
+    LOCK(cs_main);
+    CIdentityContentCache::AggregatedMap replayed = CIdentity::GetAggregatedIdentityMultimap(idID, startHeight, endHeight, true);
+    for (int pass = 0; pass < 2; pass++)
+    {
+        CIdentityContentCache::AggregatedMap content = IdentityContentCache.GetAggregatedContent(idID, std::vector<uint160>(), startHeight, endHeight);
+        BOOST_REQUIRE_EQUAL(content.size(), replayed.size());
+        for (auto it = content.begin(), replayedIt = replayed.begin(); it != content.end(); it++, replayedIt++)
+        {
+            BOOST_CHECK(it->first == replayedIt->first);
+            BOOST_CHECK(std::get<0>(it->second) == std::get<0>(replayedIt->second));
+            BOOST_CHECK(std::get<1>(it->second) == std::get<1>(replayedIt->second));
+            BOOST_CHECK_EQUAL(std::get<2>(it->second), std::get<2>(replayedIt->second));
+            BOOST_CHECK(std::get<3>(it->second) == std::get<3>(replayedIt->second));
+        }
+    }
+    return replayed.size();
+}
+
+// the values of the content of idID under key
+std::multiset<std::vector<unsigned char>> ContentValues(const uint160 &idID, const uint160 &key)
+{
+    LOCK(cs_main);
+    std::multiset<std::vector<unsigned char>> values;
+    CIdentityContentCache::AggregatedMap content = IdentityContentCache.GetAggregatedContent(idID, std::vector<uint160>(), 0, 0);
+    for (auto it = content.lower_bound(key); it != content.upper_bound(key); it++)
+    {
+        values.insert(std::get<0>(it->second));
+    }
+    return values;
+}
+
+}
+
+BOOST_FIXTURE_TEST_SUITE(identitycontent_tests, ChainCacheTestingSetup)
+
+BOOST_AUTO_TEST_CASE(identity_content_follows_identity_history)
+{
+    Follow(&IdentityContentCache);
+    uint160 keyOne = CCrossChainRPCData::GetID("chaincachecontentone");
+    uint160 keyTwo = CCrossChainRPCData::GetID("chaincachecontenttwo");
+    auto Content = [](const std::string &value) { return std::vector<unsigned char>(value.begin(), value.end()); };
+
+    CIdentity identity = TestIdentity("chaincachecontent", testKeyID, {{keyOne, Content("one")}, {keyOne, Content("two")}, {keyTwo, Content("three")}});
+    uint160 idID = identity.GetID();
+
+    BOOST_CHECK_EQUAL(CheckContent(idID), 0);
+
+    CBlock block1 = ConnectBlock({SpendingTx({}, {CTxOut(0, identity.IdentityUpdateOutputScript(1))})});
+    BOOST_CHECK_EQUAL(CheckContent(idID), 3);
+
+    // remove one value and add another
+    identity.contentMultiMap = {ContentRemoval(CContentMultiMapRemove::ACTION_REMOVE_ONE_KEYVALUE, keyOne, "one"), {keyTwo, Content("four")}};
+    CBlock block2 = ConnectBlock({SpendingTx({COutPoint(block1.vtx[1].GetHash(), 0)}, {CTxOut(0, identity.IdentityUpdateOutputScript(2))})});
+    BOOST_CHECK_EQUAL(CheckContent(idID), 3);
+    BOOST_CHECK_EQUAL(CheckContent(idID, 2), 1);
+    BOOST_CHECK_EQUAL(CheckContent(idID, 1, 1), 3);
+    BOOST_CHECK(ContentValues(idID, keyOne) == std::multiset<std::vector<unsigned char>>({Content("two")}));
+    BOOST_CHECK(ContentValues(idID, keyTwo) == std::multiset<std::vector<unsigned char>>({Content("three"), Content("four")}));
+
+    identity.contentMultiMap = {ContentRemoval(CContentMultiMapRemove::ACTION_CLEAR_MAP), {keyOne, Content("five")}};
+    ConnectBlock({SpendingTx({COutPoint(block2.vtx[1].GetHash(), 0)}, {CTxOut(0, identity.IdentityUpdateOutputScript(3))})});
+    BOOST_CHECK_EQUAL(CheckContent(idID), 1);
+    BOOST_CHECK_EQUAL(CheckContent(idID, 1, 2), 3);
+    BOOST_CHECK(ContentValues(idID, keyOne) == std::multiset<std::vector<unsigned char>>({Content("five")}));
+    BOOST_CHECK(ContentValues(idID, keyTwo).empty());
+
+    DisconnectBlock();
+    BOOST_CHECK_EQUAL(CheckContent(idID), 3);
+
+    DisconnectBlock();
+    BOOST_CHECK_EQUAL(CheckContent(idID), 3);
+    BOOST_CHECK_EQUAL(CheckContent(idID, 1, 1), 3);
+
+    DisconnectBlock();
+    BOOST_CHECK_EQUAL(CheckContent(idID), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,159 @@
+// Copyright (c) 2026 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#include "pbaas/identityindex.h"
+#include "test/test_chaincache.h"
+
+#include <algorithm>
+
+#include <boost/test/unit_test.hpp>
+
+/*
+ * The identity index checked against the unspent and address indexes across identities defined, updated and
+ * disconnected.
+ */
+
+namespace
+{
+
+// checks the identities indexed under indexKey from the identity index, all at once and a page at a time,
+// against the unspent index
+size_t CheckIdentities(const uint160 &indexKey)
+{
+    LOCK(cs_main);
+    std::vector<CAddressUnspentDbEntry> unspent;
+    BOOST_REQUIRE(GetAddressUnspent(indexKey, CScript::P2IDX, unspent));
+    std::map<uint160, CAddressUnspentDbEntry> indexed;
+    for (auto &oneOutput : unspent)
+    {
+        CIdentity identity(oneOutput.second.script);
+        BOOST_REQUIRE(identity.IsValid());
+        indexed.insert(std::make_pair(identity.GetID(), oneOutput));
+    }
+
+    std::vector<CIndexedIdentity> identities;
+    bool fMore = true;
+    BOOST_REQUIRE(IdentityIndex.GetIdentities(indexKey, identities, uint160(), 0, &fMore));
+    BOOST_CHECK(!fMore);
+    std::vector<CIndexedIdentity> paged;
+    for (fMore = true; fMore; )
+    {
+        BOOST_REQUIRE(IdentityIndex.GetIdentities(indexKey, paged, paged.size() ? paged.back().identity.GetID() : uint160(), paged.size() + 1, &fMore));
+    }
+
+    BOOST_REQUIRE_EQUAL(identities.size(), indexed.size());
+    BOOST_REQUIRE_EQUAL(paged.size(), indexed.size());
+    auto indexedIt = indexed.begin();
+    for (int i = 0; i < identities.size(); i++, indexedIt++)
+    {
+        for (auto &one : {identities[i], paged[i]})
+        {
+            BOOST_CHECK(one.identity.GetID() == indexedIt->first);
+            BOOST_CHECK(one.output == COutPoint(indexedIt->second.first.txhash, indexedIt->second.first.index));
+            BOOST_CHECK_EQUAL(one.blockHeight, indexedIt->second.second.blockHeight);
+            BOOST_CHECK(::AsVector(one.identity) == ::AsVector(CIdentity(indexedIt->second.second.script)));
+        }
+    }
+    return indexed.size();
+}
+
+// checks the first output of each identity indexed under indexKey from start through end, all at once and a page
+// at a time, against reading every output in that range
+size_t CheckIdentityOuts(const uint160 &indexKey, uint32_t start=0, uint32_t end=0)
+{
+    LOCK(cs_main);
+    std::map<uint160, std::pair<CAddressIndexDbEntry, CIdentity>> indexed;
+    BOOST_REQUIRE(CIdentity::GetIdentityOutsWithIndexKey(indexKey, indexed, start, end));
+
+    std::vector<std::pair<CAddressIndexDbEntry, CIdentity>> identities, paged;
+    BOOST_REQUIRE(IdentityIndex.GetIdentityOuts(indexKey, identities, start, end));
+    for (bool fMore = true; fMore; )
+    {
+        BOOST_REQUIRE(IdentityIndex.GetIdentityOuts(indexKey, paged, start, end, paged.size() ? paged.back().second.GetID() : uint160(), paged.size() + 1, &fMore));
+    }
+
+    BOOST_REQUIRE_EQUAL(identities.size(), indexed.size());
+    BOOST_REQUIRE_EQUAL(paged.size(), indexed.size());
+    auto indexedIt = indexed.begin();
+    for (int i = 0; i < identities.size(); i++, indexedIt++)
+    {
+        for (auto &one : {identities[i], paged[i]})
+        {
+            BOOST_CHECK(one.second.GetID() == indexedIt->first);
+            BOOST_CHECK(::AsVector(one.first.first) == ::AsVector(indexedIt->second.first.first));
+            BOOST_CHECK_EQUAL(one.first.second, indexedIt->second.first.second);
+            BOOST_CHECK(::AsVector(one.second) == ::AsVector(indexedIt->second.second));
+        }
+    }
+    return indexed.size();
+}
+
+}
+
+BOOST_FIXTURE_TEST_SUITE(identityindex_tests, ChainCacheTestingSetup)
+
+BOOST_AUTO_TEST_CASE(identity_index_follows_identity_index_keys)
+{
+    Follow(&IdentityIndex);
+    CKey otherKey;
+    otherKey.MakeNewKey(true);
+    CKeyID otherKeyID = otherKey.GetPubKey().GetID();
+    uint160 testKeyIndex = CIdentity::IdentityPrimaryAddressKey(testKeyID);
+    uint160 otherKeyIndex = CIdentity::IdentityPrimaryAddressKey(otherKeyID);
+
+    CIdentity idA = TestIdentity("chaincacheida", testKeyID);
+    CIdentity idB = TestIdentity("chaincacheidb", testKeyID);
+    CIdentity idC = TestIdentity("chaincacheidc", testKeyID);
+    CIdentity idD = TestIdentity("chaincacheidd", otherKeyID);
+
+    BOOST_CHECK_EQUAL(CheckIdentities(testKeyIndex), 0);
+
+    CBlock block1 = ConnectBlock({SpendingTx({}, {CTxOut(0, idA.IdentityUpdateOutputScript(1)),
+                                                  CTxOut(0, idB.IdentityUpdateOutputScript(1)),
+                                                  CTxOut(0, idC.IdentityUpdateOutputScript(1)),
+                                                  CTxOut(0, idD.IdentityUpdateOutputScript(1))})});
+    BOOST_CHECK_EQUAL(CheckIdentities(testKeyIndex), 3);
+    BOOST_CHECK_EQUAL(CheckIdentities(otherKeyIndex), 1);
+    BOOST_CHECK_EQUAL(CheckIdentityOuts(testKeyIndex), 3);
+
+    // A moves to the other key and B is updated without changing it
+    CIdentity newA = idA, newB = idB;
+    newA.primaryAddresses = {CTxDestination(otherKeyID)};
+    CBlock block2 = ConnectBlock({SpendingTx({COutPoint(block1.vtx[1].GetHash(), 0), COutPoint(block1.vtx[1].GetHash(), 1)},
+                                             {CTxOut(0, newA.IdentityUpdateOutputScript(2)), CTxOut(0, newB.IdentityUpdateOutputScript(2))})});
+    BOOST_CHECK_EQUAL(CheckIdentities(testKeyIndex), 2);
+    BOOST_CHECK_EQUAL(CheckIdentities(otherKeyIndex), 2);
+    BOOST_CHECK_EQUAL(CheckIdentityOuts(testKeyIndex), 3);
+    BOOST_CHECK_EQUAL(CheckIdentityOuts(testKeyIndex, 2, 2), 1);
+    BOOST_CHECK_EQUAL(CheckIdentityOuts(otherKeyIndex), 2);
+    {
+        LOCK(cs_main);
+        std::vector<CIndexedIdentity> identities;
+        BOOST_REQUIRE(IdentityIndex.GetIdentities(otherKeyIndex, identities));
+        auto movedIt = std::find_if(identities.begin(), identities.end(),
+                                    [&idA](const CIndexedIdentity &one) { return one.identity.GetID() == idA.GetID(); });
+        BOOST_REQUIRE(movedIt != identities.end());
+        BOOST_CHECK(movedIt->output == COutPoint(block2.vtx[1].GetHash(), 0));
+        BOOST_CHECK(movedIt->identity.primaryAddresses == newA.primaryAddresses);
+    }
+
+    ConnectBlock({SpendingTx({COutPoint(block2.vtx[1].GetHash(), 1)}, {CTxOut(0, newB.IdentityUpdateOutputScript(3))})});
+    BOOST_CHECK_EQUAL(CheckIdentities(testKeyIndex), 2);
+    BOOST_CHECK_EQUAL(CheckIdentityOuts(testKeyIndex, 2, 3), 1);
+
+    DisconnectBlock();
+    BOOST_CHECK_EQUAL(CheckIdentities(testKeyIndex), 2);
+    BOOST_CHECK_EQUAL(CheckIdentityOuts(testKeyIndex, 2, 3), 1);
+
+    DisconnectBlock();
+    BOOST_CHECK_EQUAL(CheckIdentities(testKeyIndex), 3);
+    BOOST_CHECK_EQUAL(CheckIdentities(otherKeyIndex), 1);
+    BOOST_CHECK_EQUAL(CheckIdentityOuts(otherKeyIndex), 1);
+
+    DisconnectBlock();
+    BOOST_CHECK_EQUAL(CheckIdentities(testKeyIndex), 0);
+    BOOST_CHECK_EQUAL(CheckIdentityOuts(testKeyIndex), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,119 @@
+// Copyright (c) 2026 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#include "pbaas/importcache.h"
+#include "test/test_chaincache.h"
+
+#include <boost/test/unit_test.hpp>
+
+/*
+ * The export proof cache checked against checking proofs directly, and import stages across tip changes.
+ */
+
+namespace
+{
+
+// a full transaction proof for a transaction that differs by n
+CPartialTransactionProof TestProof(uint32_t n)
+{
+    CMutableTransaction mtx;
+    mtx.nLockTime = n;
+    mtx.vout.push_back(CTxOut(n, CScript() << OP_TRUE));
+    return CPartialTransactionProof(CMMRProof(), CTransaction(mtx));
+}
+
+// checks the cached result of checking proof against checking it directly
+void CheckProof(const CPartialTransactionProof &proof, bool optimizedETH)
+{
+    CTransaction checkedTx, cachedTx;
+    bool checkedPartial = false, cachedPartial = !checkedPartial;
+    uint256 checkedRoot = proof.CheckPartialTransaction(checkedTx, &checkedPartial, optimizedETH);
+    uint256 cachedRoot = ProofVerificationCache.CheckPartialTransaction(proof, cachedTx, &cachedPartial, optimizedETH);
+    BOOST_CHECK(cachedRoot == checkedRoot);
+    BOOST_CHECK(cachedTx.GetHash() == checkedTx.GetHash());
+    BOOST_CHECK_EQUAL(cachedPartial, checkedPartial);
+}
+
+}
+
+BOOST_FIXTURE_TEST_SUITE(importcache_tests, ChainCacheTestingSetup)
+
+BOOST_AUTO_TEST_CASE(proof_verification_cache_matches_proof_checks)
+{
+    ProofVerificationCache.Clear();
+
+    // a miss, then a hit, for each proof and ETH option
+    for (int i = 0; i < 2; i++)
+    {
+        CheckProof(TestProof(1), true);
+        CheckProof(TestProof(1), false);
+        CheckProof(TestProof(2), true);
+    }
+
+    // after enough other proofs to drop the first ones from the cache, they are checked again
+    for (uint32_t n = 3; n < 1100; n++)
+    {
+        CheckProof(TestProof(n), true);
+    }
+    CheckProof(TestProof(1), true);
+    CheckProof(TestProof(2), true);
+    CheckProof(TestProof(1099), true);
+
+    // without the result
+    CTransaction cachedTx;
+    BOOST_CHECK(ProofVerificationCache.CheckPartialTransaction(TestProof(1), cachedTx) ==
+                TestProof(1).CheckPartialTransaction(cachedTx));
+
+    ProofVerificationCache.Clear();
+}
+
+BOOST_AUTO_TEST_CASE(import_stages_keep_until_inputs_or_tip_change)
+{
+    Follow(&ImportStages);
+    ConnectBlock();
+
+    CUTXORef exportA(uint256S("0a"), 1), exportB(uint256S("0b"), 1);
+    uint256 inputHash = uint256S("01"), otherInputHash = uint256S("02");
+    CImportStage stage, found;
+    stage.isValid = true;
+    stage.transferHash = uint256S("03");
+    stage.importOutputs.push_back(CTxOut(1000, GetScriptForDestination(testKeyID)));
+
+    {
+        LOCK(cs_main);
+        BOOST_CHECK(!ImportStages.GetStage(exportA, inputHash, found));
+        ImportStages.SetStage(exportA, inputHash, stage);
+        BOOST_REQUIRE(ImportStages.GetStage(exportA, inputHash, found));
+        BOOST_CHECK(found.isValid);
+        BOOST_CHECK(found.transferHash == stage.transferHash);
+        BOOST_CHECK(found.importOutputs == stage.importOutputs);
+
+        // other inputs or another export miss
+        BOOST_CHECK(!ImportStages.GetStage(exportA, otherInputHash, found));
+        BOOST_CHECK(!ImportStages.GetStage(exportB, inputHash, found));
+
+        // the last stage set for an export replaces the one before
+        ImportStages.SetStage(exportA, otherInputHash, stage);
+        BOOST_CHECK(!ImportStages.GetStage(exportA, inputHash, found));
+        BOOST_CHECK(ImportStages.GetStage(exportA, otherInputHash, found));
+    }
+
+    // a new tip, or going back to an old one, starts again
+    ConnectBlock();
+    {
+        LOCK(cs_main);
+        BOOST_CHECK(!ImportStages.GetStage(exportA, otherInputHash, found));
+        ImportStages.SetStage(exportA, inputHash, stage);
+    }
+
+    DisconnectBlock();
+    {
+        LOCK(cs_main);
+        BOOST_CHECK(!ImportStages.GetStage(exportA, inputHash, found));
+    }
+
+    DisconnectBlock();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
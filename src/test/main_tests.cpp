@@ -4,6 +4,8 @@
 
 #include "chainparams.h"
 #include "main.h"
+#include "random.h"
+#include "txdb.h"
 
 #include "test/test_bitcoin.h"
 
@@ -127,4 +129,92 @@ BOOST_AUTO_TEST_CASE(test_combiner_all)
     BOOST_CHECK(Test());
 }
 
+BOOST_AUTO_TEST_CASE(block_index_trimmed_solution)
+{
+    CBlockHeader header;
+    header.nVersion = 4;
+    header.nTime = 1234567;
+    header.nBits = 0x200f0f0f;
+    header.nSolution = std::vector<unsigned char>(1344, 0x5a);
+    header.nSolution[0] = 0x01;
+    uint256 hash = header.GetHash();
+
+    CBlockIndex index(header);
+    index.phashBlock = &hash;
+    BOOST_CHECK(index.HasSolution());
+    BOOST_CHECK(index.BlockMMRRoot() == header.hashMerkleRoot);
+
+    std::vector<const CBlockIndex*> vBlocks(1, &index);
+    BOOST_CHECK(pblocktree->WriteBatchSync(std::vector<std::pair<int, const CBlockFileInfo*> >(), 0, vBlocks));
+
+    // once trimmed, the solution is read back from the block tree database
+    index.TrimSolution();
+    BOOST_CHECK(!index.HasSolution());
+    BOOST_CHECK(index.GetSolution() == header.nSolution);
+    BOOST_CHECK(index.GetBlockHeader().GetHash() == hash);
+
+    // a solution that cannot be read is reported, rather than thrown, and is not written back
+    BOOST_CHECK(pblocktree->EraseBatchSync(vBlocks));
+    std::vector<unsigned char> solution(1, 0x01);
+    BOOST_CHECK(!index.GetSolution(solution));
+    BOOST_CHECK(solution.empty());
+    CBlockHeader readHeader;
+    BOOST_CHECK(!index.GetBlockHeader(readHeader));
+    BOOST_CHECK(!pblocktree->WriteBatchSync(std::vector<std::pair<int, const CBlockFileInfo*> >(), 0, vBlocks));
+}
+
+BOOST_AUTO_TEST_CASE(load_block_index_parallel)
+{
+    // a chain of headers hanging off a parent that is not in the database
+    std::vector<CBlockHeader> headers(200);
+    std::vector<uint256> hashes(headers.size());
+    std::vector<CBlockIndex> indexes;
+    indexes.reserve(headers.size());
+    uint256 hashPrev = GetRandHash();
+    for (size_t i = 0; i < headers.size(); i++) {
+        headers[i].nVersion = 4;
+        headers[i].hashPrevBlock = hashPrev;
+        headers[i].nTime = 1000 + i;
+        headers[i].nSolution = std::vector<unsigned char>(32, i);
+        hashes[i] = headers[i].GetHash();
+        hashPrev = hashes[i];
+    }
+    for (size_t i = 0; i < headers.size(); i++) {
+        indexes.push_back(CBlockIndex(headers[i]));
+        indexes[i].phashBlock = &hashes[i];
+        indexes[i].pprev = i ? &indexes[i - 1] : NULL;
+        indexes[i].SetHeight(i + 1);
+    }
+    // the first entry is written with a null parent, so it is not checked as a genesis block
+    std::vector<const CBlockIndex*> vBlocks;
+    for (size_t i = 1; i < indexes.size(); i++) {
+        vBlocks.push_back(&indexes[i]);
+    }
+    BOOST_CHECK(pblocktree->WriteBatchSync(std::vector<std::pair<int, const CBlockFileInfo*> >(), 0, vBlocks));
+
+    for (int nThreads : {1, 3, 8}) {
+        std::map<uint256, CBlockIndex*> mapLoaded;
+        auto insert = [&mapLoaded](const uint256& hash) -> CBlockIndex* {
+            if (hash.IsNull())
+                return NULL;
+            CBlockIndex*& pindex = mapLoaded[hash];
+            if (!pindex)
+                pindex = new CBlockIndex();
+            return pindex;
+        };
+        BOOST_CHECK(pblocktree->LoadBlockIndexGuts(insert, nThreads));
+        for (size_t i = 1; i < indexes.size(); i++) {
+            BOOST_REQUIRE(mapLoaded.count(hashes[i]));
+            const CBlockIndex* pindex = mapLoaded[hashes[i]];
+            BOOST_CHECK_EQUAL(pindex->GetHeight(), (int)i + 1);
+            BOOST_CHECK(pindex->pprev == mapLoaded[hashes[i - 1]]);
+            BOOST_CHECK(pindex->nTime == headers[i].nTime);
+            BOOST_CHECK(!pindex->HasSolution());
+        }
+        for (auto& entry : mapLoaded) {
+            delete entry.second;
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
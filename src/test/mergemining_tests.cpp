@@ -0,0 +1,178 @@
+// Copyright (c) 2026 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#include "arith_uint256.h"
+#include "pbaas/pbaas.h"
+#include "primitives/block.h"
+#include "test/test_bitcoin.h"
+
+#include <boost/test/unit_test.hpp>
+
+/*
+ * Merge mining slots checked against finding the chains a header qualifies for from the blocks themselves, by
+ * walking the chains with targets at or above the header's hash and filling a copy of the header with each block.
+ */
+
+namespace
+{
+
+// a solution with room for PBaaS headers, as blocks have once PBaaS is active
+void SetPBaaSSolution(CBlockHeader &header)
+{
+    header.nVersion = CBlockHeader::VERUS_V2;
+    header.nSolution.resize(CConstVerusSolutionVector::SOLUTION_SIZE);
+    BOOST_REQUIRE(CVerusSolutionVector(header.nSolution).SetVersion(CActivationHeight::ACTIVATE_PBAAS));
+}
+
+// a chain to merge mine with a block that holds its own PBaaS header, the way its daemon makes one.
+// nothing listens on port 1, so submissions fail without waiting
+CPBaaSMergeMinedChainData MergeMinedChain(const std::string &name, uint32_t nBits, const uint256 &prevHash)
+{
+    CCurrencyDefinition chainDef;
+    chainDef.name = name;
+    CBlock block;
+    SetPBaaSSolution(block);
+    block.hashPrevBlock = prevHash;
+    block.nBits = nBits;
+    block.nTime = 1700000000;
+    BOOST_REQUIRE(block.AddPBaaSHeader(chainDef.GetID()) != -1);
+    return CPBaaSMergeMinedChainData(chainDef, "127.0.0.1", 1, "user:pass", block);
+}
+
+// the chains a header would be submitted to, in order, found by walking the merge mined chains by target
+std::vector<std::string> ChainsByTargetWalk(const CBlockHeader &bh)
+{
+    LOCK(ConnectedChains.cs_mergemining);
+    arith_uint256 hash = UintToArith256(bh.GetHash());
+    std::set<uint160> inHeader, submitted;
+    CPBaaSBlockHeader pbh;
+    for (uint32_t i = 0; bh.GetPBaaSHeader(pbh, i); i++)
+    {
+        inHeader.insert(pbh.chainID);
+    }
+
+    std::vector<std::string> chains;
+    for (bool found = true; found; )
+    {
+        found = false;
+        for (auto chainIt = ConnectedChains.mergeMinedTargets.lower_bound(hash); !found && chainIt != ConnectedChains.mergeMinedTargets.end(); chainIt++)
+        {
+            uint160 chainID = chainIt->second->GetID();
+            if (!inHeader.count(chainID) || submitted.count(chainID))
+            {
+                continue;
+            }
+            CBlockHeader filled = bh;
+            CPBaaSPreHeader(chainIt->second->block).SetBlockData(filled);
+            if (filled.CheckNonCanonicalData(chainID))
+            {
+                chains.push_back(chainIt->second->chainDefinition.name);
+                submitted.insert(chainID);
+                found = true;
+            }
+        }
+    }
+    return chains;
+}
+
+// checks that bh holds the header of each merge mined chain, as its block has it, and no others, and that nBits
+// is the easiest of their targets and the header's own
+void CheckCombined(const CBlockHeader &bh, uint32_t nBits, uint32_t combinedBits)
+{
+    LOCK(ConnectedChains.cs_mergemining);
+    arith_uint256 target;
+    target.SetCompact(nBits);
+    std::set<uint160> inHeader;
+    CPBaaSBlockHeader pbh, blockPBH;
+    for (uint32_t i = 0; bh.GetPBaaSHeader(pbh, i); i++)
+    {
+        auto chainIt = ConnectedChains.mergeMinedChains.find(pbh.chainID);
+        BOOST_REQUIRE(chainIt != ConnectedChains.mergeMinedChains.end());
+        BOOST_REQUIRE(chainIt->second.block.GetPBaaSHeader(blockPBH, pbh.chainID) != -1);
+        BOOST_CHECK(pbh.hashPreHeader == blockPBH.hashPreHeader);
+        inHeader.insert(pbh.chainID);
+
+        arith_uint256 chainTarget;
+        chainTarget.SetCompact(chainIt->second.block.nBits);
+        if (chainTarget > target)
+        {
+            target = chainTarget;
+        }
+    }
+    BOOST_CHECK_EQUAL(inHeader.size(), ConnectedChains.mergeMinedChains.size());
+    BOOST_CHECK_EQUAL(combinedBits, target.GetCompact());
+}
+
+// sets the nonce of bh so its hash is at or below target
+void SolveHeader(CBlockHeader &bh, uint32_t nBits)
+{
+    arith_uint256 target;
+    target.SetCompact(nBits);
+    arith_uint256 nonce;
+    for (int i = 0; i < 10000 && UintToArith256(bh.GetHash()) > target; i++)
+    {
+        bh.nNonce = ArithToUint256(++nonce);
+    }
+    BOOST_REQUIRE(UintToArith256(bh.GetHash()) <= target);
+}
+
+}
+
+BOOST_FIXTURE_TEST_SUITE(mergemining_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(qualified_headers_match_target_walk)
+{
+    const uint32_t bitsA = 0x207fffff, bitsB = 0x203fffff, bitsC = 0x201fffff, bitsHeader = 0x1f07ffff;
+    CPBaaSMergeMinedChainData chainA = MergeMinedChain("mergeminea", bitsA, uint256S("01"));
+    CPBaaSMergeMinedChainData chainB = MergeMinedChain("mergemineb", bitsB, uint256S("02"));
+    CPBaaSMergeMinedChainData chainC = MergeMinedChain("mergeminec", bitsC, uint256S("03"));
+    BOOST_REQUIRE(ConnectedChains.AddMergedBlock(chainA));
+    BOOST_REQUIRE(ConnectedChains.AddMergedBlock(chainB));
+    BOOST_REQUIRE(ConnectedChains.AddMergedBlock(chainC));
+
+    CBlockHeader bh;
+    SetPBaaSSolution(bh);
+    bh.hashPrevBlock = uint256S("04");
+    bh.nBits = bitsHeader;
+    bh.nTime = 1700000000;
+    CheckCombined(bh, bitsHeader, ConnectedChains.CombineBlocks(bh));
+
+    // C has a new block after the header was made, so the header qualifies for A and B only
+    chainC = MergeMinedChain("mergeminec", bitsC, uint256S("05"));
+    BOOST_REQUIRE(ConnectedChains.AddMergedBlock(chainC));
+    SolveHeader(bh, bitsC);
+    std::vector<std::string> walked = ChainsByTargetWalk(bh);
+    BOOST_CHECK(walked == std::vector<std::string>({"mergemineb", "mergeminea"}));
+
+    ConnectedChains.QueueNewBlockHeader(bh);
+    std::vector<std::string> submitted;
+    for (auto &oneResult : ConnectedChains.SubmitQualifiedBlocks())
+    {
+        submitted.push_back(oneResult.first);
+    }
+    BOOST_CHECK(submitted == walked);
+
+    // submitted chains leave merge mining until their next block, and combining again removes B, updates C and keeps A
+    BOOST_REQUIRE(ConnectedChains.AddMergedBlock(chainA));
+    CheckCombined(bh, bitsHeader, ConnectedChains.CombineBlocks(bh));
+    SolveHeader(bh, bitsC);
+    walked = ChainsByTargetWalk(bh);
+    BOOST_CHECK(walked == std::vector<std::string>({"mergeminec", "mergeminea"}));
+
+    ConnectedChains.QueueNewBlockHeader(bh);
+    submitted.clear();
+    for (auto &oneResult : ConnectedChains.SubmitQualifiedBlocks())
+    {
+        submitted.push_back(oneResult.first);
+    }
+    BOOST_CHECK(submitted == walked);
+
+    ConnectedChains.RemoveMergedBlock(chainA.GetID());
+    ConnectedChains.RemoveMergedBlock(chainB.GetID());
+    ConnectedChains.RemoveMergedBlock(chainC.GetID());
+    LOCK(ConnectedChains.cs_mergemining);
+    ConnectedChains.qualifiedHeaders.clear();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,93 @@
+// Copyright (c) 2026 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#include "pbaas/offerbook.h"
+#include "test/test_chaincache.h"
+
+#include <algorithm>
+
+#include <boost/test/unit_test.hpp>
+
+/*
+ * The offer book checked against the unspent index across offers posted, closed and disconnected.
+ */
+
+namespace
+{
+
+// checks the outputs posted to offerKey from the book, on the first call and from the cache, against the unspent index
+size_t CheckPostedOutputs(const uint160 &offerKey)
+{
+    LOCK(cs_main);
+    std::vector<CAddressUnspentDbEntry> unspent;
+    BOOST_REQUIRE(GetAddressUnspent(offerKey, CScript::P2PKH, unspent));
+    std::set<COutPoint> indexed;
+    for (auto &oneOutput : unspent)
+    {
+        indexed.insert(COutPoint(oneOutput.first.txhash, oneOutput.first.index));
+    }
+    for (int pass = 0; pass < 2; pass++)
+    {
+        std::vector<COutPoint> posted;
+        BOOST_REQUIRE(OfferBook.GetPostedOutputs(offerKey, posted));
+        BOOST_CHECK(posted == std::vector<COutPoint>(indexed.begin(), indexed.end()));
+    }
+    return indexed.size();
+}
+
+}
+
+BOOST_FIXTURE_TEST_SUITE(offerbook_tests, ChainCacheTestingSetup)
+
+BOOST_AUTO_TEST_CASE(offer_book_follows_offer_index)
+{
+    Follow(&OfferBook);
+    uint160 currencyID = CCrossChainRPCData::GetID("chaincacheoffers");
+    uint160 forKey = COnChainOffer::OnChainOfferForCurrencyKey(currencyID);
+    uint160 offerKey = COnChainOffer::OnChainCurrencyOfferKey(currencyID);
+    std::vector<CTxDestination> offerDests({CKeyID(forKey), CKeyID(offerKey)});
+    CCommitmentHash commitment = CCommitmentHash(uint256());
+
+    BOOST_CHECK_EQUAL(CheckPostedOutputs(forKey), 0);
+
+    CBlock block1 = ConnectBlock({SpendingTx({}, {EvalOutput(EVAL_IDENTITY_COMMITMENT, commitment, 10000, &offerDests),
+                                                  EvalOutput(EVAL_IDENTITY_COMMITMENT, commitment, 20000, &offerDests)})});
+    BOOST_CHECK_EQUAL(CheckPostedOutputs(forKey), 2);
+    BOOST_CHECK_EQUAL(CheckPostedOutputs(offerKey), 2);
+
+    // closing one offer and posting another in the same transaction
+    CBlock block2 = ConnectBlock({SpendingTx({COutPoint(block1.vtx[1].GetHash(), 0)},
+                                             {EvalOutput(EVAL_IDENTITY_COMMITMENT, commitment, 30000, &offerDests)})});
+    BOOST_CHECK_EQUAL(CheckPostedOutputs(forKey), 2);
+    {
+        LOCK(cs_main);
+        std::vector<COutPoint> posted;
+        BOOST_REQUIRE(OfferBook.GetPostedOutputs(forKey, posted));
+        BOOST_CHECK(std::count(posted.begin(), posted.end(), COutPoint(block1.vtx[1].GetHash(), 0)) == 0);
+        BOOST_CHECK(std::count(posted.begin(), posted.end(), COutPoint(block1.vtx[1].GetHash(), 1)) == 1);
+        BOOST_CHECK(std::count(posted.begin(), posted.end(), COutPoint(block2.vtx[1].GetHash(), 0)) == 1);
+
+        // commitments are indexed under the offer keys, but are not offers that can be taken
+        std::shared_ptr<const COpenOffer> offer;
+        BOOST_CHECK(OfferBook.GetOffer(block2.vtx[1].GetHash(), chainActive.Height(), offer));
+        BOOST_CHECK(!offer);
+        BOOST_CHECK(!OfferBook.GetOffer(uint256S("0a"), chainActive.Height(), offer));
+    }
+
+    ConnectBlock({SpendingTx({COutPoint(block1.vtx[1].GetHash(), 1), COutPoint(block2.vtx[1].GetHash(), 0)}, {CTxOut(60000, GetScriptForDestination(testKeyID))})});
+    BOOST_CHECK_EQUAL(CheckPostedOutputs(forKey), 0);
+    BOOST_CHECK_EQUAL(CheckPostedOutputs(offerKey), 0);
+
+    DisconnectBlock();
+    BOOST_CHECK_EQUAL(CheckPostedOutputs(forKey), 2);
+
+    DisconnectBlock();
+    BOOST_CHECK_EQUAL(CheckPostedOutputs(forKey), 2);
+    BOOST_CHECK_EQUAL(CheckPostedOutputs(offerKey), 2);
+
+    DisconnectBlock();
+    BOOST_CHECK_EQUAL(CheckPostedOutputs(forKey), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -3,7 +3,9 @@
 // file COPYING or https://www.opensource.org/licenses/mit-license.php .
 
 #include "rpc/server.h"
+#include "rpc/blocktemplate.h"
 #include "rpc/client.h"
+#include "rpc/jsonstream.h"
 
 #include "key_io.h"
 #include "main.h"
@@ -461,4 +463,125 @@ BOOST_AUTO_TEST_CASE(rpc_insightexplorer)
     fTimestampIndex = false;
 }
 
+BOOST_AUTO_TEST_CASE(rpc_jsonstream)
+{
+    UniValue inner(UniValue::VOBJ);
+    inner.push_back(Pair("a", 1));
+    inner.push_back(Pair("quote\"d", "line\nbreak"));
+    inner.push_back(Pair("empty", UniValue(UniValue::VARR)));
+    inner.push_back(Pair("none", NullUniValue));
+    UniValue value(UniValue::VARR);
+    value.push_back(inner);
+    value.push_back(UniValue(UniValue::VOBJ));
+    value.push_back(true);
+    value.push_back(ValueFromAmount(123456789));
+
+    // output is the same as UniValue::write, whatever the size of the pieces
+    std::string strOut;
+    for (size_t nFlushSize : {(size_t)1, (size_t)7, CJSONStreamWriter::DEFAULT_FLUSH_SIZE})
+    {
+        std::vector<std::string> vChunks;
+        CJSONStreamWriter writer([&vChunks](const std::string& chunk) { vChunks.push_back(chunk); }, nFlushSize);
+        writer.Value(value);
+        BOOST_CHECK_EQUAL(writer.Flushed(), nFlushSize != CJSONStreamWriter::DEFAULT_FLUSH_SIZE);
+        writer.Flush();
+        BOOST_CHECK_EQUAL(boost::algorithm::join(vChunks, ""), value.write());
+    }
+
+    // elements written one at a time
+    CJSONStreamWriter writer([&strOut](const std::string& chunk) { strOut += chunk; });
+    writer.BeginObject();
+    writer.Key("result");
+    writer.BeginArray();
+    for (int i = 0; i < value.size(); i++)
+    {
+        // values already serialized are written as they are
+        if (i % 2)
+            writer.ValueJSON(value[i].write());
+        else
+            writer.Value(value[i]);
+    }
+    writer.EndArray();
+    writer.KeyValue("error", NullUniValue);
+    writer.KeyValue("id", 1);
+    writer.EndObject();
+    BOOST_CHECK(!writer.Flushed());
+    writer.Flush();
+    BOOST_CHECK_EQUAL(strOut, JSONRPCReplyObj(value, NullUniValue, 1).write());
+
+    // a reply cut short in a nested value is closed before the error is added, and stays valid JSON
+    strOut.clear();
+    CJSONStreamWriter failed([&strOut](const std::string& chunk) { strOut += chunk; }, 1);
+    failed.BeginObject();
+    failed.Key("result");
+    failed.BeginArray();
+    failed.Value(inner);
+    failed.BeginObject();
+    failed.Key("partial");
+    failed.CloseLevels(1);
+    failed.KeyValue("error", JSONRPCError(RPC_MISC_ERROR, "failed"));
+    failed.KeyValue("id", 1);
+    failed.EndObject();
+    failed.Flush();
+    UniValue parsed;
+    BOOST_CHECK(parsed.read(strOut));
+    BOOST_CHECK_EQUAL(find_value(parsed, "result")[1].write(), "{\"partial\":null}");
+    BOOST_CHECK_EQUAL(find_value(find_value(parsed, "error"), "code").get_int(), RPC_MISC_ERROR);
+}
+
+static CTransaction BlockTemplateTx(uint32_t nLockTime, bool fCoinbase)
+{
+    CMutableTransaction mtx;
+    mtx.vin.resize(1);
+    if (!fCoinbase)
+        mtx.vin[0].prevout = COutPoint(uint256S("0x01"), nLockTime);
+    mtx.vout.resize(1);
+    mtx.nLockTime = nLockTime;
+    return CTransaction(mtx);
+}
+
+static CBlockTemplate BlockTemplateOn(const uint256 &hashPrevBlock, const CTransaction &tx)
+{
+    CBlockTemplate blockTemplate;
+    blockTemplate.block.hashPrevBlock = hashPrevBlock;
+    blockTemplate.block.vtx.push_back(BlockTemplateTx(0, true));
+    blockTemplate.block.vtx.push_back(tx);
+    blockTemplate.vTxFees = {0, 10};
+    blockTemplate.vTxSigOps = {1, 1};
+    return blockTemplate;
+}
+
+BOOST_AUTO_TEST_CASE(rpc_blocktemplatecache)
+{
+    CTransaction tx1 = BlockTemplateTx(1, false), tx2 = BlockTemplateTx(2, false);
+    CBlockTemplate first = BlockTemplateOn(uint256S("0xa1"), tx1);
+
+    CBlockTemplateCache cache;
+    BOOST_CHECK(!cache.IsCurrent(1, &first));
+    cache.Update(1, &first, 100);
+    cache.Remember("first");
+    BOOST_CHECK(cache.IsCurrent(1, &first));
+    BOOST_CHECK_EQUAL(*cache.transactionsJSON, cache.transactions.write());
+    BOOST_CHECK_EQUAL(find_value(cache.transactions[0], "hash").get_str(), tx1.GetHash().GetHex());
+    std::shared_ptr<const std::string> firstJSON = cache.transactionsJSON;
+
+    // a new tip invalidates the cache, even before a new template generation is counted
+    CBlockTemplate second = BlockTemplateOn(uint256S("0xa2"), tx2);
+    BOOST_CHECK(!cache.IsCurrent(1, &second));
+    cache.Update(1, &second, 101);
+    BOOST_CHECK(cache.IsCurrent(1, &second));
+    BOOST_CHECK_EQUAL(cache.transactions.size(), 1);
+    BOOST_CHECK_EQUAL(find_value(cache.transactions[0], "hash").get_str(), tx2.GetHash().GetHex());
+    BOOST_CHECK_EQUAL(*cache.transactionsJSON, cache.transactions.write());
+
+    // replies holding the JSON of the earlier template keep it
+    BOOST_CHECK(firstJSON != cache.transactionsJSON);
+    BOOST_CHECK(firstJSON->find(tx1.GetHash().GetHex()) != std::string::npos);
+
+    UniValue delta = cache.Delta("first");
+    BOOST_CHECK_EQUAL(find_value(delta, "added").size(), 1);
+    BOOST_CHECK_EQUAL(find_value(find_value(delta, "added")[0], "hash").get_str(), tx2.GetHash().GetHex());
+    BOOST_CHECK_EQUAL(find_value(delta, "removed")[0].get_str(), tx1.GetHash().GetHex());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,259 @@
+// Copyright (c) 2026 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#include "test/test_chaincache.h"
+
+#include "chainparams.h"
+#include "key.h"
+#include "script/standard.h"
+
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+
+// (type, address hash, index height) of each address and unspent index entry of an output, as ConnectBlock makes them
+std::vector<std::tuple<int, uint160, int32_t>> OutputIndexEntries(const CTxOut &out, int32_t height)
+{
+    std::vector<std::tuple<int, uint160, int32_t>> entries;
+    COptCCParams p;
+    if (out.scriptPubKey.IsPayToCryptoCondition(p))
+    {
+        std::vector<CTxDestination> dests = p.IsValid() ? p.GetDestinations() : out.scriptPubKey.GetDestinations();
+        std::map<uint160, uint32_t> heightOffsets = p.GetIndexHeightOffsets(height);
+        for (auto &dest : dests)
+        {
+            if (dest.which() != COptCCParams::ADDRTYPE_INVALID)
+            {
+                uint160 destID = GetDestinationID(dest);
+                int32_t indexHeight = (dest.which() == COptCCParams::ADDRTYPE_INDEX && heightOffsets.count(destID)) ? heightOffsets[destID] : height;
+                entries.push_back(std::make_tuple((int)AddressTypeFromDest(dest), destID, indexHeight));
+            }
+        }
+    }
+    else
+    {
+        CScript::ScriptType scriptType = out.scriptPubKey.GetType();
+        uint160 addrHash;
+        if (scriptType != CScript::UNKNOWN && !(addrHash = out.scriptPubKey.AddressHash()).IsNull())
+        {
+            entries.push_back(std::make_tuple((int)scriptType, addrHash, height));
+        }
+    }
+    return entries;
+}
+
+}
+
+// blocks are written to the second block file, after the genesis block in the first
+ChainCacheTestingSetup::ChainCacheTestingSetup() : fOldAddressIndex(fAddressIndex), fOldIdIndex(fIdIndex), fOldTxIndex(fTxIndex), nextBlockPos(1, 0)
+{
+    fAddressIndex = fIdIndex = fTxIndex = true;
+    CKey testKey;
+    testKey.MakeNewKey(true);
+    testKeyID = testKey.GetPubKey().GetID();
+#ifdef ENABLE_WALLET
+    // the wallet is not part of what is tested and would see every transaction
+    UnregisterValidationInterface(pwalletMain);
+#endif
+}
+
+ChainCacheTestingSetup::~ChainCacheTestingSetup()
+{
+    while (connectedBlocks.size())
+    {
+        DisconnectBlock();
+    }
+    for (auto pCache : followingCaches)
+    {
+        UnregisterValidationInterface(pCache);
+        pCache->Clear();
+    }
+    fAddressIndex = fOldAddressIndex;
+    fIdIndex = fOldIdIndex;
+    fTxIndex = fOldTxIndex;
+}
+
+void ChainCacheTestingSetup::Follow(CChainFollowingCache *pCache)
+{
+    pCache->Clear();
+    RegisterValidationInterface(pCache);
+    followingCaches.push_back(pCache);
+}
+
+CBlock ChainCacheTestingSetup::ConnectBlock(const std::vector<CMutableTransaction> &txs)
+{
+    LOCK(cs_main);
+    CBlockIndex *pprev = chainActive.LastTip();
+    int32_t height = pprev->GetHeight() + 1;
+
+    CMutableTransaction coinbase;
+    coinbase.vin.resize(1);
+    coinbase.vin[0].prevout.SetNull();
+    coinbase.vin[0].scriptSig = CScript() << height << OP_0;
+    coinbase.vout.push_back(CTxOut(0, CScript() << OP_TRUE));
+
+    connectedBlocks.push_back(CTestConnectedBlock());
+    CTestConnectedBlock &connected = connectedBlocks.back();
+    CBlock &block = connected.block;
+    block.hashPrevBlock = pprev->GetBlockHash();
+    block.nTime = pprev->nTime + 60;
+    block.nBits = pprev->nBits;
+    block.vtx.push_back(coinbase);
+    for (auto &tx : txs)
+    {
+        block.vtx.push_back(tx);
+    }
+    block.hashMerkleRoot = block.BuildMerkleTree();
+
+    CDiskBlockPos blockPos = nextBlockPos;
+    BOOST_REQUIRE(WriteBlockToDisk(block, blockPos, Params().MessageStart()));
+    nextBlockPos.nPos = blockPos.nPos + ::GetSerializeSize(block, SER_DISK, CLIENT_VERSION);
+
+    CBlockIndex *pindex = new CBlockIndex(block);
+    pindex->phashBlock = &mapBlockIndex.insert(std::make_pair(block.GetHash(), pindex)).first->first;
+    pindex->pprev = pprev;
+    pindex->SetHeight(height);
+    pindex->nFile = blockPos.nFile;
+    pindex->nDataPos = blockPos.nPos;
+    pindex->nStatus |= BLOCK_HAVE_DATA;
+
+    std::vector<std::pair<uint256, CDiskTxPos>> txIndex;
+    std::vector<CAddressUnspentDbEntry> unspentIndex;
+    CDiskTxPos txPos(blockPos, GetSizeOfCompactSize(block.vtx.size()));
+    for (int i = 0; i < block.vtx.size(); i++)
+    {
+        const CTransaction &tx = block.vtx[i];
+        const uint256 txHash = tx.GetHash();
+        txIndex.push_back(std::make_pair(txHash, txPos));
+        txPos.nTxOffset += ::GetSerializeSize(tx, SER_DISK, CLIENT_VERSION);
+
+        for (int j = 0; !tx.IsCoinBase() && j < tx.vin.size(); j++)
+        {
+            const COutPoint &prevout = tx.vin[j].prevout;
+            const CCoins *pCoins = pcoinsTip->AccessCoins(prevout.hash);
+            BOOST_REQUIRE(pCoins && pCoins->IsAvailable(prevout.n));
+            const CTxOut &spentOut = pCoins->vout[prevout.n];
+            connected.spentOutputs.push_back(CTestSpentOutput(prevout, spentOut, pCoins->nHeight));
+            for (auto &entry : OutputIndexEntries(spentOut, height))
+            {
+                connected.addressIndex.push_back(std::make_pair(
+                    CAddressIndexKey(std::get<0>(entry), std::get<1>(entry), std::get<2>(entry), i, txHash, j, true),
+                    -spentOut.nValue));
+                unspentIndex.push_back(std::make_pair(
+                    CAddressUnspentKey(std::get<0>(entry), std::get<1>(entry), prevout.hash, prevout.n),
+                    CAddressUnspentValue()));
+            }
+        }
+        for (int k = 0; k < tx.vout.size(); k++)
+        {
+            const CTxOut &out = tx.vout[k];
+            for (auto &entry : OutputIndexEntries(out, height))
+            {
+                connected.addressIndex.push_back(std::make_pair(
+                    CAddressIndexKey(std::get<0>(entry), std::get<1>(entry), std::get<2>(entry), i, txHash, k, false),
+                    out.nValue));
+                unspentIndex.push_back(std::make_pair(
+                    CAddressUnspentKey(std::get<0>(entry), std::get<1>(entry), txHash, k),
+                    CAddressUnspentValue(out.nValue, out.scriptPubKey, std::get<2>(entry))));
+            }
+        }
+        UpdateCoins(tx, *pcoinsTip, height);
+    }
+    BOOST_REQUIRE(pblocktree->WriteTxIndex(txIndex));
+    BOOST_REQUIRE(pblocktree->WriteAddressIndex(connected.addressIndex));
+    BOOST_REQUIRE(pblocktree->UpdateAddressUnspentIndex(unspentIndex));
+
+    chainActive.SetTip(pindex);
+    for (auto &tx : block.vtx)
+    {
+        SyncWithWallets(tx, &block);
+    }
+    GetMainSignals().ChainTip(pindex, &block, SproutMerkleTree(), SaplingMerkleTree(), true);
+    return block;
+}
+
+void ChainCacheTestingSetup::DisconnectBlock()
+{
+    LOCK(cs_main);
+    CTestConnectedBlock connected = connectedBlocks.back();
+    connectedBlocks.pop_back();
+    CBlock &block = connected.block;
+    CBlockIndex *pindex = chainActive.LastTip();
+    BOOST_REQUIRE(pindex->GetBlockHash() == block.GetHash());
+
+    std::vector<CAddressUnspentDbEntry> unspentIndex;
+    for (auto &tx : block.vtx)
+    {
+        pcoinsTip->ModifyCoins(tx.GetHash())->Clear();
+        for (int k = 0; k < tx.vout.size(); k++)
+        {
+            for (auto &entry : OutputIndexEntries(tx.vout[k], pindex->GetHeight()))
+            {
+                unspentIndex.push_back(std::make_pair(
+                    CAddressUnspentKey(std::get<0>(entry), std::get<1>(entry), tx.GetHash(), k),
+                    CAddressUnspentValue()));
+            }
+        }
+    }
+    for (auto &spent : connected.spentOutputs)
+    {
+        CCoinsModifier coins = pcoinsTip->ModifyCoins(spent.prevout.hash);
+        if (coins->vout.size() <= spent.prevout.n)
+        {
+            coins->vout.resize(spent.prevout.n + 1);
+        }
+        coins->vout[spent.prevout.n] = spent.output;
+        coins->nHeight = spent.height;
+        for (auto &entry : OutputIndexEntries(spent.output, spent.height))
+        {
+            unspentIndex.push_back(std::make_pair(
+                CAddressUnspentKey(std::get<0>(entry), std::get<1>(entry), spent.prevout.hash, spent.prevout.n),
+                CAddressUnspentValue(spent.output.nValue, spent.output.scriptPubKey, std::get<2>(entry))));
+        }
+    }
+    BOOST_REQUIRE(pblocktree->EraseAddressIndex(connected.addressIndex));
+    BOOST_REQUIRE(pblocktree->UpdateAddressUnspentIndex(unspentIndex));
+
+    chainActive.SetTip(pindex->pprev);
+    for (auto &tx : block.vtx)
+    {
+        SyncWithWallets(tx, NULL);
+    }
+    GetMainSignals().ChainTip(pindex, &block, SproutMerkleTree(), SaplingMerkleTree(), false);
+
+    mapBlockIndex.erase(block.GetHash());
+    delete pindex;
+}
+
+CMutableTransaction ChainCacheTestingSetup::SpendingTx(const std::vector<COutPoint> &spent, const std::vector<CTxOut> &outputs) const
+{
+    CMutableTransaction mtx;
+    for (auto &prevout : spent)
+    {
+        mtx.vin.push_back(CTxIn(prevout));
+    }
+    mtx.vout = outputs;
+    return mtx;
+}
+
+CPBaaSNotarization ConverterNotarization(const uint160 &currencyID, const uint160 &reserveID, CAmount nativeReserve)
+{
+    CCurrencyState state(currencyID,
+                         {ASSETCHAINS_CHAINID, reserveID},
+                         {50000000, 50000000},
+                         {nativeReserve, 100000000},
+                         0, 0, 200000000,
+                         CCurrencyState::FLAG_FRACTIONAL | CCurrencyState::FLAG_LAUNCHCONFIRMED);
+    return CPBaaSNotarization(currencyID, CCoinbaseCurrencyState(state), chainActive.Height() + 1, CUTXORef(), 0);
+}
+
+CIdentity TestIdentity(const std::string &name,
+                       const CTxDestination &primary,
+                       const std::multimap<uint160, std::vector<unsigned char>> &content)
+{
+    CIdentity identity(CIdentity::VERSION_CURRENT, 0, {primary}, 1, ASSETCHAINS_CHAINID, name, {}, content, uint160(), uint160());
+    identity.revocationAuthority = identity.recoveryAuthority = identity.GetID();
+    return identity;
+}
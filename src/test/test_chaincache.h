@@ -0,0 +1,81 @@
+// Copyright (c) 2026 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#ifndef BITCOIN_TEST_TEST_CHAINCACHE_H
+#define BITCOIN_TEST_TEST_CHAINCACHE_H
+
+#include "cc/CCinclude.h"
+#include "main.h"
+#include "pbaas/chaincache.h"
+#include "pbaas/identity.h"
+#include "pbaas/notarization.h"
+#include "test/test_bitcoin.h"
+
+#include <vector>
+
+/*
+ * Testing setup for the chain following caches, which are checked against the index queries they stand in
+ * for. Blocks are connected and disconnected by hand, writing the tx, address and unspent index entries
+ * ConnectBlock writes and sending the signals ConnectTip and DisconnectTip send, in the same order, without
+ * validating the transactions in them.
+ */
+
+class CTestSpentOutput
+{
+public:
+    COutPoint prevout;
+    CTxOut output;
+    int32_t height;
+
+    CTestSpentOutput(const COutPoint &Prevout, const CTxOut &Output, int32_t Height) : prevout(Prevout), output(Output), height(Height) {}
+};
+
+class CTestConnectedBlock
+{
+public:
+    CBlock block;
+    std::vector<CAddressIndexDbEntry> addressIndex;
+    std::vector<CTestSpentOutput> spentOutputs;
+};
+
+struct ChainCacheTestingSetup : public TestingSetup
+{
+    bool fOldAddressIndex, fOldIdIndex, fOldTxIndex;
+    CKeyID testKeyID;
+    std::vector<CChainFollowingCache *> followingCaches;
+    std::vector<CTestConnectedBlock> connectedBlocks;
+    CDiskBlockPos nextBlockPos;
+
+    ChainCacheTestingSetup();
+    ~ChainCacheTestingSetup();
+
+    // clears the cache and has it follow the blocks connected and disconnected until the end of the test
+    void Follow(CChainFollowingCache *pCache);
+
+    // connects a block with a coinbase and txs on the tip and returns it
+    CBlock ConnectBlock(const std::vector<CMutableTransaction> &txs=std::vector<CMutableTransaction>());
+
+    // disconnects the last block connected, restoring the outputs it spent
+    void DisconnectBlock();
+
+    // an output with obj under evalCode, spendable by the test key and also indexed under indexDests
+    template <typename TOBJ>
+    CTxOut EvalOutput(uint8_t evalCode, const TOBJ &obj, CAmount value=0, const std::vector<CTxDestination> *indexDests=nullptr) const
+    {
+        return CTxOut(value, MakeMofNCCScript(CConditionObj<TOBJ>(evalCode, {CTxDestination(testKeyID)}, 1, &obj), indexDests));
+    }
+
+    CMutableTransaction SpendingTx(const std::vector<COutPoint> &spent, const std::vector<CTxOut> &outputs) const;
+};
+
+// a notarization of a fractional currency with native and reserveID reserves, which is indexed as
+// a converter of both while its native reserve is above the minimum
+CPBaaSNotarization ConverterNotarization(const uint160 &currencyID, const uint160 &reserveID, CAmount nativeReserve);
+
+// an identity controlled by primary, which is its own revocation and recovery authority
+CIdentity TestIdentity(const std::string &name,
+                       const CTxDestination &primary,
+                       const std::multimap<uint160, std::vector<unsigned char>> &content=std::multimap<uint160, std::vector<unsigned char>>());
+
+#endif // BITCOIN_TEST_TEST_CHAINCACHE_H
@@ -745,6 +745,66 @@ BOOST_AUTO_TEST_CASE(test_big_overwinter_transaction) {
     threadGroup.join_all();
 }
 
+BOOST_AUTO_TEST_CASE(test_signature_batch) {
+    uint32_t consensusBranchId = NetworkUpgradeInfo[Consensus::UPGRADE_SAPLING].nBranchId;
+    CMutableTransaction mtx;
+    mtx.fOverwintered = true;
+    mtx.nVersion = SAPLING_TX_VERSION;
+    mtx.nVersionGroupId = SAPLING_VERSION_GROUP_ID;
+
+    CKey key;
+    key.MakeNewKey(true);
+    CBasicKeyStore keystore;
+    keystore.AddKeyPubKey(key, key.GetPubKey());
+    CScript scriptPubKey = GetScriptForDestination(key.GetPubKey().GetID());
+
+    // enough inputs to span several verification chunks
+    uint32_t nInputs = CSignatureBatch::CHUNK_SIZE * 3 + 7;
+    for (uint32_t i = 0; i < nInputs; i++) {
+        uint256 prevId;
+        prevId.SetHex("0000000000000000000000000000000000000000000000000000000000000200");
+        mtx.vin.push_back(CTxIn(COutPoint(prevId, i), CScript()));
+        mtx.vout.push_back(CTxOut(1000, CScript() << OP_1));
+    }
+    for (uint32_t i = 0; i < nInputs; i++) {
+        BOOST_CHECK(SignSignature(keystore, scriptPubKey, mtx, i, 1000, SIGHASH_ALL, consensusBranchId));
+    }
+
+    CTransaction tx(mtx);
+    PrecomputedTransactionData txdata(tx);
+
+    CCoins coins;
+    coins.nVersion = 1;
+    coins.fCoinBase = false;
+    coins.vout.resize(nInputs, CTxOut(1000, scriptPubKey));
+
+    // scripts pass, and every signature is deferred to the batch
+    CSignatureBatch sigBatch;
+    for (uint32_t i = 0; i < nInputs; i++) {
+        CScriptCheck check(coins, tx, i, SCRIPT_VERIFY_P2SH, false, consensusBranchId, &txdata);
+        BOOST_CHECK(check.CanDeferSignature());
+        check.SetSignatureBatch(&sigBatch);
+        BOOST_CHECK(check());
+    }
+    BOOST_CHECK_EQUAL(sigBatch.Size(), nInputs);
+    BOOST_CHECK_EQUAL(sigBatch.NumChunks(), 4);
+    for (size_t i = 0; i < sigBatch.NumChunks(); i++) {
+        BOOST_CHECK(sigBatch.VerifyChunk(i));
+    }
+    BOOST_CHECK(sigBatch.FindInvalid().empty());
+
+    // a signature over the wrong hash fails its chunk and is reported on its own
+    std::vector<unsigned char> vchSig;
+    BOOST_CHECK(key.Sign(GetRandHash(), vchSig));
+    sigBatch.Add(key.GetPubKey(), GetRandHash(), vchSig, tx.GetHash(), nInputs, false);
+    BOOST_CHECK(sigBatch.VerifyChunk(0));
+    BOOST_CHECK(!sigBatch.VerifyChunk(sigBatch.NumChunks() - 1));
+    std::vector<CSignatureBatch::CEntry> invalid = sigBatch.FindInvalid();
+    BOOST_CHECK_EQUAL(invalid.size(), 1);
+    BOOST_CHECK(invalid[0].txid == tx.GetHash());
+    BOOST_CHECK_EQUAL(invalid[0].nIn, nInputs);
+}
+
 BOOST_AUTO_TEST_CASE(test_IsStandard)
 {
     LOCK(cs_main);
@@ -0,0 +1,137 @@
+// Copyright (c) 2026 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#include "pbaas/transferqueue.h"
+#include "test/test_chaincache.h"
+
+#include <boost/test/unit_test.hpp>
+
+/*
+ * The pending transfer queue checked against decoding the reserve transfer index.
+ */
+
+namespace
+{
+
+// a transfer of value from sourceID to destID, paid to keyID
+CReserveTransfer TestTransfer(const uint160 &sourceID, CAmount value, const uint160 &destID, const CKeyID &keyID)
+{
+    return CReserveTransfer(CReserveTransfer::VALID, sourceID, value, sourceID, 20000, destID,
+                            CTransferDestination(CTransferDestination::DEST_PKH, ::AsVector(keyID)));
+}
+
+bool SameTransfer(const ChainTransferData &left, const ChainTransferData &right)
+{
+    return std::get<0>(left) == std::get<0>(right) &&
+           std::get<1>(left).txIn.prevout == std::get<1>(right).txIn.prevout &&
+           std::get<1>(left).nValue == std::get<1>(right).nValue &&
+           std::get<1>(left).scriptPubKey == std::get<1>(right).scriptPubKey &&
+           ::AsVector(std::get<2>(left)) == ::AsVector(std::get<2>(right));
+}
+
+// checks the pending transfers from the queue, for all destinations and for each after afterHeight, against
+// decoding the reserve transfer index
+size_t CheckTransfers(uint32_t afterHeight=0)
+{
+    LOCK(cs_main);
+    std::vector<CAddressUnspentDbEntry> unspent;
+    BOOST_REQUIRE(GetAddressUnspent(CReserveTransfer::ReserveTransferKey(), CScript::P2IDX, unspent));
+    std::map<uint160, std::map<std::pair<uint32_t, COutPoint>, ChainTransferData>> indexed;
+    size_t indexedCount = 0;
+    for (auto &oneOutput : unspent)
+    {
+        uint160 destID;
+        ChainTransferData transfer;
+        COutPoint output(oneOutput.first.txhash, oneOutput.first.index);
+        BOOST_REQUIRE(CPendingTransferQueue::DecodeTransfer(CTxOut(oneOutput.second.satoshis, oneOutput.second.script),
+                                                            output,
+                                                            oneOutput.second.blockHeight,
+                                                            destID,
+                                                            transfer));
+        indexed[destID][std::make_pair((uint32_t)oneOutput.second.blockHeight, output)] = transfer;
+        indexedCount++;
+    }
+
+    std::multimap<uint160, ChainTransferData> allTransfers;
+    BOOST_REQUIRE(PendingTransfers.GetAllTransfers(allTransfers));
+    BOOST_REQUIRE_EQUAL(allTransfers.size(), indexedCount);
+    auto allIt = allTransfers.begin();
+    for (auto &oneDest : indexed)
+    {
+        std::vector<ChainTransferData> destTransfers;
+        BOOST_REQUIRE(PendingTransfers.GetTransfers(oneDest.first, destTransfers, afterHeight));
+        auto destIt = destTransfers.begin();
+        for (auto &oneTransfer : oneDest.second)
+        {
+            BOOST_CHECK(allIt->first == oneDest.first);
+            BOOST_CHECK(SameTransfer(allIt->second, oneTransfer.second));
+            allIt++;
+            if (oneTransfer.first.first > afterHeight)
+            {
+                BOOST_REQUIRE(destIt != destTransfers.end());
+                BOOST_CHECK(SameTransfer(*destIt, oneTransfer.second));
+                destIt++;
+            }
+        }
+        BOOST_CHECK(destIt == destTransfers.end());
+    }
+    return indexedCount;
+}
+
+}
+
+BOOST_FIXTURE_TEST_SUITE(transferqueue_tests, ChainCacheTestingSetup)
+
+BOOST_AUTO_TEST_CASE(transfer_queue_follows_reserve_transfer_index)
+{
+    Follow(&PendingTransfers);
+    uint160 sourceID = CCrossChainRPCData::GetID("chaincachesource");
+    uint160 destAID = CCrossChainRPCData::GetID("chaincachedesta");
+    uint160 destBID = CCrossChainRPCData::GetID("chaincachedestb");
+
+    BOOST_CHECK_EQUAL(CheckTransfers(), 0);
+
+    CBlock block1 = ConnectBlock({SpendingTx({}, {EvalOutput(EVAL_RESERVE_TRANSFER, TestTransfer(sourceID, 100000, destAID, testKeyID), 120000),
+                                                  EvalOutput(EVAL_RESERVE_TRANSFER, TestTransfer(sourceID, 200000, destAID, testKeyID), 220000),
+                                                  EvalOutput(EVAL_RESERVE_TRANSFER, TestTransfer(sourceID, 300000, destBID, testKeyID), 320000)})});
+    BOOST_CHECK_EQUAL(CheckTransfers(), 3);
+
+    // an export takes one transfer to A, and another transfer to B is queued
+    CBlock block2 = ConnectBlock({SpendingTx({COutPoint(block1.vtx[1].GetHash(), 0)}, {CTxOut(0, GetScriptForDestination(testKeyID))}),
+                                  SpendingTx({}, {EvalOutput(EVAL_RESERVE_TRANSFER, TestTransfer(sourceID, 400000, destBID, testKeyID), 420000)})});
+    BOOST_CHECK_EQUAL(CheckTransfers(), 3);
+    BOOST_CHECK_EQUAL(CheckTransfers(1), 3);
+    {
+        LOCK(cs_main);
+        std::vector<ChainTransferData> transfers;
+        BOOST_REQUIRE(PendingTransfers.GetTransfers(destAID, transfers));
+        BOOST_REQUIRE_EQUAL(transfers.size(), 1);
+        BOOST_CHECK(std::get<1>(transfers[0]).txIn.prevout == COutPoint(block1.vtx[1].GetHash(), 1));
+
+        // the transfers to B are in height order, and only the one in this block is after the one before
+        transfers.clear();
+        BOOST_REQUIRE(PendingTransfers.GetTransfers(destBID, transfers));
+        BOOST_REQUIRE_EQUAL(transfers.size(), 2);
+        BOOST_CHECK(std::get<0>(transfers[0]) < std::get<0>(transfers[1]));
+        transfers.clear();
+        BOOST_REQUIRE(PendingTransfers.GetTransfers(destBID, transfers, chainActive.Height() - 1));
+        BOOST_REQUIRE_EQUAL(transfers.size(), 1);
+        BOOST_CHECK(std::get<1>(transfers[0]).txIn.prevout == COutPoint(block2.vtx[2].GetHash(), 0));
+    }
+
+    ConnectBlock({SpendingTx({COutPoint(block1.vtx[1].GetHash(), 1), COutPoint(block1.vtx[1].GetHash(), 2), COutPoint(block2.vtx[2].GetHash(), 0)},
+                             {CTxOut(0, GetScriptForDestination(testKeyID))})});
+    BOOST_CHECK_EQUAL(CheckTransfers(), 0);
+
+    DisconnectBlock();
+    BOOST_CHECK_EQUAL(CheckTransfers(1), 3);
+
+    DisconnectBlock();
+    BOOST_CHECK_EQUAL(CheckTransfers(), 3);
+
+    DisconnectBlock();
+    BOOST_CHECK_EQUAL(CheckTransfers(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
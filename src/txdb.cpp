@@ -12,8 +12,10 @@
 #include "uint256.h"
 #include "core_io.h"
 
+#include <atomic>
 #include <stdint.h>
 
+#include <boost/bind.hpp>
 #include <boost/thread.hpp>
 
 using namespace std;
@@ -22,6 +24,8 @@ using namespace std;
 // previously used by DB_SAPLING_ANCHOR and DB_BEST_SAPLING_ANCHOR.
 static const char DB_SPROUT_ANCHOR = 'A';
 static const char DB_SAPLING_ANCHOR = 'Z';
+static const char DB_SPROUT_ANCHOR_DELTA = 'v';
+static const char DB_SAPLING_ANCHOR_DELTA = 'V';
 static const char DB_NULLIFIER = 's';
 static const char DB_SAPLING_NULLIFIER = 'S';
 static const char DB_COINS = 'c';
@@ -37,20 +41,197 @@ static const char DB_BLOCK_INDEX = 'b';
 static const char DB_BEST_BLOCK = 'B';
 static const char DB_BEST_SPROUT_ANCHOR = 'a';
 static const char DB_BEST_SAPLING_ANCHOR = 'z';
+static const char DB_CHAINSTATE_VERSION = 'W';
 static const char DB_FLAG = 'F';
 static const char DB_REINDEX_FLAG = 'R';
 static const char DB_LAST_BLOCK = 'l';
 
+//! Number of block index entries a loading thread collects before adding them to the block index
+static const size_t BLOCK_INDEX_LOAD_BATCH = 1024;
+
 // Zcash defines are slightly different - commenting rather than removing
 // in case there is ever a related error
 //static const char DB_TIMESTAMPINDEX = 'T';
 //static const char DB_BLOCKHASHINDEX = 'h';
 
-CCoinsViewDB::CCoinsViewDB(std::string dbName, size_t nCacheSize, bool fMemory, bool fWipe) : db(GetDataDir() / dbName, nCacheSize, fMemory, fWipe) {
+CCoinsViewDB::CCoinsViewDB(std::string dbName, size_t nCacheSize, bool fMemory, bool fWipe) : db(GetDataDir() / dbName, nCacheSize, fMemory, fWipe),
+    sproutAnchorCache(ANCHOR_CACHE_SIZE, 0.1, true), saplingAnchorCache(ANCHOR_CACHE_SIZE, 0.1, true) {
+}
+
+CCoinsViewDB::CCoinsViewDB(size_t nCacheSize, bool fMemory, bool fWipe) : db(GetDataDir() / "chainstate", nCacheSize, fMemory, fWipe),
+    sproutAnchorCache(ANCHOR_CACHE_SIZE, 0.1, true), saplingAnchorCache(ANCHOR_CACHE_SIZE, 0.1, true)
+{
 }
 
-CCoinsViewDB::CCoinsViewDB(size_t nCacheSize, bool fMemory, bool fWipe) : db(GetDataDir() / "chainstate", nCacheSize, fMemory, fWipe) 
+/**
+ * Nodes of a commitment tree frontier, serialized exactly like the tree: left, right and the
+ * parents. Node i is left, right or parent i - 2.
+ */
+class CAnchorFrontier
+{
+public:
+    boost::optional<uint256> left;
+    boost::optional<uint256> right;
+    std::vector<boost::optional<uint256>> parents;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(left);
+        READWRITE(right);
+        READWRITE(parents);
+    }
+
+    template <typename Tree>
+    explicit CAnchorFrontier(const Tree &tree)
+    {
+        CDataStream ss(SER_DISK, CLIENT_VERSION);
+        ss << tree;
+        ss >> *this;
+    }
+
+    template <typename Tree>
+    Tree GetTree() const
+    {
+        CDataStream ss(SER_DISK, CLIENT_VERSION);
+        ss << *this;
+        Tree tree;
+        ss >> tree;
+        return tree;
+    }
+
+    size_t NumNodes() const { return parents.size() + 2; }
+
+    boost::optional<uint256> Node(size_t i) const
+    {
+        if (i == 0)
+            return left;
+        if (i == 1)
+            return right;
+        return i - 2 < parents.size() ? parents[i - 2] : boost::none;
+    }
+
+    void SetNode(size_t i, const boost::optional<uint256> &node)
+    {
+        if (i == 0)
+            left = node;
+        else if (i == 1)
+            right = node;
+        else
+            parents.at(i - 2) = node;
+    }
+};
+
+/**
+ * What is stored under an anchor: the frontier nodes that differ from the tree of the base anchor,
+ * or all of them when there is no base. Appending commitments mostly changes the lowest nodes, so
+ * consecutive anchors share most of the tree. Erased anchors are kept, flagged, as long as others
+ * may be based on them.
+ */
+class CAnchorDelta
+{
+public:
+    uint256 baseRoot;
+    uint32_t nDepth;
+    bool fErased;
+    uint32_t nNodes;
+    std::vector<std::pair<uint32_t, boost::optional<uint256>>> changed;
+
+    CAnchorDelta() : nDepth(0), fErased(false), nNodes(2) {}
+
+    CAnchorDelta(const uint256 &baseRootIn, const CAnchorFrontier &base, const CAnchorFrontier &frontier, uint32_t nDepthIn) :
+        baseRoot(baseRootIn), nDepth(nDepthIn), fErased(false), nNodes(frontier.NumNodes())
+    {
+        for (uint32_t i = 0; i < nNodes; i++)
+        {
+            boost::optional<uint256> node = frontier.Node(i);
+            if (node != base.Node(i))
+                changed.push_back(std::make_pair(i, node));
+        }
+    }
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(baseRoot);
+        READWRITE(VARINT(nDepth));
+        READWRITE(fErased);
+        READWRITE(VARINT(nNodes));
+        READWRITE(changed);
+    }
+
+    void Apply(CAnchorFrontier &frontier) const
+    {
+        if (nNodes < 2)
+            throw std::runtime_error("Invalid anchor delta");
+        frontier.parents.resize(nNodes - 2);
+        for (auto &node : changed)
+        {
+            if (node.first >= nNodes)
+                throw std::runtime_error("Invalid anchor delta");
+            frontier.SetNode(node.first, node.second);
+        }
+    }
+};
+
+template <typename Tree>
+bool CCoinsViewDB::ReadAnchor(const uint256 &rt, CAnchorTreeEntry<Tree> &entry, char dbChar, char legacyChar,
+                              LRUCache<uint256, CAnchorTreeEntry<Tree>> &cache) const
 {
+    if (cache.Get(rt, entry))
+        return true;
+
+    // walk back to a tree we have, in memory, stored in full or in the old format
+    std::vector<CAnchorDelta> chain;
+    CAnchorFrontier frontier((Tree()));
+    uint256 root = rt;
+    while (true)
+    {
+        CAnchorTreeEntry<Tree> baseEntry;
+        if (root == Tree::empty_root())
+        {
+            break;
+        }
+        if (root != rt && cache.Get(root, baseEntry))
+        {
+            frontier = CAnchorFrontier(baseEntry.tree);
+            break;
+        }
+        CAnchorDelta delta;
+        if (db.Read(make_pair(dbChar, root), delta))
+        {
+            chain.push_back(delta);
+            if (delta.baseRoot.IsNull())
+                break;
+            if (chain.size() > ANCHOR_CHECKPOINT_INTERVAL)
+                return error("%s: anchor %s is too far from a full tree", __func__, rt.GetHex());
+            root = delta.baseRoot;
+            continue;
+        }
+        Tree tree;
+        if (!db.Read(make_pair(legacyChar, root), tree))
+        {
+            if (!chain.empty())
+                return error("%s: base %s of anchor %s is missing", __func__, root.GetHex(), rt.GetHex());
+            return false;
+        }
+        if (chain.empty())
+        {
+            entry = CAnchorTreeEntry<Tree>(tree, 0, false);
+            cache.Put(rt, entry);
+            return true;
+        }
+        frontier = CAnchorFrontier(tree);
+        break;
+    }
+
+    for (auto it = chain.rbegin(); it != chain.rend(); it++)
+        it->Apply(frontier);
+    entry = CAnchorTreeEntry<Tree>(frontier.GetTree<Tree>(), chain.front().nDepth, chain.front().fErased);
+    cache.Put(rt, entry);
+    return true;
 }
 
 
@@ -61,9 +242,11 @@ bool CCoinsViewDB::GetSproutAnchorAt(const uint256 &rt, SproutMerkleTree &tree)
         return true;
     }
 
-    bool read = db.Read(make_pair(DB_SPROUT_ANCHOR, rt), tree);
-
-    return read;
+    CAnchorTreeEntry<SproutMerkleTree> entry;
+    if (!ReadAnchor(rt, entry, DB_SPROUT_ANCHOR_DELTA, DB_SPROUT_ANCHOR, sproutAnchorCache) || entry.fErased)
+        return false;
+    tree = entry.tree;
+    return true;
 }
 
 bool CCoinsViewDB::GetSaplingAnchorAt(const uint256 &rt, SaplingMerkleTree &tree) const {
@@ -73,9 +256,11 @@ bool CCoinsViewDB::GetSaplingAnchorAt(const uint256 &rt, SaplingMerkleTree &tree
         return true;
     }
 
-    bool read = db.Read(make_pair(DB_SAPLING_ANCHOR, rt), tree);
-
-    return read;
+    CAnchorTreeEntry<SaplingMerkleTree> entry;
+    if (!ReadAnchor(rt, entry, DB_SAPLING_ANCHOR_DELTA, DB_SAPLING_ANCHOR, saplingAnchorCache) || entry.fErased)
+        return false;
+    tree = entry.tree;
+    return true;
 }
 
 bool CCoinsViewDB::GetNullifier(const uint256 &nf, ShieldedType type) const {
@@ -109,6 +294,19 @@ uint256 CCoinsViewDB::GetBestBlock() const {
     return hashBestChain;
 }
 
+bool CCoinsViewDB::CheckVersion() const {
+    CChainstateVersion version;
+    if (!db.Read(DB_CHAINSTATE_VERSION, version))
+        return true; // written before anchors were stored as deltas, which is still readable
+    if (version.nVersion > CHAINSTATE_VERSION)
+        return error("%s: coin database version %d is newer than the supported version %d", __func__, version.nVersion, CHAINSTATE_VERSION);
+    // a release that stores anchors only as full trees does not update the version record, and
+    // would have left delta records behind that no longer match the chain state
+    if (version.hashBlock != GetBestBlock())
+        return error("%s: coin database was written by an older version after block %s", __func__, version.hashBlock.GetHex());
+    return true;
+}
+
 uint256 CCoinsViewDB::GetBestAnchor(ShieldedType type) const {
     uint256 hashBestAnchor;
     
@@ -128,9 +326,9 @@ uint256 CCoinsViewDB::GetBestAnchor(ShieldedType type) const {
     return hashBestAnchor;
 }
 
-void BatchWriteNullifiers(CDBBatch& batch, CNullifiersMap& mapToUse, const char& dbChar)
+void BatchWriteNullifiers(CDBBatch& batch, const CNullifiersMap& mapToUse, const char& dbChar)
 {
-    for (CNullifiersMap::iterator it = mapToUse.begin(); it != mapToUse.end();) {
+    for (CNullifiersMap::const_iterator it = mapToUse.begin(); it != mapToUse.end(); it++) {
         if (it->second.flags & CNullifiersCacheEntry::DIRTY) {
             if (!it->second.entered)
                 batch.Erase(make_pair(dbChar, it->first));
@@ -138,42 +336,108 @@ void BatchWriteNullifiers(CDBBatch& batch, CNullifiersMap& mapToUse, const char&
                 batch.Write(make_pair(dbChar, it->first), true);
             // TODO: changed++? ... See comment in CCoinsViewDB::BatchWrite. If this is needed we could return an int
         }
-        CNullifiersMap::iterator itOld = it++;
-        mapToUse.erase(itOld);
     }
 }
 
-template<typename Map, typename MapIterator, typename MapEntry, typename Tree>
-void BatchWriteAnchors(CDBBatch& batch, Map& mapToUse, const char& dbChar)
+template <typename Tree, typename Map>
+void CCoinsViewDB::BatchWriteAnchors(CDBBatch &batch, const Map &mapToUse, char dbChar, char legacyChar, char bestChar,
+                                     LRUCache<uint256, CAnchorTreeEntry<Tree>> &cache,
+                                     std::vector<std::pair<uint256, CAnchorTreeEntry<Tree>>> &vWritten)
 {
-    for (MapIterator it = mapToUse.begin(); it != mapToUse.end();) {
-        if (it->second.flags & MapEntry::DIRTY) {
-            if (!it->second.entered)
-                batch.Erase(make_pair(dbChar, it->first));
-            else {
-                if (it->first != Tree::empty_root()) {
-                    batch.Write(make_pair(dbChar, it->first), it->second.tree);
-                }
+    std::vector<std::pair<size_t, typename Map::const_iterator>> vEntered;
+    for (auto it = mapToUse.begin(); it != mapToUse.end(); it++) {
+        if (!(it->second.flags & Map::mapped_type::DIRTY) || it->first == Tree::empty_root())
+            continue;
+        if (it->second.entered)
+        {
+            vEntered.push_back(std::make_pair(it->second.tree.size(), it));
+            continue;
+        }
+        // Erased anchors may be the base of others, so they are only flagged. Which deltas are
+        // stored against an anchor is not tracked, and a flagged record only costs its changed
+        // nodes, which are reused if a reorg enters the anchor again.
+        CAnchorDelta delta;
+        CAnchorTreeEntry<Tree> entry;
+        if (db.Read(make_pair(dbChar, it->first), delta))
+        {
+            delta.fErased = true;
+            batch.Write(make_pair(dbChar, it->first), delta);
+        }
+        else if (ReadAnchor(it->first, entry, dbChar, legacyChar, cache))
+        {
+            CAnchorFrontier empty((Tree()));
+            delta = CAnchorDelta(uint256(), empty, CAnchorFrontier(entry.tree), 0);
+            delta.fErased = true;
+            batch.Write(make_pair(dbChar, it->first), delta);
+            batch.Erase(make_pair(legacyChar, it->first));
+        }
+        else
+        {
+            continue;
+        }
+        if (cache.Get(it->first, entry))
+        {
+            entry.fErased = true;
+            vWritten.push_back(std::make_pair(it->first, entry));
+        }
+    }
+
+    // store each new tree against the next smaller one, starting from the best anchor in the database
+    std::sort(vEntered.begin(), vEntered.end(),
+        [](const std::pair<size_t, typename Map::const_iterator> &a, const std::pair<size_t, typename Map::const_iterator> &b) {
+            return a.first < b.first;
+        });
+    uint256 baseRoot;
+    CAnchorTreeEntry<Tree> baseEntry;
+    if (!db.Read(bestChar, baseRoot) || baseRoot == Tree::empty_root() || !ReadAnchor(baseRoot, baseEntry, dbChar, legacyChar, cache))
+    {
+        baseRoot = Tree::empty_root();
+        baseEntry = CAnchorTreeEntry<Tree>();
+    }
+    for (auto &entered : vEntered)
+    {
+        const uint256 &rt = entered.second->first;
+        const Tree &tree = entered.second->second.tree;
+        CAnchorDelta delta;
+        CAnchorTreeEntry<Tree> written(tree, 0, false);
+        if (db.Read(make_pair(dbChar, rt), delta))
+        {
+            // entered again after being erased, other anchors may be stored against this record
+            if (delta.fErased)
+            {
+                delta.fErased = false;
+                batch.Write(make_pair(dbChar, rt), delta);
             }
-            // TODO: changed++?
+            written.nDepth = delta.nDepth;
         }
-        MapIterator itOld = it++;
-        mapToUse.erase(itOld);
+        else if (!db.Exists(make_pair(legacyChar, rt)))
+        {
+            CAnchorFrontier frontier(tree);
+            if (baseEntry.nDepth + 1 >= ANCHOR_CHECKPOINT_INTERVAL)
+                delta = CAnchorDelta(uint256(), CAnchorFrontier((Tree())), frontier, 0);
+            else
+                delta = CAnchorDelta(baseRoot, CAnchorFrontier(baseEntry.tree), frontier, baseEntry.nDepth + 1);
+            batch.Write(make_pair(dbChar, rt), delta);
+            written.nDepth = delta.nDepth;
+        }
+        vWritten.push_back(std::make_pair(rt, written));
+        baseRoot = rt;
+        baseEntry = written;
     }
 }
 
-bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins,
-                              const uint256 &hashBlock,
-                              const uint256 &hashSproutAnchor,
-                              const uint256 &hashSaplingAnchor,
-                              CAnchorsSproutMap &mapSproutAnchors,
-                              CAnchorsSaplingMap &mapSaplingAnchors,
-                              CNullifiersMap &mapSproutNullifiers,
-                              CNullifiersMap &mapSaplingNullifiers) {
+bool CCoinsViewDB::WriteCoinsBatch(const CCoinsMap &mapCoins,
+                                   const uint256 &hashBlock,
+                                   const uint256 &hashSproutAnchor,
+                                   const uint256 &hashSaplingAnchor,
+                                   const CAnchorsSproutMap &mapSproutAnchors,
+                                   const CAnchorsSaplingMap &mapSaplingAnchors,
+                                   const CNullifiersMap &mapSproutNullifiers,
+                                   const CNullifiersMap &mapSaplingNullifiers) {
     CDBBatch batch(db);
     size_t count = 0;
     size_t changed = 0;
-    for (CCoinsMap::iterator it = mapCoins.begin(); it != mapCoins.end();) {
+    for (CCoinsMap::const_iterator it = mapCoins.begin(); it != mapCoins.end(); it++) {
         if (it->second.flags & CCoinsCacheEntry::DIRTY) {
             if (it->second.coins.IsPruned())
                 batch.Erase(make_pair(DB_COINS, it->first));
@@ -182,25 +446,303 @@ bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins,
             changed++;
         }
         count++;
-        CCoinsMap::iterator itOld = it++;
-        mapCoins.erase(itOld);
     }
 
-    ::BatchWriteAnchors<CAnchorsSproutMap, CAnchorsSproutMap::iterator, CAnchorsSproutCacheEntry, SproutMerkleTree>(batch, mapSproutAnchors, DB_SPROUT_ANCHOR);
-    ::BatchWriteAnchors<CAnchorsSaplingMap, CAnchorsSaplingMap::iterator, CAnchorsSaplingCacheEntry, SaplingMerkleTree>(batch, mapSaplingAnchors, DB_SAPLING_ANCHOR);
+    std::vector<std::pair<uint256, CAnchorTreeEntry<SproutMerkleTree>>> vSproutWritten;
+    std::vector<std::pair<uint256, CAnchorTreeEntry<SaplingMerkleTree>>> vSaplingWritten;
+    BatchWriteAnchors(batch, mapSproutAnchors, DB_SPROUT_ANCHOR_DELTA, DB_SPROUT_ANCHOR, DB_BEST_SPROUT_ANCHOR, sproutAnchorCache, vSproutWritten);
+    BatchWriteAnchors(batch, mapSaplingAnchors, DB_SAPLING_ANCHOR_DELTA, DB_SAPLING_ANCHOR, DB_BEST_SAPLING_ANCHOR, saplingAnchorCache, vSaplingWritten);
 
     ::BatchWriteNullifiers(batch, mapSproutNullifiers, DB_NULLIFIER);
     ::BatchWriteNullifiers(batch, mapSaplingNullifiers, DB_SAPLING_NULLIFIER);
 
-    if (!hashBlock.IsNull())
+    if (!hashBlock.IsNull()) {
         batch.Write(DB_BEST_BLOCK, hashBlock);
+        batch.Write(DB_CHAINSTATE_VERSION, CChainstateVersion(CHAINSTATE_VERSION, hashBlock));
+    }
     if (!hashSproutAnchor.IsNull())
         batch.Write(DB_BEST_SPROUT_ANCHOR, hashSproutAnchor);
     if (!hashSaplingAnchor.IsNull())
         batch.Write(DB_BEST_SAPLING_ANCHOR, hashSaplingAnchor);
 
     LogPrint("coindb", "Committing %u changed transactions (out of %u) to coin database...\n", (unsigned int)changed, (unsigned int)count);
-    return db.WriteBatch(batch);
+    if (!db.WriteBatch(batch))
+        return false;
+
+    for (auto &written : vSproutWritten)
+        sproutAnchorCache.Put(written.first, written.second);
+    for (auto &written : vSaplingWritten)
+        saplingAnchorCache.Put(written.first, written.second);
+    return true;
+}
+
+bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins,
+                              const uint256 &hashBlock,
+                              const uint256 &hashSproutAnchor,
+                              const uint256 &hashSaplingAnchor,
+                              CAnchorsSproutMap &mapSproutAnchors,
+                              CAnchorsSaplingMap &mapSaplingAnchors,
+                              CNullifiersMap &mapSproutNullifiers,
+                              CNullifiersMap &mapSaplingNullifiers) {
+    bool fOk = WriteCoinsBatch(mapCoins, hashBlock, hashSproutAnchor, hashSaplingAnchor,
+                               mapSproutAnchors, mapSaplingAnchors, mapSproutNullifiers, mapSaplingNullifiers);
+    mapCoins.clear();
+    mapSproutAnchors.clear();
+    mapSaplingAnchors.clear();
+    mapSproutNullifiers.clear();
+    mapSaplingNullifiers.clear();
+    return fOk;
+}
+
+CCoinsViewWriteBehind::CCoinsViewWriteBehind(CCoinsView *baseIn, CCoinsViewDB *pdbIn) :
+    CCoinsViewBacked(baseIn), pdb(pdbIn), fPending(false), fFailed(false), fStop(false)
+{
+    writeThread = boost::thread(boost::bind(&CCoinsViewWriteBehind::ThreadWrite, this));
+}
+
+CCoinsViewWriteBehind::~CCoinsViewWriteBehind()
+{
+    {
+        boost::unique_lock<boost::mutex> lock(cs);
+        fStop = true;
+        condWrite.notify_all();
+    }
+    // a generation that was handed over is still written before the thread exits
+    writeThread.join();
+}
+
+void CCoinsViewWriteBehind::ThreadWrite()
+{
+    RenameThread("verus-coinsflush");
+    while (true)
+    {
+        {
+            boost::unique_lock<boost::mutex> lock(cs);
+            while (!fPending && !fStop)
+                condWrite.wait(lock);
+            if (!fPending)
+                return;
+        }
+
+        // nothing touches the pending maps until fPending is reset, other than reads
+        bool fOk = false;
+        int64_t nStart = GetTimeMicros();
+        for (int nTry = 0; !fOk && nTry < WRITE_TRIES; nTry++)
+        {
+            if (nTry)
+            {
+                LogPrintf("%s: retrying write to coin database\n", __func__);
+                MilliSleep(nTry * 1000);
+            }
+            try {
+                fOk = pdb->WriteCoinsBatch(*pCoins, hashBlock, hashSproutAnchor, hashSaplingAnchor,
+                                           mapSproutAnchors, mapSaplingAnchors, mapSproutNullifiers, mapSaplingNullifiers);
+            } catch (const std::exception& e) {
+                LogPrintf("%s: %s\n", __func__, e.what());
+            }
+        }
+        LogPrint("bench", "    - Background coins write: %.2fms\n", (GetTimeMicros() - nStart) * 0.001);
+
+        boost::unique_lock<boost::mutex> lock(cs);
+        fPending = false;
+        condWrite.notify_all();
+        if (!fOk)
+        {
+            // the generation is the only copy of these changes, so it stays readable over the stale database
+            // and no more flushes are accepted, which makes the next flush abort the node
+            LogPrintf("%s: failed to write to coin database\n", __func__);
+            fFailed = true;
+            continue;
+        }
+        // the map has to be gone before the pool its nodes came from
+        pCoins.reset();
+        pCoinsMemoryResource.reset();
+        mapSproutAnchors.clear();
+        mapSaplingAnchors.clear();
+        mapSproutNullifiers.clear();
+        mapSaplingNullifiers.clear();
+        hashBlock.SetNull();
+        hashSproutAnchor.SetNull();
+        hashSaplingAnchor.SetNull();
+    }
+}
+
+void CCoinsViewWriteBehind::WaitForWrite(boost::unique_lock<boost::mutex> &lock) const
+{
+    while (fPending)
+        condWrite.wait(lock);
+}
+
+bool CCoinsViewWriteBehind::Sync()
+{
+    boost::unique_lock<boost::mutex> lock(cs);
+    WaitForWrite(lock);
+    return !fFailed;
+}
+
+bool CCoinsViewWriteBehind::GetSproutAnchorAt(const uint256 &rt, SproutMerkleTree &tree) const
+{
+    {
+        boost::unique_lock<boost::mutex> lock(cs);
+        CAnchorsSproutMap::const_iterator it = mapSproutAnchors.find(rt);
+        if (it != mapSproutAnchors.end())
+        {
+            if (!it->second.entered)
+                return false;
+            tree = it->second.tree;
+            return true;
+        }
+    }
+    return base->GetSproutAnchorAt(rt, tree);
+}
+
+bool CCoinsViewWriteBehind::GetSaplingAnchorAt(const uint256 &rt, SaplingMerkleTree &tree) const
+{
+    {
+        boost::unique_lock<boost::mutex> lock(cs);
+        CAnchorsSaplingMap::const_iterator it = mapSaplingAnchors.find(rt);
+        if (it != mapSaplingAnchors.end())
+        {
+            if (!it->second.entered)
+                return false;
+            tree = it->second.tree;
+            return true;
+        }
+    }
+    return base->GetSaplingAnchorAt(rt, tree);
+}
+
+bool CCoinsViewWriteBehind::GetNullifier(const uint256 &nf, ShieldedType type) const
+{
+    {
+        boost::unique_lock<boost::mutex> lock(cs);
+        const CNullifiersMap *pNullifiers;
+        switch (type) {
+            case SPROUT:
+                pNullifiers = &mapSproutNullifiers;
+                break;
+            case SAPLING:
+                pNullifiers = &mapSaplingNullifiers;
+                break;
+            default:
+                throw runtime_error("Unknown shielded type");
+        }
+        CNullifiersMap::const_iterator it = pNullifiers->find(nf);
+        if (it != pNullifiers->end())
+            return it->second.entered;
+    }
+    return base->GetNullifier(nf, type);
+}
+
+bool CCoinsViewWriteBehind::GetCoins(const uint256 &txid, CCoins &coins) const
+{
+    {
+        boost::unique_lock<boost::mutex> lock(cs);
+        if (pCoins)
+        {
+            CCoinsMap::const_iterator it = pCoins->find(txid);
+            if (it != pCoins->end())
+            {
+                if (it->second.coins.IsPruned())
+                    return false;
+                coins = it->second.coins;
+                return true;
+            }
+        }
+    }
+    return base->GetCoins(txid, coins);
+}
+
+bool CCoinsViewWriteBehind::HaveCoins(const uint256 &txid) const
+{
+    {
+        boost::unique_lock<boost::mutex> lock(cs);
+        if (pCoins)
+        {
+            CCoinsMap::const_iterator it = pCoins->find(txid);
+            if (it != pCoins->end())
+                return !it->second.coins.IsPruned();
+        }
+    }
+    return base->HaveCoins(txid);
+}
+
+uint256 CCoinsViewWriteBehind::GetBestBlock() const
+{
+    {
+        boost::unique_lock<boost::mutex> lock(cs);
+        if (!hashBlock.IsNull())
+            return hashBlock;
+    }
+    return base->GetBestBlock();
+}
+
+uint256 CCoinsViewWriteBehind::GetBestAnchor(ShieldedType type) const
+{
+    {
+        boost::unique_lock<boost::mutex> lock(cs);
+        switch (type) {
+            case SPROUT:
+                if (!hashSproutAnchor.IsNull())
+                    return hashSproutAnchor;
+                break;
+            case SAPLING:
+                if (!hashSaplingAnchor.IsNull())
+                    return hashSaplingAnchor;
+                break;
+            default:
+                throw runtime_error("Unknown shielded type");
+        }
+    }
+    return base->GetBestAnchor(type);
+}
+
+bool CCoinsViewWriteBehind::BatchWrite(CCoinsMap &mapCoins,
+                                       const uint256 &hashBlockIn,
+                                       const uint256 &hashSproutAnchorIn,
+                                       const uint256 &hashSaplingAnchorIn,
+                                       CAnchorsSproutMap &mapSproutAnchorsIn,
+                                       CAnchorsSaplingMap &mapSaplingAnchorsIn,
+                                       CNullifiersMap &mapSproutNullifiersIn,
+                                       CNullifiersMap &mapSaplingNullifiersIn)
+{
+    boost::unique_lock<boost::mutex> lock(cs);
+    WaitForWrite(lock);
+    if (fFailed)
+        return false;
+
+    // the coins move into a map of our own, so the cache can release its pool right away
+    pCoinsMemoryResource.reset(new CCoinsMapMemoryResource());
+    pCoins.reset(new CCoinsMap(0, CCoinsKeyHasher(), std::equal_to<uint256>(), CCoinsMapAllocator(pCoinsMemoryResource.get())));
+    for (CCoinsMap::iterator it = mapCoins.begin(); it != mapCoins.end(); it++) {
+        if (it->second.flags & CCoinsCacheEntry::DIRTY) {
+            CCoinsCacheEntry &entry = (*pCoins)[it->first];
+            entry.coins.swap(it->second.coins);
+            entry.flags = it->second.flags;
+        }
+    }
+    mapCoins.clear();
+
+    mapSproutAnchors.swap(mapSproutAnchorsIn);
+    mapSaplingAnchors.swap(mapSaplingAnchorsIn);
+    mapSproutNullifiers.swap(mapSproutNullifiersIn);
+    mapSaplingNullifiers.swap(mapSaplingNullifiersIn);
+    hashBlock = hashBlockIn;
+    hashSproutAnchor = hashSproutAnchorIn;
+    hashSaplingAnchor = hashSaplingAnchorIn;
+
+    fPending = true;
+    condWrite.notify_all();
+    return true;
+}
+
+bool CCoinsViewWriteBehind::GetStats(CCoinsStats &stats) const
+{
+    {
+        boost::unique_lock<boost::mutex> lock(cs);
+        WaitForWrite(lock);
+    }
+    return base->GetStats(stats);
 }
 
 CBlockTreeDB::CBlockTreeDB(size_t nCacheSize, bool fMemory, bool fWipe, bool compression, int maxOpenFiles) : CDBWrapper(GetDataDir() / "blocks" / "index", nCacheSize, fMemory, fWipe, compression, maxOpenFiles) {
@@ -279,7 +821,11 @@ bool CBlockTreeDB::WriteBatchSync(const std::vector<std::pair<int, const CBlockF
     }
     batch.Write(DB_LAST_BLOCK, nLastFile);
     for (std::vector<const CBlockIndex*>::const_iterator it=blockinfo.begin(); it != blockinfo.end(); it++) {
-        batch.Write(make_pair(DB_BLOCK_INDEX, (*it)->GetBlockHash()), CDiskBlockIndex(*it));
+        // an index entry written again after its solution was dropped from memory keeps the stored one
+        std::vector<unsigned char> solution;
+        if (!(*it)->GetSolution(solution))
+            return error("%s: cannot write the index of block %s without its solution", __func__, (*it)->GetBlockHash().GetHex());
+        batch.Write(make_pair(DB_BLOCK_INDEX, (*it)->GetBlockHash()), CDiskBlockIndex(*it, solution));
     }
     return WriteBatch(batch, true);
 }
@@ -292,6 +838,10 @@ bool CBlockTreeDB::EraseBatchSync(const std::vector<const CBlockIndex*>& blockin
     return WriteBatch(batch, true);
 }
 
+bool CBlockTreeDB::ReadDiskBlockIndex(const uint256 &blockhash, CDiskBlockIndex &dbindex) {
+    return Read(make_pair(DB_BLOCK_INDEX, blockhash), dbindex);
+}
+
 bool CBlockTreeDB::ReadTxIndex(const uint256 &txid, CDiskTxPos &pos) {
     return Read(make_pair(DB_TXINDEX, txid), pos);
 }
@@ -642,77 +1192,126 @@ bool CBlockTreeDB::blockOnchainActive(const uint256 &hash) {
     return true;
 }
 
-bool CBlockTreeDB::LoadBlockIndexGuts(boost::function<CBlockIndex*(const uint256&)> insertBlockIndex)
+bool CBlockTreeDB::LoadBlockIndexGuts(boost::function<CBlockIndex*(const uint256&)> insertBlockIndex, int nThreads)
 {
-    boost::scoped_ptr<CDBIterator> pcursor(NewIterator());
+    // Each thread scans the entries whose block hash starts with a range of byte values, so
+    // deserializing and hashing the headers, which is most of the work, is done in parallel.
+    // Entries are handed to insertBlockIndex in batches, under a lock, as they are scanned.
+    nThreads = std::max(1, std::min(nThreads, 256));
+
+    boost::mutex csInsert;
+    std::atomic<bool> fStop(false);
+    std::string strError;
+    uint64_t nLoaded = 0;
+
+    auto fail = [&](const std::string &strFailure) {
+        boost::unique_lock<boost::mutex> lock(csInsert);
+        if (!fStop.exchange(true))
+            strError = strFailure;
+    };
+
+    auto insertBatch = [&](std::vector<std::pair<uint256, CDiskBlockIndex>> &batch) {
+        boost::unique_lock<boost::mutex> lock(csInsert);
+        for (auto &entry : batch)
+        {
+            const CDiskBlockIndex &diskindex = entry.second;
+            CBlockIndex* pindexNew    = insertBlockIndex(entry.first);
+            pindexNew->pprev          = insertBlockIndex(diskindex.hashPrev);
+            pindexNew->SetHeight(diskindex.GetHeight());
+            pindexNew->nFile          = diskindex.nFile;
+            pindexNew->nDataPos       = diskindex.nDataPos;
+            pindexNew->nUndoPos       = diskindex.nUndoPos;
+            pindexNew->hashSproutAnchor     = diskindex.hashSproutAnchor;
+            pindexNew->nVersion       = diskindex.nVersion;
+            pindexNew->hashMerkleRoot = diskindex.hashMerkleRoot;
+            pindexNew->hashFinalSaplingRoot   = diskindex.hashFinalSaplingRoot;
+            pindexNew->nTime          = diskindex.nTime;
+            pindexNew->nBits          = diskindex.nBits;
+            pindexNew->nNonce         = diskindex.nNonce;
+            // the solution stays in the database until it is needed
+            pindexNew->nSolutionVersion = diskindex.nSolutionVersion;
+            pindexNew->hashBlockMMRRoot = diskindex.hashBlockMMRRoot;
+            pindexNew->nStatus        = diskindex.nStatus;
+            pindexNew->nCachedBranchId = diskindex.nCachedBranchId;
+            pindexNew->nTx            = diskindex.nTx;
+            pindexNew->nSproutValue   = diskindex.nSproutValue;
+            pindexNew->nSaplingValue  = diskindex.nSaplingValue;
+        }
+        nLoaded += batch.size();
+        batch.clear();
+    };
 
-    pcursor->Seek(make_pair(DB_BLOCK_INDEX, uint256()));
+    auto scanRange = [&](int nBegin, int nEnd) {
+        boost::scoped_ptr<CDBIterator> pcursor(NewIterator());
+        uint256 hashStart;
+        *hashStart.begin() = nBegin;
+        pcursor->Seek(make_pair(DB_BLOCK_INDEX, hashStart));
+
+        std::vector<std::pair<uint256, CDiskBlockIndex>> batch;
+        batch.reserve(BLOCK_INDEX_LOAD_BATCH);
+
+        while (!fStop && pcursor->Valid()) {
+            std::pair<char, uint256> key;
+            if (!pcursor->GetKey(key) || key.first != DB_BLOCK_INDEX || *key.second.begin() >= nEnd)
+                break;
 
-    // Load mapBlockIndex
-    while (pcursor->Valid()) {
-        boost::this_thread::interruption_point();
-        std::pair<char, uint256> key;
-        if (pcursor->GetKey(key) && key.first == DB_BLOCK_INDEX) {
             CDiskBlockIndex diskindex;
-            if (pcursor->GetValue(diskindex)) {
-                // Construct block index object
+            if (!pcursor->GetValue(diskindex)) {
+                fail("LoadBlockIndex() : failed to read value");
+                return;
+            }
 #ifdef VERUSHASHDEBUG
-                if (diskindex.nVersion == CBlockHeader::VERUS_V2)
-                {
-                    printf("VerusHash 2.0 block header: %s\n", diskindex.ToString().c_str());
-                }
+            if (diskindex.nVersion == CBlockHeader::VERUS_V2)
+            {
+                printf("VerusHash 2.0 block header: %s\n", diskindex.ToString().c_str());
+            }
 #endif
-                CBlockIndex* pindexNew    = insertBlockIndex(diskindex.GetBlockHash());
-                pindexNew->pprev          = insertBlockIndex(diskindex.hashPrev);
-                pindexNew->SetHeight(diskindex.GetHeight());
-                pindexNew->nFile          = diskindex.nFile;
-                pindexNew->nDataPos       = diskindex.nDataPos;
-                pindexNew->nUndoPos       = diskindex.nUndoPos;
-                pindexNew->hashSproutAnchor     = diskindex.hashSproutAnchor;
-                pindexNew->nVersion       = diskindex.nVersion;
-                pindexNew->hashMerkleRoot = diskindex.hashMerkleRoot;
-                pindexNew->hashFinalSaplingRoot   = diskindex.hashFinalSaplingRoot;
-                pindexNew->nTime          = diskindex.nTime;
-                pindexNew->nBits          = diskindex.nBits;
-                pindexNew->nNonce         = diskindex.nNonce;
-                pindexNew->nSolution      = diskindex.nSolution;
-                pindexNew->nStatus        = diskindex.nStatus;
-                pindexNew->nCachedBranchId = diskindex.nCachedBranchId;
-                pindexNew->nTx            = diskindex.nTx;
-                pindexNew->nSproutValue   = diskindex.nSproutValue;
-                pindexNew->nSaplingValue  = diskindex.nSaplingValue;
-
-                // Consistency checks
-                auto header = pindexNew->GetBlockHeader();
-                uint256 hash = header.GetHash();
-                if (diskindex.hashPrev.IsNull() && hash != Params().consensus.hashGenesisBlock)
-                {
-                    return error("LoadBlockIndex(): prior block hash NULL on non-genesis block: %s\n", diskindex.ToString());
-                }
-
-                if (hash != pindexNew->GetBlockHash())
-                {
-                    printf("Error -- hashes don't match.\nheader.GetHash: %s\nGetBlockHash(): %s\non disk: %s\nin memory: %s\n",
-                           hash.GetHex().c_str(), pindexNew->GetBlockHash().GetHex().c_str(), diskindex.ToString().c_str(),  pindexNew->ToString().c_str());
-                    return error("LoadBlockIndex(): block header inconsistency detected: on-disk = %s, in-memory = %s",
-                                 diskindex.ToString(),  pindexNew->ToString());
-                }
+            // Consistency checks, the header is hashed once, and that hash must be the one it is stored under
+            uint256 hash = diskindex.GetBlockHash();
+            if (diskindex.hashPrev.IsNull() && hash != Params().consensus.hashGenesisBlock)
+            {
+                fail(strprintf("LoadBlockIndex(): prior block hash NULL on non-genesis block: %s\n", diskindex.ToString()));
+                return;
+            }
 
-                if ( 0 ) // POW will be checked before any block is connected
-                {
-                    uint8_t pubkey33[33];
-                    komodo_index2pubkey33(pubkey33,pindexNew,pindexNew->GetHeight());
-                    if (!CheckProofOfWork(header,pubkey33,pindexNew->GetHeight(),Params().GetConsensus()))
-                        return error("LoadBlockIndex(): CheckProofOfWork failed: %s", pindexNew->ToString());
-                }
-                pcursor->Next();
-            } else {
-                return error("LoadBlockIndex() : failed to read value");
+            if (hash != key.second)
+            {
+                printf("Error -- hashes don't match.\nheader.GetHash: %s\nstored as: %s\non disk: %s\n",
+                       hash.GetHex().c_str(), key.second.GetHex().c_str(), diskindex.ToString().c_str());
+                fail(strprintf("LoadBlockIndex(): block header inconsistency detected: on-disk = %s, stored as %s",
+                               diskindex.ToString(), key.second.GetHex()));
+                return;
             }
-        } else {
-            break;
+
+            diskindex.SetSolutionSummary(diskindex.nSolution);
+            std::vector<unsigned char>().swap(diskindex.nSolution);
+            batch.push_back(std::make_pair(hash, std::move(diskindex)));
+            if (batch.size() >= BLOCK_INDEX_LOAD_BATCH)
+                insertBatch(batch);
+
+            pcursor->Next();
         }
+        insertBatch(batch);
+    };
+
+    // POW will be checked before any block is connected, so it is not checked here
+    boost::thread_group scanThreads;
+    for (int i = 0; i < nThreads; i++) {
+        int nBegin = i * 256 / nThreads, nEnd = (i + 1) * 256 / nThreads;
+        scanThreads.create_thread([&scanRange, nBegin, nEnd]() { scanRange(nBegin, nEnd); });
+    }
+    try {
+        scanThreads.join_all();
+    } catch (const boost::thread_interrupted&) {
+        // the scans use this frame, so they have to finish before it unwinds
+        fStop = true;
+        scanThreads.join_all();
+        throw;
     }
 
+    if (!strError.empty())
+        return error("%s", strError);
+
+    LogPrint("bench", "%s: loaded %u block index entries with %d threads\n", __func__, nLoaded, nThreads);
     return true;
 }
@@ -9,16 +9,22 @@
 #include "coins.h"
 #include "dbwrapper.h"
 #include "chain.h"
+#include "lrucache.h"
 
 #include <map>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 #include <univalue.h>
 
 #include <boost/function.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
 
 class CBlockIndex;
+class CDiskBlockIndex;
 struct CDiskTxPos;
 struct CAddressUnspentKey;
 struct CAddressUnspentValue;
@@ -44,6 +50,8 @@ static const int64_t nDefaultDbCache = 450;
 static const int64_t nMaxDbCache = sizeof(void*) > 4 ? 16384 : 1024;
 //! min. -dbcache in (MiB)
 static const int64_t nMinDbCache = 4;
+//! -backgroundcoinsflush default
+static const bool DEFAULT_BACKGROUND_COINS_FLUSH = true;
 
 struct CDiskTxPos : public CDiskBlockPos
 {
@@ -70,11 +78,59 @@ struct CDiskTxPos : public CDiskBlockPos
     }
 };
 
+//! Version of the coin database format, 1 stores anchors as deltas against earlier anchors
+static const int CHAINSTATE_VERSION = 1;
+
+//! Format version of the coin database, together with the best block it was last written at
+struct CChainstateVersion
+{
+    int nVersion;
+    uint256 hashBlock;
+
+    CChainstateVersion() : nVersion(0) {}
+    CChainstateVersion(int nVersionIn, const uint256 &hashBlockIn) : nVersion(nVersionIn), hashBlock(hashBlockIn) {}
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(nVersion);
+        READWRITE(hashBlock);
+    }
+};
+
+//! Anchors at most this many deltas away from a full commitment tree in the coin database
+static const uint32_t ANCHOR_CHECKPOINT_INTERVAL = 32;
+//! Commitment trees of recently used anchors kept in memory, per shielded pool
+static const int ANCHOR_CACHE_SIZE = 1000;
+
+//! A commitment tree as stored under its anchor, fErased anchors are kept as bases of others
+template <typename Tree>
+struct CAnchorTreeEntry
+{
+    Tree tree;
+    uint32_t nDepth;
+    bool fErased;
+
+    CAnchorTreeEntry() : nDepth(0), fErased(false) {}
+    CAnchorTreeEntry(const Tree &treeIn, uint32_t nDepthIn, bool fErasedIn) : tree(treeIn), nDepth(nDepthIn), fErased(fErasedIn) {}
+};
+
 /** CCoinsView backed by the coin database (chainstate/) */
 class CCoinsViewDB : public CCoinsView
 {
 protected:
     CDBWrapper db;
+    mutable LRUCache<uint256, CAnchorTreeEntry<SproutMerkleTree>> sproutAnchorCache;
+    mutable LRUCache<uint256, CAnchorTreeEntry<SaplingMerkleTree>> saplingAnchorCache;
+
+    template <typename Tree>
+    bool ReadAnchor(const uint256 &rt, CAnchorTreeEntry<Tree> &entry, char dbChar, char legacyChar,
+                    LRUCache<uint256, CAnchorTreeEntry<Tree>> &cache) const;
+    template <typename Tree, typename Map>
+    void BatchWriteAnchors(CDBBatch &batch, const Map &mapToUse, char dbChar, char legacyChar, char bestChar,
+                           LRUCache<uint256, CAnchorTreeEntry<Tree>> &cache,
+                           std::vector<std::pair<uint256, CAnchorTreeEntry<Tree>>> &vWritten);
     CCoinsViewDB(std::string dbName, size_t nCacheSize, bool fMemory = false, bool fWipe = false);
 public:
     CCoinsViewDB(size_t nCacheSize, bool fMemory = false, bool fWipe = false);
@@ -86,6 +142,8 @@ public:
     bool HaveCoins(const uint256 &txid) const;
     uint256 GetBestBlock() const;
     uint256 GetBestAnchor(ShieldedType type) const;
+    //! False if the database was written in a format this version can not use
+    bool CheckVersion() const;
     bool BatchWrite(CCoinsMap &mapCoins,
                     const uint256 &hashBlock,
                     const uint256 &hashSproutAnchor,
@@ -94,9 +152,91 @@ public:
                     CAnchorsSaplingMap &mapSaplingAnchors,
                     CNullifiersMap &mapSproutNullifiers,
                     CNullifiersMap &mapSaplingNullifiers);
+    //! Write the dirty entries of the maps in one batch, leaving the maps as they are
+    virtual bool WriteCoinsBatch(const CCoinsMap &mapCoins,
+                         const uint256 &hashBlock,
+                         const uint256 &hashSproutAnchor,
+                         const uint256 &hashSaplingAnchor,
+                         const CAnchorsSproutMap &mapSproutAnchors,
+                         const CAnchorsSaplingMap &mapSaplingAnchors,
+                         const CNullifiersMap &mapSproutNullifiers,
+                         const CNullifiersMap &mapSaplingNullifiers);
     bool GetStats(CCoinsStats &stats) const;
 };
 
+/**
+ * Sits between the coins tip cache and the coin database. What the cache flushes is taken over
+ * and written to the database by a background thread, so connecting blocks does not wait on the
+ * write. Until the write is done, reads are answered from the generation being written before
+ * falling through to the database.
+ *
+ * The best block goes into the same batch as the coins, so after a crash the database is at the
+ * last completed flush, exactly as with synchronous flushes. Only one generation is written at a
+ * time; a flush that comes while one is still being written waits for it.
+ */
+class CCoinsViewWriteBehind : public CCoinsViewBacked
+{
+private:
+    CCoinsViewDB *pdb;
+
+    mutable boost::mutex cs;
+    //! Signalled when a generation is handed over, when it is written and on shutdown
+    mutable boost::condition_variable condWrite;
+    boost::thread writeThread;
+
+    //! Times a generation is written before giving up
+    static const int WRITE_TRIES = 3;
+
+    //! A generation has been handed over and is not written yet
+    bool fPending;
+    //! A write failed, no more flushes are accepted and the generation that failed is kept for reads
+    bool fFailed;
+    bool fStop;
+
+    std::unique_ptr<CCoinsMapMemoryResource> pCoinsMemoryResource;
+    //! The generation handed over, set from when it is handed over until it is written
+    std::unique_ptr<CCoinsMap> pCoins;
+    uint256 hashBlock;
+    uint256 hashSproutAnchor;
+    uint256 hashSaplingAnchor;
+    CAnchorsSproutMap mapSproutAnchors;
+    CAnchorsSaplingMap mapSaplingAnchors;
+    CNullifiersMap mapSproutNullifiers;
+    CNullifiersMap mapSaplingNullifiers;
+
+    void ThreadWrite();
+    void WaitForWrite(boost::unique_lock<boost::mutex> &lock) const;
+
+    CCoinsViewWriteBehind(const CCoinsViewWriteBehind&);
+    void operator=(const CCoinsViewWriteBehind&);
+
+public:
+    //! Reads that miss the pending generation go to baseIn, writes go to pdbIn
+    CCoinsViewWriteBehind(CCoinsView *baseIn, CCoinsViewDB *pdbIn);
+    ~CCoinsViewWriteBehind();
+
+    bool GetSproutAnchorAt(const uint256 &rt, SproutMerkleTree &tree) const;
+    bool GetSaplingAnchorAt(const uint256 &rt, SaplingMerkleTree &tree) const;
+    bool GetNullifier(const uint256 &nf, ShieldedType type) const;
+    bool GetCoins(const uint256 &txid, CCoins &coins) const;
+    bool HaveCoins(const uint256 &txid) const;
+    uint256 GetBestBlock() const;
+    uint256 GetBestAnchor(ShieldedType type) const;
+    //! Take over the dirty entries and return once the previous generation is written
+    bool BatchWrite(CCoinsMap &mapCoins,
+                    const uint256 &hashBlock,
+                    const uint256 &hashSproutAnchor,
+                    const uint256 &hashSaplingAnchor,
+                    CAnchorsSproutMap &mapSproutAnchors,
+                    CAnchorsSaplingMap &mapSaplingAnchors,
+                    CNullifiersMap &mapSproutNullifiers,
+                    CNullifiersMap &mapSaplingNullifiers);
+    bool GetStats(CCoinsStats &stats) const;
+
+    //! Wait until everything handed over is in the database, false if a write failed
+    bool Sync();
+};
+
 /** Access to the block database (blocks/index/) */
 class CBlockTreeDB : public CDBWrapper
 {
@@ -108,6 +248,7 @@ private:
 public:
     bool WriteBatchSync(const std::vector<std::pair<int, const CBlockFileInfo*> >& fileInfo, int nLastFile, const std::vector<const CBlockIndex*>& blockinfo);
     bool EraseBatchSync(const std::vector<const CBlockIndex*>& blockinfo);
+    bool ReadDiskBlockIndex(const uint256 &blockhash, CDiskBlockIndex &dbindex);
     bool ReadBlockFileInfo(int nFile, CBlockFileInfo &fileinfo);
     bool ReadLastBlockFile(int &nFile);
     bool WriteReindexing(bool fReindex);
@@ -127,7 +268,7 @@ public:
     bool ReadTimestampBlockIndex(const uint256 &hash, unsigned int &logicalTS);
     bool WriteFlag(const std::string &name, bool fValue);
     bool ReadFlag(const std::string &name, bool &fValue);
-    bool LoadBlockIndexGuts(boost::function<CBlockIndex*(const uint256&)> insertBlockIndex);
+    bool LoadBlockIndexGuts(boost::function<CBlockIndex*(const uint256&)> insertBlockIndex, int nThreads = 1);
     bool blockOnchainActive(const uint256 &hash);
     UniValue Snapshot(int top);
 };
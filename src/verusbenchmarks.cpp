@@ -0,0 +1,289 @@
+// Copyright (c) 2026 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#include "verusbenchmarks.h"
+
+#include "arith_uint256.h"
+#include "cc/CCinclude.h"
+#include "chainparams.h"
+#include "consensus/validation.h"
+#include "hash.h"
+#include "main.h"
+#include "miner.h"
+#include "mmr.h"
+#include "pbaas/identity.h"
+#include "pbaas/pbaas.h"
+#include "pbaas/reserves.h"
+#include "utiltime.h"
+
+#include <algorithm>
+#include <numeric>
+
+// seed of all fixture data, change it only together with the results being compared
+static const uint64_t BENCHMARK_FIXTURE_SEED = 0x5645525553424e43;
+
+static uint256 FixtureHash(uint64_t n)
+{
+    CHashWriter hw(SER_GETHASH, PROTOCOL_VERSION);
+    hw << BENCHMARK_FIXTURE_SEED << n;
+    return hw.GetHash();
+}
+
+static uint160 FixtureID(uint64_t n)
+{
+    uint256 hash = FixtureHash(n);
+    return uint160(std::vector<unsigned char>(hash.begin(), hash.begin() + 20));
+}
+
+static double SecondsSince(int64_t nStartMicros)
+{
+    return (GetTimeMicros() - nStartMicros) / 1000000.0;
+}
+
+// a PBaaS block header with a full size solution
+static CBlockHeader FixtureHeader()
+{
+    CBlockHeader header;
+    header.nVersion = CBlockHeader::VERUS_V2;
+    header.hashPrevBlock = FixtureHash(0);
+    header.hashMerkleRoot = FixtureHash(1);
+    header.hashFinalSaplingRoot = FixtureHash(2);
+    header.nTime = 1600000000;
+    header.nBits = 0x1e0fffff;
+    header.nNonce = FixtureHash(3);
+    header.nSolution.resize(1344);
+    for (size_t i = 0; i < header.nSolution.size(); i++)
+    {
+        header.nSolution[i] = (unsigned char)FixtureHash(4 + i / 32).begin()[i % 32];
+    }
+    header.nSolution[0] = SOLUTION_VERUSHHASH_V2_2;
+    return header;
+}
+
+double benchmark_verushash_v2b(size_t nHashes)
+{
+    CBlockHeader header = FixtureHeader();
+
+    uint256 result;
+    int64_t nStart = GetTimeMicros();
+    for (size_t i = 0; i < nHashes; i++)
+    {
+        *((uint32_t *)header.nNonce.begin()) = (uint32_t)i;
+        CVerusHashV2bWriter hw(SER_GETHASH, PROTOCOL_VERSION, SOLUTION_VERUSHHASH_V2_2);
+        hw << header;
+        result = hw.GetHash();
+    }
+    double elapsed = SecondsSince(nStart);
+    LogPrint("bench", "%s: last hash %s\n", __func__, result.GetHex());
+    return elapsed;
+}
+
+bool mine_verus_v2(CBlockHeader &bh, CVerusHashV2bWriter &vhw, uint256 &finalHash, uint256 &target, uint64_t start, uint64_t *count);
+bool mine_verus_v2_lanes(CBlockHeader &bh, CVerusHashV2bWriter &vhw, uint256 &finalHash, uint256 &target, uint64_t start, uint64_t *count);
+
+double benchmark_verus_mining(size_t nHashes, bool fLanes)
+{
+    if (!IsCPUVerusOptimized())
+    {
+        throw std::runtime_error("Mining kernels need AES and CLMUL support");
+    }
+
+    // a target nothing meets, so every nonce is hashed
+    CBlockHeader header = FixtureHeader();
+    CVerusHashV2bWriter hw(SER_GETHASH, PROTOCOL_VERSION, SOLUTION_VERUSHHASH_V2_2);
+    uint256 target, finalHash;
+    uint64_t count = nHashes;
+
+    int64_t nStart = GetTimeMicros();
+    if (fLanes ? mine_verus_v2_lanes(header, hw, finalHash, target, 0, &count) : mine_verus_v2(header, hw, finalHash, target, 0, &count))
+    {
+        throw std::runtime_error("Found a hash below a zero target");
+    }
+    return SecondsSince(nStart);
+}
+
+double benchmark_convert_amounts(int nReserves, size_t nConversions)
+{
+    if (nReserves < 1 || nReserves > CCurrencyState::MAX_RESERVE_CURRENCIES)
+    {
+        throw std::runtime_error("Invalid number of reserve currencies");
+    }
+
+    std::vector<uint160> currencies;
+    std::vector<int32_t> weights;
+    std::vector<int64_t> reserves;
+    std::vector<CAmount> inputReserve, inputFractional;
+    for (int i = 0; i < nReserves; i++)
+    {
+        currencies.push_back(FixtureID(i));
+        weights.push_back(CCurrencyState::MAX_RESERVE_RATIO / nReserves);
+        reserves.push_back(10000000000000 + i * 1000000000);
+        inputReserve.push_back(100000000000 + i * 10000);
+        inputFractional.push_back(50000000000 + i * 10000);
+    }
+    CCurrencyState state(FixtureID(nReserves), currencies, weights, reserves,
+                         0, 0, 100000000000000, CCurrencyState::FLAG_FRACTIONAL);
+
+    int64_t nStart = GetTimeMicros();
+    for (size_t i = 0; i < nConversions; i++)
+    {
+        CCurrencyState newState;
+        CValidationState validationState;
+        state.ConvertAmounts(inputReserve, inputFractional, newState, true, true, validationState);
+    }
+    return SecondsSince(nStart);
+}
+
+double benchmark_mmr_proofs(size_t nLeaves, size_t nProofs)
+{
+    if (!nLeaves)
+    {
+        throw std::runtime_error("Invalid number of leaves");
+    }
+
+    // same node type and layer chunking as the chain MMR
+    CMerkleMountainRange<CDefaultMMRNode, CChunkedLayer<CDefaultMMRNode, 9>> mmr;
+    for (size_t i = 0; i < nLeaves; i++)
+    {
+        mmr.Add(CDefaultMMRNode(FixtureHash(i)));
+    }
+    CMerkleMountainView<CDefaultMMRNode, CChunkedLayer<CDefaultMMRNode, 9>> mmv(mmr, mmr.size());
+    mmv.GetRoot();
+
+    int64_t nStart = GetTimeMicros();
+    for (size_t i = 0; i < nProofs; i++)
+    {
+        CMMRProof proof;
+        if (!mmv.GetProof(proof, UintToArith256(FixtureHash(nLeaves + i)).GetLow64() % nLeaves))
+        {
+            throw std::runtime_error("Failed to create MMR proof");
+        }
+    }
+    return SecondsSince(nStart);
+}
+
+double benchmark_layer_conversions(size_t nConversions, bool fDecimal)
+{
+    // buys and sells of one reserve layer, at the sizes and ratios of live baskets
+    std::vector<std::tuple<CAmount, CAmount, CAmount, int32_t>> inputs;
+    for (size_t i = 0; i < 1000; i++)
+    {
+        uint64_t n = UintToArith256(FixtureHash(i)).GetLow64();
+        inputs.push_back(std::make_tuple((CAmount)(n % 1000000000000),
+                                         (CAmount)(100000000000000 + n % 10000000000000),
+                                         (CAmount)(10000000000000 + n % 1000000000000),
+                                         (int32_t)(CCurrencyState::MIN_RESERVE_RATIO * (5 + n % 96))));
+    }
+
+    int64_t nStart = GetTimeMicros();
+    for (size_t i = 0; i < nConversions; i++)
+    {
+        CAmount in, supply, reserve;
+        int32_t ratio;
+        std::tie(in, supply, reserve, ratio) = inputs[i % inputs.size()];
+        if (fDecimal)
+        {
+            CalculateFractionalOutDecimal(in, supply, reserve, ratio);
+            CalculateReserveOutDecimal(in, supply, reserve, ratio);
+        }
+        else
+        {
+            CalculateFractionalOut(in, supply, reserve, ratio);
+            CalculateReserveOut(in, supply, reserve, ratio);
+        }
+    }
+    return SecondsSince(nStart);
+}
+
+double benchmark_reserve_transaction_descriptor(size_t nOutputs, size_t nTxs)
+{
+    LOCK(cs_main);
+    if (!chainActive.LastTip())
+    {
+        throw std::runtime_error("No chain loaded");
+    }
+
+    CMutableTransaction mtx = CreateNewContextualCMutableTransaction(Params().GetConsensus(), chainActive.Height() + 1);
+    mtx.vin.push_back(CTxIn(FixtureHash(0), 0));
+    for (size_t i = 0; i < nOutputs; i++)
+    {
+        std::vector<CTxDestination> dests({CTxDestination(CKeyID(FixtureID(i)))});
+        CTokenOutput to(ASSETCHAINS_CHAINID, 100000000 + i);
+        mtx.vout.push_back(CTxOut(0, MakeMofNCCScript(CConditionObj<CTokenOutput>(EVAL_RESERVE_OUTPUT, dests, 1, &to))));
+    }
+    CTransaction tx(mtx);
+    CCoinsViewCache view(pcoinsTip);
+
+    int64_t nStart = GetTimeMicros();
+    for (size_t i = 0; i < nTxs; i++)
+    {
+        CReserveTransactionDescriptor rtxd(tx, view, chainActive.Height() + 1);
+    }
+    return SecondsSince(nStart);
+}
+
+double benchmark_lookup_identity(size_t nLookups)
+{
+    // alternate between an identity that exists and one that does not
+    int64_t nStart = GetTimeMicros();
+    for (size_t i = 0; i < nLookups; i++)
+    {
+        CIdentity::LookupIdentity(CIdentityID(i & 1 ? FixtureID(i) : ASSETCHAINS_CHAINID));
+    }
+    return SecondsSince(nStart);
+}
+
+double benchmark_create_new_block()
+{
+    CScript scriptPubKey = CScript() << OP_TRUE;
+
+    int64_t nStart = GetTimeMicros();
+    std::unique_ptr<CBlockTemplate> pblocktemplate(CreateNewBlock(Params(), scriptPubKey));
+    double elapsed = SecondsSince(nStart);
+    if (!pblocktemplate)
+    {
+        throw std::runtime_error("Failed to create block template");
+    }
+    LogPrint("bench", "%s: %u transactions\n", __func__, (unsigned int)pblocktemplate->block.vtx.size());
+    return elapsed;
+}
+
+std::vector<CVerusBenchmark> GetStandaloneBenchmarks()
+{
+    return {
+        {"verushashv2b", []() { return benchmark_verushash_v2b(100000); }},
+        {"verusmining", []() { return benchmark_verus_mining(100000, false); }},
+        {"verusmininglanes", []() { return benchmark_verus_mining(100000, true); }},
+        {"convertamounts", []() { return benchmark_convert_amounts(4, 1000); }},
+        {"convertamounts10", []() { return benchmark_convert_amounts(CCurrencyState::MAX_RESERVE_CURRENCIES, 1000); }},
+        {"mmrproofs", []() { return benchmark_mmr_proofs(1000000, 10000); }},
+        {"layerconversions", []() { return benchmark_layer_conversions(10000, false); }},
+        {"layerconversionsdecimal", []() { return benchmark_layer_conversions(10000, true); }},
+    };
+}
+
+UniValue BenchmarkResultToUniValue(const std::string &name, const std::vector<double> &samples)
+{
+    UniValue result(UniValue::VOBJ);
+    result.push_back(Pair("name", name));
+
+    UniValue sampleArr(UniValue::VARR);
+    for (double sample : samples)
+    {
+        sampleArr.push_back(UniValue(sample));
+    }
+    result.push_back(Pair("samples", sampleArr));
+
+    if (samples.size())
+    {
+        std::vector<double> sorted(samples);
+        std::sort(sorted.begin(), sorted.end());
+        size_t mid = sorted.size() / 2;
+        result.push_back(Pair("min", sorted.front()));
+        result.push_back(Pair("max", sorted.back()));
+        result.push_back(Pair("mean", std::accumulate(sorted.begin(), sorted.end(), 0.0) / sorted.size()));
+        result.push_back(Pair("median", sorted.size() & 1 ? sorted[mid] : (sorted[mid - 1] + sorted[mid]) / 2));
+    }
+    return result;
+}
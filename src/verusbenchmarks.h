@@ -0,0 +1,44 @@
+// Copyright (c) 2026 The Verus developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#ifndef VERUS_BENCHMARKS_H
+#define VERUS_BENCHMARKS_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <univalue.h>
+
+/**
+ * Benchmarks of Verus and PBaaS hot paths. All inputs are synthetic and generated from a fixed
+ * seed, so runs on different releases measure the same work. Each function returns the running
+ * time of one sample in seconds.
+ */
+
+// benchmarks that need nothing but the process, also run by bench_verus
+double benchmark_verushash_v2b(size_t nHashes);
+double benchmark_verus_mining(size_t nHashes, bool fLanes);
+double benchmark_convert_amounts(int nReserves, size_t nConversions);
+double benchmark_mmr_proofs(size_t nLeaves, size_t nProofs);
+double benchmark_layer_conversions(size_t nConversions, bool fDecimal);
+
+// benchmarks that need a loaded chain, run through zcbenchmark
+double benchmark_reserve_transaction_descriptor(size_t nOutputs, size_t nTxs);
+double benchmark_lookup_identity(size_t nLookups);
+double benchmark_create_new_block();
+
+struct CVerusBenchmark
+{
+    std::string name;
+    std::function<double()> run;
+};
+
+//! Benchmarks bench_verus runs, with their default sizes
+std::vector<CVerusBenchmark> GetStandaloneBenchmarks();
+
+//! Summary of the samples of one benchmark, for tracking results between releases
+UniValue BenchmarkResultToUniValue(const std::string &name, const std::vector<double> &samples);
+
+#endif // VERUS_BENCHMARKS_H
@@ -21,6 +21,7 @@
 #include "walletdb.h"
 #include "primitives/transaction.h"
 #include "zcbenchmarks.h"
+#include "verusbenchmarks.h"
 #include "script/interpreter.h"
 #include "zcash/Address.hpp"
 
@@ -5475,6 +5476,19 @@ UniValue zc_benchmark(const UniValue& params, bool fHelp)
             "Runs a benchmark of the selected type samplecount times,\n"
             "returning the running times of each sample.\n"
             "\n"
+            "Verus benchmarks, with their optional size arguments:\n"
+            "  verushashv2b [hashes]               VerusHash v2.2 of a PBaaS block header\n"
+            "  verusmining [hashes]                the miner's VerusHash v2.2 kernel, one nonce at a time\n"
+            "  verusmininglanes [hashes]           the miner's VerusHash v2.2 kernel, with interleaved nonces\n"
+            "  convertamounts [reserves] [count]   CCurrencyState::ConvertAmounts\n"
+            "  mmrproofs [leaves] [proofs]         MMR proofs of random leaves\n"
+            "  layerconversions [count]            CalculateFractionalOut and CalculateReserveOut\n"
+            "  layerconversionsdecimal [count]     the same conversions with the decimal reference versions\n"
+            "  reservedescriptor [outputs] [count] CReserveTransactionDescriptor of a transaction with reserve outputs\n"
+            "  lookupidentity [count]              CIdentity::LookupIdentity, alternately found and not found\n"
+            "  createnewblock                      CreateNewBlock from the current mempool, regtest only\n"
+            "The first seven are also run by the bench_verus program.\n"
+            "\n"
             "Output: [\n"
             "  {\n"
             "    \"runningtime\": runningtime\n"
@@ -5541,6 +5555,20 @@ UniValue zc_benchmark(const UniValue& params, bool fHelp)
                 nInputs = params[2].get_int();
             }
             sample_times.push_back(benchmark_large_tx(nInputs));
+        } else if (benchmarktype == "checkqueue") {
+            // Number of threads verifying the inputs, and number of inputs to verify
+            int nThreads = 1;
+            int nInputs = 10000;
+            if (params.size() >= 3) {
+                nThreads = params[2].get_int();
+            }
+            if (params.size() >= 4) {
+                nInputs = params[3].get_int();
+            }
+            if (nThreads < 1 || nInputs < 1) {
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid thread or input count");
+            }
+            sample_times.push_back(benchmark_checkqueue(nThreads, nInputs));
         } else if (benchmarktype == "trydecryptnotes") {
             int nKeys = params[2].get_int();
             sample_times.push_back(benchmark_try_decrypt_sprout_notes(nKeys));
@@ -5579,6 +5607,56 @@ UniValue zc_benchmark(const UniValue& params, bool fHelp)
             sample_times.push_back(benchmark_verify_sapling_spend());
         } else if (benchmarktype == "verifysaplingoutput") {
             sample_times.push_back(benchmark_verify_sapling_output());
+        } else if (benchmarktype == "verushashv2b") {
+            int nHashes = params.size() >= 3 ? params[2].get_int() : 100000;
+            if (nHashes < 1) {
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid hash count");
+            }
+            sample_times.push_back(benchmark_verushash_v2b(nHashes));
+        } else if (benchmarktype == "verusmining" || benchmarktype == "verusmininglanes") {
+            int nHashes = params.size() >= 3 ? params[2].get_int() : 100000;
+            if (nHashes < 1) {
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid hash count");
+            }
+            sample_times.push_back(benchmark_verus_mining(nHashes, benchmarktype == "verusmininglanes"));
+        } else if (benchmarktype == "convertamounts") {
+            int nReserves = params.size() >= 3 ? params[2].get_int() : 4;
+            int nConversions = params.size() >= 4 ? params[3].get_int() : 1000;
+            if (nReserves < 1 || nReserves > CCurrencyState::MAX_RESERVE_CURRENCIES || nConversions < 1) {
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid reserve or conversion count");
+            }
+            sample_times.push_back(benchmark_convert_amounts(nReserves, nConversions));
+        } else if (benchmarktype == "mmrproofs") {
+            int nLeaves = params.size() >= 3 ? params[2].get_int() : 1000000;
+            int nProofs = params.size() >= 4 ? params[3].get_int() : 10000;
+            if (nLeaves < 1 || nProofs < 1) {
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid leaf or proof count");
+            }
+            sample_times.push_back(benchmark_mmr_proofs(nLeaves, nProofs));
+        } else if (benchmarktype == "layerconversions" || benchmarktype == "layerconversionsdecimal") {
+            int nConversions = params.size() >= 3 ? params[2].get_int() : 10000;
+            if (nConversions < 1) {
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid conversion count");
+            }
+            sample_times.push_back(benchmark_layer_conversions(nConversions, benchmarktype == "layerconversionsdecimal"));
+        } else if (benchmarktype == "reservedescriptor") {
+            int nOutputs = params.size() >= 3 ? params[2].get_int() : 10;
+            int nTxs = params.size() >= 4 ? params[3].get_int() : 1000;
+            if (nOutputs < 1 || nTxs < 1) {
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid output or transaction count");
+            }
+            sample_times.push_back(benchmark_reserve_transaction_descriptor(nOutputs, nTxs));
+        } else if (benchmarktype == "lookupidentity") {
+            int nLookups = params.size() >= 3 ? params[2].get_int() : 1000;
+            if (nLookups < 1) {
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid lookup count");
+            }
+            sample_times.push_back(benchmark_lookup_identity(nLookups));
+        } else if (benchmarktype == "createnewblock") {
+            if (Params().NetworkIDString() != "regtest") {
+                throw JSONRPCError(RPC_TYPE_ERROR, "Benchmark must be run in regtest mode");
+            }
+            sample_times.push_back(benchmark_create_new_block());
         } else {
             throw JSONRPCError(RPC_TYPE_ERROR, "Invalid benchmarktype");
         }
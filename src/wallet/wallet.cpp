@@ -1379,8 +1379,8 @@ void CWallet::ClearNoteWitnessCache()
     //fprintf(stderr,"Clear witness cache\n");
 }
 
-template<typename NoteDataMap>
-void CopyPreviousWitnesses(NoteDataMap& noteDataMap, int indexHeight, int64_t nWitnessCacheSize)
+template<typename NoteDataMap, typename NoteData>
+void CopyPreviousWitnesses(NoteDataMap& noteDataMap, int indexHeight, int64_t nWitnessCacheSize, size_t treeSize, std::map<NoteData*, size_t>& toUpdate)
 {
     for (auto& item : noteDataMap) {
         auto* nd = &(item.second);
@@ -1395,9 +1395,11 @@ void CopyPreviousWitnesses(NoteDataMap& noteDataMap, int indexHeight, int64_t nW
             // Witnesses being incremented should always be either -1
             // (never incremented or decremented) or one below indexHeight
             assert((nd->witnessHeight == -1) || (nd->witnessHeight == indexHeight - 1));
-            // Copy the witness for the previous block if we have one
+            // Copy the witness for the previous block if we have one, and
+            // bring the copy up to date with the block's commitments later
             if (nd->witnesses.size() > 0) {
                 nd->witnesses.push_front(nd->witnesses.front());
+                toUpdate[nd] = treeSize;
             }
             if (nd->witnesses.size() > WITNESS_CACHE_SIZE) {
                 nd->witnesses.pop_back();
@@ -1406,25 +1408,12 @@ void CopyPreviousWitnesses(NoteDataMap& noteDataMap, int indexHeight, int64_t nW
     }
 }
 
-template<typename NoteDataMap>
-void AppendNoteCommitment(NoteDataMap& noteDataMap, int indexHeight, int64_t nWitnessCacheSize, const uint256& note_commitment)
-{
-    for (auto& item : noteDataMap) {
-        auto* nd = &(item.second);
-        if (nd->witnessHeight < indexHeight && nd->witnesses.size() > 0) {
-            // Check the validity of the cache
-            // See comment in CopyPreviousWitnesses about validity.
-            assert(nWitnessCacheSize >= nd->witnesses.size());
-            nd->witnesses.front().append(note_commitment);
-        }
-    }
-}
-
-template<typename OutPoint, typename NoteData, typename Witness>
-void WitnessNoteIfMine(std::map<OutPoint, NoteData>& noteDataMap, int indexHeight, int64_t nWitnessCacheSize, const OutPoint& key, const Witness& witness)
+template<typename OutPoint, typename NoteData, typename WitnessFrontier>
+void WitnessNoteIfMine(std::map<OutPoint, NoteData>& noteDataMap, int indexHeight, int64_t nWitnessCacheSize, const OutPoint& key, const WitnessFrontier& frontier, std::map<NoteData*, size_t>& toUpdate)
 {
     if (noteDataMap.count(key) && noteDataMap[key].witnessHeight < indexHeight) {
         auto* nd = &(noteDataMap[key]);
+        auto witness = frontier.witness();
         if (nd->witnesses.size() > 0) {
             // We think this can happen because we write out the
             // witness cache state after every block increment or
@@ -1443,6 +1432,8 @@ void WitnessNoteIfMine(std::map<OutPoint, NoteData>& noteDataMap, int indexHeigh
             nd->witnesses.clear();
         }
         nd->witnesses.push_front(witness);
+        // The witness only needs the commitments after this one
+        toUpdate[nd] = frontier.size();
         // Set height to one less than pindex so it gets incremented
         nd->witnessHeight = indexHeight - 1;
         // Check the validity of the cache
@@ -1450,6 +1441,16 @@ void WitnessNoteIfMine(std::map<OutPoint, NoteData>& noteDataMap, int indexHeigh
     }
 }
 
+template<typename NoteData, typename WitnessFrontier>
+void UpdateWitnesses(const std::map<NoteData*, size_t>& toUpdate, int64_t nWitnessCacheSize, const WitnessFrontier& frontier)
+{
+    for (auto& item : toUpdate) {
+        // Check the validity of the cache
+        // See comment in CopyPreviousWitnesses about validity.
+        assert(nWitnessCacheSize >= item.first->witnesses.size());
+        frontier.update(item.first->witnesses.front(), item.second);
+    }
+}
 
 template<typename NoteDataMap>
 void UpdateWitnessHeights(NoteDataMap& noteDataMap, int indexHeight, int64_t nWitnessCacheSize)
@@ -1471,9 +1472,20 @@ void CWallet::IncrementNoteWitnesses(const CBlockIndex* pindex,
                                      SaplingMerkleTree& saplingTree)
 {
     LOCK(cs_wallet);
+
+    // Witnesses to bring up to date once all of the block's commitments are
+    // in the frontiers, with the tree size each of them is current at. The
+    // frontiers hash each new subtree of the commitment trees once for all
+    // witnesses, so the cost of a block no longer grows with the product of
+    // its commitments and the wallet's notes.
+    std::map<SproutNoteData*, size_t> sproutToUpdate;
+    std::map<SaplingNoteData*, size_t> saplingToUpdate;
+    SproutWitnessFrontier sproutFrontier(sproutTree);
+    SaplingWitnessFrontier saplingFrontier(saplingTree);
+
     for (std::pair<const uint256, CWalletTx>& wtxItem : mapWallet) {
-       ::CopyPreviousWitnesses(wtxItem.second.mapSproutNoteData, pindex->GetHeight(), nWitnessCacheSize);
-       ::CopyPreviousWitnesses(wtxItem.second.mapSaplingNoteData, pindex->GetHeight(), nWitnessCacheSize);
+       ::CopyPreviousWitnesses(wtxItem.second.mapSproutNoteData, pindex->GetHeight(), nWitnessCacheSize, sproutFrontier.size(), sproutToUpdate);
+       ::CopyPreviousWitnesses(wtxItem.second.mapSaplingNoteData, pindex->GetHeight(), nWitnessCacheSize, saplingFrontier.size(), saplingToUpdate);
     }
 
     if (nWitnessCacheSize < WITNESS_CACHE_SIZE) {
@@ -1495,38 +1507,34 @@ void CWallet::IncrementNoteWitnesses(const CBlockIndex* pindex,
             const JSDescription& jsdesc = tx.vJoinSplit[i];
             for (uint8_t j = 0; j < jsdesc.commitments.size(); j++) {
                 const uint256& note_commitment = jsdesc.commitments[j];
-                sproutTree.append(note_commitment);
-
-                // Increment existing witnesses
-                for (std::pair<const uint256, CWalletTx>& wtxItem : mapWallet) {
-                    ::AppendNoteCommitment(wtxItem.second.mapSproutNoteData, pindex->GetHeight(), nWitnessCacheSize, note_commitment);
-                }
+                sproutFrontier.append(note_commitment);
 
                 // If this is our note, witness it
                 if (txIsOurs) {
                     JSOutPoint jsoutpt {hash, i, j};
-                    ::WitnessNoteIfMine(mapWallet[hash].mapSproutNoteData, pindex->GetHeight(), nWitnessCacheSize, jsoutpt, sproutTree.witness());
+                    ::WitnessNoteIfMine(mapWallet[hash].mapSproutNoteData, pindex->GetHeight(), nWitnessCacheSize, jsoutpt, sproutFrontier, sproutToUpdate);
                 }
             }
         }
         // Sapling
         for (uint32_t i = 0; i < tx.vShieldedOutput.size(); i++) {
             const uint256& note_commitment = tx.vShieldedOutput[i].cm;
-            saplingTree.append(note_commitment);
-
-            // Increment existing witnesses
-            for (std::pair<const uint256, CWalletTx>& wtxItem : mapWallet) {
-                ::AppendNoteCommitment(wtxItem.second.mapSaplingNoteData, pindex->GetHeight(), nWitnessCacheSize, note_commitment);
-            }
+            saplingFrontier.append(note_commitment);
 
             // If this is our note, witness it
             if (txIsOurs) {
                 SaplingOutPoint outPoint {hash, i};
-                ::WitnessNoteIfMine(mapWallet[hash].mapSaplingNoteData, pindex->GetHeight(), nWitnessCacheSize, outPoint, saplingTree.witness());
+                ::WitnessNoteIfMine(mapWallet[hash].mapSaplingNoteData, pindex->GetHeight(), nWitnessCacheSize, outPoint, saplingFrontier, saplingToUpdate);
             }
         }
     }
 
+    // Increment existing witnesses
+    ::UpdateWitnesses(sproutToUpdate, nWitnessCacheSize, sproutFrontier);
+    ::UpdateWitnesses(saplingToUpdate, nWitnessCacheSize, saplingFrontier);
+    sproutTree = sproutFrontier.merkle_tree();
+    saplingTree = saplingFrontier.merkle_tree();
+
     // Update witness heights
     for (std::pair<const uint256, CWalletTx>& wtxItem : mapWallet) {
         ::UpdateWitnessHeights(wtxItem.second.mapSproutNoteData, pindex->GetHeight(), nWitnessCacheSize);
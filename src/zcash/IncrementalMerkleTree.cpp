@@ -348,6 +348,106 @@ void IncrementalWitness<Depth, Hash>::append(Hash obj) {
     }
 }
 
+template<size_t Depth, typename Hash>
+IncrementalWitnessFrontier<Depth, Hash>::IncrementalWitnessFrontier(const IncrementalMerkleTree<Depth, Hash>& tree) :
+    tree(tree), start(tree.size()), lefts(Depth + 1)
+{
+    // Find the complete left subtrees still waiting for their siblings. The
+    // tree only combines a full pair of leaves when the next leaf is appended,
+    // so do that combination here.
+    boost::optional<Hash> combined;
+    if (tree.left && tree.right) {
+        combined = Hash::combine(*tree.left, *tree.right, 0);
+    } else if (tree.left) {
+        lefts[0] = *tree.left;
+    }
+
+    for (size_t i = 0; i < tree.parents.size(); i++) {
+        if (combined) {
+            if (tree.parents[i]) {
+                combined = Hash::combine(*tree.parents[i], *combined, i+1);
+            } else {
+                lefts[i+1] = combined;
+                combined = boost::none;
+            }
+        } else if (tree.parents[i]) {
+            lefts[i+1] = tree.parents[i];
+        }
+    }
+
+    if (combined) {
+        lefts[tree.parents.size() + 1] = combined;
+    }
+}
+
+template<size_t Depth, typename Hash>
+void IncrementalWitnessFrontier<Depth, Hash>::append(Hash obj) {
+    size_t index = tree.size();
+    tree.append(obj);
+
+    // Record every subtree this leaf completes
+    size_t depth = 0;
+    completed[std::make_pair(depth, index)] = obj;
+    while (index & 1) {
+        obj = Hash::combine(*lefts[depth], obj, depth);
+        lefts[depth] = boost::none;
+        index >>= 1;
+        depth++;
+        completed[std::make_pair(depth, index)] = obj;
+    }
+    lefts[depth] = obj;
+}
+
+template<size_t Depth, typename Hash>
+void IncrementalWitnessFrontier<Depth, Hash>::update(IncrementalWitness<Depth, Hash>& witness, size_t from) const {
+    size_t to = tree.size();
+    if (from < start || from > to) {
+        throw std::runtime_error("witness is not within the frontier's range");
+    }
+
+    while (from < to) {
+        // The witness's next uncle subtree, either the one its cursor was
+        // filling or the first one the new commitments are in
+        size_t depth, first;
+        if (witness.cursor) {
+            depth = witness.cursor_depth;
+            first = from - witness.cursor->size();
+        } else {
+            depth = witness.tree.next_depth(witness.filled.size());
+            first = from;
+        }
+
+        if (depth >= Depth) {
+            throw std::runtime_error("tree is full");
+        }
+        witness.cursor_depth = depth;
+
+        size_t end = first + (size_t(1) << depth);
+        if (end <= to) {
+            auto it = completed.find(std::make_pair(depth, first >> depth));
+            if (it == completed.end()) {
+                throw std::runtime_error("witness is inconsistent with the frontier");
+            }
+            witness.filled.push_back(it->second);
+            witness.cursor = boost::none;
+            from = end;
+        } else {
+            // The subtree is incomplete, and since it starts on a boundary of
+            // its size, its leaves are represented by the lower levels of the tree.
+            IncrementalMerkleTree<Depth, Hash> cursor;
+            cursor.left = tree.left;
+            cursor.right = tree.right;
+            cursor.parents.assign(tree.parents.begin(),
+                                  tree.parents.begin() + std::min(depth - 1, tree.parents.size()));
+            while (!cursor.parents.empty() && !cursor.parents.back()) {
+                cursor.parents.pop_back();
+            }
+            witness.cursor = cursor;
+            from = to;
+        }
+    }
+}
+
 template class IncrementalMerkleTree<INCREMENTAL_MERKLE_TREE_DEPTH, SHA256Compress>;
 template class IncrementalMerkleTree<INCREMENTAL_MERKLE_TREE_DEPTH_TESTING, SHA256Compress>;
 
@@ -360,4 +460,10 @@ template class IncrementalMerkleTree<INCREMENTAL_MERKLE_TREE_DEPTH_TESTING, Pede
 template class IncrementalWitness<SAPLING_INCREMENTAL_MERKLE_TREE_DEPTH, PedersenHash>;
 template class IncrementalWitness<INCREMENTAL_MERKLE_TREE_DEPTH_TESTING, PedersenHash>;
 
+template class IncrementalWitnessFrontier<INCREMENTAL_MERKLE_TREE_DEPTH, SHA256Compress>;
+template class IncrementalWitnessFrontier<INCREMENTAL_MERKLE_TREE_DEPTH_TESTING, SHA256Compress>;
+
+template class IncrementalWitnessFrontier<SAPLING_INCREMENTAL_MERKLE_TREE_DEPTH, PedersenHash>;
+template class IncrementalWitnessFrontier<INCREMENTAL_MERKLE_TREE_DEPTH_TESTING, PedersenHash>;
+
 } // end namespace `libzcash`
@@ -3,6 +3,7 @@
 
 #include <array>
 #include <deque>
+#include <map>
 #include <boost/optional.hpp>
 #include <boost/static_assert.hpp>
 
@@ -82,10 +83,14 @@ bool operator==(const EmptyMerkleRoots<Depth, Hash>& a,
 template<size_t Depth, typename Hash>
 class IncrementalWitness;
 
+template<size_t Depth, typename Hash>
+class IncrementalWitnessFrontier;
+
 template<size_t Depth, typename Hash>
 class IncrementalMerkleTree {
 
 friend class IncrementalWitness<Depth, Hash>;
+friend class IncrementalWitnessFrontier<Depth, Hash>;
 
 public:
     BOOST_STATIC_ASSERT(Depth >= 1);
@@ -155,6 +160,7 @@ bool operator==(const IncrementalMerkleTree<Depth, Hash>& a,
 template <size_t Depth, typename Hash>
 class IncrementalWitness {
 friend class IncrementalMerkleTree<Depth, Hash>;
+friend class IncrementalWitnessFrontier<Depth, Hash>;
 
 public:
     // Required for Unserialize()
@@ -213,6 +219,47 @@ bool operator==(const IncrementalWitness<Depth, Hash>& a,
             a.cursor_depth == b.cursor_depth);
 }
 
+// Brings any number of witnesses of one tree up to date with the commitments
+// appended to it, such as all wallet notes for the commitments of a block.
+// Every subtree completed by the appended commitments is hashed once, here,
+// and a witness only picks up the roots of the subtrees on its path and takes
+// its partial subtree from this frontier, instead of every witness hashing
+// every commitment into its own cursor.
+template<size_t Depth, typename Hash>
+class IncrementalWitnessFrontier {
+public:
+    IncrementalWitnessFrontier(const IncrementalMerkleTree<Depth, Hash>& tree);
+
+    void append(Hash obj);
+
+    size_t size() const {
+        return tree.size();
+    }
+
+    const IncrementalMerkleTree<Depth, Hash>& merkle_tree() const {
+        return tree;
+    }
+
+    IncrementalWitness<Depth, Hash> witness() const {
+        return tree.witness();
+    }
+
+    // Update a witness that was current when the tree had `from` commitments
+    // to the tree with all commitments appended so far. `from` cannot be
+    // smaller than the size of the tree this frontier was created from.
+    void update(IncrementalWitness<Depth, Hash>& witness, size_t from) const;
+
+private:
+    IncrementalMerkleTree<Depth, Hash> tree;
+    size_t start;
+
+    // Latest complete left subtree at each depth, until its sibling completes
+    std::vector<boost::optional<Hash>> lefts;
+
+    // Roots of the subtrees completed since creation, by depth and index
+    std::map<std::pair<size_t, size_t>, Hash> completed;
+};
+
 class SHA256Compress : public uint256 {
 public:
     SHA256Compress() : uint256() {}
@@ -260,4 +307,10 @@ typedef libzcash::IncrementalMerkleTree<INCREMENTAL_MERKLE_TREE_DEPTH_TESTING, l
 typedef libzcash::IncrementalWitness<SAPLING_INCREMENTAL_MERKLE_TREE_DEPTH, libzcash::PedersenHash> SaplingWitness;
 typedef libzcash::IncrementalWitness<INCREMENTAL_MERKLE_TREE_DEPTH_TESTING, libzcash::PedersenHash> SaplingTestingWitness;
 
+typedef libzcash::IncrementalWitnessFrontier<INCREMENTAL_MERKLE_TREE_DEPTH, libzcash::SHA256Compress> SproutWitnessFrontier;
+typedef libzcash::IncrementalWitnessFrontier<INCREMENTAL_MERKLE_TREE_DEPTH_TESTING, libzcash::SHA256Compress> SproutTestingWitnessFrontier;
+
+typedef libzcash::IncrementalWitnessFrontier<SAPLING_INCREMENTAL_MERKLE_TREE_DEPTH, libzcash::PedersenHash> SaplingWitnessFrontier;
+typedef libzcash::IncrementalWitnessFrontier<INCREMENTAL_MERKLE_TREE_DEPTH_TESTING, libzcash::PedersenHash> SaplingTestingWitnessFrontier;
+
 #endif /* ZC_INCREMENTALMERKLETREE_H_ */
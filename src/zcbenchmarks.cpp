@@ -4,7 +4,9 @@
 #include <thread>
 #include <unistd.h>
 #include <boost/filesystem.hpp>
+#include <boost/thread.hpp>
 
+#include "checkqueue.h"
 #include "coins.h"
 #include "util.h"
 #include "init.h"
@@ -272,6 +274,63 @@ double benchmark_large_tx(size_t nInputs)
     return timer_stop(tv_start);
 }
 
+// Measures how the validation check queue scales, by verifying the scripts of a
+// transaction with nInputs P2PKH inputs using nThreads threads, including the master.
+double benchmark_checkqueue(int nThreads, size_t nInputs)
+{
+    CKey priv;
+    priv.MakeNewKey(true);
+    CBasicKeyStore tempKeystore;
+    tempKeystore.AddKey(priv);
+    CScript prevPubKey = GetScriptForDestination(priv.GetPubKey().GetID());
+
+    CMutableTransaction m_orig_tx;
+    m_orig_tx.vout.resize(1);
+    m_orig_tx.vout[0].nValue = 1000000;
+    m_orig_tx.vout[0].scriptPubKey = prevPubKey;
+    auto orig_tx = CTransaction(m_orig_tx);
+
+    CMutableTransaction spending_tx;
+    spending_tx.fOverwintered = true;
+    spending_tx.nVersionGroupId = SAPLING_VERSION_GROUP_ID;
+    spending_tx.nVersion = SAPLING_TX_VERSION;
+    for (size_t i = 0; i < nInputs; i++) {
+        spending_tx.vin.emplace_back(orig_tx.GetHash(), 0);
+    }
+    auto consensusBranchId = NetworkUpgradeInfo[Consensus::UPGRADE_SAPLING].nBranchId;
+    for (size_t i = 0; i < nInputs; i++) {
+        SignSignature(tempKeystore, prevPubKey, spending_tx, i, 1000000, SIGHASH_ALL, consensusBranchId);
+    }
+    CTransaction final_spending_tx(spending_tx);
+    PrecomputedTransactionData txdata(final_spending_tx);
+    CCoins coins(orig_tx, 1);
+
+    std::vector<CScriptCheck> vChecks;
+    vChecks.reserve(nInputs);
+    for (size_t i = 0; i < nInputs; i++) {
+        vChecks.push_back(CScriptCheck(coins, final_spending_tx, i, STANDARD_SCRIPT_VERIFY_FLAGS, false, consensusBranchId, &txdata));
+    }
+
+    CCheckQueue<CCheckVariant<CScriptCheck>> checkqueue(128);
+    boost::thread_group threadGroup;
+    for (int i = 0; i < nThreads - 1; i++) {
+        threadGroup.create_thread(boost::bind(&CCheckQueue<CCheckVariant<CScriptCheck>>::Thread, boost::ref(checkqueue)));
+    }
+
+    struct timeval tv_start;
+    timer_start(tv_start);
+    {
+        CCheckQueueControl<CCheckVariant<CScriptCheck>> control(&checkqueue);
+        control.AddAny(vChecks);
+        assert(control.Wait());
+    }
+    double ret = timer_stop(tv_start);
+
+    threadGroup.interrupt_all();
+    threadGroup.join_all();
+    return ret;
+}
+
 // The two benchmarks, try_decrypt_sprout_notes and try_decrypt_sapling_notes,
 // are checking worst-case scenarios. In both we add n keys to a wallet, 
 // create a transaction using a key not in our original list of n, and then
@@ -429,7 +488,7 @@ double benchmark_increment_sapling_note_witnesses(size_t nTxs)
     {
         auto saplingTx = CreateSaplingTxWithNoteData(consensusParams, wallet, saplingSpendingKey);
         wallet.AddToWallet(saplingTx, true, NULL);
-        block1.vtx.push_back(saplingTx);
+        block2.vtx.push_back(saplingTx);
     }
 
     CBlockIndex index2(block2);
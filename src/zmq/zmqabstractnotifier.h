@@ -6,6 +6,7 @@
 #define BITCOIN_ZMQ_ZMQABSTRACTNOTIFIER_H
 
 #include "zmqconfig.h"
+#include "notificationqueue.h"
 
 class CBlockIndex;
 class CZMQAbstractNotifier;
@@ -26,19 +27,20 @@ public:
 
     std::string GetType() const { return type; }
     void SetType(const std::string &t) { type = t; }
+    std::string GetTopic() const { return topic; }
+    void SetTopic(const std::string &t) { topic = t; }
     std::string GetAddress() const { return address; }
     void SetAddress(const std::string &a) { address = a; }
 
     virtual bool Initialize(void *pcontext) = 0;
     virtual void Shutdown() = 0;
 
-    virtual bool NotifyBlock(const CBlockIndex *pindex);
-    virtual bool NotifyBlock(const CBlock& pblock);
-    virtual bool NotifyTransaction(const CTransaction &transaction);
+    virtual bool NotifyMessage(const CNotificationMessage &message);
 
 protected:
     void *psocket;
     std::string type;
+    std::string topic;
     std::string address;
 };
 
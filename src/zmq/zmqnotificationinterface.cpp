@@ -5,9 +5,6 @@
 #include "zmqnotificationinterface.h"
 #include "zmqpublishnotifier.h"
 
-#include "version.h"
-#include "main.h"
-#include "streams.h"
 #include "util.h"
 
 void zmqError(const char *str)
@@ -32,24 +29,17 @@ CZMQNotificationInterface::~CZMQNotificationInterface()
 CZMQNotificationInterface* CZMQNotificationInterface::CreateWithArguments(const std::map<std::string, std::string> &args)
 {
     CZMQNotificationInterface* notificationInterface = NULL;
-    std::map<std::string, CZMQNotifierFactory> factories;
     std::list<CZMQAbstractNotifier*> notifiers;
 
-    factories["pubhashblock"] = CZMQAbstractNotifier::Create<CZMQPublishHashBlockNotifier>;
-    factories["pubhashtx"] = CZMQAbstractNotifier::Create<CZMQPublishHashTransactionNotifier>;
-    factories["pubrawblock"] = CZMQAbstractNotifier::Create<CZMQPublishRawBlockNotifier>;
-    factories["pubrawtx"] = CZMQAbstractNotifier::Create<CZMQPublishRawTransactionNotifier>;
-    factories["pubcheckedblock"] = CZMQAbstractNotifier::Create<CZMQPublishCheckedBlockNotifier>;
-
-    for (std::map<std::string, CZMQNotifierFactory>::const_iterator i=factories.begin(); i!=factories.end(); ++i)
+    for (const std::string &topic : GetNotificationTopics())
     {
-        std::map<std::string, std::string>::const_iterator j = args.find("-zmq" + i->first);
+        std::map<std::string, std::string>::const_iterator j = args.find("-zmqpub" + topic);
         if (j!=args.end())
         {
-            CZMQNotifierFactory factory = i->second;
             std::string address = j->second;
-            CZMQAbstractNotifier *notifier = factory();
-            notifier->SetType(i->first);
+            CZMQAbstractNotifier *notifier = CZMQAbstractNotifier::Create<CZMQPublishNotifier>();
+            notifier->SetType("pub" + topic);
+            notifier->SetTopic(topic);
             notifier->SetAddress(address);
             notifiers.push_back(notifier);
         }
@@ -125,57 +115,32 @@ void CZMQNotificationInterface::Shutdown()
     }
 }
 
-void CZMQNotificationInterface::UpdatedBlockTip(const CBlockIndex *pindex)
-{
-    for (std::list<CZMQAbstractNotifier*>::iterator i = notifiers.begin(); i!=notifiers.end(); )
-    {
-        CZMQAbstractNotifier *notifier = *i;
-        if (notifier->NotifyBlock(pindex))
-        {
-            i++;
-        }
-        else
-        {
-            notifier->Shutdown();
-            i = notifiers.erase(i);
-        }
-    }
-}
-
-void CZMQNotificationInterface::BlockChecked(const CBlock& block, const CValidationState& state)
+std::set<std::string> CZMQNotificationInterface::GetTopics() const
 {
-    if (state.IsInvalid()) {
-        return;
-    }
-
-    for (std::list<CZMQAbstractNotifier*>::iterator i = notifiers.begin(); i!=notifiers.end(); )
+    std::set<std::string> topics;
+    for (std::list<CZMQAbstractNotifier*>::const_iterator i = notifiers.begin(); i!=notifiers.end(); ++i)
     {
-        CZMQAbstractNotifier *notifier = *i;
-        if (notifier->NotifyBlock(block))
-        {
-            i++;
-        }
-        else
-        {
-            notifier->Shutdown();
-            i = notifiers.erase(i);
-        }
+        topics.insert((*i)->GetTopic());
     }
+    return topics;
 }
 
-void CZMQNotificationInterface::SyncTransaction(const CTransaction &tx, const CBlock *pblock)
+void CZMQNotificationInterface::PublishBatch(const std::vector<CNotificationMessage> &batch)
 {
-    for (std::list<CZMQAbstractNotifier*>::iterator i = notifiers.begin(); i!=notifiers.end(); )
+    for (const CNotificationMessage &message : batch)
     {
-        CZMQAbstractNotifier *notifier = *i;
-        if (notifier->NotifyTransaction(tx))
+        for (std::list<CZMQAbstractNotifier*>::iterator i = notifiers.begin(); i!=notifiers.end(); )
         {
-            i++;
-        }
-        else
-        {
-            notifier->Shutdown();
-            i = notifiers.erase(i);
+            CZMQAbstractNotifier *notifier = *i;
+            if (notifier->NotifyMessage(message))
+            {
+                i++;
+            }
+            else
+            {
+                notifier->Shutdown();
+                i = notifiers.erase(i);
+            }
         }
     }
 }
@@ -5,30 +5,29 @@
 #ifndef BITCOIN_ZMQ_ZMQNOTIFICATIONINTERFACE_H
 #define BITCOIN_ZMQ_ZMQNOTIFICATIONINTERFACE_H
 
-#include "validationinterface.h"
-#include "consensus/validation.h"
+#include "notificationqueue.h"
+#include <list>
 #include <string>
 #include <map>
 
 class CBlockIndex;
 class CZMQAbstractNotifier;
 
-class CZMQNotificationInterface : public CValidationInterface
+class CZMQNotificationInterface : public CNotificationSink
 {
 public:
     virtual ~CZMQNotificationInterface();
 
     static CZMQNotificationInterface* CreateWithArguments(const std::map<std::string, std::string> &args);
 
+    // CNotificationSink
+    std::set<std::string> GetTopics() const;
+    void PublishBatch(const std::vector<CNotificationMessage> &batch);
+
 protected:
     bool Initialize();
     void Shutdown();
 
-    // CValidationInterface
-    void SyncTransaction(const CTransaction &tx, const CBlock *pblock);
-    void UpdatedBlockTip(const CBlockIndex *pindex);
-    void BlockChecked(const CBlock& block, const CValidationState& state);
-
 private:
     CZMQNotificationInterface();
 
@@ -2,68 +2,82 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or https://www.opensource.org/licenses/mit-license.php .
 
-#include "chainparams.h"
 #include "zmqpublishnotifier.h"
-#include "main.h"
+#include "crypto/common.h"
 #include "util.h"
 
-static std::multimap<std::string, CZMQAbstractPublishNotifier*> mapPublishNotifiers;
+static std::multimap<std::string, CZMQPublishNotifier*> mapPublishNotifiers;
 
-static const char *MSG_HASHBLOCK = "hashblock";
-static const char *MSG_HASHTX    = "hashtx";
-static const char *MSG_RAWBLOCK  = "rawblock";
-static const char *MSG_RAWTX     = "rawtx";
-static const char *MSG_CHECKEDBLOCK = "checkedblock";
+//! payloads from this size on are handed to zmq without copying them
+static const size_t ZMQ_ZERO_COPY_SIZE = 1024;
 
-// Internal function to send multipart message
-static int zmq_send_multipart(void *sock, const void* data, size_t size, ...)
+// Internal function to send one part of a multipart message
+static int zmq_send_part(void *sock, const void* data, size_t size, int flags)
 {
-    va_list args;
-    va_start(args, size);
+    zmq_msg_t msg;
 
-    while (1)
+    int rc = zmq_msg_init_size(&msg, size);
+    if (rc != 0)
     {
-        zmq_msg_t msg;
-
-        int rc = zmq_msg_init_size(&msg, size);
-        if (rc != 0)
-        {
-            zmqError("Unable to initialize ZMQ msg");
-            va_end(args);
-            return -1;
-        }
+        zmqError("Unable to initialize ZMQ msg");
+        return -1;
+    }
 
-        void *buf = zmq_msg_data(&msg);
-        memcpy(buf, data, size);
+    memcpy(zmq_msg_data(&msg), data, size);
 
-        data = va_arg(args, const void*);
+    rc = zmq_msg_send(&msg, sock, flags);
+    if (rc == -1)
+    {
+        zmqError("Unable to send ZMQ msg");
+        zmq_msg_close(&msg);
+        return -1;
+    }
 
-        rc = zmq_msg_send(&msg, sock, data ? ZMQ_SNDMORE : 0);
-        if (rc == -1)
-        {
-            zmqError("Unable to send ZMQ msg");
-            zmq_msg_close(&msg);
-            va_end(args);
-            return -1;
-        }
+    zmq_msg_close(&msg);
+    return 0;
+}
 
-        zmq_msg_close(&msg);
+// Called by zmq once it is done with a payload sent without a copy
+static void zmq_release_payload(void *, void *hint)
+{
+    delete static_cast<CNotificationPayload*>(hint);
+}
 
-        if (!data)
-            break;
+// Internal function to send a shared payload as one part of a multipart message
+static int zmq_send_payload(void *sock, const CNotificationPayload &payload, int flags)
+{
+    if (payload->size() < ZMQ_ZERO_COPY_SIZE)
+        return zmq_send_part(sock, payload->data(), payload->size(), flags);
+
+    // the message keeps a reference to the payload, which other notifiers may be sending as well
+    CNotificationPayload *pReference = new CNotificationPayload(payload);
+    zmq_msg_t msg;
+    int rc = zmq_msg_init_data(&msg, (void*)payload->data(), payload->size(), zmq_release_payload, pReference);
+    if (rc != 0)
+    {
+        delete pReference;
+        zmqError("Unable to initialize ZMQ msg");
+        return -1;
+    }
 
-        size = va_arg(args, size_t);
+    rc = zmq_msg_send(&msg, sock, flags);
+    if (rc == -1)
+    {
+        zmqError("Unable to send ZMQ msg");
+        zmq_msg_close(&msg);
+        return -1;
     }
-    va_end(args);
+
+    zmq_msg_close(&msg);
     return 0;
 }
 
-bool CZMQAbstractPublishNotifier::Initialize(void *pcontext)
+bool CZMQPublishNotifier::Initialize(void *pcontext)
 {
     assert(!psocket);
 
     // check if address is being used by other publish notifier
-    std::multimap<std::string, CZMQAbstractPublishNotifier*>::iterator i = mapPublishNotifiers.find(address);
+    std::multimap<std::string, CZMQPublishNotifier*>::iterator i = mapPublishNotifiers.find(address);
 
     if (i==mapPublishNotifiers.end())
     {
@@ -97,14 +111,14 @@ bool CZMQAbstractPublishNotifier::Initialize(void *pcontext)
     }
 }
 
-void CZMQAbstractPublishNotifier::Shutdown()
+void CZMQPublishNotifier::Shutdown()
 {
     assert(psocket);
 
     int count = mapPublishNotifiers.count(address);
 
     // remove this notifier from the list of publishers using this address
-    typedef std::multimap<std::string, CZMQAbstractPublishNotifier*>::iterator iterator;
+    typedef std::multimap<std::string, CZMQPublishNotifier*>::iterator iterator;
     std::pair<iterator, iterator> iterpair = mapPublishNotifiers.equal_range(address);
 
     for (iterator it = iterpair.first; it != iterpair.second; ++it)
@@ -127,15 +141,16 @@ void CZMQAbstractPublishNotifier::Shutdown()
     psocket = 0;
 }
 
-bool CZMQAbstractPublishNotifier::SendMessage(const char *command, const void* data, size_t size)
+bool CZMQPublishNotifier::SendMessage(const char *command, const CNotificationPayload &payload)
 {
     assert(psocket);
 
     /* send three parts, command & data & a LE 4byte sequence number */
     unsigned char msgseq[sizeof(uint32_t)];
     WriteLE32(&msgseq[0], nSequence);
-    int rc = zmq_send_multipart(psocket, command, strlen(command), data, size, msgseq, (size_t)sizeof(uint32_t), (void*)0);
-    if (rc == -1)
+    if (zmq_send_part(psocket, command, strlen(command), ZMQ_SNDMORE) == -1 ||
+        zmq_send_payload(psocket, payload, ZMQ_SNDMORE) == -1 ||
+        zmq_send_part(psocket, msgseq, sizeof(uint32_t), 0) == -1)
         return false;
 
     /* increment memory only sequence number after sending */
@@ -144,65 +159,10 @@ bool CZMQAbstractPublishNotifier::SendMessage(const char *command, const void* d
     return true;
 }
 
-bool CZMQPublishHashBlockNotifier::NotifyBlock(const CBlockIndex *pindex)
+bool CZMQPublishNotifier::NotifyMessage(const CNotificationMessage &message)
 {
-    uint256 hash = pindex->GetBlockHash();
-    LogPrint("zmq", "zmq: Publish hashblock %s\n", hash.GetHex());
-    char data[32];
-    for (unsigned int i = 0; i < 32; i++)
-        data[31 - i] = hash.begin()[i];
-    return SendMessage(MSG_HASHBLOCK, data, 32);
-}
-
-bool CZMQPublishHashTransactionNotifier::NotifyTransaction(const CTransaction &transaction)
-{
-    uint256 hash = transaction.GetHash();
-    LogPrint("zmq", "zmq: Publish hashtx %s\n", hash.GetHex());
-    char data[32];
-    for (unsigned int i = 0; i < 32; i++)
-        data[31 - i] = hash.begin()[i];
-    return SendMessage(MSG_HASHTX, data, 32);
-}
-
-bool CZMQPublishRawBlockNotifier::NotifyBlock(const CBlockIndex *pindex)
-{
-    LogPrint("zmq", "zmq: Publish rawblock %s\n", pindex->GetBlockHash().GetHex());
-
-    const Consensus::Params& consensusParams = Params().GetConsensus();
-    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
-    {
-        LOCK(cs_main);
-        CBlock block;
-        if(!ReadBlockFromDisk(block, pindex, consensusParams, 1))
-        {
-            zmqError("Can't read block from disk");
-            return false;
-        }
-
-        ss << block;
-    }
-
-    return SendMessage(MSG_RAWBLOCK, &(*ss.begin()), ss.size());
-}
-
-bool CZMQPublishCheckedBlockNotifier::NotifyBlock(const CBlock& block)
-{
-    LogPrint("zmq", "zmq: Publish checkedblock %s\n", block.GetHash().GetHex());
-
-    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
-    {
-        LOCK(cs_main);
-        ss << block;
-    }
-
-    return SendMessage(MSG_CHECKEDBLOCK, &(*ss.begin()), ss.size());
-}
-
-bool CZMQPublishRawTransactionNotifier::NotifyTransaction(const CTransaction &transaction)
-{
-    uint256 hash = transaction.GetHash();
-    LogPrint("zmq", "zmq: Publish rawtx %s\n", hash.GetHex());
-    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
-    ss << transaction;
-    return SendMessage(MSG_RAWTX, &(*ss.begin()), ss.size());
+    if (message.topic != topic)
+        return true;
+    LogPrint("zmq", "zmq: Publish %s, %u bytes\n", topic, message.payload->size());
+    return SendMessage(topic.c_str(), message.payload);
 }
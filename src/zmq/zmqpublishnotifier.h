@@ -7,9 +7,7 @@
 
 #include "zmqabstractnotifier.h"
 
-class CBlockIndex;
-
-class CZMQAbstractPublishNotifier : public CZMQAbstractNotifier
+class CZMQPublishNotifier : public CZMQAbstractNotifier
 {
 private:
     uint32_t nSequence; //! upcounting per message sequence number
@@ -22,40 +20,13 @@ public:
           * data
           * message sequence number
     */
-    bool SendMessage(const char *command, const void* data, size_t size);
+    bool SendMessage(const char *command, const CNotificationPayload &payload);
 
     bool Initialize(void *pcontext);
     void Shutdown();
-};
-
-class CZMQPublishHashBlockNotifier : public CZMQAbstractPublishNotifier
-{
-public:
-    bool NotifyBlock(const CBlockIndex *pindex);
-};
-
-class CZMQPublishHashTransactionNotifier : public CZMQAbstractPublishNotifier
-{
-public:
-    bool NotifyTransaction(const CTransaction &transaction);
-};
 
-class CZMQPublishRawBlockNotifier : public CZMQAbstractPublishNotifier
-{
-public:
-    bool NotifyBlock(const CBlockIndex *pindex);
-};
-
-class CZMQPublishRawTransactionNotifier : public CZMQAbstractPublishNotifier
-{
-public:
-    bool NotifyTransaction(const CTransaction &transaction);
-};
-
-class CZMQPublishCheckedBlockNotifier : public CZMQAbstractPublishNotifier
-{
-public:
-    bool NotifyBlock(const CBlock &block);
+    //! publish a message of the topic of this notifier
+    bool NotifyMessage(const CNotificationMessage &message);
 };
 
 #endif // BITCOIN_ZMQ_ZMQPUBLISHNOTIFIER_H